@@ -0,0 +1,242 @@
+/*******************************************************************************
+* File Name: app_event.c
+*
+* Description: This file contains the event bus between the acquisition, the
+* BLE server and the display. Every subscriber owns a fixed-size queue of the
+* event types it asked for. Producers claim queue slots with a compare and
+* swap and never block, so events are published from tasks, the BT stack and
+* interrupts alike; an event that finds a queue full is dropped and counted.
+* The subscriber task is woken through its task notification.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stddef.h>
+#include "app_event.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static app_event_queue_t *app_event_subscribers[APP_EVENT_SUBSCRIBERS_MAX];
+static uint32_t app_event_subscriber_count = 0u;
+
+/*******************************************************************************
+* Function Name: app_event_push
+********************************************************************************
+* Summary:
+*  Appends an event to a subscriber queue. Each slot carries the position it
+*  is next free or filled at, so a producer only needs to claim the position;
+*  a producer interrupted between claim and write delays the subscriber, but
+*  never another producer.
+*
+* Parameters:
+*  app_event_queue_t *p_queue   : Subscriber queue
+*  const app_event_t *p_event   : Event
+*
+* Return:
+*  bool : false if the queue is full
+*
+*******************************************************************************/
+static bool app_event_push(app_event_queue_t *p_queue, const app_event_t *p_event)
+{
+    uint32_t pos = __atomic_load_n(&p_queue->head, __ATOMIC_RELAXED);
+    app_event_slot_t *p_slot;
+    int32_t depth;
+    uint16_t high_water;
+
+    for (;;)
+    {
+        int32_t diff;
+
+        p_slot = &p_queue->slot[pos & (APP_EVENT_QUEUE_LEN - 1u)];
+        diff = (int32_t)(__atomic_load_n(&p_slot->seq, __ATOMIC_ACQUIRE) - pos);
+
+        if (0 == diff)
+        {
+            if (__atomic_compare_exchange_n(&p_queue->head, &pos, pos + 1u, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = __atomic_load_n(&p_queue->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    p_slot->event = *p_event;
+    __atomic_store_n(&p_slot->seq, pos + 1u, __ATOMIC_RELEASE);
+
+    /* Negative if the subscriber has read past this event meanwhile */
+    depth = (int32_t)(pos + 1u - __atomic_load_n(&p_queue->tail, __ATOMIC_RELAXED));
+    high_water = __atomic_load_n(&p_queue->stats.high_water, __ATOMIC_RELAXED);
+    while ((depth > (int32_t)high_water) &&
+           !__atomic_compare_exchange_n(&p_queue->stats.high_water, &high_water, (uint16_t)depth, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: app_event_subscribe
+********************************************************************************
+* Summary:
+*  Registers a subscriber queue. Subscribers are registered at startup and
+*  stay for the lifetime of the application.
+*
+* Parameters:
+*  app_event_queue_t *p_queue : Queue storage of the subscriber
+*  uint32_t mask              : APP_EVENT_MASK of the types to deliver
+*  TaskHandle_t task          : Task notified on delivery; NULL to poll
+*
+* Return:
+*  bool : false if APP_EVENT_SUBSCRIBERS_MAX queues are registered already
+*
+*******************************************************************************/
+bool app_event_subscribe(app_event_queue_t *p_queue, uint32_t mask, TaskHandle_t task)
+{
+    uint32_t count = __atomic_load_n(&app_event_subscriber_count, __ATOMIC_RELAXED);
+
+    if (count >= APP_EVENT_SUBSCRIBERS_MAX)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0u; i < APP_EVENT_QUEUE_LEN; i++)
+    {
+        p_queue->slot[i].seq = i;
+    }
+    p_queue->head = 0u;
+    p_queue->tail = 0u;
+    p_queue->mask = mask;
+    p_queue->task = task;
+    p_queue->stats = (app_event_stats_t){ .depth = APP_EVENT_QUEUE_LEN };
+
+    app_event_subscribers[count] = p_queue;
+    __atomic_store_n(&app_event_subscriber_count, count + 1u, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: app_event_publish
+********************************************************************************
+* Summary:
+*  Delivers an event to every subscriber of its type and wakes their tasks.
+*  Never blocks; can be called from any task or interrupt.
+*
+* Parameters:
+*  const app_event_t *p_event : Event
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void app_event_publish(const app_event_t *p_event)
+{
+    uint32_t count = __atomic_load_n(&app_event_subscriber_count, __ATOMIC_ACQUIRE);
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    bool in_isr = xPortIsInsideInterrupt();
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        app_event_queue_t *p_queue = app_event_subscribers[i];
+
+        if (0u == (p_queue->mask & APP_EVENT_MASK(p_event->type)))
+        {
+            continue;
+        }
+
+        if (!app_event_push(p_queue, p_event))
+        {
+            (void)__atomic_add_fetch(&p_queue->stats.dropped, 1u, __ATOMIC_RELAXED);
+            continue;
+        }
+        (void)__atomic_add_fetch(&p_queue->stats.received, 1u, __ATOMIC_RELAXED);
+
+        if (NULL == p_queue->task)
+        {
+            continue;
+        }
+        if (in_isr)
+        {
+            vTaskNotifyGiveFromISR(p_queue->task, &higher_priority_task_woken);
+        }
+        else
+        {
+            xTaskNotifyGive(p_queue->task);
+        }
+    }
+
+    if (in_isr)
+    {
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_event_receive
+********************************************************************************
+* Summary:
+*  Takes the oldest event from a subscriber queue. Must only be called by the
+*  subscriber.
+*
+* Parameters:
+*  app_event_queue_t *p_queue : Subscriber queue
+*  app_event_t *p_event       : Receives the event
+*
+* Return:
+*  bool : false if no event is ready
+*
+*******************************************************************************/
+bool app_event_receive(app_event_queue_t *p_queue, app_event_t *p_event)
+{
+    uint32_t pos = p_queue->tail;
+    app_event_slot_t *p_slot = &p_queue->slot[pos & (APP_EVENT_QUEUE_LEN - 1u)];
+
+    if ((int32_t)(__atomic_load_n(&p_slot->seq, __ATOMIC_ACQUIRE) - (pos + 1u)) < 0)
+    {
+        return false;
+    }
+
+    *p_event = p_slot->event;
+    __atomic_store_n(&p_slot->seq, pos + APP_EVENT_QUEUE_LEN, __ATOMIC_RELEASE);
+    __atomic_store_n(&p_queue->tail, pos + 1u, __ATOMIC_RELAXED);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: app_event_get_stats
+********************************************************************************
+* Summary:
+*  Copies the counters of a subscriber queue.
+*
+* Parameters:
+*  const app_event_queue_t *p_queue : Subscriber queue
+*  app_event_stats_t *p_stats       : Receives the counters
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void app_event_get_stats(const app_event_queue_t *p_queue, app_event_stats_t *p_stats)
+{
+    if ((NULL != p_queue) && (NULL != p_stats))
+    {
+        *p_stats = p_queue->stats;
+    }
+}
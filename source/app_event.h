@@ -0,0 +1,104 @@
+/*******************************************************************************
+* File Name: app_event.h
+*
+* Description: This file is the public interface of app_event.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef APP_EVENT_H_
+#define APP_EVENT_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Events a subscriber can hold before further ones are dropped; a power of 2 */
+#define APP_EVENT_QUEUE_LEN             (8u)
+#define APP_EVENT_SUBSCRIBERS_MAX       (4u)
+
+#define APP_EVENT_MASK(type)            (1UL << (uint32_t)(type))
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+typedef enum
+{
+    APP_EVENT_SAMPLE,       /* New CO2 sample published */
+    APP_EVENT_CONNECTION,   /* Central connected or disconnected */
+    APP_EVENT_ALARM,        /* CO2 crossed the alarm threshold */
+    APP_EVENT_BUTTON,       /* User button pressed */
+    APP_EVENT_TYPE_COUNT
+} app_event_type_t;
+
+typedef struct
+{
+    app_event_type_t type;
+    union
+    {
+        struct
+        {
+            uint16_t co2_ppm;
+            uint32_t seq;           /* Sequence number of the sensor state */
+        } sample;
+        struct
+        {
+            bool     connected;
+            uint8_t  count;         /* Centrals connected after the change */
+        } connection;
+        struct
+        {
+            bool     active;
+            uint16_t co2_ppm;
+        } alarm;
+    } data;
+} app_event_t;
+
+/* Counters of a subscriber queue */
+typedef struct
+{
+    uint16_t depth;         /* Queue capacity */
+    uint16_t high_water;    /* Most events queued at once */
+    uint32_t received;      /* Events queued */
+    uint32_t dropped;       /* Events lost to a full queue */
+} app_event_stats_t;
+
+typedef struct
+{
+    uint32_t     seq;
+    app_event_t  event;
+} app_event_slot_t;
+
+/* Queue of a subscriber; the storage belongs to the subscriber */
+typedef struct
+{
+    app_event_slot_t    slot[APP_EVENT_QUEUE_LEN];
+    uint32_t            head;       /* Next slot claimed by a producer */
+    uint32_t            tail;       /* Next slot read by the subscriber */
+    uint32_t            mask;       /* APP_EVENT_MASK of the types delivered */
+    TaskHandle_t        task;       /* Notified after each delivery */
+    app_event_stats_t   stats;
+} app_event_queue_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+bool app_event_subscribe(app_event_queue_t *p_queue, uint32_t mask, TaskHandle_t task);
+void app_event_publish(const app_event_t *p_event);
+bool app_event_receive(app_event_queue_t *p_queue, app_event_t *p_event);
+void app_event_get_stats(const app_event_queue_t *p_queue, app_event_stats_t *p_stats);
+
+#endif /* APP_EVENT_H_ */
@@ -0,0 +1,194 @@
+/*******************************************************************************
+* File Name: app_trace.c
+*
+* Description: This file contains the deferred trace. Callers in the GATT
+* handlers, the connection callback and the sensor path store the address of
+* a format string and its raw arguments in a RAM ring, which takes a few
+* dozen cycles instead of the milliseconds a line costs on the blocking
+* retarget-io UART. A low-priority task formats the records and prints them
+* when nothing else runs. Records that find the ring full are dropped and
+* counted; writers never block.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "app_trace.h"
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t    seq;        /* Position the slot is next free or filled at */
+    const char  *fmt;
+    uint32_t    time_ms;
+    uint32_t    argc;
+    uint32_t    args[APP_TRACE_MAX_ARGS];
+} app_trace_record_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Initialized statically so that records can be written before main runs
+ * any initialization */
+_Static_assert(APP_TRACE_RING_LEN == 32u, "app_trace_ring initializer covers 32 slots");
+
+static app_trace_record_t app_trace_ring[APP_TRACE_RING_LEN] =
+{
+    /* Slot n is free for position n */
+#define APP_TRACE_SLOT(n)   [n] = { .seq = (n) }
+    APP_TRACE_SLOT(0),  APP_TRACE_SLOT(1),  APP_TRACE_SLOT(2),  APP_TRACE_SLOT(3),
+    APP_TRACE_SLOT(4),  APP_TRACE_SLOT(5),  APP_TRACE_SLOT(6),  APP_TRACE_SLOT(7),
+    APP_TRACE_SLOT(8),  APP_TRACE_SLOT(9),  APP_TRACE_SLOT(10), APP_TRACE_SLOT(11),
+    APP_TRACE_SLOT(12), APP_TRACE_SLOT(13), APP_TRACE_SLOT(14), APP_TRACE_SLOT(15),
+    APP_TRACE_SLOT(16), APP_TRACE_SLOT(17), APP_TRACE_SLOT(18), APP_TRACE_SLOT(19),
+    APP_TRACE_SLOT(20), APP_TRACE_SLOT(21), APP_TRACE_SLOT(22), APP_TRACE_SLOT(23),
+    APP_TRACE_SLOT(24), APP_TRACE_SLOT(25), APP_TRACE_SLOT(26), APP_TRACE_SLOT(27),
+    APP_TRACE_SLOT(28), APP_TRACE_SLOT(29), APP_TRACE_SLOT(30), APP_TRACE_SLOT(31)
+#undef APP_TRACE_SLOT
+};
+static uint32_t app_trace_head = 0u;
+static uint32_t app_trace_tail = 0u;
+static uint32_t app_trace_dropped = 0u;
+static TaskHandle_t app_trace_task_handle = NULL;
+
+/*******************************************************************************
+* Function Name: app_trace_write
+********************************************************************************
+* Summary:
+*  Stores a trace record; called through the APP_TRACE_* macros. Can be
+*  called from any task or interrupt, and before the scheduler starts.
+*
+* Parameters:
+*  uint32_t argc    : Number of arguments after the format string
+*  const char *fmt  : printf format string; must be a literal
+*  ...              : Integer arguments
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void app_trace_write(uint32_t argc, const char *fmt, ...)
+{
+    uint32_t pos = __atomic_load_n(&app_trace_head, __ATOMIC_RELAXED);
+    app_trace_record_t *p_rec;
+    TaskHandle_t task;
+    va_list ap;
+
+    for (;;)
+    {
+        int32_t diff;
+
+        p_rec = &app_trace_ring[pos & (APP_TRACE_RING_LEN - 1u)];
+        diff = (int32_t)(__atomic_load_n(&p_rec->seq, __ATOMIC_ACQUIRE) - pos);
+
+        if (0 == diff)
+        {
+            if (__atomic_compare_exchange_n(&app_trace_head, &pos, pos + 1u, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            (void)__atomic_add_fetch(&app_trace_dropped, 1u, __ATOMIC_RELAXED);
+            return;
+        }
+        else
+        {
+            pos = __atomic_load_n(&app_trace_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    p_rec->fmt = fmt;
+    p_rec->time_ms = (uint32_t)(xTaskGetTickCountFromISR() * portTICK_PERIOD_MS);
+    p_rec->argc = (argc < APP_TRACE_MAX_ARGS) ? argc : APP_TRACE_MAX_ARGS;
+    va_start(ap, fmt);
+    for (uint32_t i = 0u; i < p_rec->argc; i++)
+    {
+        p_rec->args[i] = va_arg(ap, uint32_t);
+    }
+    va_end(ap);
+    __atomic_store_n(&p_rec->seq, pos + 1u, __ATOMIC_RELEASE);
+
+    /* Wake the trace task on the first record of a burst only */
+    task = __atomic_load_n(&app_trace_task_handle, __ATOMIC_ACQUIRE);
+    if ((NULL != task) && (pos == __atomic_load_n(&app_trace_tail, __ATOMIC_RELAXED)))
+    {
+        if (xPortIsInsideInterrupt())
+        {
+            BaseType_t higher_priority_task_woken = pdFALSE;
+
+            vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+            portYIELD_FROM_ISR(higher_priority_task_woken);
+        }
+        else
+        {
+            xTaskNotifyGive(task);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_trace_task
+********************************************************************************
+* Summary:
+*  Task that prints the trace records in the order they were written,
+*  prefixed with their time in ms, and reports dropped records.
+*
+* Parameters:
+*  void *param : Task parameter defined during task creation (unused)
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void app_trace_task(void *param)
+{
+    uint32_t dropped_reported = 0u;
+
+    (void)param;
+
+    __atomic_store_n(&app_trace_task_handle, xTaskGetCurrentTaskHandle(), __ATOMIC_RELEASE);
+
+    for (;;)
+    {
+        uint32_t pos = app_trace_tail;
+        app_trace_record_t *p_rec = &app_trace_ring[pos & (APP_TRACE_RING_LEN - 1u)];
+        uint32_t dropped;
+
+        if ((int32_t)(__atomic_load_n(&p_rec->seq, __ATOMIC_ACQUIRE) - (pos + 1u)) >= 0)
+        {
+            printf("[%lu] ", (unsigned long)p_rec->time_ms);
+            printf(p_rec->fmt, p_rec->args[0], p_rec->args[1], p_rec->args[2],
+                   p_rec->args[3], p_rec->args[4], p_rec->args[5]);
+
+            __atomic_store_n(&p_rec->seq, pos + APP_TRACE_RING_LEN, __ATOMIC_RELEASE);
+            __atomic_store_n(&app_trace_tail, pos + 1u, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        dropped = __atomic_load_n(&app_trace_dropped, __ATOMIC_RELAXED);
+        if (dropped != dropped_reported)
+        {
+            printf("[trace] %lu records dropped\r\n", (unsigned long)(dropped - dropped_reported));
+            dropped_reported = dropped;
+        }
+
+        /* A writer that read the tail just before it moved here gives no
+         * notification; the timeout picks its record up */
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000u));
+    }
+}
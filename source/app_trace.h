@@ -0,0 +1,82 @@
+/*******************************************************************************
+* File Name: app_trace.h
+*
+* Description: This file is the public interface of app_trace.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef APP_TRACE_H_
+#define APP_TRACE_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define APP_TRACE_LEVEL_NONE            (0)
+#define APP_TRACE_LEVEL_ERROR           (1)
+#define APP_TRACE_LEVEL_WARN            (2)
+#define APP_TRACE_LEVEL_INFO            (3)
+#define APP_TRACE_LEVEL_DEBUG           (4)
+
+/* Call sites above this level are removed at compile time, arguments
+ * included */
+#ifndef APP_TRACE_LEVEL
+#define APP_TRACE_LEVEL                 APP_TRACE_LEVEL_INFO
+#endif
+
+/* Records held until the trace task prints them; a power of 2 */
+#define APP_TRACE_RING_LEN              (32u)
+#define APP_TRACE_MAX_ARGS              (6u)
+
+#define APP_TRACE_TASK_PRIORITY         (1u)
+#define APP_TRACE_TASK_STACK_SIZE       (512u)
+
+/* Number of arguments after the format string, up to APP_TRACE_MAX_ARGS */
+#define APP_TRACE_ARGC(...)             APP_TRACE_ARGC_(__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0, _)
+#define APP_TRACE_ARGC_(fmt, a1, a2, a3, a4, a5, a6, n, ...)    n
+
+/* Records a printf format string literal with up to APP_TRACE_MAX_ARGS
+ * integer arguments. Only the address of the string and the raw arguments
+ * are stored; the text is formatted later by the trace task, so %s and
+ * floating-point conversions are not supported. */
+#define APP_TRACE(...)                  app_trace_write(APP_TRACE_ARGC(__VA_ARGS__), __VA_ARGS__)
+
+#if (APP_TRACE_LEVEL >= APP_TRACE_LEVEL_ERROR)
+#define APP_TRACE_ERROR(...)            APP_TRACE(__VA_ARGS__)
+#else
+#define APP_TRACE_ERROR(...)            ((void)0)
+#endif
+#if (APP_TRACE_LEVEL >= APP_TRACE_LEVEL_WARN)
+#define APP_TRACE_WARN(...)             APP_TRACE(__VA_ARGS__)
+#else
+#define APP_TRACE_WARN(...)             ((void)0)
+#endif
+#if (APP_TRACE_LEVEL >= APP_TRACE_LEVEL_INFO)
+#define APP_TRACE_INFO(...)             APP_TRACE(__VA_ARGS__)
+#else
+#define APP_TRACE_INFO(...)             ((void)0)
+#endif
+#if (APP_TRACE_LEVEL >= APP_TRACE_LEVEL_DEBUG)
+#define APP_TRACE_DEBUG(...)            APP_TRACE(__VA_ARGS__)
+#else
+#define APP_TRACE_DEBUG(...)            ((void)0)
+#endif
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void app_trace_write(uint32_t argc, const char *fmt, ...);
+void app_trace_task(void *param);
+
+#endif /* APP_TRACE_H_ */
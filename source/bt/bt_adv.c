@@ -0,0 +1,550 @@
+/*******************************************************************************
+* File Name: bt_adv.c
+*
+* Description: This file contains the advertising payload and schedule of
+* the GATT server. In beacon mode the advertisement carries the latest CO2
+* sample as service data, so that any number of scanners read it without
+* connecting. The payload is built once; each sample rewrites only its value
+* bytes in place before the payload is handed to the stack.
+*
+* The device advertises fast for BT_ADV_FAST_WINDOW_MS after boot, a
+* disconnection, a button press or a CO2 alarm, and slow otherwise. After
+* boot and disconnections the fast window is preceded by high duty directed
+* advertising to the last bonded central, which reconnects within a few
+* milliseconds if it is in range. All
+* state changes run in the timer service task, so the stack callbacks, the
+* sensor task and the window timer never race on the state.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "cybsp.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "cycfg_gap.h"
+#include "cycfg_bt_settings.h"
+#include "wiced_bt_ble.h"
+#include "app_trace.h"
+#include "bt_adv.h"
+#include "bt_bond.h"
+#include "bt_conn.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Advertised service, least significant byte first */
+#define BT_ADV_SERVICE_UUID             0xD9u, 0x13u, 0x47u, 0x51u, 0xE7u, 0x2Eu, 0xE5u, 0x8Bu, \
+                                        0x52u, 0x48u, 0xB9u, 0x38u, 0x08u, 0xEFu, 0x4Au, 0x43u
+#define BT_ADV_SERVICE_UUID_LEN         (16u)
+
+/* Flags, service data and shortened name take all 31 bytes */
+#define BT_ADV_SHORT_NAME               "AirQ"
+#define BT_ADV_SHORT_NAME_LEN           (sizeof(BT_ADV_SHORT_NAME) - 1u)
+
+#define BT_ADV_ELEM_COUNT               (3u)
+
+/* Estimated radio time of an advertising event: a 47-byte PDU at 1 Mbit/s
+ * on each of the three primary channels, followed for connectable events by
+ * the wait for a scan or connection request */
+#define BT_ADV_PDU_US                   (376u)
+#define BT_ADV_RX_WINDOW_US             (190u)
+#define BT_ADV_EVENT_US_CONN            (3u * (BT_ADV_PDU_US + BT_ADV_RX_WINDOW_US))
+#define BT_ADV_EVENT_US_NONCONN         (3u * BT_ADV_PDU_US)
+
+/* High duty directed advertising repeats a 22-byte PDU on the three
+ * channels every 3.75 ms at most */
+#define BT_ADV_DIRECT_PDU_US            (176u)
+#define BT_ADV_EVENT_US_DIRECT          (3u * (BT_ADV_DIRECT_PDU_US + BT_ADV_RX_WINDOW_US))
+#define BT_ADV_DIRECT_INTERVAL          (6u)
+
+/* Advertising interval unit */
+#define BT_ADV_SLOT_US                  (625u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static uint8_t bt_adv_flags = BTM_BLE_GENERAL_DISCOVERABLE_FLAG | BTM_BLE_BREDR_NOT_SUPPORTED;
+static uint8_t bt_adv_service_data[BT_ADV_SERVICE_UUID_LEN + BT_ADV_BEACON_LEN] =
+{
+    BT_ADV_SERVICE_UUID
+};
+static uint8_t bt_adv_short_name[] = BT_ADV_SHORT_NAME;
+
+static wiced_bt_ble_advert_elem_t bt_adv_beacon_elem[BT_ADV_ELEM_COUNT] =
+{
+    { .advert_type = BTM_BLE_ADVERT_TYPE_FLAG, .len = 1u, .p_data = &bt_adv_flags },
+    { .advert_type = BTM_BLE_ADVERT_TYPE_128SERVICE_DATA, .len = sizeof(bt_adv_service_data),
+      .p_data = bt_adv_service_data },
+    { .advert_type = BTM_BLE_ADVERT_TYPE_NAME_SHORT, .len = BT_ADV_SHORT_NAME_LEN,
+      .p_data = bt_adv_short_name },
+};
+
+static bool bt_adv_beacon = BT_ADV_BEACON_DEFAULT;
+static bool bt_adv_ready = false;
+
+/* Stack advertising mode of each state */
+static const wiced_bt_ble_advert_mode_t bt_adv_mode[BT_ADV_STATE_COUNT] =
+{
+    [BT_ADV_STATE_OFF]      = BTM_BLE_ADVERT_OFF,
+    [BT_ADV_STATE_FAST]     = BTM_BLE_ADVERT_UNDIRECTED_HIGH,
+    [BT_ADV_STATE_SLOW]     = BTM_BLE_ADVERT_UNDIRECTED_LOW,
+    [BT_ADV_STATE_NONCONN]  = BTM_BLE_ADVERT_NONCONN_LOW,
+    [BT_ADV_STATE_DIRECTED] = BTM_BLE_ADVERT_DIRECTED_HIGH,
+};
+
+/* Owned by the timer service task */
+static TimerHandle_t bt_adv_window_timer = NULL;
+static uint8_t bt_adv_state = BT_ADV_STATE_OFF;
+static uint32_t bt_adv_state_since_ms = 0u;
+static uint32_t bt_adv_wait_since_ms = 0u;     /* Start of the wait for a central */
+static wiced_bt_device_address_t bt_adv_peer;   /* Target of directed advertising */
+static wiced_bt_ble_address_type_t bt_adv_peer_type;
+static bt_adv_stats_t bt_adv_stats;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+static void     bt_adv_apply(void);
+static uint32_t bt_adv_now_ms(void);
+static void     bt_adv_run(void *p_unused, uint32_t trigger);
+static void     bt_adv_enter(uint8_t state, uint32_t now_ms);
+static bool     bt_adv_directed_target(void);
+static void     bt_adv_account(uint32_t now_ms, bt_adv_stats_t *p_stats);
+static void     bt_adv_window_expired(TimerHandle_t timer);
+
+/*******************************************************************************
+* Function Name: bt_adv_init
+********************************************************************************
+* Summary:
+*  Sets the advertising payload of the current mode and creates the timer
+*  of the fast window. Must be called once the stack is enabled; the
+*  advertisements start with BT_ADV_TRIGGER_BOOT.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_adv_init(void)
+{
+    if (NULL == bt_adv_window_timer)
+    {
+        bt_adv_window_timer = xTimerCreate("BT adv", pdMS_TO_TICKS(BT_ADV_FAST_WINDOW_MS),
+                                           pdFALSE, NULL, bt_adv_window_expired);
+        CY_ASSERT(NULL != bt_adv_window_timer);
+    }
+    bt_adv_ready = true;
+    bt_adv_apply();
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_set_beacon
+********************************************************************************
+* Summary:
+*  Switches between the beacon payload and the configured advertisement.
+*  Once the connection limit is reached only a beacon keeps advertising.
+*
+* Parameters:
+*  bool enable : true for beacon mode
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_adv_set_beacon(bool enable)
+{
+    if (enable != bt_adv_beacon)
+    {
+        bt_adv_beacon = enable;
+        bt_adv_apply();
+        bt_adv_trigger(BT_ADV_TRIGGER_REFRESH);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_is_beacon
+********************************************************************************
+* Summary:
+*  Returns true in beacon mode.
+*
+*******************************************************************************/
+bool bt_adv_is_beacon(void)
+{
+    return bt_adv_beacon;
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_publish
+********************************************************************************
+* Summary:
+*  Writes a sample into the beacon payload and hands the payload to the
+*  stack. Only the value bytes of the service data change; the sequence is
+*  that of the sensor state, so scanners tell a new sample from a repeated
+*  advertisement. Called by the owner of the sensor state.
+*
+* Parameters:
+*  const bt_sensor_state_t *p_state : Published sensor state
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_adv_publish(const bt_sensor_state_t *p_state)
+{
+    uint8_t *p_val = &bt_adv_service_data[BT_ADV_SERVICE_UUID_LEN];
+
+    p_val[BT_ADV_BEACON_PPM_OFFSET] = (uint8_t)(p_state->co2_ppm & 0xFFu);
+    p_val[BT_ADV_BEACON_PPM_OFFSET + 1u] = (uint8_t)(p_state->co2_ppm >> 8u);
+    p_val[BT_ADV_BEACON_STATUS_OFFSET] = p_state->status;
+    p_val[BT_ADV_BEACON_SEQ_OFFSET] = (uint8_t)p_state->seq;
+
+    if (bt_adv_beacon)
+    {
+        bt_adv_apply();
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_trigger
+********************************************************************************
+* Summary:
+*  Reports an event affecting the advertising schedule. The state changes in
+*  the timer service task; can be called from any task.
+*
+* Parameters:
+*  uint8_t trigger : BT_ADV_TRIGGER_*
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_adv_trigger(uint8_t trigger)
+{
+    if (pdPASS != xTimerPendFunctionCall(bt_adv_run, NULL, trigger, 0u))
+    {
+        APP_TRACE_WARN("Advertising trigger %d lost\r\n", trigger);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_get_stats
+********************************************************************************
+* Summary:
+*  Copies the advertising counters, including the time of the current state.
+*
+* Parameters:
+*  bt_adv_stats_t *p_stats : Receives the counters
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_adv_get_stats(bt_adv_stats_t *p_stats)
+{
+    uint32_t now_ms = bt_adv_now_ms();
+
+    taskENTER_CRITICAL();
+    *p_stats = bt_adv_stats;
+    bt_adv_account(now_ms, p_stats);
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_now_ms
+********************************************************************************
+* Summary:
+*  Returns the time since the scheduler started in milliseconds.
+*
+*******************************************************************************/
+static uint32_t bt_adv_now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_run
+********************************************************************************
+* Summary:
+*  Moves the advertising schedule on a trigger. Runs in the timer service
+*  task. Without room for another central only a beacon advertises;
+*  otherwise boot, disconnections, button presses and alarms open a fast
+*  window, which steps down to slow when it ends, and advertising resumes
+*  slow after a connection. Boot and disconnections first advertise directed
+*  to the last bonded central, unless it is connected.
+*
+* Parameters:
+*  void *p_unused   : Unused
+*  uint32_t trigger : BT_ADV_TRIGGER_*
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_adv_run(void *p_unused, uint32_t trigger)
+{
+    uint32_t now_ms = bt_adv_now_ms();
+    uint8_t state = bt_adv_state;
+
+    (void)p_unused;
+
+    if (BT_ADV_TRIGGER_CONNECT == trigger)
+    {
+        uint32_t wait_ms = now_ms - bt_adv_wait_since_ms;
+
+        taskENTER_CRITICAL();
+        bt_adv_stats.connects[bt_adv_state]++;
+        bt_adv_stats.connect_ms_last = wait_ms;
+        if (wait_ms > bt_adv_stats.connect_ms_max)
+        {
+            bt_adv_stats.connect_ms_max = wait_ms;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    switch (trigger)
+    {
+    case BT_ADV_TRIGGER_BOOT:
+    case BT_ADV_TRIGGER_DISCONNECT:
+        /* A new wait for a central begins */
+        bt_adv_wait_since_ms = now_ms;
+        state = bt_adv_directed_target() ? BT_ADV_STATE_DIRECTED : BT_ADV_STATE_FAST;
+        break;
+
+    case BT_ADV_TRIGGER_CONNECT:
+        bt_adv_wait_since_ms = now_ms;
+        state = BT_ADV_STATE_SLOW;
+        break;
+
+    case BT_ADV_TRIGGER_BUTTON:
+    case BT_ADV_TRIGGER_ALARM:
+        state = BT_ADV_STATE_FAST;
+        break;
+
+    case BT_ADV_TRIGGER_WINDOW:
+        if (BT_ADV_STATE_DIRECTED == state)
+        {
+            state = BT_ADV_STATE_FAST;
+        }
+        else if (BT_ADV_STATE_FAST == state)
+        {
+            state = BT_ADV_STATE_SLOW;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (bt_conn_is_full())
+    {
+        state = bt_adv_beacon ? BT_ADV_STATE_NONCONN : BT_ADV_STATE_OFF;
+    }
+    else if ((BT_ADV_STATE_OFF == state) || (BT_ADV_STATE_NONCONN == state))
+    {
+        /* Room again, without a fast trigger */
+        bt_adv_wait_since_ms = now_ms;
+        state = BT_ADV_STATE_SLOW;
+    }
+
+    if (BT_ADV_STATE_DIRECTED == state)
+    {
+        (void)xTimerChangePeriod(bt_adv_window_timer, pdMS_TO_TICKS(BT_ADV_DIRECTED_WINDOW_MS), 0u);
+    }
+    else if (BT_ADV_STATE_FAST == state)
+    {
+        (void)xTimerChangePeriod(bt_adv_window_timer, pdMS_TO_TICKS(BT_ADV_FAST_WINDOW_MS), 0u);
+    }
+
+    /* The stack stops advertising on a connection, so it is restarted even
+     * without a change of state */
+    if ((state != bt_adv_state) || (BT_ADV_TRIGGER_CONNECT == trigger) ||
+        (BT_ADV_STATE_DIRECTED == state))
+    {
+        bt_adv_enter(state, now_ms);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_directed_target
+********************************************************************************
+* Summary:
+*  Takes the last bonded central as the target of directed advertising.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : false if no central is bonded or the last one is connected
+*
+*******************************************************************************/
+static bool bt_adv_directed_target(void)
+{
+    return (bt_bond_last_peer(bt_adv_peer, &bt_adv_peer_type) &&
+            (NULL == bt_conn_find_by_addr(bt_adv_peer)));
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_enter
+********************************************************************************
+* Summary:
+*  Starts the advertising mode of a state and closes the accounting of the
+*  previous one.
+*
+* Parameters:
+*  uint8_t state   : BT_ADV_STATE_*
+*  uint32_t now_ms : Current time
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_adv_enter(uint8_t state, uint32_t now_ms)
+{
+    wiced_result_t result;
+
+    if (BT_ADV_STATE_DIRECTED == state)
+    {
+        result = wiced_bt_start_advertisements(bt_adv_mode[state], bt_adv_peer_type, bt_adv_peer);
+    }
+    else
+    {
+        result = wiced_bt_start_advertisements(bt_adv_mode[state], 0, NULL);
+    }
+
+    if (WICED_BT_SUCCESS != result)
+    {
+        APP_TRACE_WARN("Advertisement update failed: %d\r\n", result);
+    }
+
+    taskENTER_CRITICAL();
+    bt_adv_account(now_ms, &bt_adv_stats);
+    bt_adv_stats.entries[state]++;
+    bt_adv_state = state;
+    bt_adv_state_since_ms = now_ms;
+    taskEXIT_CRITICAL();
+
+    APP_TRACE_DEBUG("Advertising state %d\r\n", state);
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_account
+********************************************************************************
+* Summary:
+*  Adds the time of the current state since it was entered, and the radio
+*  time of its advertising events, to a set of counters. The radio time is
+*  estimated from the configured advertising interval of the state.
+*
+* Parameters:
+*  uint32_t now_ms          : Current time
+*  bt_adv_stats_t *p_stats  : Counters to update
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_adv_account(uint32_t now_ms, bt_adv_stats_t *p_stats)
+{
+    const wiced_bt_cfg_ble_advert_settings_t *p_cfg = wiced_bt_cfg_settings.p_ble_cfg->p_adv_cfg;
+    uint32_t elapsed_ms = now_ms - bt_adv_state_since_ms;
+    uint32_t event_us = BT_ADV_EVENT_US_CONN;
+    uint32_t interval = 0u;
+
+    switch (bt_adv_state)
+    {
+    case BT_ADV_STATE_FAST:
+        interval = p_cfg->high_duty_min_interval;
+        break;
+
+    case BT_ADV_STATE_SLOW:
+        interval = p_cfg->low_duty_min_interval;
+        break;
+
+    case BT_ADV_STATE_NONCONN:
+        interval = p_cfg->low_duty_nonconn_min_interval;
+        event_us = BT_ADV_EVENT_US_NONCONN;
+        break;
+
+    case BT_ADV_STATE_DIRECTED:
+        interval = BT_ADV_DIRECT_INTERVAL;
+        event_us = BT_ADV_EVENT_US_DIRECT;
+        break;
+
+    default:
+        break;
+    }
+
+    p_stats->time_ms[bt_adv_state] += elapsed_ms;
+    if (0u != interval)
+    {
+        p_stats->radio_ms[bt_adv_state] +=
+            (uint32_t)(((uint64_t)elapsed_ms * event_us) / (interval * BT_ADV_SLOT_US));
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_window_expired
+********************************************************************************
+* Summary:
+*  Ends the directed or the fast window. Runs in the timer service task.
+*
+* Parameters:
+*  TimerHandle_t timer : Window timer (unused)
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_adv_window_expired(TimerHandle_t timer)
+{
+    (void)timer;
+    bt_adv_run(NULL, BT_ADV_TRIGGER_WINDOW);
+}
+
+/*******************************************************************************
+* Function Name: bt_adv_apply
+********************************************************************************
+* Summary:
+*  Hands the payload of the current mode to the stack, which copies it.
+*  Advertising continues with the new payload.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_adv_apply(void)
+{
+    wiced_result_t result;
+
+    if (!bt_adv_ready)
+    {
+        return;
+    }
+
+    if (bt_adv_beacon)
+    {
+        result = wiced_bt_ble_set_raw_advertisement_data(BT_ADV_ELEM_COUNT, bt_adv_beacon_elem);
+    }
+    else
+    {
+        result = wiced_bt_ble_set_raw_advertisement_data(CY_BT_ADV_PACKET_DATA_SIZE,
+                                                         cy_bt_adv_packet_data);
+    }
+
+    if (WICED_BT_SUCCESS != result)
+    {
+        APP_TRACE_WARN("Advertisement data update failed: %d\r\n", result);
+    }
+}
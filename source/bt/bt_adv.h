@@ -0,0 +1,86 @@
+/*******************************************************************************
+* File Name: bt_adv.h
+*
+* Description: This file is the public interface of bt_adv.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_ADV_H_
+#define BT_ADV_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "bt_sensor_state.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Beacon mode at startup */
+#define BT_ADV_BEACON_DEFAULT           (true)
+
+/* Service data of the beacon, after the service UUID */
+#define BT_ADV_BEACON_PPM_OFFSET        (0u)    /* u16 CO2 in ppm */
+#define BT_ADV_BEACON_STATUS_OFFSET     (2u)    /* u8 BT_SENSOR_STATUS_* */
+#define BT_ADV_BEACON_SEQ_OFFSET        (3u)    /* u8 sample sequence, rolling over */
+#define BT_ADV_BEACON_LEN               (4u)
+
+/* Advertising states */
+#define BT_ADV_STATE_OFF                (0u)
+#define BT_ADV_STATE_FAST               (1u)    /* Connectable, high duty */
+#define BT_ADV_STATE_SLOW               (2u)    /* Connectable, low duty */
+#define BT_ADV_STATE_NONCONN            (3u)    /* Beacon only, connection limit reached */
+#define BT_ADV_STATE_DIRECTED           (4u)    /* Connectable by the last bonded central only */
+#define BT_ADV_STATE_COUNT              (5u)
+
+/* Causes of a change of the advertising state */
+#define BT_ADV_TRIGGER_BOOT             (0u)    /* Directed if bonded, then fast window */
+#define BT_ADV_TRIGGER_DISCONNECT       (1u)    /* Directed if bonded, then fast window */
+#define BT_ADV_TRIGGER_BUTTON           (2u)    /* Fast window */
+#define BT_ADV_TRIGGER_ALARM            (3u)    /* Fast window */
+#define BT_ADV_TRIGGER_CONNECT          (4u)    /* Slow while connections are accepted */
+#define BT_ADV_TRIGGER_WINDOW           (5u)    /* End of the directed or fast window */
+#define BT_ADV_TRIGGER_REFRESH          (6u)    /* Beacon mode changed */
+
+/* Fast advertising after a fast trigger, before stepping down to slow */
+#define BT_ADV_FAST_WINDOW_MS           (30000u)
+
+/* High duty directed advertising, the longest the controller allows,
+ * before the fast window */
+#define BT_ADV_DIRECTED_WINDOW_MS       (1280u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Time and estimated radio time per advertising state, for comparing the
+ * power cost of the schedule with the time centrals take to connect */
+typedef struct
+{
+    uint32_t time_ms[BT_ADV_STATE_COUNT];       /* Time spent in each state */
+    uint32_t radio_ms[BT_ADV_STATE_COUNT];      /* Estimated radio time of the advertising events */
+    uint32_t entries[BT_ADV_STATE_COUNT];       /* Times each state was entered */
+    uint32_t connects[BT_ADV_STATE_COUNT];      /* Connections made in each state */
+    uint32_t connect_ms_last;                   /* Advertising time before the last connection */
+    uint32_t connect_ms_max;
+} bt_adv_stats_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void bt_adv_init(void);
+void bt_adv_set_beacon(bool enable);
+bool bt_adv_is_beacon(void);
+void bt_adv_publish(const bt_sensor_state_t *p_state);
+void bt_adv_trigger(uint8_t trigger);
+void bt_adv_get_stats(bt_adv_stats_t *p_stats);
+
+#endif /* BT_ADV_H_ */
@@ -24,10 +24,21 @@
 #include "wiced_bt_types.h"
 #include "wiced_bt_gatt.h"
 #include "wiced_bt_stack.h"
+#include "app_event.h"
+#include "app_trace.h"
+#include "bt_adv.h"
 #include "bt_app.h"
+#include "bt_attr.h"
+#include "bt_batch.h"
+#include "bt_bond.h"
+#include "bt_buf_pool.h"
+#include "bt_conn.h"
+#include "bt_link.h"
+#include "bt_notify.h"
+#include "bt_sensor_state.h"
 #include "flash_utils.h"
 #include "xensiv_pasco2_mtb.h"
-#include "ws2812.h"
+#include "xensiv_pasco2_rate.h"
 
 /*******************************************************************************
 * Macros
@@ -35,6 +46,88 @@
 #define DEFAULT_PRESSURE_REF_HPA        (0x3F7)
 #define SYSTICK_RELOAD_VAL   			6400000UL
 
+/* Acquire samples on the sensor data ready (DRDY) interrupt instead of
+ * polling. No board of the BSP routes the INT pin of the sensor, so the pin
+ * it is wired to must be given as PIN_XENSIV_PASCO2_INT in the DEFINES of
+ * the Makefile; without it the periodic polling loop is used. */
+#if defined(PIN_XENSIV_PASCO2_INT) && !defined(APP_PASCO2_DRDY)
+#define APP_PASCO2_DRDY
+#endif
+#if defined(APP_PASCO2_DRDY) && !defined(PIN_XENSIV_PASCO2_INT)
+#error "APP_PASCO2_DRDY needs PIN_XENSIV_PASCO2_INT, the pin wired to the INT pin of the PAS CO2 sensor"
+#endif
+#define PASCO2_INT_PRIORITY             (7u)
+#define PASCO2_I2C_PRIORITY             (7u)
+
+/* CO2 level above which the sensor raises its alarm flag */
+#define CO2_ALARM_THRESHOLD_PPM         (1400u)
+
+/* Longest wait for a data ready event before the pending result is read
+ * anyway, so a missed edge cannot stall the acquisition, in measurement
+ * periods */
+#define PASCO2_DRDY_TIMEOUT_PERIODS     (2u)
+
+/* Result reads per measurement period when the DRDY interrupt is not
+ * available */
+#define PASCO2_POLLS_PER_PERIOD         (5u)
+
+/* Polling period of the BTTEST loop */
+#define PASCO2_POLL_PERIOD_MS           (2000u)
+
+/* Adaptive measurement period. The fast period is the one set by the
+ * sensor initialization; the period doubles after PASCO2_RATE_STABLE_SAMPLES
+ * readings within PASCO2_RATE_STABLE_PPM (about the sensor noise) while no
+ * central is subscribed, and returns to the fast period on a subscription or
+ * when CO2 changes by PASCO2_RATE_FAST_SLOPE_PPM_MIN or more */
+#define PASCO2_RATE_FAST_S              (10u)
+#define PASCO2_RATE_SLOW_S              (600u)
+#define PASCO2_RATE_STABLE_PPM          (30u)
+#define PASCO2_RATE_FAST_SLOPE_PPM_MIN  (100u)
+#define PASCO2_RATE_STABLE_SAMPLES      (3u)
+
+/* Answer reads of the CO2 characteristic with a result read from the sensor
+ * at the time of the request instead of the latest published sample. The
+ * response is deferred until bt_task has completed the read. */
+//#define APP_GATT_FRESH_READ
+
+/* Writes to the CO2 characteristic value are control frames: an opcode
+ * followed by little-endian parameters, padded to the value length. The
+ * forced compensation, and the trigger settings, which apply to every
+ * subscriber of the CO2 characteristic rather than to the writing
+ * connection, are only accepted from bonded, encrypted links. */
+#define BT_CTRL_FRAME_LEN               (4u)
+#define BT_CTRL_OP_FCS_START            (0x01u)     /* u16 CO2 reference in ppm */
+#define BT_CTRL_OP_FCS_CANCEL           (0x02u)
+#define BT_CTRL_OP_TRIGGER_DEADBAND     (0x10u)     /* u16 CO2 deadband in ppm */
+#define BT_CTRL_OP_TRIGGER_MIN_INTERVAL (0x11u)     /* u16 seconds */
+#define BT_CTRL_OP_TRIGGER_MAX_INTERVAL (0x12u)     /* u16 seconds; 0 disables the heartbeat */
+#define BT_CTRL_OP_BATCH                (0x13u)     /* u16 samples per notification; 0 for single values */
+#define BT_CTRL_OP_LINK_MODE            (0x14u)     /* u8 BT_LINK_MODE_* */
+#define BT_CTRL_OP_BEACON               (0x15u)     /* u8 1 to advertise the CO2 value, 0 for the plain advertisement */
+
+/* CO2 reference range accepted for a forced compensation */
+#define PASCO2_FCS_REF_MIN_PPM          (350u)
+#define PASCO2_FCS_REF_MAX_PPM          (1500u)
+
+#define PASCO2_FCS_REQ_NONE             (0u)
+#define PASCO2_FCS_REQ_START            (1u)
+#define PASCO2_FCS_REQ_CANCEL           (2u)
+
+/* Entries of bt_app_notify_table; also the index of bt_app_send_notification */
+#define BT_APP_NOTIFY_CO2               (0u)
+#define BT_APP_NOTIFY_TEMPERATURE       (1u)
+#define BT_APP_NOTIFY_COUNT             (2u)
+
+/* Default CO2 notification trigger: changes within the deadband (below the
+ * sensor accuracy) are not notified, and an unchanged value is repeated
+ * once a minute so that centrals can tell a quiet room from a lost link */
+#define BT_APP_CO2_DEADBAND_PPM         (20u)
+#define BT_APP_CO2_MIN_INTERVAL_S       (0u)
+#define BT_APP_CO2_MAX_INTERVAL_S       (60u)
+
+/* Longest time a sample waits in a batch before the batch is sent anyway */
+#define BT_APP_BATCH_TIMEOUT_S          (300u)
+
 //#define BTTEST
 /*******************************************************************************
 * Function Prototypes
@@ -45,7 +138,7 @@ wiced_bt_gatt_status_t bt_app_gatt_event_cb(wiced_bt_gatt_evt_t event,
 wiced_bt_gatt_status_t bt_app_gatt_conn_status_cb(wiced_bt_gatt_connection_status_t 
                                                                     *p_conn_status);
 wiced_bt_gatt_status_t bt_app_gatt_req_cb(wiced_bt_gatt_attribute_request_t *p_attr_req);
-wiced_bt_gatt_status_t bt_app_gatt_req_write_value(uint16_t attr_handle,
+wiced_bt_gatt_status_t bt_app_gatt_req_write_value(uint16_t conn_id, uint16_t attr_handle,
                                                     uint8_t *p_val, uint16_t len);
 wiced_bt_gatt_status_t bt_app_gatt_req_write_handler(uint16_t conn_id,
                                                 wiced_bt_gatt_opcode_t opcode,
@@ -59,27 +152,83 @@ wiced_bt_gatt_status_t bt_app_gatt_req_read_by_type_handler (uint16_t conn_id,
                                                 wiced_bt_gatt_opcode_t opcode,
                                                 wiced_bt_gatt_read_by_type_t *p_read_req,
                                                 uint16_t len_requested);
-static gatt_db_lookup_table_t *bt_app_find_by_handle(uint16_t handle);
+wiced_bt_gatt_status_t bt_app_gatt_req_read_multi_handler(uint16_t conn_id,
+                                                wiced_bt_gatt_opcode_t opcode,
+                                                wiced_bt_gatt_read_multiple_req_t *p_read_req,
+                                                uint16_t len_req);
+static uint16_t bt_app_read_value(uint16_t conn_id, gatt_db_lookup_table_t *p_attr,
+                                  uint16_t offset, uint8_t *p_out, uint16_t out_len);
+static uint8_t bt_app_cccd_index(uint16_t attr_handle);
+static void  bt_app_update_subscriptions(void);
+static void  bt_app_resume_notifications(bt_conn_t *p_conn, uint8_t cccd);
 static void* bt_app_alloc_buffer(int len);
 static void  bt_app_free_buffer(uint8_t *p_event_data);
 static void  bt_print_bd_address(wiced_bt_device_address_t bdadr);
+#ifdef APP_PASCO2_DRDY
+static void  bt_pasco2_drdy_handler(void *callback_arg, cyhal_gpio_event_t event);
+#endif
+#ifndef BTTEST
+static bool  bt_pasco2_acquire(void);
+static void  bt_pasco2_async_wake(void *arg);
+static void  bt_pasco2_req_done(xensiv_pasco2_async_req_t *req, int32_t res);
+static uint32_t bt_pasco2_fcs_service(void);
+static bool  bt_pasco2_rate_service(void);
+static TickType_t bt_pasco2_acquire_period(void);
+static void  bt_pasco2_fcs_event(void *arg, xensiv_pasco2_fcs_event_t event,
+                                 uint32_t elapsed_ms, int32_t res);
+#endif
+static wiced_bt_gatt_status_t bt_app_ctrl_frame(uint16_t conn_id, uint8_t *p_val, uint16_t len);
+static bool  bt_app_conn_trusted(uint16_t conn_id);
+static void  bt_boot_profile_mark(uint32_t *p_mark);
+static void  bt_app_publish_sample(uint16_t co2_ppm);
+static void  bt_app_encode_co2(gatt_db_lookup_table_t *p_attr);
+static void  bt_app_batch_sample(void);
+static void  bt_app_publish_events(void);
+static void  bt_app_event_service(void);
+static void  bt_app_batch_send(void);
+#ifdef APP_GATT_FRESH_READ
+static void  bt_app_fresh_read_respond(void);
+#endif
 
 /*******************************************************************************
  * Structures
  ******************************************************************************/
+/* Startup milestones in milliseconds since the scheduler started; 0 until
+ * the milestone has been reached */
+typedef struct
+{
+    uint32_t sensor_ready;
+    uint32_t first_sample;
+    uint32_t first_notification;
+    bool     warm;
+} bt_boot_profile_t;
+
+#ifdef APP_GATT_FRESH_READ
+/* Read of the CO2 characteristic waiting for a sensor read. Shared by the
+ * stack context and bt_task under a critical section. */
+typedef struct
+{
+    volatile bool           pending;
+    uint16_t                conn_id;
+    wiced_bt_gatt_opcode_t  opcode;
+    gatt_db_lookup_table_t  *p_attr;
+    uint16_t                offset;
+    int                     to_send;
+} bt_fresh_read_t;
+#endif
 
 /*******************************************************************************
 * Global Variables
 *******************************************************************************/
-/* Variable to denote notification received for bt task. */
+/* NOTIFIY_ON while at least one connection is subscribed to the CO2
+ * characteristic; per-connection state is kept by bt_conn */
 uint8_t notify_enabled;
 uint8_t temp=0;
+/* Number of connected centrals */
 uint8_t bt_connected = 0;
-/* Holds the connection ID */
-volatile uint16_t bt_connection_id = 0;
 extern volatile bool co2_check_flag;
 
-extern TaskHandle_t  dis_task_handle;
+extern TaskHandle_t  bt_task_handle;
 uint16_t ppm;
 uint8_t scheduleIdx = 0;
 /**
@@ -91,6 +240,95 @@ static void bt_tickHandler(void);
 extern xensiv_pasco2_t xensiv_pasco2;
 extern cyhal_i2c_t cyhal_i2c;
 
+#ifdef APP_PASCO2_DRDY
+/* Callback data for the sensor INT pin; must outlive the registration */
+static xensiv_pasco2_mtb_interrupt_cb_t pasco2_int_cb_data;
+/* Set by the INT pin handler, consumed by bt_task */
+static volatile bool pasco2_drdy_pending = false;
+#endif
+
+#ifndef BTTEST
+/* Sensor requests are executed by the asynchronous engine so that bt_task
+ * never blocks on the bus or on the inter-command delay */
+static xensiv_pasco2_async_t pasco2_async;
+static xensiv_pasco2_async_req_t pasco2_result_req;
+#ifdef APP_PASCO2_DRDY
+static xensiv_pasco2_async_req_t pasco2_clear_req;
+#endif
+/* Number of queued requests of the current acquisition */
+static uint8_t pasco2_reqs_pending = 0;
+static bool pasco2_sample_done = false;
+static int32_t pasco2_sample_res = XENSIV_PASCO2_OK;
+/* Read the result without waiting for DRDY or the timeout, as the sensor may
+ * already hold one after a warm start */
+static bool pasco2_sample_due = false;
+
+/* Forced compensation requested over BLE; the job runs in bt_task between
+ * acquisitions so that sampling and BLE traffic continue */
+static volatile uint8_t pasco2_fcs_request = PASCO2_FCS_REQ_NONE;
+static volatile uint16_t pasco2_fcs_ref;
+static xensiv_pasco2_fcs_job_t pasco2_fcs_job;
+
+/* Measurement period selected from the readings and the subscription state;
+ * applied in bt_task with the sensor switched to idle and back */
+static const xensiv_pasco2_rate_config_t pasco2_rate_config =
+{
+    .fast_rate_s = PASCO2_RATE_FAST_S,
+    .slow_rate_s = PASCO2_RATE_SLOW_S,
+    .stable_ppm = PASCO2_RATE_STABLE_PPM,
+    .fast_slope_ppm_min = PASCO2_RATE_FAST_SLOPE_PPM_MIN,
+    .stable_samples = PASCO2_RATE_STABLE_SAMPLES
+};
+static xensiv_pasco2_rate_ctrl_t pasco2_rate;
+static xensiv_pasco2_async_req_t pasco2_rate_reqs[3];
+/* Period the sensor runs at; 0 forces the selected period to be applied */
+static uint16_t pasco2_rate_applied = PASCO2_RATE_FAST_S;
+/* Last measurement configuration read with a result */
+static xensiv_pasco2_measurement_config_t pasco2_meas_config =
+{
+    .b.op_mode = (uint32_t)XENSIV_PASCO2_OP_MODE_CONTINUOUS,
+    .b.boc_cfg = (uint32_t)XENSIV_PASCO2_BOC_CFG_AUTOMATIC
+};
+#endif
+
+static bt_boot_profile_t bt_boot_profile;
+
+/* Events of other tasks handled by bt_task */
+static app_event_queue_t bt_app_events;
+
+/* Samples waiting for the subscribers in batch mode. The stack sends from
+ * the buffer given to it, so batches alternate between two buffers. */
+static bt_batch_t bt_app_batch[2];
+static uint8_t bt_app_batch_idx = 0u;
+#ifdef APP_GATT_FRESH_READ
+static bt_fresh_read_t bt_fresh_read;
+#endif
+
+/* Notifiable characteristics. The temperature value is kept current by the
+ * read handler. */
+static const bt_notify_trigger_t bt_app_co2_trigger =
+{
+    .deadband = BT_APP_CO2_DEADBAND_PPM,
+    .min_interval_s = BT_APP_CO2_MIN_INTERVAL_S,
+    .max_interval_s = BT_APP_CO2_MAX_INTERVAL_S
+};
+
+static const bt_notify_desc_t bt_app_notify_table[BT_APP_NOTIFY_COUNT] =
+{
+    [BT_APP_NOTIFY_CO2] =
+    {
+        .value_handle = HDLC_AIRQ_CO2_SENSOR_VALUE,
+        .cccd = BT_CONN_CCCD_CO2,
+        .encode = bt_app_encode_co2
+    },
+    [BT_APP_NOTIFY_TEMPERATURE] =
+    {
+        .value_handle = HDLC_AIRQ_TEMPERATURE_SENSOR_VALUE,
+        .cccd = BT_CONN_CCCD_TEMPERATURE,
+        .encode = NULL
+    }
+};
+
 /* schedule handler
  * Both master and slave register for interrupts.
  * Master sends the header
@@ -103,11 +341,11 @@ static void bt_tickHandler(void)
     scheduleIdx = scheduleIdx%8;
     if ((scheduleIdx == 0) || (scheduleIdx == 1))
     {
-    	memcpy(app_airq_co2_sensor,&ppm, 2);
-
 		if(bt_connected && (notify_enabled == NOTIFIY_ON))
 		{
-			bt_app_send_notification(0);
+			/* Encoded from the sensor state by bt_task; whether it is sent
+			 * is up to the trigger */
+			bt_notify_mark(BT_APP_NOTIFY_CO2);
 		}
 
     }
@@ -131,64 +369,517 @@ static void bt_tickHandler(void)
 void bt_task(void* param)
 {
 	 cy_rslt_t result = CY_RSLT_SUCCESS;
-
-	 uint32_t nofify_value;
+	 uint32_t notified;
 
     /* Suppress warning for unused parameter */
     (void)param;
 
-   	vTaskDelay(2000);
+    bt_notify_init(bt_app_notify_table, BT_APP_NOTIFY_COUNT);
+    bt_notify_set_trigger(BT_APP_NOTIFY_CO2, &bt_app_co2_trigger);
+    (void)app_event_subscribe(&bt_app_events, APP_EVENT_MASK(APP_EVENT_BUTTON),
+                              xTaskGetCurrentTaskHandle());
+
 #ifndef BTTEST
-	/* Initialize PAS CO2 sensor with default parameter values */
-	result = xensiv_pasco2_mtb_init_i2c(&xensiv_pasco2, &cyhal_i2c);
+	/* Initialize PAS CO2 sensor with default parameter values. A sensor
+	 * still measuring since before a reset of the MCU is kept as is, which
+	 * skips the soft reset and its 2 s delay */
+	result = xensiv_pasco2_mtb_init_i2c_warm(&xensiv_pasco2, &cyhal_i2c,
+											&bt_boot_profile.warm);
 	if (result != CY_RSLT_SUCCESS)
 	{
 		printf("PAS CO2 device initialization error");
 		CY_ASSERT(0);
 	}
-#endif
-	printf("PAS CO2 init done!\r\n");
+	pasco2_sample_due = bt_boot_profile.warm;
 
-#ifndef BTTEST
+	xensiv_pasco2_rate_init(&pasco2_rate, &pasco2_rate_config);
+
+	/* Skip redundant configuration writes, such as the constant pressure
+	 * reference applied after every read */
+	xensiv_pasco2_enable_shadow(&xensiv_pasco2, true);
+
+	/* The reference does not change, so it is applied once instead of
+	 * after every read */
+	(void)xensiv_pasco2_set_pressure_compensation(&xensiv_pasco2, DEFAULT_PRESSURE_REF_HPA);
+
+	result = xensiv_pasco2_mtb_async_init(&pasco2_async, &xensiv_pasco2,
+										PASCO2_I2C_PRIORITY,
+										bt_pasco2_async_wake, NULL);
+	if (result != CY_RSLT_SUCCESS)
+	{
+		printf("PAS CO2 async initialization error");
+		CY_ASSERT(0);
+	}
 
-   	result = xensiv_pasco2_mtb_read(&xensiv_pasco2, DEFAULT_PRESSURE_REF_HPA, &ppm);
-	if (result == CY_RSLT_SUCCESS)
+#ifdef APP_PASCO2_DRDY
+	/* Route the end of every measurement sequence to the INT pin so that the
+	 * task only touches the bus when a new result is available */
+	xensiv_pasco2_interrupt_config_t int_config =
+	{
+		.b.int_func = XENSIV_PASCO2_INTERRUPT_FUNCTION_DRDY,
+		.b.int_typ = (uint32_t)XENSIV_PASCO2_INTERRUPT_TYPE_HIGH_ACTIVE
+	};
+
+	pasco2_int_cb_data.callback = bt_pasco2_drdy_handler;
+	pasco2_int_cb_data.callback_arg = NULL;
+
+	result = xensiv_pasco2_mtb_interrupt_init_ex(&xensiv_pasco2, int_config,
+												CO2_ALARM_THRESHOLD_PPM,
+												PIN_XENSIV_PASCO2_INT,
+												PASCO2_INT_PRIORITY,
+												&pasco2_int_cb_data);
+	if (result != CY_RSLT_SUCCESS)
 	{
-		printf("CO2 %d ppm.\n", ppm);
+		printf("PAS CO2 interrupt initialization error");
+		CY_ASSERT(0);
 	}
+
+	/* A result completed during initialization would keep the pin latched */
+	(void)xensiv_pasco2_clear_measurement_status(&xensiv_pasco2,
+									XENSIV_PASCO2_REG_MEAS_STS_INT_STS_CLR_MSK);
+#endif
 #endif
-	xTaskNotify(dis_task_handle, ppm, eSetValueWithoutOverwrite);
+	bt_boot_profile_mark(&bt_boot_profile.sensor_ready);
+	printf("PAS CO2 init done (%s start)!\r\n", bt_boot_profile.warm ? "warm" : "cold");
 
     /* Repeatedly running part of the task */
     for(;;)
     {
 
 #ifndef BTTEST
-       	result = xensiv_pasco2_mtb_read(&xensiv_pasco2, DEFAULT_PRESSURE_REF_HPA, &ppm);
-		if (result == CY_RSLT_SUCCESS)
+		if (!bt_pasco2_acquire())
 		{
-			printf("CO2 %d ppm.\n", ppm);
+#ifdef APP_GATT_FRESH_READ
+			/* No new result; answer with the latest sample */
+			bt_app_fresh_read_respond();
+#endif
+			continue;
 		}
+		APP_TRACE_INFO("CO2 %d ppm.\n", ppm);
 
+		/* Readings taken during a forced compensation use its own period */
+		if (!pasco2_fcs_job.active)
+		{
+			(void)xensiv_pasco2_rate_update(&pasco2_rate, ppm);
+		}
 #else
 		ppm = ppm + 10;
 #endif
-    	memcpy(app_airq_co2_sensor,&ppm, 2);
+		bt_boot_profile_mark(&bt_boot_profile.first_sample);
+		bt_app_publish_sample(ppm);
+		notified = bt_notify_flush();
+		bt_app_batch_sample();
+#ifdef APP_GATT_FRESH_READ
+		bt_app_fresh_read_respond();
+#endif
 
 		if(bt_connected && (notify_enabled == NOTIFIY_ON))
 		{
 			co2_check_flag = false;
 
-			bt_app_send_notification(0);
+			if ((0u == bt_boot_profile.first_notification) &&
+				(0u != (notified & (1UL << BT_APP_NOTIFY_CO2))))
+			{
+				bt_boot_profile_mark(&bt_boot_profile.first_notification);
+				printf("Boot profile (%s start): sensor ready %lu ms, first sample %lu ms, "
+					   "first notification %lu ms\r\n",
+					   bt_boot_profile.warm ? "warm" : "cold",
+					   (unsigned long)bt_boot_profile.sensor_ready,
+					   (unsigned long)bt_boot_profile.first_sample,
+					   (unsigned long)bt_boot_profile.first_notification);
+			}
 		}
 
-		xTaskNotify(dis_task_handle, ppm, eSetValueWithoutOverwrite);
+		bt_app_publish_events();
+
+#ifdef BTTEST
+		bt_app_event_service();
+		bt_bond_flush();
+		vTaskDelay(PASCO2_POLL_PERIOD_MS);
+#endif
+
+    }
+}
+
+#ifdef APP_PASCO2_DRDY
+/*******************************************************************************
+* Function Name: bt_pasco2_drdy_handler
+********************************************************************************
+* Summary:
+*  PAS CO2 INT pin handler. Wakes the acquisition task once a new measurement
+*  result is available.
+*
+* Parameters:
+*  void *callback_arg        : Callback argument (unused)
+*  cyhal_gpio_event_t event  : GPIO event (unused)
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_pasco2_drdy_handler(void *callback_arg, cyhal_gpio_event_t event)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    (void)callback_arg;
+    (void)event;
+
+    pasco2_drdy_pending = true;
+    vTaskNotifyGiveFromISR(bt_task_handle, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+#endif
+
+#ifndef BTTEST
+/*******************************************************************************
+* Function Name: bt_pasco2_acquire
+********************************************************************************
+* Summary:
+*  Runs the PAS CO2 request engine until a new CO2 result has been read into
+*  ppm. The result is requested on the DRDY interrupt, or when the DRDY
+*  timeout (polling period without DRDY) expires. The task sleeps on its
+*  notification in between, which is given by the DRDY and I2C interrupts.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : true if ppm holds a new value
+*
+*******************************************************************************/
+static bool bt_pasco2_acquire(void)
+{
+    TickType_t deadline = xTaskGetTickCount() + bt_pasco2_acquire_period();
+    bool due = pasco2_sample_due;
+
+    pasco2_sample_done = false;
+    pasco2_sample_due = false;
+
+    for (;;)
+    {
+        uint32_t wait_ms = xensiv_pasco2_async_process(&pasco2_async);
+        uint32_t fcs_wait_ms = XENSIV_PASCO2_FCS_IDLE;
+        TickType_t now;
+        TickType_t wait;
+
+        /* The job uses the blocking driver API, so it only runs while the
+         * engine has no request of ours in flight */
+        if (0u == pasco2_reqs_pending)
+        {
+            fcs_wait_ms = bt_pasco2_fcs_service();
+        }
+        now = xTaskGetTickCount();
+
+        bt_app_event_service();
+        bt_bond_flush();
+
+        if ((0u == pasco2_reqs_pending) && bt_pasco2_rate_service())
+        {
+            deadline = now + bt_pasco2_acquire_period();
+            continue;
+        }
+
+        if (pasco2_sample_done)
+        {
+            return (XENSIV_PASCO2_OK == pasco2_sample_res);
+        }
+
+#ifdef APP_PASCO2_DRDY
+        if (pasco2_drdy_pending)
+        {
+            pasco2_drdy_pending = false;
+            due = true;
+        }
+#endif
+#ifdef APP_GATT_FRESH_READ
+        if (bt_fresh_read.pending)
+        {
+            due = true;
+        }
+#endif
+        if ((int32_t)(deadline - now) <= 0)
+        {
+#ifdef APP_PASCO2_DRDY
+            APP_TRACE_WARN("PAS CO2 data ready timeout\r\n");
+#endif
+            deadline = now + bt_pasco2_acquire_period();
+            due = true;
+        }
+
+        if (due && (0u == pasco2_reqs_pending))
+        {
+            due = false;
+
+            pasco2_result_req.op = XENSIV_PASCO2_ASYNC_GET_RESULT;
+            pasco2_result_req.callback = bt_pasco2_req_done;
+            pasco2_reqs_pending++;
+            xensiv_pasco2_async_submit(&pasco2_async, &pasco2_result_req);
+#ifdef APP_PASCO2_DRDY
+            /* Release the latched INT pin so the next result raises a new edge */
+            pasco2_clear_req.op = XENSIV_PASCO2_ASYNC_SET_REG;
+            pasco2_clear_req.reg_addr = XENSIV_PASCO2_REG_MEAS_STS;
+            pasco2_clear_req.len = 1u;
+            pasco2_clear_req.data[0] = XENSIV_PASCO2_REG_MEAS_STS_INT_STS_CLR_MSK;
+            pasco2_clear_req.callback = bt_pasco2_req_done;
+            pasco2_reqs_pending++;
+            xensiv_pasco2_async_submit(&pasco2_async, &pasco2_clear_req);
+#endif
+            continue;
+        }
+
+        wait = deadline - now;
+        if ((XENSIV_PASCO2_ASYNC_WAIT_FOREVER != wait_ms) && (pdMS_TO_TICKS(wait_ms) < wait))
+        {
+            wait = pdMS_TO_TICKS(wait_ms);
+        }
+        if ((XENSIV_PASCO2_FCS_IDLE != fcs_wait_ms) && (pdMS_TO_TICKS(fcs_wait_ms) < wait))
+        {
+            wait = pdMS_TO_TICKS(fcs_wait_ms);
+        }
+        (void)ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_pasco2_fcs_service
+********************************************************************************
+* Summary:
+*  Starts or cancels the forced compensation job as requested over BLE and
+*  advances the running job.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : Milliseconds until the job must be serviced again, or
+*             XENSIV_PASCO2_FCS_IDLE if no job is running
+*
+*******************************************************************************/
+static uint32_t bt_pasco2_fcs_service(void)
+{
+    uint8_t request = pasco2_fcs_request;
+    int32_t res;
+
+    pasco2_fcs_request = PASCO2_FCS_REQ_NONE;
+
+    if (PASCO2_FCS_REQ_START == request)
+    {
+        if (pasco2_fcs_job.active)
+        {
+            printf("PAS CO2 FCS already running\r\n");
+        }
+        else
+        {
+            res = xensiv_pasco2_fcs_start(&pasco2_fcs_job, &xensiv_pasco2, pasco2_fcs_ref,
+                                          bt_pasco2_fcs_event, NULL);
+            printf("PAS CO2 FCS start at %d ppm: %d\r\n", pasco2_fcs_ref, (int)res);
+            if (XENSIV_PASCO2_OK != res)
+            {
+                /* The sensor may still be idle if restoring it failed too */
+                pasco2_rate_applied = 0u;
+            }
+        }
+    }
+    else if (PASCO2_FCS_REQ_CANCEL == request)
+    {
+        (void)xensiv_pasco2_fcs_cancel(&pasco2_fcs_job);
+    }
+
+    return xensiv_pasco2_fcs_step(&pasco2_fcs_job);
+}
+
+/*******************************************************************************
+* Function Name: bt_pasco2_rate_service
+********************************************************************************
+* Summary:
+*  Updates the subscription state of the rate controller and queues the
+*  requests switching the sensor to the selected measurement period. The
+*  sensor only accepts a new period in idle mode, so it is set to idle, the
+*  period is written and continuous mode is started again. Not done while a
+*  forced compensation runs, as the job restores the period on completion.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : true if requests for a new period have been queued
+*
+*******************************************************************************/
+static bool bt_pasco2_rate_service(void)
+{
+    bool subscribed = (0u != bt_connected) && (NOTIFIY_ON == notify_enabled);
+    uint16_t rate = xensiv_pasco2_rate_set_subscribed(&pasco2_rate, subscribed);
+    xensiv_pasco2_measurement_config_t meas_config = pasco2_meas_config;
+
+    if ((rate == pasco2_rate_applied) || pasco2_fcs_job.active)
+    {
+        return false;
+    }
+
+    meas_config.b.op_mode = (uint32_t)XENSIV_PASCO2_OP_MODE_IDLE;
+    pasco2_rate_reqs[0].op = XENSIV_PASCO2_ASYNC_SET_REG;
+    pasco2_rate_reqs[0].reg_addr = XENSIV_PASCO2_REG_MEAS_CFG;
+    pasco2_rate_reqs[0].len = 1u;
+    pasco2_rate_reqs[0].data[0] = meas_config.u;
+
+    pasco2_rate_reqs[1].op = XENSIV_PASCO2_ASYNC_SET_MEAS_RATE;
+    pasco2_rate_reqs[1].value = rate;
+
+    meas_config.b.op_mode = (uint32_t)XENSIV_PASCO2_OP_MODE_CONTINUOUS;
+    meas_config.b.boc_cfg = (uint32_t)XENSIV_PASCO2_BOC_CFG_AUTOMATIC;
+    pasco2_rate_reqs[2].op = XENSIV_PASCO2_ASYNC_SET_REG;
+    pasco2_rate_reqs[2].reg_addr = XENSIV_PASCO2_REG_MEAS_CFG;
+    pasco2_rate_reqs[2].len = 1u;
+    pasco2_rate_reqs[2].data[0] = meas_config.u;
+
+    for (uint8_t i = 0u; i < 3u; i++)
+    {
+        pasco2_rate_reqs[i].callback = bt_pasco2_req_done;
+        pasco2_reqs_pending++;
+        xensiv_pasco2_async_submit(&pasco2_async, &pasco2_rate_reqs[i]);
+    }
+
+    APP_TRACE_INFO("PAS CO2 measurement period %d s\r\n", rate);
+    pasco2_rate_applied = rate;
+    pasco2_meas_config = meas_config;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_pasco2_acquire_period
+********************************************************************************
+* Summary:
+*  Returns the time after which a result is read without a data ready event,
+*  derived from the measurement period the sensor runs at.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  TickType_t : DRDY timeout, or polling period without DRDY
+*
+*******************************************************************************/
+static TickType_t bt_pasco2_acquire_period(void)
+{
+    uint32_t rate_ms = (uint32_t)((0u != pasco2_rate_applied) ? pasco2_rate_applied : PASCO2_RATE_FAST_S) * 1000u;
+
+#ifdef APP_PASCO2_DRDY
+    return pdMS_TO_TICKS(rate_ms * PASCO2_DRDY_TIMEOUT_PERIODS);
+#else
+    return pdMS_TO_TICKS(rate_ms / PASCO2_POLLS_PER_PERIOD);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: bt_pasco2_fcs_event
+********************************************************************************
+* Summary:
+*  Progress and completion events of the forced compensation job.
+*
+* Parameters:
+*  void *arg                         : Callback argument (unused)
+*  xensiv_pasco2_fcs_event_t event   : Job event
+*  uint32_t elapsed_ms               : Time since the job was started
+*  int32_t res                       : Driver result of the job
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_pasco2_fcs_event(void *arg, xensiv_pasco2_fcs_event_t event,
+                                uint32_t elapsed_ms, int32_t res)
+{
+    (void)arg;
+
+    switch (event)
+    {
+    case XENSIV_PASCO2_FCS_EVENT_PROGRESS:
+        printf("PAS CO2 FCS running, %lu s\r\n", (unsigned long)(elapsed_ms / 1000u));
+        break;
+    case XENSIV_PASCO2_FCS_EVENT_DONE:
+        printf("PAS CO2 FCS done after %lu s, offset saved\r\n", (unsigned long)(elapsed_ms / 1000u));
+        break;
+    case XENSIV_PASCO2_FCS_EVENT_CANCELLED:
+        printf("PAS CO2 FCS cancelled: %d\r\n", (int)res);
+        break;
+    default:
+        printf("PAS CO2 FCS failed: %d\r\n", (int)res);
+        break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_pasco2_req_done
+********************************************************************************
+* Summary:
+*  Completion callback of the PAS CO2 requests, run by
+*  xensiv_pasco2_async_process in bt_task.
+*
+* Parameters:
+*  xensiv_pasco2_async_req_t *req : Completed request
+*  int32_t res                    : XENSIV_PASCO2_OK or driver error code
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_pasco2_req_done(xensiv_pasco2_async_req_t *req, int32_t res)
+{
+    pasco2_reqs_pending--;
+
+    if (req == &pasco2_result_req)
+    {
+        if (XENSIV_PASCO2_OK == res)
+        {
+            ppm = req->result.co2_ppm;
+        }
+        if ((XENSIV_PASCO2_OK == res) || (XENSIV_PASCO2_READ_NRDY == res))
+        {
+            pasco2_meas_config = req->result.meas_config;
+        }
+        pasco2_sample_res = res;
+        pasco2_sample_done = true;
+    }
+    else if ((req >= &pasco2_rate_reqs[0]) && (req <= &pasco2_rate_reqs[2]) &&
+             (XENSIV_PASCO2_OK != res))
+    {
+        /* Apply the period again, as the sensor may have been left idle */
+        pasco2_rate_applied = 0u;
+    }
+}
 
-		vTaskDelay(2000);
+/*******************************************************************************
+* Function Name: bt_pasco2_async_wake
+********************************************************************************
+* Summary:
+*  Wake function of the PAS CO2 request engine. Called on submission and from
+*  the I2C interrupt at the end of every transfer.
+*
+* Parameters:
+*  void *arg : Wake argument (unused)
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_pasco2_async_wake(void *arg)
+{
+    (void)arg;
 
+    if (xPortIsInsideInterrupt())
+    {
+        BaseType_t higher_priority_task_woken = pdFALSE;
 
+        vTaskNotifyGiveFromISR(bt_task_handle, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+    else
+    {
+        xTaskNotifyGive(bt_task_handle);
     }
 }
+#endif
 
 
 /*
@@ -219,9 +910,13 @@ void bt_schedulerInit(void)
  ******************************************************************************/
 void bt_app_init(void)
 {
-    wiced_result_t result = WICED_BT_SUCCESS;
     wiced_bt_gatt_status_t status = WICED_BT_GATT_SUCCESS;
 
+    /* Index the attribute table and set up the response buffers before any
+     * GATT request can arrive */
+    bt_attr_init();
+    bt_buf_pool_init();
+
     /* Register with BT stack to receive GATT callback */
     status = wiced_bt_gatt_register(bt_app_gatt_event_cb);
     printf("GATT event handler registration status: %d \r\n",status);
@@ -230,22 +925,21 @@ void bt_app_init(void)
     status = wiced_bt_gatt_db_init(gatt_database, gatt_database_len, NULL);
     printf("GATT database initialization status: %d \r\n",status);
 
-    /* Allow peer to pair */
-    wiced_bt_set_pairable_mode(FALSE, FALSE);
+    /* Allow peer to pair and bond, so that subscriptions survive a
+     * reconnection */
+    wiced_bt_set_pairable_mode(WICED_TRUE, WICED_FALSE);
 
     /* Set Advertisement Data */
-    wiced_bt_ble_set_raw_advertisement_data(CY_BT_ADV_PACKET_DATA_SIZE, 
-                                                            cy_bt_adv_packet_data);
-    /* Start Undirected LE Advertisements on device startup.
-     * The corresponding parameters are contained in 'app_bt_cfg.c' */
-    result = wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, 0, NULL);
-
-    /* Failed to start advertisement. Stop program execution */
-    if (WICED_BT_SUCCESS != result)
-    {
-        printf("Failed to start advertisement! \r\n");
-        CY_ASSERT(0);
-    }
+    bt_adv_init();
+    /* Accept as many centrals as the stack is configured to serve */
+    bt_conn_init(MIN(BT_CONN_MAX, wiced_bt_cfg_settings.p_gatt_cfg->server_max_links));
+    bt_link_init();
+    bt_bond_init();
+
+    /* Advertise directed to the last bonded central, then fast for a while
+     * after startup, then slow. The corresponding parameters are contained
+     * in 'app_bt_cfg.c' */
+    bt_adv_trigger(BT_ADV_TRIGGER_BOOT);
 
 }
 
@@ -271,7 +965,7 @@ wiced_result_t bt_app_management_cb(wiced_bt_management_evt_t event,
     wiced_result_t result = WICED_BT_SUCCESS;
     wiced_bt_device_address_t local_bda = {0x00, 0xA0, 0x50, 0x02, 0x04, 0x08};
 
-    printf("Bluetooth app management callback: 0x%x\r\n", event);
+    APP_TRACE_DEBUG("Bluetooth app management callback: 0x%x\r\n", event);
 
     switch (event)
     {
@@ -303,32 +997,98 @@ wiced_result_t bt_app_management_cb(wiced_bt_management_evt_t event,
             break;
 
         case BTM_LOCAL_IDENTITY_KEYS_UPDATE_EVT:
-        	break;
+            /* Keep the identity of the device across resets */
+            bt_bond_save_local_keys(&p_event_data->local_identity_keys_update);
+            break;
 
-        case BTM_BLE_ADVERT_STATE_CHANGED_EVT:
+        case BTM_LOCAL_IDENTITY_KEYS_REQUEST_EVT:
+            /* The stack generates new keys if none are stored */
+            result = bt_bond_load_local_keys(&p_event_data->local_identity_keys_request) ?
+                     WICED_BT_SUCCESS : WICED_BT_ERROR;
+            break;
 
-            /* Advertisement State Changed */
-            printf("Bluetooth advertisement state change: 0x%x\r\n",
-                                     p_event_data->ble_advert_state_changed);
+        case BTM_PAIRING_IO_CAPABILITIES_BLE_REQUEST_EVT:
+            /* No display or keyboard: Just Works pairing with bonding */
+            p_event_data->pairing_io_capabilities_ble_request.local_io_cap = BTM_IO_CAPABILITIES_NONE;
+            p_event_data->pairing_io_capabilities_ble_request.oob_data = BTM_OOB_NONE;
+            p_event_data->pairing_io_capabilities_ble_request.auth_req = BTM_LE_AUTH_REQ_SC_BOND;
+            p_event_data->pairing_io_capabilities_ble_request.max_key_size = 0x10;
+            p_event_data->pairing_io_capabilities_ble_request.init_keys = BTM_LE_KEY_PENC | BTM_LE_KEY_PID;
+            p_event_data->pairing_io_capabilities_ble_request.resp_keys = BTM_LE_KEY_PENC | BTM_LE_KEY_PID;
             break;
 
-        case BTM_BLE_CONNECTION_PARAM_UPDATE:
-            printf("Bluetooth connection parameter update status:%d\n \
-                    parameter interval: %d ms\n \
-                    parameter latency: %d ms\n \
-                    parameter timeout: %d ms\r\n",
-                    p_event_data->ble_connection_param_update.status,
+        case BTM_USER_CONFIRMATION_REQUEST_EVT:
+            wiced_bt_dev_confirm_req_reply(WICED_BT_SUCCESS,
+                                           p_event_data->user_confirmation_request.bd_addr);
+            break;
+
+        case BTM_SECURITY_REQUEST_EVT:
+            wiced_bt_ble_security_grant(p_event_data->security_request.bd_addr, WICED_BT_SUCCESS);
+            break;
+
+        case BTM_PAIRING_COMPLETE_EVT:
+            APP_TRACE_INFO("Bluetooth pairing complete: %d\r\n",
+                           p_event_data->pairing_complete.pairing_complete_info.ble.reason);
+            break;
+
+        case BTM_ENCRYPTION_STATUS_EVT:
+        {
+            bt_conn_t *p_conn = bt_conn_find_by_addr(p_event_data->encryption_status.bd_addr);
+
+            APP_TRACE_INFO("Bluetooth encryption status: %d\r\n",
+                           p_event_data->encryption_status.result);
+            if ((NULL != p_conn) && (WICED_BT_SUCCESS == p_event_data->encryption_status.result))
+            {
+                p_conn->encrypted = true;
+            }
+            break;
+        }
+
+        case BTM_PAIRED_DEVICE_LINK_KEYS_UPDATE_EVT:
+            /* Bonded; also stores the configurations written so far */
+            bt_bond_save_keys(&p_event_data->paired_device_link_keys_update);
+            break;
+
+        case BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT:
+            /* Served from RAM, so encryption on reconnection does not wait
+             * for the flash */
+            result = bt_bond_load_keys(&p_event_data->paired_device_link_keys_request) ?
+                     WICED_BT_SUCCESS : WICED_BT_ERROR;
+            break;
+
+        case BTM_BLE_ADVERT_STATE_CHANGED_EVT:
+
+            /* Advertisement State Changed */
+            APP_TRACE_INFO("Bluetooth advertisement state change: 0x%x\r\n",
+                                     p_event_data->ble_advert_state_changed);
+            break;
+
+        case BTM_BLE_CONNECTION_PARAM_UPDATE:
+            APP_TRACE_INFO("Bluetooth connection parameter update status:%d\n \
+                    parameter interval: %d x 1.25 ms\n \
+                    parameter latency: %d events\n \
+                    parameter timeout: %d x 10 ms\r\n",
+                    p_event_data->ble_connection_param_update.status,
                     p_event_data->ble_connection_param_update.conn_interval,
                     p_event_data->ble_connection_param_update.conn_latency,
                     p_event_data->ble_connection_param_update.supervision_timeout);
+            bt_link_param_update(&p_event_data->ble_connection_param_update);
             result = WICED_SUCCESS;
             break;
 
         case BTM_BLE_PHY_UPDATE_EVT:
             /* Print the updated Bluetooth physical link*/
-            printf("Bluetooth phy update selected TX - %dM\r\nBluetooth phy update selected RX - %dM\r\n",
+            APP_TRACE_INFO("Bluetooth phy update selected TX - %dM\r\nBluetooth phy update selected RX - %dM\r\n",
                     p_event_data->ble_phy_update_event.tx_phy,
                     p_event_data->ble_phy_update_event.rx_phy);
+            bt_link_phy_update(&p_event_data->ble_phy_update_event);
+            break;
+
+        case BTM_BLE_DATA_LENGTH_UPDATE_EVENT:
+            APP_TRACE_INFO("Bluetooth data length update TX %d RX %d octets\r\n",
+                    p_event_data->ble_data_length_update_event.max_tx_octets,
+                    p_event_data->ble_data_length_update_event.max_rx_octets);
+            bt_link_data_length_update(&p_event_data->ble_data_length_update_event);
             break;
 
         case BTM_PIN_REQUEST_EVT:
@@ -371,7 +1131,7 @@ wiced_bt_gatt_status_t bt_app_gatt_event_cb(wiced_bt_gatt_evt_t event,
             status = bt_app_gatt_conn_status_cb(&p_event_data->connection_status );
             if(WICED_BT_GATT_SUCCESS != status)
             {
-               printf("GATT connection status failed: 0x%x\r\n", status);
+               APP_TRACE_WARN("GATT connection status failed: 0x%x\r\n", status);
             }
             break;
 
@@ -445,13 +1205,26 @@ wiced_bt_gatt_status_t bt_app_gatt_req_cb(wiced_bt_gatt_attribute_request_t *p_a
             break;
 
         case GATT_REQ_READ_MULTI:
+        case GATT_REQ_READ_MULTI_VAR_LENGTH:
+            status = bt_app_gatt_req_read_multi_handler(p_attr_req->conn_id,
+                                                        p_attr_req->opcode,
+                                                        &p_attr_req->data.read_multiple_req,
+                                                        p_attr_req->len_requested);
             break;
 
         case GATT_REQ_MTU:
+        {
+            bt_conn_t *p_conn = bt_conn_find(p_attr_req->conn_id);
+
+            if (NULL != p_conn)
+            {
+                p_conn->mtu = MIN(p_attr_req->data.remote_mtu, CY_BT_MTU_SIZE);
+            }
             status = wiced_bt_gatt_server_send_mtu_rsp(p_attr_req->conn_id,
                                                        p_attr_req->data.remote_mtu,
                                                        CY_BT_MTU_SIZE);
              break;
+        }
 
         case GATT_REQ_WRITE:
         case GATT_CMD_WRITE:
@@ -475,7 +1248,7 @@ wiced_bt_gatt_status_t bt_app_gatt_req_cb(wiced_bt_gatt_attribute_request_t *p_a
              break;
 
         default:
-            printf("bt_app_gatt: unhandled GATT request: %d\r\n", p_attr_req->opcode);
+            APP_TRACE_WARN("bt_app_gatt: unhandled GATT request: %d\r\n", p_attr_req->opcode);
             break;
     }
 
@@ -503,73 +1276,46 @@ wiced_bt_gatt_status_t bt_app_gatt_req_read_by_type_handler(uint16_t conn_id,
                                                 wiced_bt_gatt_read_by_type_t *p_read_req,
                                                 uint16_t len_req)
 {
-    gatt_db_lookup_table_t *puAttribute;
-    uint16_t last_handle = 0;
-    uint16_t attr_handle = p_read_req->s_handle;
+    wiced_bt_gatt_status_t status;
     uint8_t *p_rsp = bt_app_alloc_buffer(len_req);
+    /* Values are copied out first, as a single read returns them: the CO2
+     * value from a sensor state snapshot, the CCCDs of this connection */
+    uint8_t *p_val = bt_app_alloc_buffer(len_req);
     uint8_t pair_len = 0;
-    int used_len = 0;
+    uint16_t used_len = 0;
 
-    if (NULL == p_rsp)
+    if ((NULL == p_rsp) || (NULL == p_val))
     {
-        printf("bt_app_gatt:no memory found, len_req: %d!!\r\n",len_req);
+        APP_TRACE_ERROR("bt_app_gatt:no memory found, len_req: %d!!\r\n",len_req);
+        bt_app_free_buffer(p_rsp);
+        bt_app_free_buffer(p_val);
         wiced_bt_gatt_server_send_error_rsp(conn_id,
                                             opcode,
-                                            attr_handle,
+                                            p_read_req->s_handle,
                                             WICED_BT_GATT_INSUF_RESOURCE);
         return WICED_BT_GATT_INSUF_RESOURCE;
     }
 
     /* Read by type returns all attributes of the specified type, 
      * between the start and end handles */
-    while (WICED_TRUE)
-    {
-        last_handle = attr_handle;
-        attr_handle = wiced_bt_gatt_find_handle_by_type(attr_handle,
-                                                        p_read_req->e_handle,
-                                                        &p_read_req->uuid);
-        if (0 == attr_handle)
-            break;
-
-        if ( NULL == (puAttribute = bt_app_find_by_handle(attr_handle)))
-        {
-            printf("bt_app_gatt:found type but no attribute for %d \r\n",last_handle);
-            wiced_bt_gatt_server_send_error_rsp(conn_id,
-                                                opcode,
-                                                p_read_req->s_handle,
-                                                WICED_BT_GATT_ERR_UNLIKELY);
-            bt_app_free_buffer(p_rsp);
-            return WICED_BT_GATT_INVALID_HANDLE;
-        }
-
-        int filled = wiced_bt_gatt_put_read_by_type_rsp_in_stream(p_rsp + used_len,
-                                                                len_req - used_len,
-                                                                &pair_len,
-                                                                attr_handle,
-                                                                puAttribute->cur_len,
-                                                                puAttribute->p_data);
-        if (0 == filled)
-        {
-            break;
-        }
-        used_len += filled;
+    status = bt_attr_read_by_type(conn_id, p_read_req, bt_app_read_value, p_val, p_rsp, len_req,
+                                  &pair_len, &used_len);
+    bt_app_free_buffer(p_val);
 
-        /* Increment starting handle for next search to one past current */
-        attr_handle++;
-    }
-
-    if (0 == used_len)
+    if (WICED_BT_GATT_SUCCESS != status)
     {
-        printf("bt_app_gatt:attr not found start_handle: 0x%04x  end_handle: 0x%04x \
+        APP_TRACE_WARN("bt_app_gatt:attr not found start_handle: 0x%04x  end_handle: 0x%04x \
                                                         type: 0x%04x\r\n",
                                                         p_read_req->s_handle,
                                                         p_read_req->e_handle,
                                                         p_read_req->uuid.uu.uuid16);
 
+        /* Invalid handle if nothing was found; unlikely error for a type
+         * found without an attribute */
         wiced_bt_gatt_server_send_error_rsp(conn_id,
                                             opcode,
                                             p_read_req->s_handle,
-                                            WICED_BT_GATT_INVALID_HANDLE);
+                                            status);
         bt_app_free_buffer(p_rsp);
         return WICED_BT_GATT_INVALID_HANDLE;
     }
@@ -583,6 +1329,130 @@ wiced_bt_gatt_status_t bt_app_gatt_req_read_by_type_handler(uint16_t conn_id,
                                                       (void *)bt_app_free_buffer);
 }
 
+/*******************************************************************************
+ * Function Name : bt_app_gatt_req_read_multi_handler
+ * *****************************************************************************
+ * Summary :
+ *    Process Read Multiple and Read Multiple Variable Length requests, so that
+ *    a central polls all sensor values in one round trip. The response is
+ *    built by bt_attr_read_multi; values are those a single read would
+ *    return.
+ *
+ * Parameters:
+ *  uint16_t                           conn_id    : Connection ID
+ *  wiced_bt_gatt_opcode_t             opcode     : LE GATT request type opcode
+ *  wiced_bt_gatt_read_multiple_req_t  p_read_req : Pointer to the handles to read
+ *  uint16_t                           len_req    : Length of data requested
+ *
+ * Return:
+ *  wiced_bt_gatt_status_t  : LE GATT status
+ ******************************************************************************/
+wiced_bt_gatt_status_t bt_app_gatt_req_read_multi_handler(uint16_t conn_id,
+                                                wiced_bt_gatt_opcode_t opcode,
+                                                wiced_bt_gatt_read_multiple_req_t *p_read_req,
+                                                uint16_t len_req)
+{
+    uint16_t bad_handle;
+    uint16_t used_len;
+    uint8_t *p_rsp;
+
+    if (0u == p_read_req->num_handles)
+    {
+        wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, 0u, WICED_BT_GATT_INVALID_PDU);
+        return WICED_BT_GATT_INVALID_PDU;
+    }
+
+    if (!bt_attr_find_all(p_read_req, &bad_handle))
+    {
+        wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, bad_handle,
+                                            WICED_BT_GATT_INVALID_HANDLE);
+        return WICED_BT_GATT_INVALID_HANDLE;
+    }
+
+    p_rsp = bt_app_alloc_buffer(len_req);
+    if (NULL == p_rsp)
+    {
+        APP_TRACE_ERROR("bt_app_gatt:no memory found, len_req: %d!!\r\n", len_req);
+        wiced_bt_gatt_server_send_error_rsp(conn_id, opcode,
+                                            wiced_bt_gatt_get_handle_from_stream(p_read_req->p_handle_stream, 0u),
+                                            WICED_BT_GATT_INSUF_RESOURCE);
+        return WICED_BT_GATT_INSUF_RESOURCE;
+    }
+
+    used_len = bt_attr_read_multi(conn_id, opcode, p_read_req, bt_app_read_value, p_rsp, len_req);
+
+    APP_TRACE_DEBUG("bt_app_gatt_read_multi_handler: conn_id:%d opcode:0x%x handles:%d len:%d\r\n",
+                    conn_id, opcode, p_read_req->num_handles, used_len);
+
+    return wiced_bt_gatt_server_send_read_multiple_rsp(conn_id, opcode, used_len, p_rsp,
+                                                       (void *)bt_app_free_buffer);
+}
+
+/*******************************************************************************
+* Function Name: bt_app_read_value
+********************************************************************************
+* Summary:
+*  Copies part of the value a read of an attribute returns to a connection.
+*  The CO2 value comes from a snapshot of the sensor state rather than from
+*  the attribute, which the next flush may be rewriting, and each central
+*  reads its own client configurations.
+*
+* Parameters:
+*  uint16_t conn_id                 : Connection ID
+*  gatt_db_lookup_table_t *p_attr   : Attribute to read
+*  uint16_t offset                  : First byte of the value to copy
+*  uint8_t *p_out                   : Receives the bytes
+*  uint16_t out_len                 : Room in p_out
+*
+* Return:
+*  uint16_t : Number of bytes copied
+*
+*******************************************************************************/
+static uint16_t bt_app_read_value(uint16_t conn_id, gatt_db_lookup_table_t *p_attr,
+                                  uint16_t offset, uint8_t *p_out, uint16_t out_len)
+{
+    const uint8_t *p_val = p_attr->p_data;
+    bt_sensor_state_t state;
+    uint16_t len;
+
+    if (offset >= p_attr->cur_len)
+    {
+        return 0u;
+    }
+    len = MIN(out_len, (uint16_t)(p_attr->cur_len - offset));
+
+    switch (p_attr->handle)
+    {
+    case HDLC_AIRQ_CO2_SENSOR_VALUE:
+        (void)bt_sensor_state_read(&state);
+        for (uint16_t i = 0u; i < len; i++)
+        {
+            uint16_t pos = (uint16_t)(offset + i);
+
+            p_out[i] = (pos < sizeof(state.co2_ppm)) ? ((uint8_t *)&state.co2_ppm)[pos] : 0u;
+        }
+        return len;
+
+    case HDLD_AIRQ_CO2_SENSOR_CLIENT_CHAR_CONFIG:
+    case HDLD_AIRQ_TEMPERATURE_SENSOR_CLIENT_CHAR_CONFIG:
+    {
+        bt_conn_t *p_conn = bt_conn_find(conn_id);
+
+        if (NULL != p_conn)
+        {
+            p_val = p_conn->cccd[bt_app_cccd_index(p_attr->handle)];
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    memcpy(p_out, p_val + offset, len);
+    return len;
+}
+
 
 /*******************************************************************************
 * Function Name: bt_app_gatt_req_write_value
@@ -600,86 +1470,86 @@ wiced_bt_gatt_status_t bt_app_gatt_req_read_by_type_handler(uint16_t conn_id,
 *  wiced_bt_gatt_status_t: Status codes in wiced_bt_gatt_status_e
 *
 *******************************************************************************/
-wiced_bt_gatt_status_t bt_app_gatt_req_write_value(uint16_t attr_handle,
+wiced_bt_gatt_status_t bt_app_gatt_req_write_value(uint16_t conn_id, uint16_t attr_handle,
                                                     uint8_t *p_val, uint16_t len)
 {
     wiced_bt_gatt_status_t gatt_status  = WICED_BT_GATT_INVALID_HANDLE;
     wiced_bool_t isHandleInTable = WICED_FALSE;
-    wiced_bool_t validLen = WICED_FALSE;
+    gatt_db_lookup_table_t *p_attr = bt_attr_find(attr_handle);
+    uint8_t cccd = bt_app_cccd_index(attr_handle);
 
     /* Check for a matching handle entry */
-    for (int i = 0; i < app_gatt_db_ext_attr_tbl_size; i++)
+    if (NULL != p_attr)
     {
+        /* Detected a matching handle in external lookup table */
+        isHandleInTable = WICED_TRUE;
 
-        if (app_gatt_db_ext_attr_tbl[i].handle == attr_handle)
+        if (attr_handle == HDLC_AIRQ_CO2_SENSOR_VALUE)
         {
-            /* Detected a matching handle in external lookup table */
-            isHandleInTable = WICED_TRUE;
-
-            /* Check if the buffer has space to store the data */
-            validLen = (app_gatt_db_ext_attr_tbl[i].max_len >= len);
+            /* Control frame; the CO2 value itself is not overwritten */
+            gatt_status = bt_app_ctrl_frame(conn_id, p_val, len);
+        }
+        else if (BT_CONN_CCCD_NONE != cccd)
+        {
+            /* Client configurations belong to the writing connection */
+            bt_conn_t *p_conn = bt_conn_find(conn_id);
+            bool first_subscription;
 
-            if (validLen)
+            if (len != 2)
             {
+                return WICED_BT_GATT_INVALID_ATTR_LEN;
+            }
+            if (NULL == p_conn)
+            {
+                return WICED_BT_GATT_ERROR;
+            }
 
-                /* Value fits within the supplied buffer; copy over the value */
-                app_gatt_db_ext_attr_tbl[i].cur_len = len;
-                memcpy(app_gatt_db_ext_attr_tbl[i].p_data, p_val, len);
-                gatt_status = WICED_BT_GATT_SUCCESS;
-
-                /* Add code for any action required when this attribute is written.
-                 * In this case, we Initialize the characteristic value */
-
-                switch ( attr_handle )
-                {
-                case HDLC_AIRQ_CO2_SENSOR_VALUE:
-
-                	if(len != 8)
-                	{
-                		 return WICED_BT_GATT_INVALID_ATTR_LEN;
-                	}
-
-                    printf("BT GATT Rx Data : ");
-
-                    for (uint8_t i = 0U; i < 4 ; i++)
-                    {
-                        printf(" %d ", p_val[i]);
-                    }
-                    printf("\r\n\r\n");
-
-
-                    break;
-
-                case HDLD_AIRQ_CO2_SENSOR_CLIENT_CHAR_CONFIG:
-
-                    if (len != 2)
-                    {
-                        return WICED_BT_GATT_INVALID_ATTR_LEN;
-                    }
-
-                    app_airq_co2_sensor_client_char_config[0] = p_val[0];
-
-                    if(app_airq_co2_sensor_client_char_config[0] == 1u)
-                    {
-                    	notify_enabled = NOTIFIY_ON;
-                    }
-                    else
-                    {
-                    	notify_enabled = NOTIFIY_OFF;
-                    }
+            first_subscription =
+                (0u == ((p_conn->cccd[BT_CONN_CCCD_CO2][0] | p_conn->cccd[BT_CONN_CCCD_TEMPERATURE][0]) &
+                        GATT_CLIENT_CONFIG_NOTIFICATION)) &&
+                (0u != (p_val[0] & GATT_CLIENT_CONFIG_NOTIFICATION));
+            taskENTER_CRITICAL();
+            p_conn->cccd[cccd][0] = p_val[0];
+            p_conn->cccd[cccd][1] = p_val[1];
+            taskEXIT_CRITICAL();
+            gatt_status = WICED_BT_GATT_SUCCESS;
 
-                	break;
+            bt_app_update_subscriptions();
 
-                }
+            if (bt_bond_is_bonded(p_conn->bd_addr))
+            {
+                /* Restored on the next connection of the central */
+                bt_bond_save_cccd(p_conn);
+            }
+            else if (first_subscription)
+            {
+                /* Ask a new subscriber to bond, so that its subscriptions
+                 * survive a reconnection; it may refuse */
+                (void)wiced_bt_dev_sec_bond(p_conn->bd_addr, p_conn->addr_type,
+                                            BT_TRANSPORT_LE, 0u, NULL);
+            }
 
+            if (0u != (p_val[0] & GATT_CLIENT_CONFIG_NOTIFICATION))
+            {
+                /* Send the current value to the new subscriber without
+                 * waiting for the trigger */
+                bt_app_resume_notifications(p_conn, cccd);
             }
-            else
+#ifndef BTTEST
+            if ((BT_CONN_CCCD_CO2 == cccd) && (0u != (p_val[0] & GATT_CLIENT_CONFIG_NOTIFICATION)))
             {
-                /* Value to write does not meet size constraints */
-                gatt_status = WICED_BT_GATT_INVALID_HANDLE;
-                printf("GATT write request to invalid handle: 0x%x\r\n", attr_handle);
+                /* Let bt_task switch to the fast measurement period */
+                xTaskNotifyGive(bt_task_handle);
             }
-            break;
+#endif
+        }
+        else
+        {
+            /* Copies the value if it fits within the attribute buffer */
+            gatt_status = bt_attr_write(p_attr, p_val, len);
+
+            /* Add code for any action required when this attribute is written.
+             * In this case, we Initialize the characteristic value */
         }
     }
 
@@ -696,13 +1566,178 @@ wiced_bt_gatt_status_t bt_app_gatt_req_write_value(uint16_t attr_handle,
                 /* The write operation was not performed for the
                     * indicated handle */
                 gatt_status = WICED_BT_GATT_WRITE_NOT_PERMIT;
-                printf("GATT write request to invalid handle: 0x%x\n", attr_handle);
+                APP_TRACE_WARN("GATT write request to invalid handle: 0x%x\n", attr_handle);
                 break;
         }
     }
     return gatt_status;
 }
 
+/*******************************************************************************
+* Function Name: bt_app_ctrl_frame
+********************************************************************************
+* Summary:
+*  Decodes a control frame written to the CO2 characteristic value and hands
+*  the request over to bt_task, which owns the sensor.
+*
+* Parameters:
+*  uint16_t conn_id   : Connection writing the frame
+*  uint8_t *p_val     : Frame: opcode followed by little-endian parameters
+*  uint16_t len       : Frame length
+*
+* Return:
+*  wiced_bt_gatt_status_t: See possible status codes in wiced_bt_gatt_status_e
+*  in wiced_bt_gatt.h
+*
+*******************************************************************************/
+static wiced_bt_gatt_status_t bt_app_ctrl_frame(uint16_t conn_id, uint8_t *p_val, uint16_t len)
+{
+    if (len != BT_CTRL_FRAME_LEN)
+    {
+        return WICED_BT_GATT_INVALID_ATTR_LEN;
+    }
+
+    APP_TRACE_DEBUG("BT GATT Rx Data :  %d  %d  %d  %d \r\n", p_val[0], p_val[1], p_val[2], p_val[3]);
+
+    /* Configuration comes in bursts; serve it on a fast link */
+    if (BT_CTRL_OP_LINK_MODE != p_val[0])
+    {
+        bt_link_activity(conn_id);
+    }
+
+    switch (p_val[0])
+    {
+#ifndef BTTEST
+    case BT_CTRL_OP_FCS_START:
+    {
+        uint16_t ref = (uint16_t)(p_val[1] | (p_val[2] << 8));
+
+        /* The compensation offset is saved in the sensor, so a wrong
+         * reference miscalibrates it for good */
+        if (!bt_app_conn_trusted(conn_id))
+        {
+            return WICED_BT_GATT_INSUF_AUTHENTICATION;
+        }
+        if ((ref < PASCO2_FCS_REF_MIN_PPM) || (ref > PASCO2_FCS_REF_MAX_PPM))
+        {
+            return WICED_BT_GATT_OUT_OF_RANGE;
+        }
+        pasco2_fcs_ref = ref;
+        pasco2_fcs_request = PASCO2_FCS_REQ_START;
+        xTaskNotifyGive(bt_task_handle);
+        break;
+    }
+
+    case BT_CTRL_OP_FCS_CANCEL:
+        if (!bt_app_conn_trusted(conn_id))
+        {
+            return WICED_BT_GATT_INSUF_AUTHENTICATION;
+        }
+        pasco2_fcs_request = PASCO2_FCS_REQ_CANCEL;
+        xTaskNotifyGive(bt_task_handle);
+        break;
+#endif
+
+    case BT_CTRL_OP_TRIGGER_DEADBAND:
+    case BT_CTRL_OP_TRIGGER_MIN_INTERVAL:
+    case BT_CTRL_OP_TRIGGER_MAX_INTERVAL:
+    {
+        uint16_t param = (uint16_t)(p_val[1] | (p_val[2] << 8));
+        bt_notify_trigger_t trigger;
+
+        /* The trigger is global: one central would otherwise silence the
+         * notifications of all others */
+        if (!bt_app_conn_trusted(conn_id))
+        {
+            return WICED_BT_GATT_INSUF_AUTHENTICATION;
+        }
+        bt_notify_get_trigger(BT_APP_NOTIFY_CO2, &trigger);
+        if (BT_CTRL_OP_TRIGGER_DEADBAND == p_val[0])
+        {
+            trigger.deadband = param;
+        }
+        else if (BT_CTRL_OP_TRIGGER_MIN_INTERVAL == p_val[0])
+        {
+            trigger.min_interval_s = param;
+        }
+        else
+        {
+            trigger.max_interval_s = param;
+        }
+
+        if ((0u != trigger.max_interval_s) && (trigger.max_interval_s < trigger.min_interval_s))
+        {
+            return WICED_BT_GATT_OUT_OF_RANGE;
+        }
+        bt_notify_set_trigger(BT_APP_NOTIFY_CO2, &trigger);
+        APP_TRACE_INFO("CO2 trigger: deadband %d ppm, interval %d..%d s\r\n",
+               trigger.deadband, trigger.min_interval_s, trigger.max_interval_s);
+        break;
+    }
+
+    case BT_CTRL_OP_BATCH:
+    {
+        uint16_t samples = (uint16_t)(p_val[1] | (p_val[2] << 8));
+        bt_conn_t *p_conn = bt_conn_find(conn_id);
+
+        if (NULL == p_conn)
+        {
+            return WICED_BT_GATT_ERROR;
+        }
+        if (samples > BT_BATCH_MAX_SAMPLES)
+        {
+            return WICED_BT_GATT_OUT_OF_RANGE;
+        }
+        /* Taken over by bt_task with the next sample */
+        p_conn->batch = (uint8_t)samples;
+        APP_TRACE_INFO("Connection 0x%x: %d samples per CO2 notification\r\n", conn_id, samples);
+        break;
+    }
+
+    case BT_CTRL_OP_LINK_MODE:
+        if (!bt_link_set_mode(conn_id, p_val[1]))
+        {
+            return WICED_BT_GATT_OUT_OF_RANGE;
+        }
+        break;
+
+    case BT_CTRL_OP_BEACON:
+        if (p_val[1] > 1u)
+        {
+            return WICED_BT_GATT_OUT_OF_RANGE;
+        }
+        bt_adv_set_beacon(1u == p_val[1]);
+        break;
+
+    default:
+        return WICED_BT_GATT_REQ_NOT_SUPPORTED;
+    }
+
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: bt_app_conn_trusted
+********************************************************************************
+* Summary:
+*  Returns true if a connection is encrypted with the keys of a bonded
+*  central, as required for control frames with lasting effects. Others
+*  get WICED_BT_GATT_INSUF_AUTHENTICATION, on which the central pairs.
+*
+* Parameters:
+*  uint16_t conn_id : Connection ID
+*
+* Return:
+*  bool : true if the connection may send such control frames
+*
+*******************************************************************************/
+static bool bt_app_conn_trusted(uint16_t conn_id)
+{
+    bt_conn_t *p_conn = bt_conn_find(conn_id);
+
+    return (NULL != p_conn) && p_conn->encrypted && bt_bond_is_bonded(p_conn->bd_addr);
+}
+
 /*******************************************************************************
 * Function Name: bt_app_gatt_req_write_handler
 ********************************************************************************
@@ -726,20 +1761,21 @@ wiced_bt_gatt_status_t bt_app_gatt_req_write_handler(uint16_t conn_id,
 {
     wiced_bt_gatt_status_t status = WICED_BT_GATT_INVALID_HANDLE;
 
-    printf("bt_app_gatt_write_handler: conn_id:%d handle:0x%x offset:%d len:%d\r\n",
+    APP_TRACE_DEBUG("bt_app_gatt_write_handler: conn_id:%d handle:0x%x offset:%d len:%d\r\n",
                                                             conn_id, 
                                                             p_write_req->handle, 
                                                             p_write_req->offset, 
                                                             p_write_req->val_len );
 
     /* Attempt to perform the Write Request */
-    status = bt_app_gatt_req_write_value(p_write_req->handle,
+    status = bt_app_gatt_req_write_value(conn_id,
+                                         p_write_req->handle,
                                          p_write_req->p_val,
                                          p_write_req->val_len);
 
     if(WICED_BT_GATT_SUCCESS != status)
     {
-        printf("bt_app_gatt:GATT set attr status : 0x%x\n", status);
+        APP_TRACE_WARN("bt_app_gatt:GATT set attr status : 0x%x\n", status);
     }
 
     return (status);
@@ -771,9 +1807,7 @@ wiced_bt_gatt_status_t bt_app_gatt_req_read_handler( uint16_t conn_id,
     uint8_t     *from;
     int          to_send;
 
-	  cy_rslt_t result = CY_RSLT_SUCCESS;
-
-    puAttribute = bt_app_find_by_handle(p_read_req->handle);
+    puAttribute = bt_attr_find(p_read_req->handle);
     if (NULL == puAttribute)
     {
         wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_read_req->handle,
@@ -782,7 +1816,7 @@ wiced_bt_gatt_status_t bt_app_gatt_req_read_handler( uint16_t conn_id,
     }
     attr_len_to_copy = puAttribute->cur_len;
 
-    printf("bt_app_gatt_read_handler: conn_id:%d handle:0x%x offset:%d len:%d\r\n",
+    APP_TRACE_DEBUG("bt_app_gatt_read_handler: conn_id:%d handle:0x%x offset:%d len:%d\r\n",
                                                     conn_id, p_read_req->handle,
                                                     p_read_req->offset,
                                                     attr_len_to_copy);
@@ -800,18 +1834,62 @@ wiced_bt_gatt_status_t bt_app_gatt_req_read_handler( uint16_t conn_id,
     switch ( p_read_req->handle )
     {
     case HDLC_AIRQ_CO2_SENSOR_VALUE:
+    {
+        /* The value is the latest sample published by bt_task, which owns
+         * the sensor; the stack context never touches the bus */
+        uint8_t *p_rsp;
 
-#ifndef BTTEST
-          	result = xensiv_pasco2_mtb_read(&xensiv_pasco2, DEFAULT_PRESSURE_REF_HPA, &ppm);
-    		if (result == CY_RSLT_SUCCESS)
-    		{
-    			printf("CO2 %d ppm.\n", ppm);
-    		}
+#if defined(APP_GATT_FRESH_READ) && !defined(BTTEST)
+        /* One read is deferred at a time; others get the latest sample */
+        bool deferred = false;
+
+        taskENTER_CRITICAL();
+        if (!bt_fresh_read.pending)
+        {
+            bt_fresh_read.conn_id = conn_id;
+            bt_fresh_read.opcode = opcode;
+            bt_fresh_read.p_attr = puAttribute;
+            bt_fresh_read.offset = p_read_req->offset;
+            bt_fresh_read.to_send = to_send;
+            bt_fresh_read.pending = true;
+            deferred = true;
+        }
+        taskEXIT_CRITICAL();
+
+        if (deferred)
+        {
+            xTaskNotifyGive(bt_task_handle);
+            return WICED_BT_GATT_PENDING;
+        }
 #endif
-        	memcpy(app_airq_co2_sensor,&ppm, 2);
+        p_rsp = (uint8_t *)bt_app_alloc_buffer(to_send);
+        if (NULL == p_rsp)
+        {
+            /* Not answered from the live value, which bt_task may update
+             * while the stack sends it */
+            APP_TRACE_ERROR("bt_app_gatt:no memory found, len_req: %d!!\r\n", to_send);
+            wiced_bt_gatt_server_send_error_rsp(conn_id, opcode, p_read_req->handle,
+                                                WICED_BT_GATT_INSUF_RESOURCE);
+            return WICED_BT_GATT_INSUF_RESOURCE;
+        }
+        (void)bt_app_read_value(conn_id, puAttribute, p_read_req->offset, p_rsp, (uint16_t)to_send);
+
+        return wiced_bt_gatt_server_send_read_handle_rsp(conn_id, opcode, to_send, p_rsp,
+                                                         (void *)bt_app_free_buffer);
+    }
 
+    case HDLD_AIRQ_CO2_SENSOR_CLIENT_CHAR_CONFIG:
+    case HDLD_AIRQ_TEMPERATURE_SENSOR_CLIENT_CHAR_CONFIG:
+    {
+        /* Each central reads its own configuration */
+        bt_conn_t *p_conn = bt_conn_find(conn_id);
 
+        if (NULL != p_conn)
+        {
+            from = &p_conn->cccd[bt_app_cccd_index(p_read_req->handle)][p_read_req->offset];
+        }
         break;
+    }
 
     case HDLC_AIRQ_TEMPERATURE_SENSOR_VALUE:
         /* Read temperture sensor data from thermistor */
@@ -845,45 +1923,127 @@ wiced_bt_gatt_status_t bt_app_gatt_conn_status_cb(wiced_bt_gatt_connection_statu
                                                                     *p_conn_status)
 {
     wiced_bt_gatt_status_t status = WICED_BT_GATT_ERROR;
-    wiced_result_t result = WICED_BT_ERROR;
+    app_event_t event = { .type = APP_EVENT_CONNECTION };
 
     if ( NULL != p_conn_status )
     {
         if (p_conn_status->connected)
         {
+            bt_conn_t *p_conn;
+
             /* Device has connected */
-            printf("Bluetooth connected with device address:" );
-            bt_print_bd_address(p_conn_status->bd_addr);
-            printf("Bluetooth device connection id: 0x%x\r\n", p_conn_status->conn_id );
-            /* Store the connection ID */
-            bt_connection_id = p_conn_status->conn_id;
+            APP_TRACE_INFO("Bluetooth connected with device address:%02X:%02X:%02X:%02X:%02X:%02X\r\n",
+                           p_conn_status->bd_addr[0], p_conn_status->bd_addr[1], p_conn_status->bd_addr[2],
+                           p_conn_status->bd_addr[3], p_conn_status->bd_addr[4], p_conn_status->bd_addr[5]);
+            APP_TRACE_INFO("Bluetooth device connection id: 0x%x\r\n", p_conn_status->conn_id );
+            p_conn = bt_conn_add(p_conn_status->conn_id, p_conn_status->bd_addr);
+            if (NULL == p_conn)
+            {
+                APP_TRACE_WARN("Bluetooth connection limit reached, disconnecting\r\n");
+                wiced_bt_gatt_disconnect(p_conn_status->conn_id);
+                return WICED_BT_GATT_SUCCESS;
+            }
+            p_conn->addr_type = p_conn_status->addr_type;
            // board_led_set_state(USER_LED1, LED_OFF);
 
-            bt_connected = 1;
+            /* Discovery and subscriptions follow, so start in bulk mode */
+            bt_link_open(p_conn_status->conn_id);
+            bt_connected = bt_conn_count();
+
+            /* A bonded central does not write its configurations again;
+             * it finds its subscriptions as it left them and gets the
+             * current values without waiting for the next sample */
+            if (bt_bond_restore_cccd(p_conn))
+            {
+                bt_app_update_subscriptions();
+                bt_app_resume_notifications(p_conn, BT_CONN_CCCD_NONE);
+#ifndef BTTEST
+                if (0u != (p_conn->cccd[BT_CONN_CCCD_CO2][0] & GATT_CLIENT_CONFIG_NOTIFICATION))
+                {
+                    xTaskNotifyGive(bt_task_handle);
+                }
+#endif
+            }
+
+            /* Keep advertising slowly for further centrals */
+            bt_adv_trigger(BT_ADV_TRIGGER_CONNECT);
 
-        	StripLights_Pixel(0, WS2812_BLUE);
-        	StripLights_Trigger(1);
+            /* The display task owns the LED */
+            event.data.connection.connected = true;
+            event.data.connection.count = bt_connected;
+            app_event_publish(&event);
         }
         else
         {
+            bt_conn_t *p_conn = bt_conn_find(p_conn_status->conn_id);
+            bt_link_t link;
+
             /* Device has disconnected */
-            printf("Bluetooth disconnected with device address:" );
-            bt_print_bd_address(p_conn_status->bd_addr);
-            printf("Bluetooth device connection id: 0x%x\r\n", p_conn_status->conn_id );
-            /* Set the connection id to zero to indicate disconnected state */
-            bt_connection_id = 0;
-            /* Restart the advertisements */
-            result = wiced_bt_start_advertisements(BTM_BLE_ADVERT_UNDIRECTED_HIGH, 0, NULL);
-            /* Failed to start advertisement. Stop program execution */
-            if (CY_RSLT_SUCCESS != result)
+            APP_TRACE_INFO("Bluetooth disconnected with device address:%02X:%02X:%02X:%02X:%02X:%02X\r\n",
+                           p_conn_status->bd_addr[0], p_conn_status->bd_addr[1], p_conn_status->bd_addr[2],
+                           p_conn_status->bd_addr[3], p_conn_status->bd_addr[4], p_conn_status->bd_addr[5]);
+            APP_TRACE_INFO("Bluetooth device connection id: 0x%x\r\n", p_conn_status->conn_id );
+            if (bt_link_get(p_conn_status->conn_id, &link))
+            {
+                APP_TRACE_INFO("Link: interval %d, latency %d, timeout %d\r\n",
+                               link.interval, link.latency, link.timeout);
+                APP_TRACE_INFO("Link: phy %d/%d, octets %d/%d\r\n",
+                               link.tx_phy, link.rx_phy, link.tx_octets, link.rx_octets);
+                APP_TRACE_INFO("Link: %d switches, bulk %lu ms, %d parameter and %d PHY updates, %d rejected\r\n",
+                               link.switches, (unsigned long)link.bulk_ms,
+                               link.param_updates, link.phy_updates, link.rejected);
+            }
+
+            if (NULL != p_conn)
             {
-                CY_ASSERT(0);
+                /* Compares bonded reconnections with centrals that
+                 * discover and subscribe again */
+                APP_TRACE_INFO("First notification after %lu ms, bonded %d\r\n",
+                               (unsigned long)p_conn->first_notify_ms,
+                               bt_bond_is_bonded(p_conn->bd_addr));
             }
 
-            bt_connected = 0;
+            /* Release the connection state and its subscriptions */
+            bt_conn_remove(p_conn_status->conn_id);
+            bt_connected = bt_conn_count();
+            bt_app_update_subscriptions();
 
-        	StripLights_Pixel(0, WS2812_WHITE);
-        	StripLights_Trigger(1);
+            /* Advertise fast for a quick reconnection */
+            bt_adv_trigger(BT_ADV_TRIGGER_DISCONNECT);
+
+            for (uint8_t c = 0u; c < BT_BUF_POOL_CLASS_COUNT; c++)
+            {
+                bt_buf_pool_stats_t pool_stats;
+
+                bt_buf_pool_get_stats(c, &pool_stats);
+                APP_TRACE_INFO("GATT buffer class %d: high water %d, allocs %lu, heap %lu, failed %lu\r\n",
+                       c, pool_stats.high_water, (unsigned long)pool_stats.allocs,
+                       (unsigned long)pool_stats.exhausted, (unsigned long)pool_stats.failures);
+            }
+            for (uint8_t n = 0u; n < BT_APP_NOTIFY_COUNT; n++)
+            {
+                bt_notify_stats_t notify_stats;
+
+                bt_notify_get_stats(n, &notify_stats);
+                APP_TRACE_INFO("Notifier %d: flushes %lu, suppressed %lu, heartbeats %lu, sent %lu\r\n",
+                               n, (unsigned long)notify_stats.flushes, (unsigned long)notify_stats.suppressed,
+                               (unsigned long)notify_stats.heartbeats, (unsigned long)notify_stats.sent);
+                APP_TRACE_INFO("Notifier %d: cycles avg %lu max %lu\r\n",
+                               n, (unsigned long)((0u != notify_stats.flushes) ? (notify_stats.cycles_total / notify_stats.flushes) : 0u),
+                               (unsigned long)notify_stats.cycles_max);
+            }
+#ifdef APP_GATT_FRESH_READ
+            taskENTER_CRITICAL();
+            if (bt_fresh_read.conn_id == p_conn_status->conn_id)
+            {
+                bt_fresh_read.pending = false;
+            }
+            taskEXIT_CRITICAL();
+#endif
+
+            event.data.connection.connected = false;
+            event.data.connection.count = bt_connected;
+            app_event_publish(&event);
          //   board_led_set_blink(USER_LED1, BLINK_SLOW);
 
         }
@@ -897,7 +2057,8 @@ wiced_bt_gatt_status_t bt_app_gatt_conn_status_cb(wiced_bt_gatt_connection_statu
  * Function Name: bt_app_free_buffer
  *******************************************************************************
  * Summary:
- *  This function frees up the memory buffer
+ *  This function frees up the memory buffer, returning it to the GATT buffer
+ *  pool or to the heap it was taken from
  *
  * Parameters:
  *  uint8_t *p_data: Pointer to the buffer to be free
@@ -908,14 +2069,15 @@ wiced_bt_gatt_status_t bt_app_gatt_conn_status_cb(wiced_bt_gatt_connection_statu
  ******************************************************************************/
 void bt_app_free_buffer(uint8_t *p_buf)
 {
-    vPortFree(p_buf);
+    bt_buf_pool_free(p_buf);
 }
 
 /*******************************************************************************
  * Function Name: bt_app_alloc_buffer
  *******************************************************************************
  * Summary:
- *  This function allocates a memory buffer.
+ *  This function allocates a memory buffer from the GATT buffer pool. The
+ *  heap is only used if the pool is exhausted or the length exceeds the MTU.
  *
  *
  * Parameters:
@@ -927,96 +2089,415 @@ void bt_app_free_buffer(uint8_t *p_buf)
  ******************************************************************************/
 void* bt_app_alloc_buffer(int len)
 {
-    return pvPortMalloc(len);
+    return bt_buf_pool_alloc((uint16_t)len);
 }
 
 /*******************************************************************************
- * Function Name : bt_app_find_by_handle
- * *****************************************************************************
- * Summary :
- *    Find attribute description by handle
- *
- * Parameters:
- *  uint16_t handle    handle to look up
- *
- * Return:
- *  gatt_db_lookup_table_t   pointer containing handle data
- * 
- ******************************************************************************/
-gatt_db_lookup_table_t  *bt_app_find_by_handle(uint16_t handle)
+* Function Name: bt_app_cccd_index
+********************************************************************************
+* Summary:
+*  Maps a client characteristic configuration handle to its per-connection
+*  slot.
+*
+* Parameters:
+*  uint16_t attr_handle : Attribute handle
+*
+* Return:
+*  uint8_t : BT_CONN_CCCD_* slot, or BT_CONN_CCCD_NONE for other handles
+*
+*******************************************************************************/
+static uint8_t bt_app_cccd_index(uint16_t attr_handle)
+{
+    switch (attr_handle)
+    {
+    case HDLD_AIRQ_CO2_SENSOR_CLIENT_CHAR_CONFIG:
+        return BT_CONN_CCCD_CO2;
+    case HDLD_AIRQ_TEMPERATURE_SENSOR_CLIENT_CHAR_CONFIG:
+        return BT_CONN_CCCD_TEMPERATURE;
+    default:
+        return BT_CONN_CCCD_NONE;
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_app_update_subscriptions
+********************************************************************************
+* Summary:
+*  Derives notify_enabled from the subscriptions of all connections.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_update_subscriptions(void)
 {
-    for (uint8_t i = 0; i < app_gatt_db_ext_attr_tbl_size; i++)
+    notify_enabled = (0u != bt_conn_subscribers(BT_CONN_CCCD_CO2)) ? NOTIFIY_ON : NOTIFIY_OFF;
+}
+
+/*******************************************************************************
+* Function Name: bt_app_resume_notifications
+********************************************************************************
+* Summary:
+*  Sends the current value of subscribed characteristics to one connection
+*  only: to a bonded central whose subscriptions were restored, or to a new
+*  subscriber, so that it gets data in the first connection events instead
+*  of at the next notification flush, without a duplicate to the others.
+*  Nothing is sent before the first sample.
+*
+* Parameters:
+*  bt_conn_t *p_conn : Restored or subscribing connection
+*  uint8_t cccd      : Configuration to catch up; BT_CONN_CCCD_NONE for all
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_resume_notifications(bt_conn_t *p_conn, uint8_t cccd)
+{
+    bt_sensor_state_t state;
+
+    if (0u == bt_sensor_state_read(&state))
     {
-        if (handle == app_gatt_db_ext_attr_tbl[i].handle)
+        return;
+    }
+
+    for (uint8_t n = 0u; n < BT_APP_NOTIFY_COUNT; n++)
+    {
+        const bt_notify_desc_t *p_desc = &bt_app_notify_table[n];
+        gatt_db_lookup_table_t *p_attr = bt_attr_find(p_desc->value_handle);
+        uint16_t len;
+        uint8_t *p_buf;
+
+        if ((NULL == p_attr) || (0u == p_attr->cur_len) ||
+            ((BT_CONN_CCCD_NONE != cccd) && (cccd != p_desc->cccd)) ||
+            (0u == (p_conn->cccd[p_desc->cccd][0] & GATT_CLIENT_CONFIG_NOTIFICATION)))
+        {
+            continue;
+        }
+
+        len = MIN(p_attr->cur_len, (uint16_t)(p_conn->mtu - 3u));
+        p_buf = bt_app_alloc_buffer(len);
+        if (NULL == p_buf)
         {
-            return (&app_gatt_db_ext_attr_tbl[i]);
+            continue;
+        }
+
+        len = bt_app_read_value(p_conn->conn_id, p_attr, 0u, p_buf, len);
+        if (WICED_BT_GATT_SUCCESS == wiced_bt_gatt_server_send_notification(p_conn->conn_id,
+                                                                             p_desc->value_handle,
+                                                                             len, p_buf,
+                                                                             (void *)bt_app_free_buffer))
+        {
+            bt_conn_notified(p_conn);
+        }
+        else
+        {
+            bt_app_free_buffer(p_buf);
         }
     }
-    return NULL;
 }
 
 /*******************************************************************************
-* Function Name: bt_app_send_notification
+* Function Name: bt_app_publish_sample
 ********************************************************************************
-* Summary: Sends GATT notification.
+* Summary:
+*  Publishes a new CO2 sample as the sensor state read by GATT reads and
+*  notifications. The value is encoded into the characteristic by the next
+*  notification flush.
 *
- * Parameters:
- *  uint8_t index   : index of the sensor
+* Parameters:
+*  uint16_t co2_ppm : CO2 concentration in ppm
 *
 * Return:
 *  None
 *
 *******************************************************************************/
-void bt_app_send_notification(uint8_t index)
+static void bt_app_publish_sample(uint16_t co2_ppm)
 {
-    wiced_bt_gatt_status_t status = WICED_BT_GATT_ERROR;
+    bt_sensor_state_t state =
+    {
+        .time_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS),
+        .co2_ppm = co2_ppm,
+        .temperature = BT_SENSOR_TEMPERATURE_NONE,
+        .status = (co2_ppm >= CO2_ALARM_THRESHOLD_PPM) ? BT_SENSOR_STATUS_ALARM : 0u
+    };
 
-    switch(index)
+#ifndef BTTEST
+    if (pasco2_fcs_job.active)
     {
+        state.status |= BT_SENSOR_STATUS_FCS;
+    }
+#endif
+    state.seq = bt_sensor_state_publish(&state);
 
-    case 0:
+    bt_notify_mark_value(BT_APP_NOTIFY_CO2, (int32_t)co2_ppm);
+    bt_adv_publish(&state);
+}
 
-       if((GATT_CLIENT_CONFIG_NOTIFICATION == \
-                            app_airq_co2_sensor_client_char_config[0])
-                            && (0 != bt_connection_id))
-        {
+/*******************************************************************************
+* Function Name: bt_app_encode_co2
+********************************************************************************
+* Summary:
+*  Encodes the latest CO2 sample into the characteristic value. The critical
+*  section keeps the BT stack from reading a partly updated attribute.
+*
+* Parameters:
+*  gatt_db_lookup_table_t *p_attr : Attribute of the CO2 characteristic value
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_encode_co2(gatt_db_lookup_table_t *p_attr)
+{
+    bt_sensor_state_t state;
+
+    (void)bt_sensor_state_read(&state);
+
+    taskENTER_CRITICAL();
+    memcpy(p_attr->p_data, &state.co2_ppm, 2);
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_app_batch_sample
+********************************************************************************
+* Summary:
+*  Adds the latest CO2 sample to the batch of the subscribers in batch mode,
+*  and sends the batch when it is full, has timed out or holds an alarm.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_batch_sample(void)
+{
+    uint8_t capacity = bt_conn_batch_capacity(BT_BATCH_HDR_LEN, BT_BATCH_REC_LEN);
+    bt_batch_t *p_batch = &bt_app_batch[bt_app_batch_idx];
+    bt_sensor_state_t sample;
+
+    if (0u == capacity)
+    {
+        /* Nobody in batch mode; samples are not kept for later subscribers */
+        bt_batch_reset(p_batch);
+        return;
+    }
+
+    (void)bt_sensor_state_read(&sample);
+
+    if (!bt_batch_add(p_batch, &sample))
+    {
+        bt_app_batch_send();
+        p_batch = &bt_app_batch[bt_app_batch_idx];
+        (void)bt_batch_add(p_batch, &sample);
+    }
+
+    if (bt_batch_due(p_batch, capacity, sample.time_ms, BT_APP_BATCH_TIMEOUT_S * 1000u))
+    {
+        bt_app_batch_send();
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_app_batch_send
+********************************************************************************
+* Summary:
+*  Sends the pending batch to the subscribers in batch mode and starts the
+*  next one in the other buffer.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_batch_send(void)
+{
+    bt_batch_t *p_batch = &bt_app_batch[bt_app_batch_idx];
 
+    (void)bt_conn_notify_batch(HDLC_AIRQ_CO2_SENSOR_VALUE, p_batch->data, bt_batch_len(p_batch));
 
-        status = wiced_bt_gatt_server_send_notification(
-                                bt_connection_id,
-                                HDLC_AIRQ_CO2_SENSOR_VALUE,
-                                app_gatt_db_ext_attr_tbl[2].cur_len,
-                                app_gatt_db_ext_attr_tbl[2].p_data,NULL);
+    bt_app_batch_idx ^= 1u;
+    bt_batch_reset(&bt_app_batch[bt_app_batch_idx]);
+}
+
+/*******************************************************************************
+* Function Name: bt_app_publish_events
+********************************************************************************
+* Summary:
+*  Publishes the latest sample on the event bus, preceded by an alarm event
+*  when the sample crosses the alarm threshold.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_publish_events(void)
+{
+    static bool alarm_active = false;
+    bt_sensor_state_t state;
+    app_event_t event;
+
+    (void)bt_sensor_state_read(&state);
 
-        if(WICED_BT_GATT_SUCCESS != status)
+    if (alarm_active != (0u != (state.status & BT_SENSOR_STATUS_ALARM)))
+    {
+        alarm_active = !alarm_active;
+        if (alarm_active)
         {
-            printf("Sending co2 status notification failed\r\n");
+            /* Let centrals in range find the alarm quickly */
+            bt_adv_trigger(BT_ADV_TRIGGER_ALARM);
         }
+        event.type = APP_EVENT_ALARM;
+        event.data.alarm.active = alarm_active;
+        event.data.alarm.co2_ppm = state.co2_ppm;
+        app_event_publish(&event);
+    }
 
-        }
-        break;
+    event.type = APP_EVENT_SAMPLE;
+    event.data.sample.co2_ppm = state.co2_ppm;
+    event.data.sample.seq = state.seq;
+    app_event_publish(&event);
+}
 
-    case 1:
+/*******************************************************************************
+* Function Name: bt_app_event_service
+********************************************************************************
+* Summary:
+*  Handles the events bt_task subscribed to. A button press opens a fast
+*  advertising window and prints the advertising counters. Called on every
+*  wake-up of bt_task.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_event_service(void)
+{
+    app_event_t event;
 
-       if((GATT_CLIENT_CONFIG_NOTIFICATION == \
-                                        app_airq_temperature_sensor_client_char_config[0])
-                                        && (0 != bt_connection_id))
+    while (app_event_receive(&bt_app_events, &event))
+    {
+        if (APP_EVENT_BUTTON == event.type)
         {
-           status = wiced_bt_gatt_server_send_notification(
-                                        bt_connection_id,
-                                        HDLC_AIRQ_TEMPERATURE_SENSOR_VALUE,
-                                        app_gatt_db_ext_attr_tbl[4].cur_len,
-                                        app_gatt_db_ext_attr_tbl[4].p_data,NULL);
-           if(WICED_BT_GATT_SUCCESS != status)
-           {
-               printf("Sending temperature sensor notification failed\r\n");
-           }
+            bt_adv_stats_t adv_stats;
+
+            bt_adv_trigger(BT_ADV_TRIGGER_BUTTON);
 
+            bt_adv_get_stats(&adv_stats);
+            for (uint8_t n = 0u; n < BT_ADV_STATE_COUNT; n++)
+            {
+                APP_TRACE_INFO("Advertising state %d: %lu ms, radio %lu ms, entered %lu, connects %lu\r\n",
+                               n, (unsigned long)adv_stats.time_ms[n], (unsigned long)adv_stats.radio_ms[n],
+                               (unsigned long)adv_stats.entries[n], (unsigned long)adv_stats.connects[n]);
+            }
+            APP_TRACE_INFO("Advertising before connection: last %lu ms, max %lu ms\r\n",
+                           (unsigned long)adv_stats.connect_ms_last, (unsigned long)adv_stats.connect_ms_max);
         }
-        break;
+    }
+}
+
+#ifdef APP_GATT_FRESH_READ
+/*******************************************************************************
+* Function Name: bt_app_fresh_read_respond
+********************************************************************************
+* Summary:
+*  Sends the deferred response of a CO2 characteristic read once bt_task has
+*  read the sensor. The value is copied into a pool buffer, as the live one
+*  is rewritten by the next sample while the stack sends it.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_app_fresh_read_respond(void)
+{
+    bt_sensor_state_t state;
+    bt_fresh_read_t read;
+    uint8_t *p_rsp;
+
+    taskENTER_CRITICAL();
+    read = bt_fresh_read;
+    bt_fresh_read.pending = false;
+    taskEXIT_CRITICAL();
+
+    if (!read.pending)
+    {
+        return;
+    }
+
+    (void)bt_sensor_state_read(&state);
+    APP_TRACE_DEBUG("CO2 fresh read: %d ppm, sample %lu\r\n", state.co2_ppm, (unsigned long)state.seq);
+
+    p_rsp = (uint8_t *)bt_app_alloc_buffer(read.to_send);
+    if (NULL == p_rsp)
+    {
+        APP_TRACE_ERROR("bt_app_gatt:no memory found, len_req: %d!!\r\n", read.to_send);
+        wiced_bt_gatt_server_send_error_rsp(read.conn_id, read.opcode, read.p_attr->handle,
+                                            WICED_BT_GATT_INSUF_RESOURCE);
+        return;
+    }
+    (void)bt_app_read_value(read.conn_id, read.p_attr, read.offset, p_rsp, (uint16_t)read.to_send);
+
+    (void)wiced_bt_gatt_server_send_read_handle_rsp(read.conn_id, read.opcode, read.to_send, p_rsp,
+                                                    (void *)bt_app_free_buffer);
+}
+#endif
 
+/*******************************************************************************
+* Function Name: bt_boot_profile_mark
+********************************************************************************
+* Summary:
+*  Records the time of a startup milestone the first time it is reached.
+*
+* Parameters:
+*  uint32_t *p_mark : Milestone of bt_boot_profile
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_boot_profile_mark(uint32_t *p_mark)
+{
+    if (0u == *p_mark)
+    {
+        *p_mark = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
     }
+}
 
+/*******************************************************************************
+* Function Name: bt_app_send_notification
+********************************************************************************
+* Summary: Sends GATT notification to all connections subscribed to it.
+*
+ * Parameters:
+ *  uint8_t index   : BT_APP_NOTIFY_* entry of the characteristic
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_app_send_notification(uint8_t index)
+{
+    bt_notify_mark(index);
+    bt_notify_force(index);
+    (void)bt_notify_flush();
 }
 
 
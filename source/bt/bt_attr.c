@@ -0,0 +1,295 @@
+/*******************************************************************************
+* File Name: bt_attr.c
+*
+* Description: This file contains the handle index of the generated GATT
+* attribute table. The table is generated when the project is built, so the
+* index is filled at init rather than emitted as a constant; a handle is
+* then resolved with a single array access. The responses to Read Multiple
+* and Read By Type requests and the writes of plain values are handled here
+* from the table.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <string.h>
+#include "app_trace.h"
+#include "bt_attr.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Position + 1 of the app_gatt_db_ext_attr_tbl entry of each handle; 0 if the
+ * handle has no entry. Valid once bt_attr_index_ready is set. */
+static uint8_t bt_attr_index[BT_ATTR_INDEX_LEN];
+static bool bt_attr_index_ready = false;
+
+/*******************************************************************************
+* Function Name: bt_attr_init
+********************************************************************************
+* Summary:
+*  Builds the handle index of app_gatt_db_ext_attr_tbl. A table with more
+*  entries than the index can address is left to the linear search. Must be
+*  called before the GATT callback is registered.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_attr_init(void)
+{
+    bt_attr_index_ready = false;
+    memset(bt_attr_index, 0, sizeof(bt_attr_index));
+
+    if (app_gatt_db_ext_attr_tbl_size >= UINT8_MAX)
+    {
+        APP_TRACE_WARN("GATT attribute index not used: %d entries\r\n",
+                       app_gatt_db_ext_attr_tbl_size);
+        return;
+    }
+
+    for (uint16_t i = 0u; i < app_gatt_db_ext_attr_tbl_size; i++)
+    {
+        uint16_t handle = app_gatt_db_ext_attr_tbl[i].handle;
+
+        /* The first entry of a handle wins, as with the linear search */
+        if ((handle < BT_ATTR_INDEX_LEN) && (0u == bt_attr_index[handle]))
+        {
+            bt_attr_index[handle] = (uint8_t)(i + 1u);
+        }
+    }
+
+    bt_attr_index_ready = true;
+}
+
+/*******************************************************************************
+* Function Name: bt_attr_find
+********************************************************************************
+* Summary:
+*  Finds the attribute table entry of a handle.
+*
+* Parameters:
+*  uint16_t handle : Handle to look up
+*
+* Return:
+*  gatt_db_lookup_table_t* : Entry of the handle, or NULL if it has none
+*
+*******************************************************************************/
+gatt_db_lookup_table_t* bt_attr_find(uint16_t handle)
+{
+    if (bt_attr_index_ready && (handle < BT_ATTR_INDEX_LEN))
+    {
+        uint8_t pos = bt_attr_index[handle];
+
+        return (0u != pos) ? &app_gatt_db_ext_attr_tbl[pos - 1u] : NULL;
+    }
+
+    for (uint16_t i = 0u; i < app_gatt_db_ext_attr_tbl_size; i++)
+    {
+        if (handle == app_gatt_db_ext_attr_tbl[i].handle)
+        {
+            return &app_gatt_db_ext_attr_tbl[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: bt_attr_find_all
+********************************************************************************
+* Summary:
+*  Checks that every handle of a Read Multiple request has an entry,
+*  including those a truncated response leaves out.
+*
+* Parameters:
+*  wiced_bt_gatt_read_multiple_req_t *p_read_req : Handles to read
+*  uint16_t *p_bad_handle                        : Receives the first handle
+*                                                  without an entry
+*
+* Return:
+*  bool : true if all handles have an entry
+*
+*******************************************************************************/
+bool bt_attr_find_all(wiced_bt_gatt_read_multiple_req_t *p_read_req, uint16_t *p_bad_handle)
+{
+    for (uint16_t n = 0u; n < p_read_req->num_handles; n++)
+    {
+        uint16_t handle = wiced_bt_gatt_get_handle_from_stream(p_read_req->p_handle_stream, n);
+
+        if (NULL == bt_attr_find(handle))
+        {
+            *p_bad_handle = handle;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_attr_read_multi
+********************************************************************************
+* Summary:
+*  Fills the response to a Read Multiple or Read Multiple Variable Length
+*  request in one pass over the requested handles. Read Multiple
+*  concatenates the values; Read Multiple Variable Length prefixes each with
+*  the length of the whole value, even if the value is cut. A response
+*  longer than len_req is truncated, as the specification allows. The
+*  handles must have been checked with bt_attr_find_all.
+*
+* Parameters:
+*  uint16_t conn_id                              : Connection ID
+*  wiced_bt_gatt_opcode_t opcode                 : Request opcode
+*  wiced_bt_gatt_read_multiple_req_t *p_read_req : Handles to read
+*  bt_attr_read_t read                           : Reads a value for the
+*                                                  connection
+*  uint8_t *p_rsp                                : Receives the response
+*  uint16_t len_req                              : Room in p_rsp
+*
+* Return:
+*  uint16_t : Length of the response
+*
+*******************************************************************************/
+uint16_t bt_attr_read_multi(uint16_t conn_id, wiced_bt_gatt_opcode_t opcode,
+                            wiced_bt_gatt_read_multiple_req_t *p_read_req,
+                            bt_attr_read_t read, uint8_t *p_rsp, uint16_t len_req)
+{
+    uint16_t used_len = 0u;
+
+    for (uint16_t n = 0u; (n < p_read_req->num_handles) && (used_len < len_req); n++)
+    {
+        uint16_t handle = wiced_bt_gatt_get_handle_from_stream(p_read_req->p_handle_stream, n);
+        gatt_db_lookup_table_t *p_attr = bt_attr_find(handle);
+
+        if (GATT_REQ_READ_MULTI_VAR_LENGTH == opcode)
+        {
+            if ((uint16_t)(len_req - used_len) < 2u)
+            {
+                break;
+            }
+            p_rsp[used_len++] = (uint8_t)(p_attr->cur_len & 0xFFu);
+            p_rsp[used_len++] = (uint8_t)(p_attr->cur_len >> 8u);
+        }
+        used_len = (uint16_t)(used_len + read(conn_id, p_attr, 0u, p_rsp + used_len,
+                                              (uint16_t)(len_req - used_len)));
+    }
+
+    return used_len;
+}
+
+/*******************************************************************************
+* Function Name: bt_attr_read_by_type
+********************************************************************************
+* Summary:
+*  Fills the response to a Read By Type request with the handle and value of
+*  each attribute of the requested type between the start and end handles.
+*  Values are those a single read returns. The response ends at the first
+*  pair that does not fit or whose value length differs from the first one.
+*
+* Parameters:
+*  uint16_t conn_id                          : Connection ID
+*  wiced_bt_gatt_read_by_type_t *p_read_req  : Handle range and type
+*  bt_attr_read_t read                       : Reads a value for the
+*                                              connection
+*  uint8_t *p_val                            : Holds one value; len_req bytes
+*  uint8_t *p_rsp                            : Receives the response
+*  uint16_t len_req                          : Room in p_rsp
+*  uint8_t *p_pair_len                       : Receives the length of each
+*                                              handle-value pair
+*  uint16_t *p_used_len                      : Receives the length of the
+*                                              response
+*
+* Return:
+*  wiced_bt_gatt_status_t : WICED_BT_GATT_SUCCESS, WICED_BT_GATT_INVALID_HANDLE
+*  if no attribute of the type is in the range, or WICED_BT_GATT_ERR_UNLIKELY
+*  if the database holds one that has no entry
+*
+*******************************************************************************/
+wiced_bt_gatt_status_t bt_attr_read_by_type(uint16_t conn_id, wiced_bt_gatt_read_by_type_t *p_read_req,
+                                            bt_attr_read_t read, uint8_t *p_val, uint8_t *p_rsp,
+                                            uint16_t len_req, uint8_t *p_pair_len, uint16_t *p_used_len)
+{
+    uint16_t attr_handle = p_read_req->s_handle;
+    uint16_t used_len = 0u;
+
+    *p_pair_len = 0u;
+    *p_used_len = 0u;
+
+    while (WICED_TRUE)
+    {
+        gatt_db_lookup_table_t *p_attr;
+        uint16_t val_len;
+        int filled;
+
+        attr_handle = wiced_bt_gatt_find_handle_by_type(attr_handle, p_read_req->e_handle,
+                                                        &p_read_req->uuid);
+        if (0u == attr_handle)
+        {
+            break;
+        }
+
+        p_attr = bt_attr_find(attr_handle);
+        if (NULL == p_attr)
+        {
+            APP_TRACE_WARN("bt_attr:found type but no attribute for %d\r\n", attr_handle);
+            return WICED_BT_GATT_ERR_UNLIKELY;
+        }
+
+        val_len = read(conn_id, p_attr, 0u, p_val, len_req);
+        filled = wiced_bt_gatt_put_read_by_type_rsp_in_stream(p_rsp + used_len, (int)(len_req - used_len),
+                                                              p_pair_len, attr_handle, (int)val_len, p_val);
+        if (0 == filled)
+        {
+            break;
+        }
+        used_len = (uint16_t)(used_len + filled);
+
+        /* Search again from one past the current handle, which must not
+         * wrap around to the start of the database */
+        if (attr_handle >= p_read_req->e_handle)
+        {
+            break;
+        }
+        attr_handle++;
+    }
+
+    *p_used_len = used_len;
+    return (0u != used_len) ? WICED_BT_GATT_SUCCESS : WICED_BT_GATT_INVALID_HANDLE;
+}
+
+/*******************************************************************************
+* Function Name: bt_attr_write
+********************************************************************************
+* Summary:
+*  Stores a value written to an attribute kept in the table.
+*
+* Parameters:
+*  gatt_db_lookup_table_t *p_attr : Attribute to write
+*  const uint8_t *p_val           : Value
+*  uint16_t len                   : Length of the value
+*
+* Return:
+*  wiced_bt_gatt_status_t : WICED_BT_GATT_SUCCESS, or
+*  WICED_BT_GATT_INVALID_HANDLE if the value does not fit
+*
+*******************************************************************************/
+wiced_bt_gatt_status_t bt_attr_write(gatt_db_lookup_table_t *p_attr, const uint8_t *p_val, uint16_t len)
+{
+    if (p_attr->max_len < len)
+    {
+        APP_TRACE_WARN("GATT write request to invalid handle: 0x%x\r\n", p_attr->handle);
+        return WICED_BT_GATT_INVALID_HANDLE;
+    }
+
+    p_attr->cur_len = len;
+    memcpy(p_attr->p_data, p_val, len);
+    return WICED_BT_GATT_SUCCESS;
+}
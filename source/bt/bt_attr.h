@@ -0,0 +1,58 @@
+/*******************************************************************************
+* File Name: bt_attr.h
+*
+* Description: This file is the public interface of bt_attr.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_ATTR_H_
+#define BT_ATTR_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "wiced_bt_gatt.h"
+#include "cycfg_gatt_db.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Attributes with a handle below this value are found through the index
+ * instead of a scan of app_gatt_db_ext_attr_tbl. Covers the handles of the
+ * generated database with room for more characteristics; higher handles
+ * still work through the scan. */
+#define BT_ATTR_INDEX_LEN               (128u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Copies part of the value a read of an attribute returns to a connection;
+ * returns the number of bytes copied */
+typedef uint16_t (*bt_attr_read_t)(uint16_t conn_id, gatt_db_lookup_table_t *p_attr,
+                                   uint16_t offset, uint8_t *p_out, uint16_t out_len);
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void                    bt_attr_init(void);
+gatt_db_lookup_table_t* bt_attr_find(uint16_t handle);
+bool                    bt_attr_find_all(wiced_bt_gatt_read_multiple_req_t *p_read_req,
+                                         uint16_t *p_bad_handle);
+uint16_t                bt_attr_read_multi(uint16_t conn_id, wiced_bt_gatt_opcode_t opcode,
+                                           wiced_bt_gatt_read_multiple_req_t *p_read_req,
+                                           bt_attr_read_t read, uint8_t *p_rsp, uint16_t len_req);
+wiced_bt_gatt_status_t  bt_attr_read_by_type(uint16_t conn_id, wiced_bt_gatt_read_by_type_t *p_read_req,
+                                             bt_attr_read_t read, uint8_t *p_val, uint8_t *p_rsp,
+                                             uint16_t len_req, uint8_t *p_pair_len, uint16_t *p_used_len);
+wiced_bt_gatt_status_t  bt_attr_write(gatt_db_lookup_table_t *p_attr, const uint8_t *p_val, uint16_t len);
+
+#endif /* BT_ATTR_H_ */
@@ -0,0 +1,139 @@
+/*******************************************************************************
+* File Name: bt_batch.c
+*
+* Description: This file contains the encoder of batched CO2 notifications.
+* Samples are packed into fixed-size records behind a short header as they
+* arrive, so a full batch is sent in one notification of up to the ATT MTU
+* instead of one notification per sample.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stddef.h>
+#include "bt_batch.h"
+
+/*******************************************************************************
+* Function Name: bt_batch_reset
+********************************************************************************
+* Summary:
+*  Empties a batch.
+*
+* Parameters:
+*  bt_batch_t *p_batch : Batch
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_batch_reset(bt_batch_t *p_batch)
+{
+    p_batch->count = 0u;
+    p_batch->last_status = 0u;
+    p_batch->first_ms = 0u;
+}
+
+/*******************************************************************************
+* Function Name: bt_batch_add
+********************************************************************************
+* Summary:
+*  Appends the record of a sample. The first sample sets the time base of
+*  the batch.
+*
+* Parameters:
+*  bt_batch_t *p_batch               : Batch
+*  const bt_sensor_state_t *p_sample : Sample
+*
+* Return:
+*  bool : false if the batch is full or the sample is too far from the
+*         first one; the batch must be sent first
+*
+*******************************************************************************/
+bool bt_batch_add(bt_batch_t *p_batch, const bt_sensor_state_t *p_sample)
+{
+    uint32_t offset_s;
+    uint8_t *p;
+
+    if (0u == p_batch->count)
+    {
+        p_batch->first_ms = p_sample->time_ms;
+        p_batch->data[0] = BT_BATCH_FORMAT;
+        p_batch->data[2] = (uint8_t)(p_sample->time_ms);
+        p_batch->data[3] = (uint8_t)(p_sample->time_ms >> 8);
+        p_batch->data[4] = (uint8_t)(p_sample->time_ms >> 16);
+        p_batch->data[5] = (uint8_t)(p_sample->time_ms >> 24);
+    }
+    else if (p_batch->count >= BT_BATCH_MAX_SAMPLES)
+    {
+        return false;
+    }
+
+    offset_s = (p_sample->time_ms - p_batch->first_ms) / 1000u;
+    if (offset_s > UINT16_MAX)
+    {
+        return false;
+    }
+
+    p = &p_batch->data[BT_BATCH_HDR_LEN + ((size_t)p_batch->count * BT_BATCH_REC_LEN)];
+    p[0] = (uint8_t)(offset_s);
+    p[1] = (uint8_t)(offset_s >> 8);
+    p[2] = (uint8_t)(p_sample->co2_ppm);
+    p[3] = (uint8_t)(p_sample->co2_ppm >> 8);
+    p[4] = (uint8_t)((uint16_t)p_sample->temperature);
+    p[5] = (uint8_t)((uint16_t)p_sample->temperature >> 8);
+    p[6] = p_sample->status;
+
+    p_batch->count++;
+    p_batch->data[1] = p_batch->count;
+    p_batch->last_status = p_sample->status;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_batch_due
+********************************************************************************
+* Summary:
+*  Tells whether a batch must be sent: when it holds the number of samples
+*  the subscribers accept, when its first sample is older than the timeout,
+*  or when its latest sample carries an alarm.
+*
+* Parameters:
+*  const bt_batch_t *p_batch : Batch
+*  uint8_t capacity          : Samples per notification
+*  uint32_t now_ms           : Current time in ms
+*  uint32_t timeout_ms       : Longest time a sample is held back
+*
+* Return:
+*  bool : true if the batch is to be sent now
+*
+*******************************************************************************/
+bool bt_batch_due(const bt_batch_t *p_batch, uint8_t capacity, uint32_t now_ms,
+                  uint32_t timeout_ms)
+{
+    if (0u == p_batch->count)
+    {
+        return false;
+    }
+
+    return ((p_batch->count >= capacity) ||
+            ((now_ms - p_batch->first_ms) >= timeout_ms) ||
+            (0u != (p_batch->last_status & BT_SENSOR_STATUS_ALARM)));
+}
+
+/*******************************************************************************
+* Function Name: bt_batch_len
+********************************************************************************
+* Summary:
+*  Returns the length of the encoded batch.
+*
+*******************************************************************************/
+uint16_t bt_batch_len(const bt_batch_t *p_batch)
+{
+    return (uint16_t)(BT_BATCH_HDR_LEN + ((uint16_t)p_batch->count * BT_BATCH_REC_LEN));
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+* File Name: bt_batch.h
+*
+* Description: This file is the public interface of bt_batch.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_BATCH_H_
+#define BT_BATCH_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "cycfg_bt_settings.h"
+#include "bt_sensor_state.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Batch layout, little-endian:
+ *  header: u8 format, u8 sample count, u32 time of the first sample in ms
+ *  record: u16 seconds since the first sample, u16 CO2 in ppm,
+ *          s16 temperature in 0.01 degC, u8 BT_SENSOR_STATUS_* */
+#define BT_BATCH_FORMAT                 (0x01u)
+#define BT_BATCH_HDR_LEN                (6u)
+#define BT_BATCH_REC_LEN                (7u)
+
+/* Records that fit in a notification of the largest ATT MTU */
+#define BT_BATCH_MAX_SAMPLES            (((CY_BT_MTU_SIZE) - 3u - BT_BATCH_HDR_LEN) / BT_BATCH_REC_LEN)
+#define BT_BATCH_MAX_LEN                (BT_BATCH_HDR_LEN + (BT_BATCH_MAX_SAMPLES * BT_BATCH_REC_LEN))
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Samples waiting for a batched notification, already encoded */
+typedef struct
+{
+    uint8_t  data[BT_BATCH_MAX_LEN];
+    uint8_t  count;
+    uint8_t  last_status;
+    uint32_t first_ms;
+} bt_batch_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void     bt_batch_reset(bt_batch_t *p_batch);
+bool     bt_batch_add(bt_batch_t *p_batch, const bt_sensor_state_t *p_sample);
+bool     bt_batch_due(const bt_batch_t *p_batch, uint8_t capacity, uint32_t now_ms,
+                      uint32_t timeout_ms);
+uint16_t bt_batch_len(const bt_batch_t *p_batch);
+
+#endif /* BT_BATCH_H_ */
@@ -0,0 +1,527 @@
+/*******************************************************************************
+* File Name: bt_bond.c
+*
+* Description: This file contains the bonding information of the GATT
+* server. The link keys and the client characteristic configurations of each
+* bonded central are kept in flash, with a copy in RAM so that key requests
+* of the stack and reconnections do not wait for the flash. A bonded central
+* that reconnects gets its subscriptions back without writing them again,
+* and the device advertises directed to the last of them after a
+* disconnection.
+*
+* Changes are made to the RAM copy in the stack context and only marked
+* there; bt_task writes the marked items to flash, as a flash write would
+* hold the stack for the duration of an erase.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "app_trace.h"
+#include "bt_bond.h"
+#include "flash_utils.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define BT_BOND_SLOT_NONE               (0xFFu)
+
+/* Items of bt_bond_dirty: one bit per peer slot, then the index and the
+ * local keys */
+#define BT_BOND_DIRTY_INDEX             (1u << BT_BOND_MAX_PEERS)
+#define BT_BOND_DIRTY_LOCAL_KEYS        (1u << (BT_BOND_MAX_PEERS + 1u))
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Flash item of a bonded central */
+typedef struct
+{
+    wiced_bt_device_link_keys_t keys;                           /* Address and keys of the central */
+    uint8_t                     cccd[BT_CONN_CCCD_COUNT][2];    /* Configurations last written */
+} bt_bond_peer_t;
+
+/* Flash item of the peer slots */
+typedef struct
+{
+    uint8_t next;       /* Slot taken by the next new central */
+    uint8_t last;       /* Slot of the last central connected; BT_BOND_SLOT_NONE if none */
+} bt_bond_index_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Written in the stack context under a critical section; read by bt_task
+ * to write them to flash, and the address of the last peer by the timer
+ * service task */
+static bt_bond_peer_t bt_bond_peer[BT_BOND_MAX_PEERS];
+static bool bt_bond_used[BT_BOND_MAX_PEERS];
+static bt_bond_index_t bt_bond_index = { .next = 0u, .last = BT_BOND_SLOT_NONE };
+static wiced_bt_local_identity_keys_t bt_bond_local_keys;
+static bool bt_bond_local_valid = false;
+
+/* Items changed in RAM and not written to flash yet */
+static uint32_t bt_bond_dirty = 0u;
+
+extern TaskHandle_t bt_task_handle;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+static uint8_t bt_bond_find(const wiced_bt_device_address_t bd_addr);
+static void    bt_bond_set_last(uint8_t slot);
+static void    bt_bond_mark(uint32_t items);
+static bool    bt_bond_write(uint16_t item, uint32_t len, uint8_t *p_data);
+
+/*******************************************************************************
+* Function Name: bt_bond_init
+********************************************************************************
+* Summary:
+*  Loads the bonding information from flash and adds the bonded centrals to
+*  the address resolution list of the stack, so that they are recognized
+*  behind their private addresses. Must be called once the stack is enabled.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_bond_init(void)
+{
+    wiced_result_t result;
+    uint8_t count = 0u;
+
+    memset(bt_bond_peer, 0, sizeof(bt_bond_peer));
+    memset(bt_bond_used, 0, sizeof(bt_bond_used));
+
+    if ((sizeof(bt_bond_index) != flash_memory_read(BT_BOND_ITEM_INDEX, sizeof(bt_bond_index),
+                                                    (uint8_t *)&bt_bond_index, &result)) ||
+        (bt_bond_index.next >= BT_BOND_MAX_PEERS))
+    {
+        bt_bond_index.next = 0u;
+        bt_bond_index.last = BT_BOND_SLOT_NONE;
+    }
+
+    for (uint8_t slot = 0u; slot < BT_BOND_MAX_PEERS; slot++)
+    {
+        if (sizeof(bt_bond_peer_t) == flash_memory_read((uint16_t)(BT_BOND_ITEM_PEER + slot),
+                                                        sizeof(bt_bond_peer_t),
+                                                        (uint8_t *)&bt_bond_peer[slot], &result))
+        {
+            bt_bond_used[slot] = true;
+            (void)wiced_bt_dev_add_device_to_address_resolution_db(&bt_bond_peer[slot].keys);
+            count++;
+        }
+    }
+
+    if ((BT_BOND_SLOT_NONE != bt_bond_index.last) &&
+        ((bt_bond_index.last >= BT_BOND_MAX_PEERS) || !bt_bond_used[bt_bond_index.last]))
+    {
+        bt_bond_index.last = BT_BOND_SLOT_NONE;
+    }
+
+    APP_TRACE_INFO("Bonded centrals: %d, last slot %d\r\n", count, bt_bond_index.last);
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_is_bonded
+********************************************************************************
+* Summary:
+*  Returns true if a central is bonded.
+*
+*******************************************************************************/
+bool bt_bond_is_bonded(const wiced_bt_device_address_t bd_addr)
+{
+    return (BT_BOND_SLOT_NONE != bt_bond_find(bd_addr));
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_save_keys
+********************************************************************************
+* Summary:
+*  Stores the link keys of a central after pairing. A new central takes the
+*  next slot, replacing the oldest bond once all slots are used, and starts
+*  with the configurations it has written on its current connection. The
+*  bond reaches flash once bt_task runs bt_bond_flush.
+*
+* Parameters:
+*  const wiced_bt_device_link_keys_t *p_keys : Address and keys of the central
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_bond_save_keys(const wiced_bt_device_link_keys_t *p_keys)
+{
+    uint8_t slot = bt_bond_find(p_keys->bd_addr);
+    bt_conn_t *p_conn = bt_conn_find_by_addr(p_keys->bd_addr);
+
+    if (BT_BOND_SLOT_NONE == slot)
+    {
+        slot = bt_bond_index.next;
+
+        if (bt_bond_used[slot])
+        {
+            APP_TRACE_INFO("Bond of slot %d replaced\r\n", slot);
+            (void)wiced_bt_dev_remove_device_from_address_resolution_db(&bt_bond_peer[slot].keys);
+        }
+
+        taskENTER_CRITICAL();
+        bt_bond_index.next = (uint8_t)((slot + 1u) % BT_BOND_MAX_PEERS);
+        memset(&bt_bond_peer[slot], 0, sizeof(bt_bond_peer_t));
+        bt_bond_used[slot] = true;
+        taskEXIT_CRITICAL();
+    }
+
+    taskENTER_CRITICAL();
+    bt_bond_peer[slot].keys = *p_keys;
+    if (NULL != p_conn)
+    {
+        memcpy(bt_bond_peer[slot].cccd, p_conn->cccd, sizeof(bt_bond_peer[slot].cccd));
+    }
+    /* The replacement slot may have moved even if the last one has not */
+    bt_bond_index.last = slot;
+    taskEXIT_CRITICAL();
+
+    bt_bond_mark((1UL << slot) | BT_BOND_DIRTY_INDEX);
+    APP_TRACE_INFO("Bond stored in slot %d\r\n", slot);
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_load_keys
+********************************************************************************
+* Summary:
+*  Looks up the link keys of a central for the stack.
+*
+* Parameters:
+*  wiced_bt_device_link_keys_t *p_keys : Address of the central; receives
+*                                        its keys
+*
+* Return:
+*  bool : true if the central is bonded
+*
+*******************************************************************************/
+bool bt_bond_load_keys(wiced_bt_device_link_keys_t *p_keys)
+{
+    uint8_t slot = bt_bond_find(p_keys->bd_addr);
+
+    if (BT_BOND_SLOT_NONE == slot)
+    {
+        return false;
+    }
+
+    *p_keys = bt_bond_peer[slot].keys;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_save_local_keys
+********************************************************************************
+* Summary:
+*  Stores the local identity keys, so that bonded centrals still resolve the
+*  address of the device after a reset. The keys reach flash once bt_task
+*  runs bt_bond_flush.
+*
+* Parameters:
+*  const wiced_bt_local_identity_keys_t *p_keys : Keys generated by the stack
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_bond_save_local_keys(const wiced_bt_local_identity_keys_t *p_keys)
+{
+    taskENTER_CRITICAL();
+    bt_bond_local_keys = *p_keys;
+    bt_bond_local_valid = true;
+    taskEXIT_CRITICAL();
+
+    bt_bond_mark(BT_BOND_DIRTY_LOCAL_KEYS);
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_load_local_keys
+********************************************************************************
+* Summary:
+*  Reads the local identity keys stored by bt_bond_save_local_keys.
+*
+* Parameters:
+*  wiced_bt_local_identity_keys_t *p_keys : Receives the keys
+*
+* Return:
+*  bool : true if keys were stored; otherwise the stack generates new ones
+*
+*******************************************************************************/
+bool bt_bond_load_local_keys(wiced_bt_local_identity_keys_t *p_keys)
+{
+    wiced_result_t result;
+
+    /* Keys saved since the reset may not be in flash yet */
+    if (bt_bond_local_valid)
+    {
+        *p_keys = bt_bond_local_keys;
+        return true;
+    }
+
+    return (sizeof(*p_keys) == flash_memory_read(BT_BOND_ITEM_LOCAL_KEYS, sizeof(*p_keys),
+                                                 (uint8_t *)p_keys, &result));
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_restore_cccd
+********************************************************************************
+* Summary:
+*  Gives a new connection of a bonded central the configurations the central
+*  wrote before, as the central does not write them again, and makes it the
+*  target of directed advertising.
+*
+* Parameters:
+*  bt_conn_t *p_conn : New connection
+*
+* Return:
+*  bool : true if the central is bonded
+*
+*******************************************************************************/
+bool bt_bond_restore_cccd(bt_conn_t *p_conn)
+{
+    uint8_t slot = bt_bond_find(p_conn->bd_addr);
+
+    if (BT_BOND_SLOT_NONE == slot)
+    {
+        return false;
+    }
+
+    memcpy(p_conn->cccd, bt_bond_peer[slot].cccd, sizeof(p_conn->cccd));
+    bt_bond_set_last(slot);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_save_cccd
+********************************************************************************
+* Summary:
+*  Stores the configurations of a connection if its central is bonded and
+*  they have changed. Configurations of other centrals are not kept. They
+*  reach flash once bt_task runs bt_bond_flush.
+*
+* Parameters:
+*  const bt_conn_t *p_conn : Connection whose configurations were written
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_bond_save_cccd(const bt_conn_t *p_conn)
+{
+    uint8_t slot = bt_bond_find(p_conn->bd_addr);
+
+    if ((BT_BOND_SLOT_NONE == slot) ||
+        (0 == memcmp(bt_bond_peer[slot].cccd, p_conn->cccd, sizeof(p_conn->cccd))))
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    memcpy(bt_bond_peer[slot].cccd, p_conn->cccd, sizeof(p_conn->cccd));
+    taskEXIT_CRITICAL();
+
+    bt_bond_mark(1UL << slot);
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_flush
+********************************************************************************
+* Summary:
+*  Writes the items changed since the last call to flash. Called by bt_task
+*  on every wake-up; the stack context wakes it when it changes an item.
+*  Each item is copied under a critical section and written outside it, so
+*  the stack can change it meanwhile; it is then marked again and written
+*  on the next call. An item that fails to be written is marked again too,
+*  so the bond is not lost until something else changes.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_bond_flush(void)
+{
+    bt_bond_peer_t peer;
+    bt_bond_index_t index;
+    wiced_bt_local_identity_keys_t local_keys;
+    uint32_t dirty;
+    uint32_t failed = 0u;
+
+    taskENTER_CRITICAL();
+    dirty = bt_bond_dirty;
+    bt_bond_dirty = 0u;
+    taskEXIT_CRITICAL();
+
+    for (uint8_t slot = 0u; slot < BT_BOND_MAX_PEERS; slot++)
+    {
+        if (0u != (dirty & (1UL << slot)))
+        {
+            taskENTER_CRITICAL();
+            peer = bt_bond_peer[slot];
+            taskEXIT_CRITICAL();
+
+            if (!bt_bond_write((uint16_t)(BT_BOND_ITEM_PEER + slot), sizeof(peer), (uint8_t *)&peer))
+            {
+                failed |= (1UL << slot);
+            }
+        }
+    }
+
+    if (0u != (dirty & BT_BOND_DIRTY_INDEX))
+    {
+        taskENTER_CRITICAL();
+        index = bt_bond_index;
+        taskEXIT_CRITICAL();
+
+        if (!bt_bond_write(BT_BOND_ITEM_INDEX, sizeof(index), (uint8_t *)&index))
+        {
+            failed |= BT_BOND_DIRTY_INDEX;
+        }
+    }
+
+    if (0u != (dirty & BT_BOND_DIRTY_LOCAL_KEYS))
+    {
+        taskENTER_CRITICAL();
+        local_keys = bt_bond_local_keys;
+        taskEXIT_CRITICAL();
+
+        if (!bt_bond_write(BT_BOND_ITEM_LOCAL_KEYS, sizeof(local_keys), (uint8_t *)&local_keys))
+        {
+            failed |= BT_BOND_DIRTY_LOCAL_KEYS;
+        }
+    }
+
+    /* Retried on the next wake-up of bt_task; waking it now would keep it
+     * busy for as long as the flash fails */
+    if (0u != failed)
+    {
+        taskENTER_CRITICAL();
+        bt_bond_dirty |= failed;
+        taskEXIT_CRITICAL();
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_last_peer
+********************************************************************************
+* Summary:
+*  Returns the address of the bonded central that connected last, the target
+*  of directed advertising. Can be called from any task.
+*
+* Parameters:
+*  wiced_bt_device_address_t bd_addr            : Receives the address
+*  wiced_bt_ble_address_type_t *p_addr_type     : Receives the address type
+*
+* Return:
+*  bool : false if no central is bonded
+*
+*******************************************************************************/
+bool bt_bond_last_peer(wiced_bt_device_address_t bd_addr, wiced_bt_ble_address_type_t *p_addr_type)
+{
+    bool found = false;
+
+    taskENTER_CRITICAL();
+    if (BT_BOND_SLOT_NONE != bt_bond_index.last)
+    {
+        const wiced_bt_device_link_keys_t *p_keys = &bt_bond_peer[bt_bond_index.last].keys;
+
+        memcpy(bd_addr, p_keys->bd_addr, sizeof(wiced_bt_device_address_t));
+        *p_addr_type = p_keys->key_data.ble_addr_type;
+        found = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return found;
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_find
+********************************************************************************
+* Summary:
+*  Returns the slot of a bonded central, or BT_BOND_SLOT_NONE.
+*
+*******************************************************************************/
+static uint8_t bt_bond_find(const wiced_bt_device_address_t bd_addr)
+{
+    for (uint8_t slot = 0u; slot < BT_BOND_MAX_PEERS; slot++)
+    {
+        if (bt_bond_used[slot] &&
+            (0 == memcmp(bt_bond_peer[slot].keys.bd_addr, bd_addr, sizeof(wiced_bt_device_address_t))))
+        {
+            return slot;
+        }
+    }
+    return BT_BOND_SLOT_NONE;
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_set_last
+********************************************************************************
+* Summary:
+*  Makes a slot the target of directed advertising. The slot index is
+*  marked for flash when it changes, so the target survives a reset.
+*
+*******************************************************************************/
+static void bt_bond_set_last(uint8_t slot)
+{
+    if (slot != bt_bond_index.last)
+    {
+        taskENTER_CRITICAL();
+        bt_bond_index.last = slot;
+        taskEXIT_CRITICAL();
+
+        bt_bond_mark(BT_BOND_DIRTY_INDEX);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_mark
+********************************************************************************
+* Summary:
+*  Marks items changed in RAM and wakes bt_task to write them to flash.
+*
+*******************************************************************************/
+static void bt_bond_mark(uint32_t items)
+{
+    taskENTER_CRITICAL();
+    bt_bond_dirty |= items;
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyGive(bt_task_handle);
+}
+
+/*******************************************************************************
+* Function Name: bt_bond_write
+********************************************************************************
+* Summary:
+*  Writes a copy of an item to flash. Returns false if it was not stored.
+*
+*******************************************************************************/
+static bool bt_bond_write(uint16_t item, uint32_t len, uint8_t *p_data)
+{
+    wiced_result_t result;
+
+    if (len != flash_memory_write(item, len, p_data, &result))
+    {
+        APP_TRACE_WARN("Bond item 0x%x not stored\r\n", item);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+* File Name: bt_bond.h
+*
+* Description: This file is the public interface of bt_bond.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_BOND_H_
+#define BT_BOND_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "wiced_bt_types.h"
+#include "wiced_bt_dev.h"
+#include "bt_conn.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Bonded centrals remembered; the least recently bonded one is replaced */
+#define BT_BOND_MAX_PEERS               (4u)
+
+/* Flash items of the bonding information */
+#define BT_BOND_ITEM_LOCAL_KEYS         (0x0100u)   /* wiced_bt_local_identity_keys_t */
+#define BT_BOND_ITEM_INDEX              (0x0101u)   /* Replacement and last peer slots */
+#define BT_BOND_ITEM_PEER               (0x0110u)   /* One item per peer slot from here */
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void bt_bond_init(void);
+bool bt_bond_is_bonded(const wiced_bt_device_address_t bd_addr);
+void bt_bond_save_keys(const wiced_bt_device_link_keys_t *p_keys);
+bool bt_bond_load_keys(wiced_bt_device_link_keys_t *p_keys);
+void bt_bond_save_local_keys(const wiced_bt_local_identity_keys_t *p_keys);
+bool bt_bond_load_local_keys(wiced_bt_local_identity_keys_t *p_keys);
+bool bt_bond_restore_cccd(bt_conn_t *p_conn);
+void bt_bond_save_cccd(const bt_conn_t *p_conn);
+void bt_bond_flush(void);
+bool bt_bond_last_peer(wiced_bt_device_address_t bd_addr, wiced_bt_ble_address_type_t *p_addr_type);
+
+#endif /* BT_BOND_H_ */
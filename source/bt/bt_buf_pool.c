@@ -0,0 +1,290 @@
+/*******************************************************************************
+* File Name: bt_buf_pool.c
+*
+* Description: This file contains the fixed-block pool that provides the
+* GATT response buffers. Blocks come in two size classes; each class keeps
+* its free blocks on a lock-free stack, so allocation and release take a
+* bounded time from any task or interrupt. An allocation that does not fit
+* or finds its class exhausted is served by the FreeRTOS heap instead, which
+* is only done in task context; in an interrupt such an allocation fails.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "bt_buf_pool.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Free list head: modification tag in the upper half, index of the first
+ * free block in the lower half. The tag changes on every update, so a head
+ * read before a concurrent pop and push of the same block cannot be
+ * mistaken for the current one. */
+#define BT_BUF_POOL_NIL                 (0xFFFFu)
+#define BT_BUF_POOL_IDX_MSK             (0x0000FFFFUL)
+#define BT_BUF_POOL_TAG_INC             (0x00010000UL)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+typedef struct
+{
+    uint16_t            block_size;
+    uint16_t            block_count;
+    uint8_t             *storage;
+    uint16_t            *next;
+    uint32_t            head;
+    bt_buf_pool_stats_t stats;
+} bt_buf_pool_class_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static uint32_t bt_buf_pool_small_mem[(BT_BUF_POOL_SMALL_SIZE * BT_BUF_POOL_SMALL_COUNT) / 4u];
+static uint32_t bt_buf_pool_large_mem[(BT_BUF_POOL_LARGE_SIZE * BT_BUF_POOL_LARGE_COUNT) / 4u];
+static uint16_t bt_buf_pool_small_next[BT_BUF_POOL_SMALL_COUNT];
+static uint16_t bt_buf_pool_large_next[BT_BUF_POOL_LARGE_COUNT];
+
+/* Ordered by block size */
+static bt_buf_pool_class_t bt_buf_pool_classes[BT_BUF_POOL_CLASS_COUNT] =
+{
+    [BT_BUF_POOL_CLASS_SMALL] =
+    {
+        .block_size = BT_BUF_POOL_SMALL_SIZE,
+        .block_count = BT_BUF_POOL_SMALL_COUNT,
+        .storage = (uint8_t *)bt_buf_pool_small_mem,
+        .next = bt_buf_pool_small_next,
+        .head = BT_BUF_POOL_NIL
+    },
+    [BT_BUF_POOL_CLASS_LARGE] =
+    {
+        .block_size = BT_BUF_POOL_LARGE_SIZE,
+        .block_count = BT_BUF_POOL_LARGE_COUNT,
+        .storage = (uint8_t *)bt_buf_pool_large_mem,
+        .next = bt_buf_pool_large_next,
+        .head = BT_BUF_POOL_NIL
+    }
+};
+
+/*******************************************************************************
+* Function Name: bt_buf_pool_pop
+********************************************************************************
+* Summary:
+*  Takes a block from the free list of a class.
+*
+* Parameters:
+*  bt_buf_pool_class_t *p_class : Size class
+*
+* Return:
+*  uint16_t : Index of the block, or BT_BUF_POOL_NIL if the class is exhausted
+*
+*******************************************************************************/
+static uint16_t bt_buf_pool_pop(bt_buf_pool_class_t *p_class)
+{
+    uint32_t head = __atomic_load_n(&p_class->head, __ATOMIC_ACQUIRE);
+    uint32_t new_head;
+    uint16_t idx;
+
+    do
+    {
+        idx = (uint16_t)(head & BT_BUF_POOL_IDX_MSK);
+        if (BT_BUF_POOL_NIL == idx)
+        {
+            return BT_BUF_POOL_NIL;
+        }
+        new_head = ((head + BT_BUF_POOL_TAG_INC) & ~BT_BUF_POOL_IDX_MSK) | p_class->next[idx];
+    } while (!__atomic_compare_exchange_n(&p_class->head, &head, new_head, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    return idx;
+}
+
+/*******************************************************************************
+* Function Name: bt_buf_pool_push
+********************************************************************************
+* Summary:
+*  Returns a block to the free list of a class.
+*
+* Parameters:
+*  bt_buf_pool_class_t *p_class : Size class
+*  uint16_t idx                 : Index of the block
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_buf_pool_push(bt_buf_pool_class_t *p_class, uint16_t idx)
+{
+    uint32_t head = __atomic_load_n(&p_class->head, __ATOMIC_RELAXED);
+    uint32_t new_head;
+
+    do
+    {
+        p_class->next[idx] = (uint16_t)(head & BT_BUF_POOL_IDX_MSK);
+        new_head = ((head + BT_BUF_POOL_TAG_INC) & ~BT_BUF_POOL_IDX_MSK) | idx;
+    } while (!__atomic_compare_exchange_n(&p_class->head, &head, new_head, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*******************************************************************************
+* Function Name: bt_buf_pool_init
+********************************************************************************
+* Summary:
+*  Puts all blocks on the free lists and clears the counters. Must be called
+*  before the first allocation.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_buf_pool_init(void)
+{
+    for (uint8_t c = 0u; c < BT_BUF_POOL_CLASS_COUNT; c++)
+    {
+        bt_buf_pool_class_t *p_class = &bt_buf_pool_classes[c];
+
+        for (uint16_t i = 0u; i < p_class->block_count; i++)
+        {
+            p_class->next[i] = ((i + 1u) < p_class->block_count) ? (uint16_t)(i + 1u) : BT_BUF_POOL_NIL;
+        }
+        p_class->head = 0u;
+        p_class->stats = (bt_buf_pool_stats_t){ 0 };
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_buf_pool_alloc
+********************************************************************************
+* Summary:
+*  Allocates a buffer from the smallest class that fits, falling back to the
+*  heap if that class is exhausted or no class is large enough. The heap is
+*  not used in an interrupt, where such an allocation returns NULL.
+*
+* Parameters:
+*  uint16_t len : Number of bytes required
+*
+* Return:
+*  void* : Buffer, or NULL if neither the pool nor the heap can serve it
+*
+*******************************************************************************/
+void* bt_buf_pool_alloc(uint16_t len)
+{
+    bt_buf_pool_class_t *p_class = NULL;
+    void *p_buf;
+
+    for (uint8_t c = 0u; c < BT_BUF_POOL_CLASS_COUNT; c++)
+    {
+        if (len <= bt_buf_pool_classes[c].block_size)
+        {
+            p_class = &bt_buf_pool_classes[c];
+            break;
+        }
+    }
+
+    if (NULL != p_class)
+    {
+        uint16_t idx = bt_buf_pool_pop(p_class);
+
+        if (BT_BUF_POOL_NIL != idx)
+        {
+            uint16_t in_use = (uint16_t)(__atomic_add_fetch(&p_class->stats.in_use, 1u, __ATOMIC_RELAXED));
+            uint16_t high_water = __atomic_load_n(&p_class->stats.high_water, __ATOMIC_RELAXED);
+
+            while ((in_use > high_water) &&
+                   !__atomic_compare_exchange_n(&p_class->stats.high_water, &high_water, in_use, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+            }
+            (void)__atomic_add_fetch(&p_class->stats.allocs, 1u, __ATOMIC_RELAXED);
+
+            return &p_class->storage[(size_t)idx * p_class->block_size];
+        }
+
+        (void)__atomic_add_fetch(&p_class->stats.exhausted, 1u, __ATOMIC_RELAXED);
+    }
+
+    /* The heap takes the scheduler lock, which an interrupt must not wait for */
+    p_buf = xPortIsInsideInterrupt() ? NULL : pvPortMalloc(len);
+
+    if ((NULL == p_buf) && (NULL != p_class))
+    {
+        (void)__atomic_add_fetch(&p_class->stats.failures, 1u, __ATOMIC_RELAXED);
+    }
+
+    return p_buf;
+}
+
+/*******************************************************************************
+* Function Name: bt_buf_pool_free
+********************************************************************************
+* Summary:
+*  Releases a buffer obtained from bt_buf_pool_alloc, to its class or to the
+*  heap depending on where it came from. Pool blocks can be released from any
+*  task or interrupt, buffers served by the heap only from a task.
+*
+* Parameters:
+*  void *p_buf : Buffer; NULL is ignored
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_buf_pool_free(void *p_buf)
+{
+    uint8_t *p = (uint8_t *)p_buf;
+
+    if (NULL == p)
+    {
+        return;
+    }
+
+    for (uint8_t c = 0u; c < BT_BUF_POOL_CLASS_COUNT; c++)
+    {
+        bt_buf_pool_class_t *p_class = &bt_buf_pool_classes[c];
+        size_t size = (size_t)p_class->block_count * p_class->block_size;
+
+        if ((p >= p_class->storage) && (p < (p_class->storage + size)))
+        {
+            /* Uncount the block before it can be taken again, so in_use never exceeds the class */
+            (void)__atomic_sub_fetch(&p_class->stats.in_use, 1u, __ATOMIC_RELAXED);
+            bt_buf_pool_push(p_class, (uint16_t)((size_t)(p - p_class->storage) / p_class->block_size));
+            return;
+        }
+    }
+
+    configASSERT(!xPortIsInsideInterrupt());
+    vPortFree(p_buf);
+}
+
+/*******************************************************************************
+* Function Name: bt_buf_pool_get_stats
+********************************************************************************
+* Summary:
+*  Copies the usage counters of a size class.
+*
+* Parameters:
+*  uint8_t size_class            : BT_BUF_POOL_CLASS_SMALL or _LARGE
+*  bt_buf_pool_stats_t *p_stats  : Receives the counters
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_buf_pool_get_stats(uint8_t size_class, bt_buf_pool_stats_t *p_stats)
+{
+    if ((size_class < BT_BUF_POOL_CLASS_COUNT) && (NULL != p_stats))
+    {
+        *p_stats = bt_buf_pool_classes[size_class].stats;
+    }
+}
@@ -0,0 +1,61 @@
+/*******************************************************************************
+* File Name: bt_buf_pool.h
+*
+* Description: This file is the public interface of bt_buf_pool.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_BUF_POOL_H_
+#define BT_BUF_POOL_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "cycfg_bt_settings.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Small blocks hold short reads, notifications and error responses */
+#define BT_BUF_POOL_SMALL_SIZE          (32u)
+#define BT_BUF_POOL_SMALL_COUNT         (8u)
+
+/* Large blocks hold a full ATT PDU */
+#define BT_BUF_POOL_LARGE_SIZE          (((CY_BT_MTU_SIZE) + 3u) & ~3u)
+#define BT_BUF_POOL_LARGE_COUNT         (4u)
+
+#define BT_BUF_POOL_CLASS_SMALL         (0u)
+#define BT_BUF_POOL_CLASS_LARGE         (1u)
+#define BT_BUF_POOL_CLASS_COUNT         (2u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Usage counters of a size class */
+typedef struct
+{
+    uint16_t in_use;        /* Blocks currently allocated */
+    uint16_t high_water;    /* Largest number of blocks allocated at once */
+    uint32_t allocs;        /* Allocations served by the class */
+    uint32_t exhausted;     /* Allocations of this class served by the heap */
+    uint32_t failures;      /* Allocations that the heap could not serve either */
+} bt_buf_pool_stats_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void  bt_buf_pool_init(void);
+void* bt_buf_pool_alloc(uint16_t len);
+void  bt_buf_pool_free(void *p_buf);
+void  bt_buf_pool_get_stats(uint8_t size_class, bt_buf_pool_stats_t *p_stats);
+
+#endif /* BT_BUF_POOL_H_ */
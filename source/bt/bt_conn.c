@@ -0,0 +1,494 @@
+/*******************************************************************************
+* File Name: bt_conn.c
+*
+* Description: This file contains the connection table of the GATT server.
+* Every connected central has its own client characteristic configurations
+* and ATT MTU, so centrals subscribe independently of each other, and a
+* notification is sent to each subscriber from a single encoded value.
+* Subscribers of the CO2 characteristic may ask for batched samples instead
+* of one notification per sample.
+*
+* The table is written from the stack context, the link timer and the BT
+* task. Slots are taken and released, and shared fields updated, in short
+* critical sections; notifications are sent to a snapshot of the subscribers
+* taken in one, so the stack is never called with the scheduler locked.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "app_trace.h"
+#include "bt_conn.h"
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Connection a notification goes to, copied from the table */
+typedef struct
+{
+    uint16_t conn_id;
+    uint16_t max_len;           /* Longest value the MTU allows */
+} bt_conn_target_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static bt_conn_t bt_conn_table[BT_CONN_MAX];
+static uint8_t bt_conn_limit = BT_CONN_MAX;
+static uint8_t bt_conn_used = 0u;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+static void bt_conn_notified_id(uint16_t conn_id);
+
+/*******************************************************************************
+* Function Name: bt_conn_init
+********************************************************************************
+* Summary:
+*  Clears the connection table and sets the number of simultaneous
+*  connections accepted.
+*
+* Parameters:
+*  uint8_t limit : Connection limit; capped at BT_CONN_MAX
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_conn_init(uint8_t limit)
+{
+    taskENTER_CRITICAL();
+    memset(bt_conn_table, 0, sizeof(bt_conn_table));
+    bt_conn_used = 0u;
+    bt_conn_limit = ((0u != limit) && (limit < BT_CONN_MAX)) ? limit : BT_CONN_MAX;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_add
+********************************************************************************
+* Summary:
+*  Takes a slot for a new connection, with notifications off and the default
+*  MTU.
+*
+* Parameters:
+*  uint16_t conn_id                          : Connection ID
+*  const wiced_bt_device_address_t bd_addr   : Address of the central
+*
+* Return:
+*  bt_conn_t* : Connection state, or NULL if the limit is reached
+*
+*******************************************************************************/
+bt_conn_t* bt_conn_add(uint16_t conn_id, const wiced_bt_device_address_t bd_addr)
+{
+    uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    for (uint8_t i = 0u; (NULL == p_conn) && (bt_conn_used < bt_conn_limit) && (i < BT_CONN_MAX); i++)
+    {
+        if (0u == bt_conn_table[i].conn_id)
+        {
+            p_conn = &bt_conn_table[i];
+            memset(p_conn, 0, sizeof(*p_conn));
+            p_conn->mtu = BT_CONN_DEFAULT_MTU;
+            memcpy(p_conn->bd_addr, bd_addr, sizeof(wiced_bt_device_address_t));
+            p_conn->connected_ms = now_ms;
+            /* Set last: a slot with an ID is complete for other contexts */
+            p_conn->conn_id = conn_id;
+            bt_conn_used++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return p_conn;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_remove
+********************************************************************************
+* Summary:
+*  Releases the slot of a closed connection.
+*
+* Parameters:
+*  uint16_t conn_id : Connection ID
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_conn_remove(uint16_t conn_id)
+{
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    if (NULL != p_conn)
+    {
+        p_conn->conn_id = 0u;
+        bt_conn_used--;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_find
+********************************************************************************
+* Summary:
+*  Looks up the state of a connection.
+*
+* Parameters:
+*  uint16_t conn_id : Connection ID
+*
+* Return:
+*  bt_conn_t* : Connection state, or NULL if the connection is unknown
+*
+*******************************************************************************/
+bt_conn_t* bt_conn_find(uint16_t conn_id)
+{
+    if (0u == conn_id)
+    {
+        return NULL;
+    }
+
+    for (uint8_t i = 0u; i < BT_CONN_MAX; i++)
+    {
+        if (conn_id == bt_conn_table[i].conn_id)
+        {
+            return &bt_conn_table[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_find_by_addr
+********************************************************************************
+* Summary:
+*  Looks up the state of a connection by the address of its central, for
+*  stack events that do not carry the connection ID.
+*
+* Parameters:
+*  const wiced_bt_device_address_t bd_addr : Address of the central
+*
+* Return:
+*  bt_conn_t* : Connection state, or NULL if no connection has that address
+*
+*******************************************************************************/
+bt_conn_t* bt_conn_find_by_addr(const wiced_bt_device_address_t bd_addr)
+{
+    for (uint8_t i = 0u; i < BT_CONN_MAX; i++)
+    {
+        if ((0u != bt_conn_table[i].conn_id) &&
+            (0 == memcmp(bt_conn_table[i].bd_addr, bd_addr, sizeof(wiced_bt_device_address_t))))
+        {
+            return &bt_conn_table[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_at
+********************************************************************************
+* Summary:
+*  Returns the connection in a slot of the table, for walking all
+*  connections.
+*
+* Parameters:
+*  uint8_t index : Slot; below BT_CONN_MAX
+*
+* Return:
+*  bt_conn_t* : Connection state, or NULL if the slot is free
+*
+*******************************************************************************/
+bt_conn_t* bt_conn_at(uint8_t index)
+{
+    if ((index >= BT_CONN_MAX) || (0u == bt_conn_table[index].conn_id))
+    {
+        return NULL;
+    }
+    return &bt_conn_table[index];
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_count
+********************************************************************************
+* Summary:
+*  Returns the number of open connections.
+*
+*******************************************************************************/
+uint8_t bt_conn_count(void)
+{
+    return bt_conn_used;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_is_full
+********************************************************************************
+* Summary:
+*  Returns true if no further connection is accepted.
+*
+*******************************************************************************/
+bool bt_conn_is_full(void)
+{
+    return (bt_conn_used >= bt_conn_limit);
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_subscribers
+********************************************************************************
+* Summary:
+*  Counts the connections with notifications enabled for a characteristic.
+*
+* Parameters:
+*  uint8_t cccd : BT_CONN_CCCD_CO2 or BT_CONN_CCCD_TEMPERATURE
+*
+* Return:
+*  uint8_t : Number of subscribed connections
+*
+*******************************************************************************/
+uint8_t bt_conn_subscribers(uint8_t cccd)
+{
+    uint8_t count = 0u;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0u; (cccd < BT_CONN_CCCD_COUNT) && (i < BT_CONN_MAX); i++)
+    {
+        if ((0u != bt_conn_table[i].conn_id) &&
+            (0u != (bt_conn_table[i].cccd[cccd][0] & GATT_CLIENT_CONFIG_NOTIFICATION)))
+        {
+            count++;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_notify
+********************************************************************************
+* Summary:
+*  Sends a characteristic value to every connection subscribed to it. The
+*  value is not copied, so it must stay unchanged until the stack has sent
+*  it; each notification is cut to the MTU of its connection. Connections in
+*  batch mode do not receive single CO2 values.
+*
+* Parameters:
+*  uint8_t cccd          : Configuration controlling the notification
+*  uint16_t attr_handle  : Handle of the characteristic value
+*  uint8_t *p_val        : Encoded value
+*  uint16_t len          : Length of the value
+*
+* Return:
+*  uint8_t : Number of notifications handed to the stack
+*
+*******************************************************************************/
+uint8_t bt_conn_notify(uint8_t cccd, uint16_t attr_handle, uint8_t *p_val, uint16_t len)
+{
+    bt_conn_target_t targets[BT_CONN_MAX];
+    uint8_t count = 0u;
+    uint8_t sent = 0u;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0u; (cccd < BT_CONN_CCCD_COUNT) && (i < BT_CONN_MAX); i++)
+    {
+        const bt_conn_t *p_conn = &bt_conn_table[i];
+
+        if ((0u != p_conn->conn_id) &&
+            (0u != (p_conn->cccd[cccd][0] & GATT_CLIENT_CONFIG_NOTIFICATION)) &&
+            ((BT_CONN_CCCD_CO2 != cccd) || (0u == p_conn->batch)))
+        {
+            targets[count].conn_id = p_conn->conn_id;
+            targets[count].max_len = (uint16_t)(p_conn->mtu - 3u);
+            count++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0u; i < count; i++)
+    {
+        uint16_t max_len = targets[i].max_len;
+
+        if (WICED_BT_GATT_SUCCESS == wiced_bt_gatt_server_send_notification(targets[i].conn_id, attr_handle,
+                                                                             (len < max_len) ? len : max_len,
+                                                                             p_val, NULL))
+        {
+            bt_conn_notified_id(targets[i].conn_id);
+            sent++;
+        }
+        else
+        {
+            APP_TRACE_WARN("Notification to connection 0x%x failed\r\n", targets[i].conn_id);
+        }
+    }
+    return sent;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_batch_capacity
+********************************************************************************
+* Summary:
+*  Returns the number of samples a batch may hold so that every CO2
+*  subscriber in batch mode gets it whole: no more than any of them asked
+*  for, and no more than fits in the smallest of their MTUs.
+*
+* Parameters:
+*  uint8_t hdr_len : Length of the batch header
+*  uint8_t rec_len : Length of a sample record
+*
+* Return:
+*  uint8_t : Samples per batch, or 0 if no connection is in batch mode
+*
+*******************************************************************************/
+uint8_t bt_conn_batch_capacity(uint8_t hdr_len, uint8_t rec_len)
+{
+    uint8_t capacity = 0u;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0u; i < BT_CONN_MAX; i++)
+    {
+        const bt_conn_t *p_conn = &bt_conn_table[i];
+        uint16_t fit;
+
+        if ((0u == p_conn->conn_id) || (0u == p_conn->batch) ||
+            (0u == (p_conn->cccd[BT_CONN_CCCD_CO2][0] & GATT_CLIENT_CONFIG_NOTIFICATION)))
+        {
+            continue;
+        }
+
+        fit = (uint16_t)((p_conn->mtu - 3u - hdr_len) / rec_len);
+        if (0u == fit)
+        {
+            fit = 1u;
+        }
+        if (fit > p_conn->batch)
+        {
+            fit = p_conn->batch;
+        }
+        if ((0u == capacity) || (fit < capacity))
+        {
+            capacity = (uint8_t)fit;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return capacity;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_notify_batch
+********************************************************************************
+* Summary:
+*  Sends a batch of CO2 samples to every CO2 subscriber in batch mode. As
+*  with bt_conn_notify, the batch must stay unchanged until it is sent.
+*
+* Parameters:
+*  uint16_t attr_handle  : Handle of the CO2 characteristic value
+*  uint8_t *p_val        : Encoded batch
+*  uint16_t len          : Length of the batch
+*
+* Return:
+*  uint8_t : Number of notifications handed to the stack
+*
+*******************************************************************************/
+uint8_t bt_conn_notify_batch(uint16_t attr_handle, uint8_t *p_val, uint16_t len)
+{
+    uint16_t targets[BT_CONN_MAX];
+    uint8_t count = 0u;
+    uint8_t sent = 0u;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0u; i < BT_CONN_MAX; i++)
+    {
+        const bt_conn_t *p_conn = &bt_conn_table[i];
+
+        if ((0u != p_conn->conn_id) && (0u != p_conn->batch) &&
+            (0u != (p_conn->cccd[BT_CONN_CCCD_CO2][0] & GATT_CLIENT_CONFIG_NOTIFICATION)))
+        {
+            targets[count++] = p_conn->conn_id;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0u; i < count; i++)
+    {
+        if (WICED_BT_GATT_SUCCESS == wiced_bt_gatt_server_send_notification(targets[i], attr_handle,
+                                                                             len, p_val, NULL))
+        {
+            bt_conn_notified_id(targets[i]);
+            sent++;
+        }
+        else
+        {
+            APP_TRACE_WARN("Batch to connection 0x%x failed\r\n", targets[i]);
+        }
+    }
+    return sent;
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_notified
+********************************************************************************
+* Summary:
+*  Records a notification handed to the stack for a connection. The time
+*  from opening the connection to its first notification tells how quickly
+*  a central gets data after (re)connecting.
+*
+* Parameters:
+*  bt_conn_t *p_conn : Connection notified
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_conn_notified(bt_conn_t *p_conn)
+{
+    uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+
+    taskENTER_CRITICAL();
+    if (0u == p_conn->first_notify_ms)
+    {
+        uint32_t elapsed_ms = now_ms - p_conn->connected_ms;
+
+        /* 0 means no notification yet */
+        p_conn->first_notify_ms = (0u != elapsed_ms) ? elapsed_ms : 1u;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_conn_notified_id
+********************************************************************************
+* Summary:
+*  Records a notification sent from a snapshot, unless the connection closed
+*  meanwhile.
+*
+* Parameters:
+*  uint16_t conn_id : Connection notified
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_conn_notified_id(uint16_t conn_id)
+{
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    if (NULL != p_conn)
+    {
+        bt_conn_notified(p_conn);
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* File Name: bt_conn.h
+*
+* Description: This file is the public interface of bt_conn.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_CONN_H_
+#define BT_CONN_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "wiced_bt_types.h"
+#include "wiced_bt_gatt.h"
+#include "bt_link.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Connection table size; the limit used at runtime is also bounded by the
+ * number of server links of the stack configuration */
+#define BT_CONN_MAX                     (4u)
+
+/* Client characteristic configurations kept per connection */
+#define BT_CONN_CCCD_CO2                (0u)
+#define BT_CONN_CCCD_TEMPERATURE        (1u)
+#define BT_CONN_CCCD_COUNT              (2u)
+#define BT_CONN_CCCD_NONE               (0xFFu)
+
+/* ATT MTU before an exchange */
+#define BT_CONN_DEFAULT_MTU             (23u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* State of a connected central. Slots are taken and released in the stack
+ * context; other contexts access them in critical sections, so a field
+ * written there with a single store needs none, but an update spanning
+ * several fields does */
+typedef struct
+{
+    uint16_t                  conn_id;                        /* 0 if the slot is free */
+    uint16_t                  mtu;                            /* Negotiated ATT MTU */
+    wiced_bt_device_address_t bd_addr;
+    wiced_bt_ble_address_type_t addr_type;                    /* Type of bd_addr */
+    uint8_t                   cccd[BT_CONN_CCCD_COUNT][2];    /* Little-endian descriptor values */
+    uint8_t                   batch;                          /* Samples per batched CO2 notification;
+                                                                 0 for single values */
+    bt_link_t                 link;                           /* Link policy and negotiated parameters */
+    uint32_t                  connected_ms;                   /* Time the connection opened */
+    uint32_t                  first_notify_ms;                /* Time from opening to the first
+                                                                 notification; 0 until then */
+    bool                      encrypted;                      /* Link encrypted since it opened */
+} bt_conn_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void       bt_conn_init(uint8_t limit);
+bt_conn_t* bt_conn_add(uint16_t conn_id, const wiced_bt_device_address_t bd_addr);
+void       bt_conn_remove(uint16_t conn_id);
+bt_conn_t* bt_conn_find(uint16_t conn_id);
+bt_conn_t* bt_conn_find_by_addr(const wiced_bt_device_address_t bd_addr);
+bt_conn_t* bt_conn_at(uint8_t index);
+uint8_t    bt_conn_count(void);
+bool       bt_conn_is_full(void);
+uint8_t    bt_conn_subscribers(uint8_t cccd);
+uint8_t    bt_conn_notify(uint8_t cccd, uint16_t attr_handle, uint8_t *p_val, uint16_t len);
+uint8_t    bt_conn_batch_capacity(uint8_t hdr_len, uint8_t rec_len);
+uint8_t    bt_conn_notify_batch(uint16_t attr_handle, uint8_t *p_val, uint16_t len);
+void       bt_conn_notified(bt_conn_t *p_conn);
+
+#endif /* BT_CONN_H_ */
@@ -0,0 +1,520 @@
+/*******************************************************************************
+* File Name: bt_link.c
+*
+* Description: This file contains the link policy of the GATT server. A
+* connection is in bulk mode while a central discovers the server, configures
+* it or moves data in quick succession, with a short connection interval, the
+* 2M PHY and the longest data length; once the traffic stops for
+* BT_LINK_BULK_HOLD_MS it returns to idle mode, whose long interval and
+* peripheral latency let the radio sleep between notifications. The
+* parameters the stack negotiates are kept per connection.
+*
+* The link state is updated from the stack context and the timer task, so it
+* is only touched in critical sections of the connection table; requests to
+* the stack are made outside them.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "cybsp.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "wiced_bt_ble.h"
+#include "wiced_bt_l2c.h"
+#include "app_trace.h"
+#include "bt_conn.h"
+#include "bt_link.h"
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Connection parameters requested in a mode */
+typedef struct
+{
+    uint16_t min_interval;      /* 1.25 ms units */
+    uint16_t max_interval;
+    uint16_t latency;           /* Connection events */
+    uint16_t timeout;           /* 10 ms units */
+} bt_link_params_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Both sets stay within the limits iOS and macOS centrals accept: a
+ * minimum interval of at least 15 ms, a maximum interval at least 15 ms
+ * above it, a maximum interval times (latency + 1) of at most 2 s, and a
+ * supervision timeout of at most 6 s that exceeds three times that
+ * product. Idle: 480 ms x 4 x 3 = 5.76 s < 6 s */
+static const bt_link_params_t bt_link_params[BT_LINK_MODE_COUNT] =
+{
+    [BT_LINK_MODE_IDLE] = { 320u, 384u, 3u, 600u },     /* 400..480 ms */
+    [BT_LINK_MODE_BULK] = { 12u, 24u, 0u, 200u },       /* 15..30 ms */
+};
+
+static TimerHandle_t bt_link_timer = NULL;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+static uint32_t bt_link_now_ms(void);
+static bool     bt_link_request(uint16_t conn_id, uint8_t mode, uint32_t hold_ms);
+static void     bt_link_hold_expired(TimerHandle_t timer);
+
+/*******************************************************************************
+* Function Name: bt_link_init
+********************************************************************************
+* Summary:
+*  Creates the timer returning links to idle mode.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_link_init(void)
+{
+    if (NULL == bt_link_timer)
+    {
+        bt_link_timer = xTimerCreate("BT link", pdMS_TO_TICKS(BT_LINK_BULK_HOLD_MS),
+                                     pdFALSE, NULL, bt_link_hold_expired);
+        CY_ASSERT(NULL != bt_link_timer);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_link_open
+********************************************************************************
+* Summary:
+*  Starts the link policy of a new connection in bulk mode, as the central
+*  exchanges the MTU, discovers the services and subscribes first.
+*
+* Parameters:
+*  uint16_t conn_id : Connection ID; must be in the connection table
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_link_open(uint16_t conn_id)
+{
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    if (NULL != p_conn)
+    {
+        p_conn->link.mode = BT_LINK_MODE_IDLE;
+    }
+    taskEXIT_CRITICAL();
+
+    if (NULL != p_conn)
+    {
+        bt_link_activity(conn_id);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_link_activity
+********************************************************************************
+* Summary:
+*  Reports bulk traffic on a connection: switches it to bulk mode if it is
+*  idle, and holds it there for another BT_LINK_BULK_HOLD_MS.
+*
+* Parameters:
+*  uint16_t conn_id : Connection ID
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_link_activity(uint16_t conn_id)
+{
+    bool idle = false;
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    if (NULL != p_conn)
+    {
+        p_conn->link.activity_ms = bt_link_now_ms();
+        idle = (BT_LINK_MODE_BULK != p_conn->link.mode);
+    }
+    taskEXIT_CRITICAL();
+
+    if (NULL == p_conn)
+    {
+        return;
+    }
+
+    if (idle)
+    {
+        (void)bt_link_request(conn_id, BT_LINK_MODE_BULK, 0u);
+    }
+    if (NULL != bt_link_timer)
+    {
+        (void)xTimerChangePeriod(bt_link_timer, pdMS_TO_TICKS(BT_LINK_BULK_HOLD_MS), 0u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_link_set_mode
+********************************************************************************
+* Summary:
+*  Switches a connection to a mode on request of the central. Bulk mode
+*  lasts until the traffic stops, as with bt_link_activity.
+*
+* Parameters:
+*  uint16_t conn_id : Connection ID
+*  uint8_t mode     : BT_LINK_MODE_*
+*
+* Return:
+*  bool : false if the connection or the mode is unknown
+*
+*******************************************************************************/
+bool bt_link_set_mode(uint16_t conn_id, uint8_t mode)
+{
+    uint8_t current = BT_LINK_MODE_IDLE;
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    if (NULL != p_conn)
+    {
+        current = p_conn->link.mode;
+    }
+    taskEXIT_CRITICAL();
+
+    if ((NULL == p_conn) || (mode >= BT_LINK_MODE_COUNT))
+    {
+        return false;
+    }
+
+    if (BT_LINK_MODE_BULK == mode)
+    {
+        bt_link_activity(conn_id);
+    }
+    else if (BT_LINK_MODE_IDLE != current)
+    {
+        (void)bt_link_request(conn_id, BT_LINK_MODE_IDLE, 0u);
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_link_param_update
+********************************************************************************
+* Summary:
+*  Records the connection parameters negotiated for a connection.
+*
+* Parameters:
+*  const wiced_bt_ble_connection_param_update_t *p_update : Stack event data
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_link_param_update(const wiced_bt_ble_connection_param_update_t *p_update)
+{
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find_by_addr(p_update->bd_addr);
+    if ((NULL != p_conn) && (WICED_BT_SUCCESS == p_update->status))
+    {
+        p_conn->link.interval = p_update->conn_interval;
+        p_conn->link.latency = p_update->conn_latency;
+        p_conn->link.timeout = p_update->supervision_timeout;
+        p_conn->link.param_updates++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_link_phy_update
+********************************************************************************
+* Summary:
+*  Records the PHY negotiated for a connection.
+*
+* Parameters:
+*  const wiced_bt_ble_phy_update_t *p_update : Stack event data
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_link_phy_update(const wiced_bt_ble_phy_update_t *p_update)
+{
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find_by_addr(p_update->bd_address);
+    if ((NULL != p_conn) && (WICED_BT_SUCCESS == p_update->status))
+    {
+        p_conn->link.tx_phy = (uint8_t)p_update->tx_phy;
+        p_conn->link.rx_phy = (uint8_t)p_update->rx_phy;
+        p_conn->link.phy_updates++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_link_data_length_update
+********************************************************************************
+* Summary:
+*  Records the data length negotiated for a connection.
+*
+* Parameters:
+*  const wiced_bt_ble_data_length_update_t *p_update : Stack event data
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_link_data_length_update(const wiced_bt_ble_data_length_update_t *p_update)
+{
+    bt_conn_t *p_conn;
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find_by_addr(p_update->bd_addr);
+    if (NULL != p_conn)
+    {
+        p_conn->link.tx_octets = p_update->max_tx_octets;
+        p_conn->link.rx_octets = p_update->max_rx_octets;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: bt_link_get
+********************************************************************************
+* Summary:
+*  Copies the link policy and negotiated parameters of a connection. The
+*  time of an ongoing bulk period is included in bulk_ms.
+*
+* Parameters:
+*  uint16_t conn_id     : Connection ID
+*  bt_link_t *p_link    : Receives the link state
+*
+* Return:
+*  bool : false if the connection is unknown
+*
+*******************************************************************************/
+bool bt_link_get(uint16_t conn_id, bt_link_t *p_link)
+{
+    bt_conn_t *p_conn;
+
+    if (NULL == p_link)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    if (NULL != p_conn)
+    {
+        *p_link = p_conn->link;
+    }
+    taskEXIT_CRITICAL();
+
+    if (NULL == p_conn)
+    {
+        return false;
+    }
+
+    if (BT_LINK_MODE_BULK == p_link->mode)
+    {
+        p_link->bulk_ms += bt_link_now_ms() - p_link->bulk_since_ms;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_link_now_ms
+********************************************************************************
+* Summary:
+*  Returns the time since the scheduler started in milliseconds.
+*
+*******************************************************************************/
+static uint32_t bt_link_now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/*******************************************************************************
+* Function Name: bt_link_request
+********************************************************************************
+* Summary:
+*  Asks the central for the connection parameters of a mode, unless the
+*  connection is already in it or had traffic within hold_ms. Entering bulk
+*  mode also asks for the 2M PHY and the longest data length, unless they
+*  are already in use; both are kept when the link returns to idle, since
+*  shorter packets save more than a PHY change would.
+*
+* Parameters:
+*  uint16_t conn_id : Connection ID
+*  uint8_t mode     : BT_LINK_MODE_*
+*  uint32_t hold_ms : Time the traffic must have stopped for; 0 for none
+*
+* Return:
+*  bool : true if the mode was switched
+*
+*******************************************************************************/
+static bool bt_link_request(uint16_t conn_id, uint8_t mode, uint32_t hold_ms)
+{
+    const bt_link_params_t *p_params = &bt_link_params[mode];
+    wiced_bt_device_address_t bd_addr;
+    bool switched = false;
+    bool set_phy = false;
+    bool set_length = false;
+    uint16_t rejected = 0u;
+    bt_conn_t *p_conn;
+
+    /* Decided here, so that a request raced by another context is made once
+     * and traffic reported meanwhile keeps the link in bulk mode */
+    taskENTER_CRITICAL();
+    p_conn = bt_conn_find(conn_id);
+    if ((NULL != p_conn) && (mode != p_conn->link.mode) &&
+        ((bt_link_now_ms() - p_conn->link.activity_ms) >= hold_ms))
+    {
+        bt_link_t *p_link = &p_conn->link;
+        uint32_t now_ms = bt_link_now_ms();
+
+        if (BT_LINK_MODE_BULK == mode)
+        {
+            p_link->bulk_since_ms = now_ms;
+            set_phy = (0u == (p_link->tx_phy & BTM_BLE_PREFER_2M_PHY));
+            set_length = (p_link->tx_octets < BT_LINK_MAX_TX_OCTETS);
+        }
+        else if (BT_LINK_MODE_BULK == p_link->mode)
+        {
+            p_link->bulk_ms += now_ms - p_link->bulk_since_ms;
+        }
+
+        p_link->mode = mode;
+        p_link->switches++;
+        memcpy(bd_addr, p_conn->bd_addr, sizeof(wiced_bt_device_address_t));
+        switched = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (!switched)
+    {
+        return false;
+    }
+
+    if (set_phy)
+    {
+        wiced_bt_ble_phy_preferences_t phy =
+        {
+            .tx_phys  = BTM_BLE_PREFER_2M_PHY,
+            .rx_phys  = BTM_BLE_PREFER_2M_PHY,
+            .phy_opts = BTM_BLE_PREFER_CODED_PHY_NONE
+        };
+
+        memcpy(phy.remote_bd_addr, bd_addr, sizeof(wiced_bt_device_address_t));
+        if (WICED_BT_SUCCESS != wiced_bt_ble_set_phy(&phy))
+        {
+            rejected++;
+        }
+    }
+    if (set_length)
+    {
+        if (WICED_BT_SUCCESS != wiced_bt_ble_set_data_packet_length(bd_addr, BT_LINK_MAX_TX_OCTETS))
+        {
+            rejected++;
+        }
+    }
+
+    if (!wiced_bt_l2cap_update_ble_conn_params(bd_addr, p_params->min_interval,
+                                               p_params->max_interval, p_params->latency,
+                                               p_params->timeout))
+    {
+        rejected++;
+    }
+
+    if (0u != rejected)
+    {
+        taskENTER_CRITICAL();
+        p_conn = bt_conn_find(conn_id);
+        if (NULL != p_conn)
+        {
+            p_conn->link.rejected = (uint16_t)(p_conn->link.rejected + rejected);
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    APP_TRACE_INFO("Connection 0x%x: link mode %d\r\n", conn_id, mode);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: bt_link_hold_expired
+********************************************************************************
+* Summary:
+*  Returns every connection whose bulk traffic stopped BT_LINK_BULK_HOLD_MS
+*  ago to idle mode, and waits for the others.
+*
+* Parameters:
+*  TimerHandle_t timer : Hold timer (unused)
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bt_link_hold_expired(TimerHandle_t timer)
+{
+    uint32_t wait_ms = 0u;
+
+    (void)timer;
+
+    for (uint8_t i = 0u; i < BT_CONN_MAX; i++)
+    {
+        bt_conn_t *p_conn;
+        uint16_t conn_id = 0u;
+        uint32_t idle_ms = 0u;
+
+        taskENTER_CRITICAL();
+        p_conn = bt_conn_at(i);
+        if ((NULL != p_conn) && (BT_LINK_MODE_BULK == p_conn->link.mode))
+        {
+            /* Read the time here, so it is not older than the activity */
+            conn_id = p_conn->conn_id;
+            idle_ms = bt_link_now_ms() - p_conn->link.activity_ms;
+        }
+        taskEXIT_CRITICAL();
+
+        if (0u == conn_id)
+        {
+            continue;
+        }
+
+        if (idle_ms >= BT_LINK_BULK_HOLD_MS)
+        {
+            if (bt_link_request(conn_id, BT_LINK_MODE_IDLE, BT_LINK_BULK_HOLD_MS))
+            {
+                continue;
+            }
+            /* Traffic reported since the check: wait a full hold again */
+            idle_ms = 0u;
+        }
+        if ((0u == wait_ms) || ((BT_LINK_BULK_HOLD_MS - idle_ms) < wait_ms))
+        {
+            wait_ms = BT_LINK_BULK_HOLD_MS - idle_ms;
+        }
+    }
+
+    if (0u != wait_ms)
+    {
+        (void)xTimerChangePeriod(bt_link_timer, pdMS_TO_TICKS(wait_ms), 0u);
+    }
+}
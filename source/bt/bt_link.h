@@ -0,0 +1,76 @@
+/*******************************************************************************
+* File Name: bt_link.h
+*
+* Description: This file is the public interface of bt_link.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_LINK_H_
+#define BT_LINK_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "wiced_bt_types.h"
+#include "wiced_bt_dev.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Link policies */
+#define BT_LINK_MODE_IDLE               (0u)    /* Long interval and peripheral latency */
+#define BT_LINK_MODE_BULK               (1u)    /* Short interval, 2M PHY, longest PDUs */
+#define BT_LINK_MODE_COUNT              (2u)
+
+/* Time without bulk traffic after which a link returns to idle */
+#define BT_LINK_BULK_HOLD_MS            (5000u)
+
+/* Longest LE data channel payload */
+#define BT_LINK_MAX_TX_OCTETS           (251u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Policy and negotiated parameters of a connection; negotiated values are 0
+ * until the stack reports them */
+typedef struct
+{
+    uint8_t  mode;              /* BT_LINK_MODE_* last requested */
+    uint16_t interval;          /* Connection interval in 1.25 ms units */
+    uint16_t latency;           /* Peripheral latency in connection events */
+    uint16_t timeout;           /* Supervision timeout in 10 ms units */
+    uint8_t  tx_phy;            /* PHY as reported by the stack */
+    uint8_t  rx_phy;
+    uint16_t tx_octets;         /* Negotiated data length */
+    uint16_t rx_octets;
+    uint32_t activity_ms;       /* Last bulk traffic */
+    uint32_t bulk_since_ms;     /* Start of the current bulk period */
+    uint32_t bulk_ms;           /* Time spent in completed bulk periods */
+    uint16_t switches;          /* Mode changes requested */
+    uint16_t param_updates;     /* Connection parameter updates reported */
+    uint16_t phy_updates;       /* PHY updates reported */
+    uint16_t rejected;          /* Requests refused by the stack */
+} bt_link_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void bt_link_init(void);
+void bt_link_open(uint16_t conn_id);
+void bt_link_activity(uint16_t conn_id);
+bool bt_link_set_mode(uint16_t conn_id, uint8_t mode);
+void bt_link_param_update(const wiced_bt_ble_connection_param_update_t *p_update);
+void bt_link_phy_update(const wiced_bt_ble_phy_update_t *p_update);
+void bt_link_data_length_update(const wiced_bt_ble_data_length_update_t *p_update);
+bool bt_link_get(uint16_t conn_id, bt_link_t *p_link);
+
+#endif /* BT_LINK_H_ */
@@ -0,0 +1,367 @@
+/*******************************************************************************
+* File Name: bt_notify.c
+*
+* Description: This file contains the table-driven notification dispatcher.
+* Each notifiable characteristic is described by its value handle, the client
+* configuration enabling it and the encoder of its payload. Producers mark
+* characteristics dirty from any context; a flush encodes every dirty
+* characteristic once and sends it to all subscribed connections when its
+* trigger conditions are met.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cybsp.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "bt_notify.h"
+#include "bt_conn.h"
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Trigger state of a characteristic */
+typedef struct
+{
+    bt_notify_trigger_t trigger;
+    int32_t             value;          /* Latest value of bt_notify_mark_value */
+    int32_t             last_value;     /* Value of the last notification */
+    uint32_t            last_ms;        /* Time of the last notification */
+    bool                has_value;      /* value was set by bt_notify_mark_value */
+    bool                notified;       /* last_value and last_ms are set */
+    bool                pending;        /* Change held back by the minimum interval */
+} bt_notify_state_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static const bt_notify_desc_t *bt_notify_table = NULL;
+static uint8_t bt_notify_count = 0u;
+/* Attribute of each characteristic value, resolved once at init */
+static gatt_db_lookup_table_t *bt_notify_attr[BT_NOTIFY_MAX];
+static bt_notify_stats_t bt_notify_stats[BT_NOTIFY_MAX];
+static bt_notify_state_t bt_notify_state[BT_NOTIFY_MAX];
+static uint32_t bt_notify_dirty = 0u;
+static uint32_t bt_notify_forced = 0u;
+
+/*******************************************************************************
+* Function Name: bt_notify_init
+********************************************************************************
+* Summary:
+*  Sets the characteristic table and resolves the value attribute of each
+*  entry, so that the dispatcher does not depend on the order of the
+*  generated attribute table. Every entry starts dirty, so that the first
+*  flush encodes values produced before the dispatcher existed. Also starts
+*  the CPU cycle counter used for the cost counters. Triggers start cleared,
+*  which notifies every change.
+*
+* Parameters:
+*  const bt_notify_desc_t *p_table : Characteristics; must outlive the dispatcher
+*  uint8_t count                   : Number of entries; at most BT_NOTIFY_MAX
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_notify_init(const bt_notify_desc_t *p_table, uint8_t count)
+{
+    CY_ASSERT(count <= BT_NOTIFY_MAX);
+
+    bt_notify_table = p_table;
+    bt_notify_count = count;
+    bt_notify_dirty = (count < 32u) ? (uint32_t)((1UL << count) - 1UL) : 0xFFFFFFFFUL;
+    bt_notify_forced = 0u;
+    memset(bt_notify_stats, 0, sizeof(bt_notify_stats));
+    memset(bt_notify_state, 0, sizeof(bt_notify_state));
+
+    for (uint8_t n = 0u; n < count; n++)
+    {
+        bt_notify_attr[n] = NULL;
+
+        for (uint16_t i = 0u; i < app_gatt_db_ext_attr_tbl_size; i++)
+        {
+            if (app_gatt_db_ext_attr_tbl[i].handle == p_table[n].value_handle)
+            {
+                bt_notify_attr[n] = &app_gatt_db_ext_attr_tbl[i];
+                break;
+            }
+        }
+
+        if (NULL == bt_notify_attr[n])
+        {
+            printf("Notifiable handle 0x%x not in the attribute table\r\n", p_table[n].value_handle);
+        }
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*******************************************************************************
+* Function Name: bt_notify_mark
+********************************************************************************
+* Summary:
+*  Marks a characteristic for the next flush, to be encoded again. The
+*  trigger compares the last value given to bt_notify_mark_value, so marking
+*  does not cause a notification by itself; a characteristic never given a
+*  value is always considered changed. Can be called from any task or
+*  interrupt.
+*
+* Parameters:
+*  uint8_t index : Entry of the characteristic table
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_notify_mark(uint8_t index)
+{
+    if (index < bt_notify_count)
+    {
+        (void)__atomic_fetch_or(&bt_notify_dirty, (1UL << index), __ATOMIC_RELEASE);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_notify_mark_value
+********************************************************************************
+* Summary:
+*  Marks a characteristic for the next flush, with the value the deadband of
+*  its trigger is applied to. Each characteristic must have a single
+*  producer of values.
+*
+* Parameters:
+*  uint8_t index : Entry of the characteristic table
+*  int32_t value : New value, in the units of the deadband
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_notify_mark_value(uint8_t index, int32_t value)
+{
+    if (index < bt_notify_count)
+    {
+        bt_notify_state[index].value = value;
+        bt_notify_state[index].has_value = true;
+        (void)__atomic_fetch_or(&bt_notify_dirty, (1UL << index), __ATOMIC_RELEASE);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_notify_force
+********************************************************************************
+* Summary:
+*  Notifies the current value of a characteristic on the next flush,
+*  regardless of its trigger, to every subscriber. A single new subscriber
+*  is better caught up by the application, on its connection only.
+*
+* Parameters:
+*  uint8_t index : Entry of the characteristic table
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_notify_force(uint8_t index)
+{
+    if (index < bt_notify_count)
+    {
+        (void)__atomic_fetch_or(&bt_notify_forced, (1UL << index), __ATOMIC_RELEASE);
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_notify_set_trigger
+********************************************************************************
+* Summary:
+*  Sets the trigger conditions of a characteristic. Takes effect on the next
+*  flush.
+*
+* Parameters:
+*  uint8_t index                        : Entry of the characteristic table
+*  const bt_notify_trigger_t *p_trigger : Trigger conditions
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_notify_set_trigger(uint8_t index, const bt_notify_trigger_t *p_trigger)
+{
+    if ((index < bt_notify_count) && (NULL != p_trigger))
+    {
+        taskENTER_CRITICAL();
+        bt_notify_state[index].trigger = *p_trigger;
+        taskEXIT_CRITICAL();
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_notify_get_trigger
+********************************************************************************
+* Summary:
+*  Copies the trigger conditions of a characteristic.
+*
+* Parameters:
+*  uint8_t index                  : Entry of the characteristic table
+*  bt_notify_trigger_t *p_trigger : Receives the trigger conditions
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_notify_get_trigger(uint8_t index, bt_notify_trigger_t *p_trigger)
+{
+    if ((index < bt_notify_count) && (NULL != p_trigger))
+    {
+        taskENTER_CRITICAL();
+        *p_trigger = bt_notify_state[index].trigger;
+        taskEXIT_CRITICAL();
+    }
+}
+
+/*******************************************************************************
+* Function Name: bt_notify_flush
+********************************************************************************
+* Summary:
+*  Encodes every dirty characteristic into its attribute value and sends it
+*  to all connections subscribed to it if its trigger conditions are met.
+*  Values are encoded even without subscribers, so that reads return them.
+*  Must be called from one task, regularly enough for the heartbeats.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : Mask of the characteristics notified to at least one connection
+*
+*******************************************************************************/
+uint32_t bt_notify_flush(void)
+{
+    uint32_t dirty = __atomic_exchange_n(&bt_notify_dirty, 0u, __ATOMIC_ACQUIRE);
+    uint32_t forced = __atomic_exchange_n(&bt_notify_forced, 0u, __ATOMIC_ACQUIRE);
+    uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    uint32_t notified = 0u;
+
+    for (uint8_t n = 0u; n < bt_notify_count; n++)
+    {
+        const bt_notify_desc_t *p_desc = &bt_notify_table[n];
+        gatt_db_lookup_table_t *p_attr = bt_notify_attr[n];
+        bt_notify_state_t *p_state = &bt_notify_state[n];
+        bt_notify_stats_t *p_stats = &bt_notify_stats[n];
+        bool is_dirty = (0u != (dirty & (1UL << n)));
+        bool due = (0u != (forced & (1UL << n)));
+        bool heartbeat = false;
+        bt_notify_trigger_t trigger;
+        uint32_t since_ms = now_ms - p_state->last_ms;
+        uint32_t start;
+        uint32_t cycles;
+        uint8_t sent;
+
+        if (NULL == p_attr)
+        {
+            continue;
+        }
+
+        taskENTER_CRITICAL();
+        trigger = p_state->trigger;
+        taskEXIT_CRITICAL();
+
+        start = DWT->CYCCNT;
+
+        if (is_dirty)
+        {
+            if (NULL != p_desc->encode)
+            {
+                p_desc->encode(p_attr);
+            }
+            p_stats->flushes++;
+
+            if (!p_state->notified || !p_state->has_value ||
+                (labs((long)p_state->value - (long)p_state->last_value) > (long)trigger.deadband))
+            {
+                p_state->pending = true;
+            }
+        }
+
+        if (p_state->pending &&
+            (!p_state->notified || (since_ms >= ((uint32_t)trigger.min_interval_s * 1000u))))
+        {
+            due = true;
+        }
+        if (!due && p_state->notified && (0u != trigger.max_interval_s) &&
+            (since_ms >= ((uint32_t)trigger.max_interval_s * 1000u)))
+        {
+            due = true;
+            heartbeat = true;
+        }
+
+        if (due)
+        {
+            sent = bt_conn_notify(p_desc->cccd, p_desc->value_handle,
+                                  p_attr->p_data, p_attr->cur_len);
+            if (0u != sent)
+            {
+                notified |= (1UL << n);
+                p_stats->sent += sent;
+                p_stats->heartbeats += heartbeat ? 1u : 0u;
+            }
+
+            /* Without subscribers the value still counts as notified; a new
+             * subscriber is caught up by the application */
+            p_state->last_value = p_state->value;
+            p_state->last_ms = now_ms;
+            p_state->notified = true;
+            p_state->pending = false;
+        }
+        else if (is_dirty)
+        {
+            p_stats->suppressed++;
+        }
+        else
+        {
+            continue;
+        }
+
+        cycles = DWT->CYCCNT - start;
+        p_stats->cycles_total += cycles;
+        if (cycles > p_stats->cycles_max)
+        {
+            p_stats->cycles_max = cycles;
+        }
+    }
+
+    return notified;
+}
+
+/*******************************************************************************
+* Function Name: bt_notify_get_stats
+********************************************************************************
+* Summary:
+*  Copies the cost counters of a characteristic.
+*
+* Parameters:
+*  uint8_t index                : Entry of the characteristic table
+*  bt_notify_stats_t *p_stats   : Receives the counters
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bt_notify_get_stats(uint8_t index, bt_notify_stats_t *p_stats)
+{
+    if ((index < bt_notify_count) && (NULL != p_stats))
+    {
+        *p_stats = bt_notify_stats[index];
+    }
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+* File Name: bt_notify.h
+*
+* Description: This file is the public interface of bt_notify.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_NOTIFY_H_
+#define BT_NOTIFY_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdint.h>
+#include "cycfg_gatt_db.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Characteristics a dispatcher can handle; one bit of the dirty mask each */
+#define BT_NOTIFY_MAX                   (32u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Writes the current payload into the attribute value, updating cur_len if
+ * the length changes */
+typedef void (*bt_notify_encoder_t)(gatt_db_lookup_table_t *p_attr);
+
+/* Conditions for notifying a new value, in the spirit of the Environmental
+ * Sensing trigger settings. A value is notified when it differs from the
+ * last notified one by more than the deadband, but not sooner than the
+ * minimum interval after the previous notification; the maximum interval
+ * repeats the current value if nothing was notified for that long. Times
+ * are evaluated on every flush, so their resolution is the flush period. */
+typedef struct
+{
+    uint16_t deadband;          /* In units of the value; 0 notifies every change */
+    uint16_t min_interval_s;    /* 0 for no minimum */
+    uint16_t max_interval_s;    /* Heartbeat; 0 disables it */
+} bt_notify_trigger_t;
+
+/* Notifiable characteristic */
+typedef struct
+{
+    uint16_t            value_handle;   /* Handle of the characteristic value */
+    uint8_t             cccd;           /* BT_CONN_CCCD_* configuration enabling the notification */
+    bt_notify_encoder_t encode;         /* NULL if the value is kept current by its owner */
+} bt_notify_desc_t;
+
+/* Cost counters of a characteristic */
+typedef struct
+{
+    uint32_t flushes;       /* Times the characteristic was flushed */
+    uint32_t suppressed;    /* Flushes held back by the trigger */
+    uint32_t heartbeats;    /* Notifications of an unchanged value */
+    uint32_t sent;          /* Notifications handed to the stack */
+    uint32_t cycles_total;  /* CPU cycles spent encoding and sending */
+    uint32_t cycles_max;    /* Longest single flush in CPU cycles */
+} bt_notify_stats_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+void     bt_notify_init(const bt_notify_desc_t *p_table, uint8_t count);
+void     bt_notify_mark(uint8_t index);
+void     bt_notify_mark_value(uint8_t index, int32_t value);
+void     bt_notify_force(uint8_t index);
+void     bt_notify_set_trigger(uint8_t index, const bt_notify_trigger_t *p_trigger);
+void     bt_notify_get_trigger(uint8_t index, bt_notify_trigger_t *p_trigger);
+uint32_t bt_notify_flush(void);
+void     bt_notify_get_stats(uint8_t index, bt_notify_stats_t *p_stats);
+
+#endif /* BT_NOTIFY_H_ */
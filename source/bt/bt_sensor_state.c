@@ -0,0 +1,91 @@
+/*******************************************************************************
+* File Name: bt_sensor_state.c
+*
+* Description: This file contains the shared sensor state. bt_task is its
+* only writer; the BT stack, other tasks and interrupts read it. The state is
+* kept twice behind a sequence counter whose parity tells readers which copy
+* is stable, so the writer never waits and a reader never sees a state half
+* written, without locks or critical sections. A reader that interrupts the
+* writer reads the stable copy at once; a reader interrupted by the writer
+* reads again.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "bt_sensor_state.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Readers use bt_sensor_state_copy[bt_sensor_state_latch & 1] */
+static bt_sensor_state_t bt_sensor_state_copy[2];
+static uint32_t bt_sensor_state_latch = 0u;
+
+/*******************************************************************************
+* Function Name: bt_sensor_state_publish
+********************************************************************************
+* Summary:
+*  Publishes a new sensor state, numbering it after the previous one. Must
+*  only be called by a single task.
+*
+* Parameters:
+*  const bt_sensor_state_t *p_state : New state; its seq is ignored
+*
+* Return:
+*  uint32_t : Sequence number given to the state
+*
+*******************************************************************************/
+uint32_t bt_sensor_state_publish(const bt_sensor_state_t *p_state)
+{
+    uint32_t latch = __atomic_load_n(&bt_sensor_state_latch, __ATOMIC_RELAXED);
+    bt_sensor_state_t next = *p_state;
+
+    next.seq = bt_sensor_state_copy[latch & 1u].seq + 1u;
+
+    /* Readers move to copy 1 while copy 0 is written, then back to copy 0
+     * while copy 1 is written */
+    __atomic_store_n(&bt_sensor_state_latch, latch + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    bt_sensor_state_copy[0] = next;
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&bt_sensor_state_latch, latch + 2u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    bt_sensor_state_copy[1] = next;
+
+    return next.seq;
+}
+
+/*******************************************************************************
+* Function Name: bt_sensor_state_read
+********************************************************************************
+* Summary:
+*  Takes a consistent snapshot of the sensor state. Can be called from any
+*  task or interrupt.
+*
+* Parameters:
+*  bt_sensor_state_t *p_state : Receives the snapshot
+*
+* Return:
+*  uint32_t : Sequence number of the snapshot; 0 if nothing was published
+*
+*******************************************************************************/
+uint32_t bt_sensor_state_read(bt_sensor_state_t *p_state)
+{
+    uint32_t latch;
+
+    do
+    {
+        latch = __atomic_load_n(&bt_sensor_state_latch, __ATOMIC_ACQUIRE);
+        *p_state = bt_sensor_state_copy[latch & 1u];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (latch != __atomic_load_n(&bt_sensor_state_latch, __ATOMIC_RELAXED));
+
+    return p_state->seq;
+}
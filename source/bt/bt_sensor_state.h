@@ -0,0 +1,51 @@
+/*******************************************************************************
+* File Name: bt_sensor_state.h
+*
+* Description: This file is the public interface of bt_sensor_state.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BT_SENSOR_STATE_H_
+#define BT_SENSOR_STATE_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Temperature of a state without temperature reading */
+#define BT_SENSOR_TEMPERATURE_NONE      (INT16_MIN)
+
+#define BT_SENSOR_STATUS_ALARM          (0x01u)     /* CO2 at or above the alarm threshold */
+#define BT_SENSOR_STATUS_FCS            (0x02u)     /* Taken during a forced compensation */
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Latest sensor state, published by bt_task */
+typedef struct
+{
+    uint32_t seq;           /* Number of states published; 0 if none yet */
+    uint32_t time_ms;       /* Milliseconds since the scheduler started */
+    uint16_t co2_ppm;
+    int16_t  temperature;   /* 0.01 degC, or BT_SENSOR_TEMPERATURE_NONE */
+    uint8_t  status;        /* BT_SENSOR_STATUS_* */
+} bt_sensor_state_t;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+uint32_t bt_sensor_state_publish(const bt_sensor_state_t *p_state);
+uint32_t bt_sensor_state_read(bt_sensor_state_t *p_state);
+
+#endif /* BT_SENSOR_STATE_H_ */
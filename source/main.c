@@ -24,6 +24,8 @@
 #include "cycfg_bt_settings.h"
 #include "cybt_platform_config.h"
 
+#include "app_event.h"
+#include "app_trace.h"
 #include "bt_app.h"
 #include "flash_utils.h"
 #include "FreeRTOS.h"
@@ -62,11 +64,15 @@
 /* Variable which holds the button pressed status */
 volatile bool co2_check_flag = false;
 TaskHandle_t  dis_task_handle;
+TaskHandle_t  bt_task_handle;
 cyhal_gpio_callback_data_t gpio_btn_callback_data;
 
 cyhal_i2c_t cyhal_i2c;
 xensiv_pasco2_t xensiv_pasco2;
 
+/* Events shown by the display task */
+static app_event_queue_t display_events;
+
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
@@ -77,6 +83,7 @@ static void gpio_interrupt_handler(void *handler_arg, cyhal_gpio_event_t event);
 void handle_error(uint32_t status);
 
 void display_task(void* param);
+static void display_sample(uint16_t ppm);
 /*******************************************************************************
 * Function Definitions
 *******************************************************************************/
@@ -177,7 +184,7 @@ int main(void)
 
 
     if(pdPASS != xTaskCreate(bt_task, "BT Task", BT_TASK_STACK_SIZE,
-                                                NULL, BT_TASK_PRIORITY, NULL))
+                                                NULL, BT_TASK_PRIORITY, &bt_task_handle))
     {
         CY_ASSERT(0u);
     }
@@ -188,6 +195,18 @@ int main(void)
         CY_ASSERT(0u);
     }
 
+    if(pdPASS != xTaskCreate(app_trace_task, "Trace Task", APP_TRACE_TASK_STACK_SIZE,
+                                                NULL, APP_TRACE_TASK_PRIORITY, NULL))
+    {
+        CY_ASSERT(0u);
+    }
+
+    /* Registered before any task runs, so no event is missed */
+    (void)app_event_subscribe(&display_events,
+                              APP_EVENT_MASK(APP_EVENT_SAMPLE) | APP_EVENT_MASK(APP_EVENT_CONNECTION) |
+                              APP_EVENT_MASK(APP_EVENT_ALARM) | APP_EVENT_MASK(APP_EVENT_BUTTON),
+                              dis_task_handle);
+
 
     /* Start the FreeRTOS scheduler */
     vTaskStartScheduler();
@@ -208,7 +227,10 @@ int main(void)
 *******************************************************************************/
 static void gpio_interrupt_handler(void *handler_arg, cyhal_gpio_event_t event)
 {
+	app_event_t button = { .type = APP_EVENT_BUTTON };
+
 	co2_check_flag = 1 - co2_check_flag;
+	app_event_publish(&button);
 }
 
 
@@ -216,7 +238,8 @@ static void gpio_interrupt_handler(void *handler_arg, cyhal_gpio_event_t event)
 * Function Name: display_task
 ********************************************************************************
 * Summary:
-*  Task that handles Bluetooth initialization and updates GATT notification data.
+*  Task that owns the LED and shows the events of the acquisition and of the
+*  Bluetooth connections.
 *
 * Parameters:
 *  void *param : Task parameter defined during task creation (unused)
@@ -228,7 +251,7 @@ static void gpio_interrupt_handler(void *handler_arg, cyhal_gpio_event_t event)
 void display_task(void* param)
 {
 	 cy_rslt_t result = CY_RSLT_SUCCESS;
-uint32_t ppm;
+	 app_event_t event;
 
 	result = StripLights_Init();
 
@@ -249,45 +272,101 @@ uint32_t ppm;
     for(;;)
     {
 
-        /* Block till a notification is received. */
-        xTaskNotifyWait(0, 0, &ppm, portMAX_DELAY);
-
-    	if(ppm <= 600 && ppm > 400)
-		{
-			printf("CO2 level is Very Good!\r\n");
-			StripLights_Pixel(0, CO2_GREEN);
-			StripLights_Trigger(1);
-		}
-		else if(ppm <= 800 && ppm > 600)
-		{
-			printf("CO2 level is Good!\r\n");
-			StripLights_Pixel(0, CO2_GREEN);
-			StripLights_Trigger(1);
-		}
-		else if(ppm <= 1000 && ppm > 800)
-		{
-			printf("CO2 level is Fair!\r\n");
-			StripLights_Pixel(0, CO2_LGREEN);
-			StripLights_Trigger(1);
-		}
-		else if(ppm <= 1400 && ppm > 1000)
-		{
-			printf("CO2 level is Bad!\r\n");
-			StripLights_Pixel(0, CO2_ORANGE);
-			StripLights_Trigger(1);
-		}
-		else if(ppm > 1400)
-		{
-			printf("CO2 level is Very Bad!\r\n");
-			StripLights_Pixel(0, CO2_RED);
-			StripLights_Trigger(1);
-		}
-
-
+        /* Block till an event is received. */
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (app_event_receive(&display_events, &event))
+        {
+            switch (event.type)
+            {
+            case APP_EVENT_SAMPLE:
+                display_sample(event.data.sample.co2_ppm);
+                break;
+
+            case APP_EVENT_CONNECTION:
+                if (event.data.connection.connected)
+                {
+                    StripLights_Pixel(0, WS2812_BLUE);
+                    StripLights_Trigger(1);
+                }
+                else if (0u == event.data.connection.count)
+                {
+                    StripLights_Pixel(0, WS2812_WHITE);
+                    StripLights_Trigger(1);
+                }
+                break;
+
+            case APP_EVENT_ALARM:
+                printf("CO2 alarm %s at %d ppm\r\n",
+                       event.data.alarm.active ? "raised" : "cleared", event.data.alarm.co2_ppm);
+                break;
+
+            case APP_EVENT_BUTTON:
+            {
+                app_event_stats_t stats;
+
+                app_event_get_stats(&display_events, &stats);
+                printf("Display events: depth %d, high water %d, received %lu, dropped %lu\r\n",
+                       stats.depth, stats.high_water, (unsigned long)stats.received,
+                       (unsigned long)stats.dropped);
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
     }
 
 
 }
+
+/*******************************************************************************
+* Function Name: display_sample
+********************************************************************************
+* Summary:
+*  Shows the CO2 level of a sample on the LED.
+*
+* Parameters:
+*  uint16_t ppm : CO2 concentration in ppm
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void display_sample(uint16_t ppm)
+{
+	if(ppm <= 600 && ppm > 400)
+	{
+		printf("CO2 level is Very Good!\r\n");
+		StripLights_Pixel(0, CO2_GREEN);
+		StripLights_Trigger(1);
+	}
+	else if(ppm <= 800 && ppm > 600)
+	{
+		printf("CO2 level is Good!\r\n");
+		StripLights_Pixel(0, CO2_GREEN);
+		StripLights_Trigger(1);
+	}
+	else if(ppm <= 1000 && ppm > 800)
+	{
+		printf("CO2 level is Fair!\r\n");
+		StripLights_Pixel(0, CO2_LGREEN);
+		StripLights_Trigger(1);
+	}
+	else if(ppm <= 1400 && ppm > 1000)
+	{
+		printf("CO2 level is Bad!\r\n");
+		StripLights_Pixel(0, CO2_ORANGE);
+		StripLights_Trigger(1);
+	}
+	else if(ppm > 1400)
+	{
+		printf("CO2 level is Very Bad!\r\n");
+		StripLights_Pixel(0, CO2_RED);
+		StripLights_Trigger(1);
+	}
+}
 /*******************************************************************************
 * Function Name: handle_error
 ********************************************************************************
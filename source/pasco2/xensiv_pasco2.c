@@ -25,7 +25,6 @@
 #include "xensiv_pasco2.h"
 #include "xensiv_pasco2_platform.h"
 
-#define XENSIV_PASCO2_COMM_DELAY_MS             (5U)
 #define XENSIV_PASCO2_COMM_TEST_VAL             (0xA5U)
 
 #define XENSIV_PASCO2_SOFT_RESET_DELAY_MS       (2000U)
@@ -33,6 +32,7 @@
 #define XENSIV_PASCO2_FCS_MEAS_RATE_S           (10)
 
 #define XENSIV_PASCO2_I2C_WRITE_BUFFER_LEN      (17U)
+#define XENSIV_PASCO2_RESULT_WINDOW_LEN         (XENSIV_PASCO2_REG_MEAS_STS - XENSIV_PASCO2_REG_SENS_STS + 1U)
 #define XENSIV_PASCO2_UART_WRITE_XFER_BUF_SIZE  (8U)
 #define XENSIV_PASCO2_UART_READ_XFER_BUF_SIZE   (5U)
 
@@ -40,6 +40,16 @@
 #define XENSIV_PASCO2_UART_READ_XFER_RESP_LEN   (3U)
 #define XENSIV_PASCO2_UART_ACK                  (0x06U)
 #define XENSIV_PASCO2_UART_NAK                  (0x15U)
+#define XENSIV_PASCO2_UART_MAX_BURST_LEN        (XENSIV_PASCO2_REG_SENS_RST + 1U)
+
+/* Per-byte UART commands sent before waiting for their responses. The datasheet does not state that
+ * the sensor buffers a command received while it is still answering the previous one, so by default
+ * each command waits for its response, which also spaces the commands like the original driver did.
+ * Define a larger value only for sensors verified to accept a burst of commands; up to
+ * XENSIV_PASCO2_UART_MAX_BURST_LEN commands then share a single round trip. */
+#ifndef XENSIV_PASCO2_UART_CMDS_IN_FLIGHT
+#define XENSIV_PASCO2_UART_CMDS_IN_FLIGHT       (1U)
+#endif
 
 static inline uint8_t xensiv_pasco2_digit_to_ascii(uint8_t digit)
 {
@@ -69,6 +79,94 @@ static inline uint8_t xensiv_pasco2_ascii_to_digit(uint8_t ascii)
     }
 }
 
+/* Registers mirrored by the shadow, indexed by xensiv_pasco2_shadow_reg_t */
+static const struct
+{
+    uint8_t reg_addr;
+    uint8_t len;
+} xensiv_pasco2_shadow_map[XENSIV_PASCO2_SHADOW_COUNT] =
+{
+    [XENSIV_PASCO2_SHADOW_MEAS_CFG]  = { XENSIV_PASCO2_REG_MEAS_CFG,    1U },
+    [XENSIV_PASCO2_SHADOW_MEAS_RATE] = { XENSIV_PASCO2_REG_MEAS_RATE_H, 2U },
+    [XENSIV_PASCO2_SHADOW_PRESS_REF] = { XENSIV_PASCO2_REG_PRESS_REF_H, 2U },
+    [XENSIV_PASCO2_SHADOW_ALARM_TH]  = { XENSIV_PASCO2_REG_ALARM_TH_H,  2U },
+    [XENSIV_PASCO2_SHADOW_INT_CFG]   = { XENSIV_PASCO2_REG_INT_CFG,     1U },
+    [XENSIV_PASCO2_SHADOW_CALIB_REF] = { XENSIV_PASCO2_REG_CALIB_REF_H, 2U },
+};
+
+/* Returns the shadow entry matching exactly the given access; XENSIV_PASCO2_SHADOW_COUNT if none */
+static uint8_t xensiv_pasco2_shadow_find(uint8_t reg_addr, uint8_t len)
+{
+    uint8_t idx;
+
+    for (idx = 0U; idx < (uint8_t)XENSIV_PASCO2_SHADOW_COUNT; ++idx)
+    {
+        if ((xensiv_pasco2_shadow_map[idx].reg_addr == reg_addr) && (xensiv_pasco2_shadow_map[idx].len == len))
+        {
+            break;
+        }
+    }
+
+    return idx;
+}
+
+/* Single mode and forced compensation are cleared by the sensor itself, so such MEAS_CFG values must not be cached */
+static inline bool xensiv_pasco2_shadow_cacheable(uint8_t idx, const uint8_t * data)
+{
+    xensiv_pasco2_measurement_config_t meas_config;
+    meas_config.u = data[0];
+
+    return ((uint8_t)XENSIV_PASCO2_SHADOW_MEAS_CFG != idx) ||
+           ((meas_config.b.op_mode != (uint32_t)XENSIV_PASCO2_OP_MODE_SINGLE) &&
+            (meas_config.b.boc_cfg != (uint32_t)XENSIV_PASCO2_BOC_CFG_FORCED));
+}
+
+/* Refreshes every shadow entry covered by an access; entries touched only partially become invalid */
+static void xensiv_pasco2_shadow_update(xensiv_pasco2_t * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len, bool success)
+{
+    for (uint8_t idx = 0U; idx < (uint8_t)XENSIV_PASCO2_SHADOW_COUNT; ++idx)
+    {
+        uint8_t first = xensiv_pasco2_shadow_map[idx].reg_addr;
+        uint8_t last = (uint8_t)(first + xensiv_pasco2_shadow_map[idx].len - 1U);
+
+        if ((last < reg_addr) || (first >= (uint32_t)reg_addr + len))
+        {
+            continue;
+        }
+
+        const uint8_t * src = &data[first - reg_addr];
+        if (success && (first >= reg_addr) && (last < (uint32_t)reg_addr + len) && xensiv_pasco2_shadow_cacheable(idx, src))
+        {
+            for (uint8_t i = 0U; i < xensiv_pasco2_shadow_map[idx].len; ++i)
+            {
+                dev->shadow.val[idx][i] = src[i];
+            }
+            dev->shadow.valid |= (uint8_t)(1U << idx);
+        }
+        else
+        {
+            dev->shadow.valid &= (uint8_t)~(1U << idx);
+        }
+    }
+}
+
+/* Blocks until the minimum spacing to the previous command has elapsed */
+static void xensiv_pasco2_wait_bus_ready(const xensiv_pasco2_t * dev)
+{
+    int32_t remaining = (int32_t)(dev->bus_ready_ms - xensiv_pasco2_plat_get_time_ms());
+
+    if (remaining > 0)
+    {
+        xensiv_pasco2_plat_delay((uint32_t)remaining);
+    }
+}
+
+/* Records that the sensor must not receive another command for delay_ms */
+static void xensiv_pasco2_set_bus_busy(xensiv_pasco2_t * dev, uint32_t delay_ms)
+{
+    dev->bus_ready_ms = xensiv_pasco2_plat_get_time_ms() + delay_ms;
+}
+
 static int32_t xensiv_pasco2_i2c_read(const xensiv_pasco2_t * dev, uint8_t reg_addr, uint8_t * data, uint8_t len)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
@@ -105,37 +203,48 @@ static int32_t xensiv_pasco2_uart_read(const xensiv_pasco2_t * dev, uint8_t reg_
     xensiv_pasco2_plat_assert(dev->ctx != NULL);
     xensiv_pasco2_plat_assert(reg_addr <= XENSIV_PASCO2_REG_SENS_RST);
     xensiv_pasco2_plat_assert(data != NULL);
+    xensiv_pasco2_plat_assert(len <= XENSIV_PASCO2_UART_MAX_BURST_LEN);
 
+    /* Up to XENSIV_PASCO2_UART_CMDS_IN_FLIGHT per-byte read commands are sent back to back;
+     * the sensor answers them in order */
+    uint8_t uart_buf[XENSIV_PASCO2_UART_CMDS_IN_FLIGHT * XENSIV_PASCO2_UART_READ_XFER_BUF_SIZE];
     int32_t res = XENSIV_PASCO2_OK;
+    uint8_t done = 0U;
 
-    for (uint8_t i = 0; i < len; ++i)
+    while ((XENSIV_PASCO2_OK == res) && (done < len))
     {
-        uint8_t uart_buf[XENSIV_PASCO2_UART_READ_XFER_BUF_SIZE] =
+        uint8_t chunk = (uint8_t)(((uint32_t)len - done < XENSIV_PASCO2_UART_CMDS_IN_FLIGHT) ?
+                                  ((uint32_t)len - done) : XENSIV_PASCO2_UART_CMDS_IN_FLIGHT);
+
+        for (uint8_t i = 0; i < chunk; ++i)
         {
-            (uint8_t)'r',
-            (uint8_t)',',
-            xensiv_pasco2_digit_to_ascii((reg_addr & (uint8_t)0xF0) >> 4U),
-            xensiv_pasco2_digit_to_ascii(reg_addr & (uint8_t)0x0F),
-            (uint8_t)'\n'
-        };
+            uint8_t * cmd = &uart_buf[i * XENSIV_PASCO2_UART_READ_XFER_BUF_SIZE];
+            uint8_t addr = (uint8_t)(reg_addr + done + i);
+
+            cmd[0] = (uint8_t)'r';
+            cmd[1] = (uint8_t)',';
+            cmd[2] = xensiv_pasco2_digit_to_ascii((addr & (uint8_t)0xF0) >> 4U);
+            cmd[3] = xensiv_pasco2_digit_to_ascii(addr & (uint8_t)0x0F);
+            cmd[4] = (uint8_t)'\n';
+        }
 
-        res = xensiv_pasco2_plat_uart_write(dev->ctx, uart_buf, XENSIV_PASCO2_UART_READ_XFER_BUF_SIZE);
+        res = xensiv_pasco2_plat_uart_write(dev->ctx, uart_buf, (size_t)chunk * XENSIV_PASCO2_UART_READ_XFER_BUF_SIZE);
 
         if (XENSIV_PASCO2_OK == res)
         {
-            res = xensiv_pasco2_plat_uart_read(dev->ctx, uart_buf, XENSIV_PASCO2_UART_READ_XFER_RESP_LEN);
-            if (XENSIV_PASCO2_OK == res)
-            {
-                data[i] = (uint8_t)((xensiv_pasco2_ascii_to_digit(uart_buf[0]) << 4) + xensiv_pasco2_ascii_to_digit(uart_buf[1]));
-            }
+            res = xensiv_pasco2_plat_uart_read(dev->ctx, uart_buf, (size_t)chunk * XENSIV_PASCO2_UART_READ_XFER_RESP_LEN);
         }
 
-        if (XENSIV_PASCO2_OK != res)
+        if (XENSIV_PASCO2_OK == res)
         {
-            break;
+            for (uint8_t i = 0; i < chunk; ++i)
+            {
+                const uint8_t * resp = &uart_buf[i * XENSIV_PASCO2_UART_READ_XFER_RESP_LEN];
+                data[done + i] = (uint8_t)((xensiv_pasco2_ascii_to_digit(resp[0]) << 4) + xensiv_pasco2_ascii_to_digit(resp[1]));
+            }
         }
 
-        reg_addr++;
+        done = (uint8_t)(done + chunk);
     }
 
     return res;
@@ -147,52 +256,70 @@ static int32_t xensiv_pasco2_uart_write(const xensiv_pasco2_t * dev, uint8_t reg
     xensiv_pasco2_plat_assert(dev->ctx != NULL);
     xensiv_pasco2_plat_assert(reg_addr <= XENSIV_PASCO2_REG_SENS_RST);
     xensiv_pasco2_plat_assert(data != NULL);
+    xensiv_pasco2_plat_assert((len > 0U) && (len <= XENSIV_PASCO2_UART_MAX_BURST_LEN));
 
+    /* Up to XENSIV_PASCO2_UART_CMDS_IN_FLIGHT per-byte write commands are sent back to back
+     * and acknowledged in order */
+    uint8_t uart_buf[XENSIV_PASCO2_UART_CMDS_IN_FLIGHT * XENSIV_PASCO2_UART_WRITE_XFER_BUF_SIZE];
     int32_t res = XENSIV_PASCO2_OK;
+    uint8_t done = 0U;
 
-    for (uint8_t i = 0; i < len; ++i)
+    /* If command triggers a software reset ignores the sensor response.
+     * SENS_RST is the last register, so this can only be the last byte */
+    bool soft_reset = (((uint32_t)reg_addr + len - 1U) == XENSIV_PASCO2_REG_SENS_RST) &&
+                      ((uint8_t)XENSIV_PASCO2_CMD_SOFT_RESET == data[len - 1U]);
+
+    while ((XENSIV_PASCO2_OK == res) && (done < len))
     {
-        uint8_t uart_buf[XENSIV_PASCO2_UART_WRITE_XFER_BUF_SIZE] =
+        uint8_t chunk = (uint8_t)(((uint32_t)len - done < XENSIV_PASCO2_UART_CMDS_IN_FLIGHT) ?
+                                  ((uint32_t)len - done) : XENSIV_PASCO2_UART_CMDS_IN_FLIGHT);
+        bool last = ((uint32_t)done + chunk) == len;
+        uint8_t acked = (last && soft_reset) ? (uint8_t)(chunk - 1U) : chunk;
+
+        for (uint8_t i = 0; i < chunk; ++i)
         {
-            (uint8_t)'w',
-            (uint8_t)',',
-            xensiv_pasco2_digit_to_ascii((reg_addr & 0xF0U) >> 4U), xensiv_pasco2_digit_to_ascii(reg_addr & 0x0FU),
-            (uint8_t)',',
-            xensiv_pasco2_digit_to_ascii((data[i] & 0xF0U) >> 4U), xensiv_pasco2_digit_to_ascii(data[i] & 0x0FU),
-            (uint8_t)'\n'
-        };
+            uint8_t * cmd = &uart_buf[i * XENSIV_PASCO2_UART_WRITE_XFER_BUF_SIZE];
+            uint8_t addr = (uint8_t)(reg_addr + done + i);
+            uint8_t val = data[done + i];
+
+            cmd[0] = (uint8_t)'w';
+            cmd[1] = (uint8_t)',';
+            cmd[2] = xensiv_pasco2_digit_to_ascii((addr & 0xF0U) >> 4U);
+            cmd[3] = xensiv_pasco2_digit_to_ascii(addr & 0x0FU);
+            cmd[4] = (uint8_t)',';
+            cmd[5] = xensiv_pasco2_digit_to_ascii((val & 0xF0U) >> 4U);
+            cmd[6] = xensiv_pasco2_digit_to_ascii(val & 0x0FU);
+            cmd[7] = (uint8_t)'\n';
+        }
 
-        res = xensiv_pasco2_plat_uart_write(dev->ctx, uart_buf, XENSIV_PASCO2_UART_WRITE_XFER_BUF_SIZE);
+        res = xensiv_pasco2_plat_uart_write(dev->ctx, uart_buf, (size_t)chunk * XENSIV_PASCO2_UART_WRITE_XFER_BUF_SIZE);
 
-        if (XENSIV_PASCO2_OK == res)
+        if ((XENSIV_PASCO2_OK == res) && (acked > 0U))
         {
-            res = xensiv_pasco2_plat_uart_read(dev->ctx, uart_buf, XENSIV_PASCO2_UART_WRITE_XFER_RESP_LEN);
+            res = xensiv_pasco2_plat_uart_read(dev->ctx, uart_buf, (size_t)acked * XENSIV_PASCO2_UART_WRITE_XFER_RESP_LEN);
 
-            /* If command triggers a software reset ignores the sensor response */
-            if ((XENSIV_PASCO2_REG_SENS_RST != reg_addr) || ((uint8_t)XENSIV_PASCO2_CMD_SOFT_RESET != data[i]))
+            for (uint8_t i = 0; (XENSIV_PASCO2_OK == res) && (i < acked); ++i)
             {
-                res = (XENSIV_PASCO2_OK == res) ?
-                      ((XENSIV_PASCO2_UART_ACK == uart_buf[0]) ? XENSIV_PASCO2_OK : XENSIV_PASCO2_ERR_COMM) :
+                res = (XENSIV_PASCO2_UART_ACK == uart_buf[i * XENSIV_PASCO2_UART_WRITE_XFER_RESP_LEN]) ?
+                      XENSIV_PASCO2_OK :
                       XENSIV_PASCO2_ERR_COMM;
             }
-            else
-            {
-                res = XENSIV_PASCO2_OK;
-            }
+
+            res = (XENSIV_PASCO2_OK == res) ? XENSIV_PASCO2_OK : XENSIV_PASCO2_ERR_COMM;
         }
 
-        if (XENSIV_PASCO2_OK != res)
+        if ((XENSIV_PASCO2_OK == res) && last && soft_reset)
         {
-            break;
+            (void)xensiv_pasco2_plat_uart_read(dev->ctx, uart_buf, XENSIV_PASCO2_UART_WRITE_XFER_RESP_LEN);
         }
 
-           reg_addr++;
+        done = (uint8_t)(done + chunk);
     }
 
     return res;
 }
 
-static int32_t xensiv_pasco2_init(const xensiv_pasco2_t * dev)
+static int32_t xensiv_pasco2_init(xensiv_pasco2_t * dev)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
@@ -208,9 +335,9 @@ static int32_t xensiv_pasco2_init(const xensiv_pasco2_t * dev)
 
     if ((XENSIV_PASCO2_OK == res) && (XENSIV_PASCO2_COMM_TEST_VAL == data))
     {
-        /* Soft reset */
+        /* Soft reset; the next access waits until the sensor has restarted */
         res = xensiv_pasco2_cmd(dev, XENSIV_PASCO2_CMD_SOFT_RESET);
-        xensiv_pasco2_plat_delay(XENSIV_PASCO2_SOFT_RESET_DELAY_MS);
+        xensiv_pasco2_set_bus_busy(dev, XENSIV_PASCO2_SOFT_RESET_DELAY_MS);
 
         if (XENSIV_PASCO2_OK == res)
         {
@@ -250,6 +377,65 @@ static int32_t xensiv_pasco2_init(const xensiv_pasco2_t * dev)
     return res;
 }
 
+/* Keeps a sensor that still runs with the configuration written by a previous warm init; initializes it otherwise */
+static int32_t xensiv_pasco2_init_warm(xensiv_pasco2_t * dev, uint8_t signature, uint16_t meas_rate, bool * warm)
+{
+    xensiv_pasco2_plat_assert(signature != XENSIV_PASCO2_COMM_TEST_VAL);
+    xensiv_pasco2_plat_assert((meas_rate >= XENSIV_PASCO2_MEAS_RATE_MIN) && (meas_rate <= XENSIV_PASCO2_MEAS_RATE_MAX));
+    xensiv_pasco2_plat_assert(warm != NULL);
+
+    *warm = false;
+
+    /* SENS_STS..MEAS_CFG; MEAS_STS is not read so that a pending result is not consumed */
+    uint8_t state[XENSIV_PASCO2_REG_MEAS_CFG - XENSIV_PASCO2_REG_SENS_STS + 1U];
+    uint8_t scratch = 0U;
+
+    int32_t res = xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SCRATCH_PAD, &scratch, 1U);
+
+    if ((XENSIV_PASCO2_OK == res) && (signature == scratch))
+    {
+        res = xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SENS_STS, state, (uint8_t)sizeof(state));
+
+        if (XENSIV_PASCO2_OK == res)
+        {
+            uint8_t sens_sts = state[0];
+            uint16_t rate = (uint16_t)(((uint16_t)state[1] << 8) | state[2]);
+            xensiv_pasco2_measurement_config_t meas_config = { .u = state[3] };
+
+            *warm = ((sens_sts & XENSIV_PASCO2_REG_SENS_STS_SEN_RDY_MSK) != 0U) &&
+                    ((sens_sts & (XENSIV_PASCO2_REG_SENS_STS_ICCER_MSK | XENSIV_PASCO2_REG_SENS_STS_ORVS_MSK | XENSIV_PASCO2_REG_SENS_STS_ORTMP_MSK)) == 0U) &&
+                    (XENSIV_PASCO2_OP_MODE_CONTINUOUS == meas_config.b.op_mode) &&
+                    (XENSIV_PASCO2_BOC_CFG_FORCED != meas_config.b.boc_cfg);
+
+            /* The period may have been adapted at runtime; changing it does not need a reset */
+            if (*warm && (meas_rate != rate))
+            {
+                res = xensiv_pasco2_start_continuous_mode(dev, meas_rate);
+            }
+        }
+    }
+
+    if (*warm)
+    {
+        return res;
+    }
+
+    res = xensiv_pasco2_init(dev);
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        res = xensiv_pasco2_start_continuous_mode(dev, meas_rate);
+    }
+
+    /* Written last, so that an interrupted initialization is not mistaken for a configured sensor */
+    if (XENSIV_PASCO2_OK == res)
+    {
+        res = xensiv_pasco2_set_scratch_pad(dev, signature);
+    }
+
+    return res;
+}
+
 int32_t xensiv_pasco2_init_i2c(xensiv_pasco2_t * dev, void * ctx)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
@@ -258,10 +444,28 @@ int32_t xensiv_pasco2_init_i2c(xensiv_pasco2_t * dev, void * ctx)
     dev->ctx = ctx;
     dev->read = xensiv_pasco2_i2c_read;
     dev->write = xensiv_pasco2_i2c_write;
+    dev->bus_ready_ms = xensiv_pasco2_plat_get_time_ms();
+    dev->shadow.enabled = false;
+    dev->shadow.valid = 0U;
 
     return xensiv_pasco2_init(dev);
 }
 
+int32_t xensiv_pasco2_init_i2c_warm(xensiv_pasco2_t * dev, void * ctx, uint8_t signature, uint16_t meas_rate, bool * warm)
+{
+    xensiv_pasco2_plat_assert(dev != NULL);
+    xensiv_pasco2_plat_assert(ctx != NULL);
+
+    dev->ctx = ctx;
+    dev->read = xensiv_pasco2_i2c_read;
+    dev->write = xensiv_pasco2_i2c_write;
+    dev->bus_ready_ms = xensiv_pasco2_plat_get_time_ms();
+    dev->shadow.enabled = false;
+    dev->shadow.valid = 0U;
+
+    return xensiv_pasco2_init_warm(dev, signature, meas_rate, warm);
+}
+
 int32_t xensiv_pasco2_init_uart(xensiv_pasco2_t * dev, void * ctx)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
@@ -270,33 +474,139 @@ int32_t xensiv_pasco2_init_uart(xensiv_pasco2_t * dev, void * ctx)
     dev->ctx = ctx;
     dev->read = xensiv_pasco2_uart_read;
     dev->write = xensiv_pasco2_uart_write;
+    dev->bus_ready_ms = xensiv_pasco2_plat_get_time_ms();
+    dev->shadow.enabled = false;
+    dev->shadow.valid = 0U;
 
     return xensiv_pasco2_init(dev);
 }
 
-int32_t xensiv_pasco2_set_reg(const xensiv_pasco2_t * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len)
+int32_t xensiv_pasco2_init_uart_warm(xensiv_pasco2_t * dev, void * ctx, uint8_t signature, uint16_t meas_rate, bool * warm)
+{
+    xensiv_pasco2_plat_assert(dev != NULL);
+    xensiv_pasco2_plat_assert(ctx != NULL);
+
+    dev->ctx = ctx;
+    dev->read = xensiv_pasco2_uart_read;
+    dev->write = xensiv_pasco2_uart_write;
+    dev->bus_ready_ms = xensiv_pasco2_plat_get_time_ms();
+    dev->shadow.enabled = false;
+    dev->shadow.valid = 0U;
+
+    return xensiv_pasco2_init_warm(dev, signature, meas_rate, warm);
+}
+
+int32_t xensiv_pasco2_set_reg(xensiv_pasco2_t * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(data != NULL);
 
+    uint8_t idx = xensiv_pasco2_shadow_find(reg_addr, len);
+
+    if (dev->shadow.enabled && (idx < (uint8_t)XENSIV_PASCO2_SHADOW_COUNT) && ((dev->shadow.valid & (1U << idx)) != 0U))
+    {
+        bool same = true;
+        for (uint8_t i = 0U; i < len; ++i)
+        {
+            same = same && (dev->shadow.val[idx][i] == data[i]);
+        }
+
+        if (same)
+        {
+            /* The sensor already holds this value */
+            dev->shadow.hits[idx]++;
+            return XENSIV_PASCO2_OK;
+        }
+    }
+
+    xensiv_pasco2_wait_bus_ready(dev);
     int32_t res = dev->write(dev, reg_addr, data, len);
-    xensiv_pasco2_plat_delay(XENSIV_PASCO2_COMM_DELAY_MS);
+    xensiv_pasco2_set_bus_busy(dev, XENSIV_PASCO2_COMM_DELAY_MS);
+
+    if (dev->shadow.enabled && (idx < (uint8_t)XENSIV_PASCO2_SHADOW_COUNT))
+    {
+        dev->shadow.misses[idx]++;
+    }
+    xensiv_pasco2_sync_shadow(dev, reg_addr, data, len, XENSIV_PASCO2_OK == res);
 
     return res;
 }
 
-int32_t xensiv_pasco2_get_reg(const xensiv_pasco2_t * dev, uint8_t reg_addr, uint8_t * data, uint8_t len)
+int32_t xensiv_pasco2_get_reg(xensiv_pasco2_t * dev, uint8_t reg_addr, uint8_t * data, uint8_t len)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(data != NULL);
 
+    uint8_t idx = xensiv_pasco2_shadow_find(reg_addr, len);
+
+    if (dev->shadow.enabled && (idx < (uint8_t)XENSIV_PASCO2_SHADOW_COUNT) && ((dev->shadow.valid & (1U << idx)) != 0U))
+    {
+        for (uint8_t i = 0U; i < len; ++i)
+        {
+            data[i] = dev->shadow.val[idx][i];
+        }
+        dev->shadow.hits[idx]++;
+        return XENSIV_PASCO2_OK;
+    }
+
+    xensiv_pasco2_wait_bus_ready(dev);
     int32_t res = dev->read(dev, reg_addr, data, len);
-    xensiv_pasco2_plat_delay(XENSIV_PASCO2_COMM_DELAY_MS);
+    xensiv_pasco2_set_bus_busy(dev, XENSIV_PASCO2_COMM_DELAY_MS);
+
+    if (dev->shadow.enabled)
+    {
+        if (idx < (uint8_t)XENSIV_PASCO2_SHADOW_COUNT)
+        {
+            dev->shadow.misses[idx]++;
+        }
+        xensiv_pasco2_shadow_update(dev, reg_addr, data, len, XENSIV_PASCO2_OK == res);
+    }
 
     return res;
 }
 
-int32_t xensiv_pasco2_get_id(const xensiv_pasco2_t * dev, xensiv_pasco2_id_t * id)
+void xensiv_pasco2_enable_shadow(xensiv_pasco2_t * dev, bool enable)
+{
+    xensiv_pasco2_plat_assert(dev != NULL);
+
+    dev->shadow.enabled = enable;
+    dev->shadow.valid = 0U;
+
+    for (uint8_t idx = 0U; idx < (uint8_t)XENSIV_PASCO2_SHADOW_COUNT; ++idx)
+    {
+        dev->shadow.hits[idx] = 0U;
+        dev->shadow.misses[idx] = 0U;
+    }
+}
+
+void xensiv_pasco2_sync_shadow(xensiv_pasco2_t * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len, bool success)
+{
+    xensiv_pasco2_plat_assert(dev != NULL);
+    xensiv_pasco2_plat_assert(data != NULL);
+
+    if (((uint8_t)XENSIV_PASCO2_REG_SENS_RST == reg_addr) && ((uint8_t)XENSIV_PASCO2_CMD_SOFT_RESET == data[0]))
+    {
+        /* Soft reset restores the default configuration */
+        dev->shadow.valid = 0U;
+    }
+    else if (dev->shadow.enabled)
+    {
+        xensiv_pasco2_shadow_update(dev, reg_addr, data, len, success);
+    }
+    else
+    {
+        /* Nothing to keep in sync while disabled */
+    }
+}
+
+void xensiv_pasco2_invalidate_shadow(xensiv_pasco2_t * dev)
+{
+    xensiv_pasco2_plat_assert(dev != NULL);
+
+    dev->shadow.valid = 0U;
+}
+
+int32_t xensiv_pasco2_get_id(xensiv_pasco2_t * dev, xensiv_pasco2_id_t * id)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(id != NULL);
@@ -304,7 +614,7 @@ int32_t xensiv_pasco2_get_id(const xensiv_pasco2_t * dev, xensiv_pasco2_id_t * i
     return xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_PROD_ID, &(id->u), 1U);
 }
 
-int32_t xensiv_pasco2_get_status(const xensiv_pasco2_t * dev, xensiv_pasco2_status_t * status)
+int32_t xensiv_pasco2_get_status(xensiv_pasco2_t * dev, xensiv_pasco2_status_t * status)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(status != NULL);
@@ -312,14 +622,14 @@ int32_t xensiv_pasco2_get_status(const xensiv_pasco2_t * dev, xensiv_pasco2_stat
     return xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SENS_STS, &(status->u), 1U);
 }
 
-int32_t xensiv_pasco2_clear_status(const xensiv_pasco2_t * dev, uint8_t mask)
+int32_t xensiv_pasco2_clear_status(xensiv_pasco2_t * dev, uint8_t mask)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SENS_STS, &mask, 1U);
 }
 
-int32_t xensiv_pasco2_get_interrupt_config(const xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t * int_config)
+int32_t xensiv_pasco2_get_interrupt_config(xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t * int_config)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(int_config != NULL);
@@ -327,14 +637,14 @@ int32_t xensiv_pasco2_get_interrupt_config(const xensiv_pasco2_t * dev, xensiv_p
     return xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_INT_CFG, &(int_config->u), 1U);
 }
 
-int32_t xensiv_pasco2_set_interrupt_config(const xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t int_config)
+int32_t xensiv_pasco2_set_interrupt_config(xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t int_config)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_INT_CFG, &(int_config.u), 1U);
 }
 
-int32_t xensiv_pasco2_get_measurement_config(const xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t * meas_config)
+int32_t xensiv_pasco2_get_measurement_config(xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t * meas_config)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(meas_config != NULL);
@@ -342,14 +652,14 @@ int32_t xensiv_pasco2_get_measurement_config(const xensiv_pasco2_t * dev, xensiv
     return xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_MEAS_CFG, &(meas_config->u), 1U);
 }
 
-int32_t xensiv_pasco2_set_measurement_config(const xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t meas_config)
+int32_t xensiv_pasco2_set_measurement_config(xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t meas_config)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_MEAS_CFG, &(meas_config.u), 1U);
 }
 
-int32_t xensiv_pasco2_get_result(const xensiv_pasco2_t * dev, uint16_t * val)
+int32_t xensiv_pasco2_get_result(xensiv_pasco2_t * dev, uint16_t * val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(val != NULL);
@@ -373,7 +683,34 @@ int32_t xensiv_pasco2_get_result(const xensiv_pasco2_t * dev, uint16_t * val)
     return res;
 }
 
-int32_t xensiv_pasco2_set_measurement_rate(const xensiv_pasco2_t * dev, uint16_t val)
+int32_t xensiv_pasco2_get_result_ex(xensiv_pasco2_t * dev, xensiv_pasco2_result_t * result)
+{
+    xensiv_pasco2_plat_assert(dev != NULL);
+    xensiv_pasco2_plat_assert(result != NULL);
+
+    uint8_t buf[XENSIV_PASCO2_RESULT_WINDOW_LEN];
+    int32_t res = xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SENS_STS, buf, (uint8_t)XENSIV_PASCO2_RESULT_WINDOW_LEN);
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        result->sens_status.u = buf[XENSIV_PASCO2_REG_SENS_STS - XENSIV_PASCO2_REG_SENS_STS];
+        result->meas_rate = (uint16_t)(((uint16_t)buf[XENSIV_PASCO2_REG_MEAS_RATE_H - XENSIV_PASCO2_REG_SENS_STS] << 8) |
+                                        buf[XENSIV_PASCO2_REG_MEAS_RATE_L - XENSIV_PASCO2_REG_SENS_STS]);
+        result->meas_config.u = buf[XENSIV_PASCO2_REG_MEAS_CFG - XENSIV_PASCO2_REG_SENS_STS];
+        result->co2_ppm = (uint16_t)(((uint16_t)buf[XENSIV_PASCO2_REG_CO2PPM_H - XENSIV_PASCO2_REG_SENS_STS] << 8) |
+                                      buf[XENSIV_PASCO2_REG_CO2PPM_L - XENSIV_PASCO2_REG_SENS_STS]);
+        result->meas_status.u = buf[XENSIV_PASCO2_REG_MEAS_STS - XENSIV_PASCO2_REG_SENS_STS];
+
+        if (result->meas_status.b.drdy == 0U)
+        {
+            res = XENSIV_PASCO2_READ_NRDY;
+        }
+    }
+
+    return res;
+}
+
+int32_t xensiv_pasco2_set_measurement_rate(xensiv_pasco2_t * dev, uint16_t val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert((val >= XENSIV_PASCO2_MEAS_RATE_MIN) && (val <= XENSIV_PASCO2_MEAS_RATE_MAX));
@@ -382,7 +719,7 @@ int32_t xensiv_pasco2_set_measurement_rate(const xensiv_pasco2_t * dev, uint16_t
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_MEAS_RATE_H, (uint8_t *)&val, 2U);
 }
 
-int32_t xensiv_pasco2_get_measurement_status(const xensiv_pasco2_t * dev, xensiv_pasco2_meas_status_t * status)
+int32_t xensiv_pasco2_get_measurement_status(xensiv_pasco2_t * dev, xensiv_pasco2_meas_status_t * status)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(status != NULL);
@@ -390,14 +727,14 @@ int32_t xensiv_pasco2_get_measurement_status(const xensiv_pasco2_t * dev, xensiv
     return xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_MEAS_STS, &(status->u), 1U);
 }
 
-int32_t xensiv_pasco2_clear_measurement_status(const xensiv_pasco2_t * dev, uint8_t mask)
+int32_t xensiv_pasco2_clear_measurement_status(xensiv_pasco2_t * dev, uint8_t mask)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_MEAS_STS, &mask, 1U);
 }
 
-int32_t xensiv_pasco2_set_alarm_threshold(const xensiv_pasco2_t * dev, uint16_t val)
+int32_t xensiv_pasco2_set_alarm_threshold(xensiv_pasco2_t * dev, uint16_t val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
@@ -405,7 +742,7 @@ int32_t xensiv_pasco2_set_alarm_threshold(const xensiv_pasco2_t * dev, uint16_t
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_ALARM_TH_H, (uint8_t *)&val, 2U);
 }
 
-int32_t xensiv_pasco2_set_pressure_compensation(const xensiv_pasco2_t * dev, uint16_t val)
+int32_t xensiv_pasco2_set_pressure_compensation(xensiv_pasco2_t * dev, uint16_t val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
@@ -413,7 +750,7 @@ int32_t xensiv_pasco2_set_pressure_compensation(const xensiv_pasco2_t * dev, uin
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_PRESS_REF_H, (uint8_t *)&val, 2U);
 }
 
-int32_t xensiv_pasco2_set_offset_compensation(const xensiv_pasco2_t * dev, uint16_t val)
+int32_t xensiv_pasco2_set_offset_compensation(xensiv_pasco2_t * dev, uint16_t val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
@@ -421,14 +758,14 @@ int32_t xensiv_pasco2_set_offset_compensation(const xensiv_pasco2_t * dev, uint1
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_CALIB_REF_H, (uint8_t *)&val, 2U);
 }
 
-int32_t xensiv_pasco2_set_scratch_pad(const xensiv_pasco2_t * dev, uint8_t val)
+int32_t xensiv_pasco2_set_scratch_pad(xensiv_pasco2_t * dev, uint8_t val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SCRATCH_PAD, &val, 1U);
 }
 
-int32_t xensiv_pasco2_get_scratch_pad(const xensiv_pasco2_t * dev, uint8_t * val)
+int32_t xensiv_pasco2_get_scratch_pad(xensiv_pasco2_t * dev, uint8_t * val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert(val != NULL);
@@ -436,14 +773,14 @@ int32_t xensiv_pasco2_get_scratch_pad(const xensiv_pasco2_t * dev, uint8_t * val
     return xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SCRATCH_PAD, val, 1U);
 }
 
-int32_t xensiv_pasco2_cmd(const xensiv_pasco2_t * dev, xensiv_pasco2_cmd_t cmd)
+int32_t xensiv_pasco2_cmd(xensiv_pasco2_t * dev, xensiv_pasco2_cmd_t cmd)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
     return xensiv_pasco2_set_reg(dev, (uint8_t)XENSIV_PASCO2_REG_SENS_RST, (const uint8_t * )&cmd, 1U);
 }
 
-int32_t xensiv_pasco2_start_single_mode(const xensiv_pasco2_t * dev)
+int32_t xensiv_pasco2_start_single_mode(xensiv_pasco2_t * dev)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
@@ -469,7 +806,7 @@ int32_t xensiv_pasco2_start_single_mode(const xensiv_pasco2_t * dev)
     return res;
 }
 
-int32_t xensiv_pasco2_start_continuous_mode(const xensiv_pasco2_t * dev, uint16_t val)
+int32_t xensiv_pasco2_start_continuous_mode(xensiv_pasco2_t * dev, uint16_t val)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
     xensiv_pasco2_plat_assert((val >= XENSIV_PASCO2_MEAS_RATE_MIN) && (val <= XENSIV_PASCO2_MEAS_RATE_MAX));
@@ -502,7 +839,7 @@ int32_t xensiv_pasco2_start_continuous_mode(const xensiv_pasco2_t * dev, uint16_
     return res;
 }
 
-int32_t xensiv_pasco2_perform_forced_compensation(const xensiv_pasco2_t * dev, uint16_t co2_ref)
+int32_t xensiv_pasco2_perform_forced_compensation(xensiv_pasco2_t * dev, uint16_t co2_ref)
 {
     xensiv_pasco2_plat_assert(dev != NULL);
 
@@ -534,11 +871,20 @@ int32_t xensiv_pasco2_perform_forced_compensation(const xensiv_pasco2_t * dev, u
 
     if (XENSIV_PASCO2_OK == res)
     {
-        /* wait until the FCS is finished */
+        /* wait until the FCS is finished; the polls are counted rather than timed, as the time base
+         * is constant without an RTOS */
+        uint32_t polls = 0U;
         do
         {
+            xensiv_pasco2_plat_delay(XENSIV_PASCO2_FCS_POLL_MS);
+            polls++;
             res = xensiv_pasco2_get_measurement_config(dev, &meas_config);
-        } while ((XENSIV_PASCO2_OK != res) || (XENSIV_PASCO2_BOC_CFG_FORCED == meas_config.b.boc_cfg));
+            if ((XENSIV_PASCO2_OK == res) && (XENSIV_PASCO2_BOC_CFG_FORCED == meas_config.b.boc_cfg) &&
+                (polls >= (XENSIV_PASCO2_FCS_TIMEOUT_MS / XENSIV_PASCO2_FCS_POLL_MS)))
+            {
+                res = XENSIV_PASCO2_ERR_FCS_TIMEOUT;
+            }
+        } while ((XENSIV_PASCO2_OK == res) && (XENSIV_PASCO2_BOC_CFG_FORCED == meas_config.b.boc_cfg));
     }
 
     if (XENSIV_PASCO2_OK == res)
@@ -554,3 +900,169 @@ int32_t xensiv_pasco2_perform_forced_compensation(const xensiv_pasco2_t * dev, u
 
     return res;
 }
+
+/* Leaves the FCS: the sensor is put in idle mode, optionally the new offset is saved,
+ * then the measurement rate and the configuration active before the job are restored */
+static int32_t xensiv_pasco2_fcs_restore(xensiv_pasco2_fcs_job_t * job, bool save)
+{
+    xensiv_pasco2_measurement_config_t meas_config = job->saved_config;
+    meas_config.b.op_mode = XENSIV_PASCO2_OP_MODE_IDLE;
+    int32_t res = xensiv_pasco2_set_measurement_config(job->dev, meas_config);
+
+    if ((XENSIV_PASCO2_OK == res) && save)
+    {
+        res = xensiv_pasco2_cmd(job->dev, XENSIV_PASCO2_CMD_SAVE_FCS_CALIB_OFFSET);
+    }
+
+    if ((XENSIV_PASCO2_OK == res) &&
+        (job->saved_rate >= XENSIV_PASCO2_MEAS_RATE_MIN) && (job->saved_rate <= XENSIV_PASCO2_MEAS_RATE_MAX))
+    {
+        res = xensiv_pasco2_set_measurement_rate(job->dev, job->saved_rate);
+    }
+
+    /* A single measurement would not be repeated by the sensor, so only continuous mode is resumed */
+    if ((XENSIV_PASCO2_OK == res) && (XENSIV_PASCO2_OP_MODE_CONTINUOUS == job->saved_config.b.op_mode))
+    {
+        res = xensiv_pasco2_set_measurement_config(job->dev, job->saved_config);
+    }
+
+    return res;
+}
+
+static void xensiv_pasco2_fcs_report(xensiv_pasco2_fcs_job_t * job, xensiv_pasco2_fcs_event_t event, int32_t res)
+{
+    if (job->callback != NULL)
+    {
+        job->callback(job->callback_arg, event, xensiv_pasco2_plat_get_time_ms() - job->start_ms, res);
+    }
+}
+
+int32_t xensiv_pasco2_fcs_start(xensiv_pasco2_fcs_job_t * job, xensiv_pasco2_t * dev, uint16_t co2_ref,
+                                xensiv_pasco2_fcs_cb_t callback, void * callback_arg)
+{
+    xensiv_pasco2_plat_assert(job != NULL);
+    xensiv_pasco2_plat_assert(dev != NULL);
+
+    job->dev = dev;
+    job->active = false;
+    job->callback = callback;
+    job->callback_arg = callback_arg;
+
+    uint16_t rate;
+    bool saved = false;
+    int32_t res = xensiv_pasco2_get_measurement_config(dev, &job->saved_config);
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        res = xensiv_pasco2_get_reg(dev, (uint8_t)XENSIV_PASCO2_REG_MEAS_RATE_H, (uint8_t *)&rate, 2U);
+        job->saved_rate = xensiv_pasco2_plat_htons(rate);
+        saved = (XENSIV_PASCO2_OK == res);
+    }
+
+    xensiv_pasco2_measurement_config_t meas_config = job->saved_config;
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        meas_config.b.op_mode = XENSIV_PASCO2_OP_MODE_IDLE;
+        res = xensiv_pasco2_set_measurement_config(dev, meas_config);
+    }
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        res = xensiv_pasco2_set_measurement_rate(dev, XENSIV_PASCO2_FCS_MEAS_RATE_S);
+    }
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        res = xensiv_pasco2_set_offset_compensation(dev, co2_ref);
+    }
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        meas_config.b.op_mode = XENSIV_PASCO2_OP_MODE_CONTINUOUS;
+        meas_config.b.boc_cfg = XENSIV_PASCO2_BOC_CFG_FORCED;
+        res = xensiv_pasco2_set_measurement_config(dev, meas_config);
+    }
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        job->start_ms = xensiv_pasco2_plat_get_time_ms();
+        job->next_poll_ms = job->start_ms + XENSIV_PASCO2_FCS_POLL_MS;
+        job->active = true;
+    }
+    else if (saved)
+    {
+        /* Do not leave the sensor idle or half configured; the error of the start is reported */
+        (void)xensiv_pasco2_fcs_restore(job, false);
+    }
+    else
+    {
+        /* Nothing was changed */
+    }
+
+    return res;
+}
+
+uint32_t xensiv_pasco2_fcs_step(xensiv_pasco2_fcs_job_t * job)
+{
+    xensiv_pasco2_plat_assert(job != NULL);
+
+    if (!job->active)
+    {
+        return XENSIV_PASCO2_FCS_IDLE;
+    }
+
+    int32_t remaining = (int32_t)(job->next_poll_ms - xensiv_pasco2_plat_get_time_ms());
+    if (remaining > 0)
+    {
+        return (uint32_t)remaining;
+    }
+
+    xensiv_pasco2_measurement_config_t meas_config;
+    int32_t res = xensiv_pasco2_get_measurement_config(job->dev, &meas_config);
+
+    if ((XENSIV_PASCO2_OK == res) && (XENSIV_PASCO2_BOC_CFG_FORCED == meas_config.b.boc_cfg))
+    {
+        if ((xensiv_pasco2_plat_get_time_ms() - job->start_ms) < XENSIV_PASCO2_FCS_TIMEOUT_MS)
+        {
+            xensiv_pasco2_fcs_report(job, XENSIV_PASCO2_FCS_EVENT_PROGRESS, XENSIV_PASCO2_OK);
+            job->next_poll_ms += XENSIV_PASCO2_FCS_POLL_MS;
+            return XENSIV_PASCO2_FCS_POLL_MS;
+        }
+
+        res = XENSIV_PASCO2_ERR_FCS_TIMEOUT;
+    }
+
+    job->active = false;
+
+    if (XENSIV_PASCO2_OK == res)
+    {
+        res = xensiv_pasco2_fcs_restore(job, true);
+    }
+    else
+    {
+        /* Leave the FCS without saving, but keep the original error */
+        (void)xensiv_pasco2_fcs_restore(job, false);
+    }
+
+    xensiv_pasco2_fcs_report(job, (XENSIV_PASCO2_OK == res) ? XENSIV_PASCO2_FCS_EVENT_DONE : XENSIV_PASCO2_FCS_EVENT_ERROR, res);
+
+    return XENSIV_PASCO2_FCS_IDLE;
+}
+
+int32_t xensiv_pasco2_fcs_cancel(xensiv_pasco2_fcs_job_t * job)
+{
+    xensiv_pasco2_plat_assert(job != NULL);
+
+    if (!job->active)
+    {
+        return XENSIV_PASCO2_OK;
+    }
+
+    job->active = false;
+
+    int32_t res = xensiv_pasco2_fcs_restore(job, false);
+    xensiv_pasco2_fcs_report(job, XENSIV_PASCO2_FCS_EVENT_CANCELLED, res);
+
+    return res;
+}
@@ -42,6 +42,7 @@
  * - \ref xensiv_pasco2_plat_i2c_transfer implementation must be provided when using the I2C interface.
  * - \ref xensiv_pasco2_plat_uart_read, \ref xensiv_pasco2_plat_uart_write implementation must be provided when using the UART interface.
  * - \ref xensiv_pasco2_plat_delay implementation must be provided that delays the processing for a certain number of milliseconds.
+ * - \ref xensiv_pasco2_plat_get_time_ms implementation must be provided that returns a free-running millisecond time base.
  * - \ref xensiv_pasco2_plat_htons implementation must be provided for byte reversing.
  * - \ref xensiv_pasco2_plat_assert implementation must be provided for runtime assertion.
  *
@@ -67,6 +68,8 @@
 #define XENSIV_PASCO2_ORTMP                     (6)
 /** Result code indicating that a new CO2 value is not yet ready */
 #define XENSIV_PASCO2_READ_NRDY                 (7)
+/** Result code indicating that the sensor did not complete the forced compensation in time */
+#define XENSIV_PASCO2_ERR_FCS_TIMEOUT           (8)
 
 /** Minimum allowed measurement rate */
 #define XENSIV_PASCO2_MEAS_RATE_MIN             (5U)
@@ -77,6 +80,18 @@
 /** I2C address of the XENSIV™ PASCO2 sensor */
 #define XENSIV_PASCO2_I2C_ADDR                  (0x28U)
 
+/** Minimum time in milliseconds between two consecutive commands to the sensor */
+#define XENSIV_PASCO2_COMM_DELAY_MS             (5U)
+
+/** Interval in milliseconds at which a running forced compensation is polled for completion */
+#define XENSIV_PASCO2_FCS_POLL_MS               (1000U)
+
+/** Longest time in milliseconds the sensor is given to complete a forced compensation */
+#define XENSIV_PASCO2_FCS_TIMEOUT_MS            (180000U)
+
+/** Returned by \ref xensiv_pasco2_fcs_step when no forced compensation job is running */
+#define XENSIV_PASCO2_FCS_IDLE                  (0xFFFFFFFFUL)
+
 /********************************* Type definitions **************************************/
 
 /** Enum defining the different device commands */
@@ -131,6 +146,18 @@ typedef enum
                                                              @note This function is available only in continuous mode */
 } xensiv_pasco2_interrupt_function_t;
 
+/** Enum defining the configuration registers mirrored by the shadow register cache */
+typedef enum
+{
+    XENSIV_PASCO2_SHADOW_MEAS_CFG = 0U,                 /**< Measurement configuration (MEAS_CFG) */
+    XENSIV_PASCO2_SHADOW_MEAS_RATE = 1U,                /**< Measurement period (MEAS_RATE_H/L) */
+    XENSIV_PASCO2_SHADOW_PRESS_REF = 2U,                /**< Pressure compensation (PRESS_REF_H/L) */
+    XENSIV_PASCO2_SHADOW_ALARM_TH = 3U,                 /**< Alarm threshold (ALARM_TH_H/L) */
+    XENSIV_PASCO2_SHADOW_INT_CFG = 4U,                  /**< Interrupt configuration (INT_CFG) */
+    XENSIV_PASCO2_SHADOW_CALIB_REF = 5U,                /**< Offset compensation reference (CALIB_REF_H/L) */
+    XENSIV_PASCO2_SHADOW_COUNT = 6U                     /**< Number of shadowed registers */
+} xensiv_pasco2_shadow_reg_t;
+
 /** Enum defining whether an alarm is issued in the case of a lower or higher threshold violation */
 typedef enum
 {
@@ -206,6 +233,16 @@ typedef union
   uint8_t u;                                            /*!< Type used for byte access */
 } xensiv_pasco2_meas_status_t;
 
+/** Structure of the contiguous register window SENS_STS..MEAS_STS fetched in a single bus transaction by \ref xensiv_pasco2_get_result_ex */
+typedef struct
+{
+    xensiv_pasco2_status_t sens_status;                 /*!< Sensor status (SENS_STS) */
+    uint16_t meas_rate;                                 /*!< Measurement period in seconds (MEAS_RATE_H/L) */
+    xensiv_pasco2_measurement_config_t meas_config;     /*!< Measurement configuration (MEAS_CFG) */
+    uint16_t co2_ppm;                                   /*!< CO2 concentration in ppm (CO2PPM_H/L); valid only if meas_status.b.drdy is set */
+    xensiv_pasco2_meas_status_t meas_status;            /*!< Measurement status (MEAS_STS) */
+} xensiv_pasco2_result_t;
+
 struct xensiv_pasco2_s;                                   /* Forward declaration */
 
 /* Function pointer to the platform-specific function for reading the sensor registers via I2C/UART */
@@ -214,14 +251,51 @@ typedef int32_t (*xensiv_pasco2_read_fptr_t)(const struct xensiv_pasco2_s * dev,
 /* Function pointer to the platform-specific function for writing  the sensor registers via I2C/UART */
 typedef int32_t (*xensiv_pasco2_write_fptr_t)(const struct xensiv_pasco2_s * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len);
 
+/** Structure of the write-through shadow of the sensor configuration registers, see \ref xensiv_pasco2_enable_shadow */
+typedef struct
+{
+    bool enabled;                                       /*!< Shadow is consulted on register accesses */
+    uint8_t valid;                                      /*!< Bit mask of \ref xensiv_pasco2_shadow_reg_t entries holding the register contents */
+    uint8_t val[XENSIV_PASCO2_SHADOW_COUNT][2];         /*!< Register contents in bus order */
+    uint32_t hits[XENSIV_PASCO2_SHADOW_COUNT];          /*!< Accesses served from the shadow or skipped as redundant writes */
+    uint32_t misses[XENSIV_PASCO2_SHADOW_COUNT];        /*!< Accesses that had to go to the sensor */
+} xensiv_pasco2_shadow_t;
+
+/** Enum defining the events reported by a forced compensation job, see \ref xensiv_pasco2_fcs_start */
+typedef enum
+{
+    XENSIV_PASCO2_FCS_EVENT_PROGRESS = 0U,              /**< The sensor is still computing the offset */
+    XENSIV_PASCO2_FCS_EVENT_DONE = 1U,                  /**< The offset was computed and saved into the non volatile memory */
+    XENSIV_PASCO2_FCS_EVENT_CANCELLED = 2U,             /**< The job was cancelled; the saved offset is unchanged */
+    XENSIV_PASCO2_FCS_EVENT_ERROR = 3U                  /**< The job failed; res holds the reason */
+} xensiv_pasco2_fcs_event_t;
+
+/** Forced compensation job callback; elapsed_ms is the time since \ref xensiv_pasco2_fcs_start */
+typedef void (*xensiv_pasco2_fcs_cb_t)(void * arg, xensiv_pasco2_fcs_event_t event, uint32_t elapsed_ms, int32_t res);
+
 /** Structure of the XENSIV™ PAS CO2 sensor device. Initialized using \ref xensiv_pasco2_init_i2c or \ref xensiv_pasco2_init_uart */
 typedef struct xensiv_pasco2_s
 {
     void * ctx;                         /*!< Context for I2C/UART platform-specific read and write functions */
     xensiv_pasco2_read_fptr_t read;     /*!< Pointer to the register read function which depends on the communication interface used */
     xensiv_pasco2_write_fptr_t write;   /*!< Pointer to the register write function which depends on the communication interface used */
+    uint32_t bus_ready_ms;              /*!< Time (\ref xensiv_pasco2_plat_get_time_ms) before which the sensor must not receive the next command */
+    xensiv_pasco2_shadow_t shadow;      /*!< Shadow of the configuration registers */
 } xensiv_pasco2_t;
 
+/** Structure of a non-blocking forced compensation job. Started using \ref xensiv_pasco2_fcs_start */
+typedef struct
+{
+    xensiv_pasco2_t * dev;                              /*!< Sensor device being calibrated */
+    bool active;                                        /*!< The job is running */
+    uint16_t saved_rate;                                /*!< Measurement rate restored at the end of the job */
+    xensiv_pasco2_measurement_config_t saved_config;    /*!< Measurement configuration restored at the end of the job */
+    uint32_t start_ms;                                  /*!< Start time of the job */
+    uint32_t next_poll_ms;                              /*!< Time of the next completion check */
+    xensiv_pasco2_fcs_cb_t callback;                    /*!< Progress and completion callback; can be NULL */
+    void * callback_arg;                                /*!< Argument passed to the callback */
+} xensiv_pasco2_fcs_job_t;
+
 /******************************* Function prototypes *************************************/
 
 #ifdef __cplusplus
@@ -250,6 +324,40 @@ int32_t xensiv_pasco2_init_i2c(xensiv_pasco2_t * dev, void *ctx);
  */
 int32_t xensiv_pasco2_init_uart(xensiv_pasco2_t * dev, void *ctx);
 
+/**
+ * @brief Initializes the XENSIV™ PAS CO2 device using the I2C interface, keeping a sensor that is still running.
+ * The sensor is kept running if the scratch pad holds the signature, no error is flagged in the sensor status and
+ * it measures in continuous mode without a pending forced compensation; only a different measurement rate is
+ * changed to meas_rate. This is the case after a reset of the host while the sensor stayed powered, and saves
+ * the soft reset and its delay.
+ * Otherwise the sensor is initialized as by \ref xensiv_pasco2_init_i2c, continuous mode is started at meas_rate
+ * and the signature is written to the scratch pad.
+ *
+ * @param[inout] dev Pointer to a XENSIV™ PAS CO2 sensor device structure allocated by the user,
+ * but the init function will initialize its contents
+ * @param[in] ctx Pointer to the platform-specific I2C communication handler
+ * @param[in] signature Scratch pad value identifying a sensor configured by this function; must differ from
+ * the value used by the communication check (0xA5)
+ * @param[in] meas_rate Measurement rate to run at [5-4095s]
+ * @param[out] warm Set to true if the running sensor was kept; false if it was reset
+ * @return XENSIV_PASCO2_OK if the initialization was successful; an error indicating what went wrong otherwise
+ */
+int32_t xensiv_pasco2_init_i2c_warm(xensiv_pasco2_t * dev, void * ctx, uint8_t signature, uint16_t meas_rate, bool * warm);
+
+/**
+ * @brief Initializes the XENSIV™ PAS CO2 device using the UART interface, keeping a sensor that is still running.
+ * See \ref xensiv_pasco2_init_i2c_warm
+ *
+ * @param[inout] dev Pointer to a XENSIV™ PAS CO2 sensor device structure allocated by the user,
+ * but the init function will initialize its contents
+ * @param[in] ctx Pointer to the platform-specific UART communication handler
+ * @param[in] signature Scratch pad value identifying a sensor configured by this function
+ * @param[in] meas_rate Measurement rate to run at [5-4095s]
+ * @param[out] warm Set to true if the running sensor was kept; false if it was reset
+ * @return XENSIV_PASCO2_OK if the initialization was successful; an error indicating what went wrong otherwise
+ */
+int32_t xensiv_pasco2_init_uart_warm(xensiv_pasco2_t * dev, void * ctx, uint8_t signature, uint16_t meas_rate, bool * warm);
+
 /**
  * @brief Writes the given data buffer into the sensor device.
  * Writes the given data buffer to the sensor register map starting at the register address
@@ -260,7 +368,7 @@ int32_t xensiv_pasco2_init_uart(xensiv_pasco2_t * dev, void *ctx);
  * @param[in] len Number of bytes of data to be written
  * @return XENSIV_PASCO2_OK if writing to the register was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_reg(const xensiv_pasco2_t * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len);
+int32_t xensiv_pasco2_set_reg(xensiv_pasco2_t * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len);
 
 /**
  * @brief Reads from the sensor device into the given data buffer.
@@ -272,7 +380,42 @@ int32_t xensiv_pasco2_set_reg(const xensiv_pasco2_t * dev, uint8_t reg_addr, con
  * @param[in] len Number of bytes of data to be read
  * @return XENSIV_PASCO2_OK if reading from the register was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_reg(const xensiv_pasco2_t * dev, uint8_t reg_addr, uint8_t * data, uint8_t len);
+int32_t xensiv_pasco2_get_reg(xensiv_pasco2_t * dev, uint8_t reg_addr, uint8_t * data, uint8_t len);
+
+/**
+ * @brief Enables or disables the write-through shadow of the configuration registers.
+ * While enabled, writes of a value already held by the sensor are skipped and reads of the
+ * configuration registers listed in \ref xensiv_pasco2_shadow_reg_t are served without a bus access.
+ * Values the sensor changes on its own (single mode and forced compensation in MEAS_CFG) are never cached,
+ * and a soft reset invalidates the whole shadow. Hit and miss counters are kept per register in dev->shadow.
+ * \note Should be called after \ref xensiv_pasco2_init_i2c or \ref xensiv_pasco2_init_uart
+ *
+ * @param[in] dev Pointer to the XENSIV™ PAS CO2 sensor device
+ * @param[in] enable true to enable the shadow; false to disable and invalidate it
+ */
+void xensiv_pasco2_enable_shadow(xensiv_pasco2_t * dev, bool enable);
+
+/**
+ * @brief Brings the shadow of the configuration registers in line with a register access made without
+ * \ref xensiv_pasco2_set_reg or \ref xensiv_pasco2_get_reg, e.g. by \ref xensiv_pasco2_async_submit.
+ * Shadowed registers fully covered by a successful access take the accessed values; the ones touched
+ * by a failed or partial access become invalid, and a soft reset invalidates the whole shadow.
+ *
+ * @param[in] dev Pointer to the XENSIV™ PAS CO2 sensor device
+ * @param[in] reg_addr Address of the first register accessed
+ * @param[in] data Bytes written to or read from the registers
+ * @param[in] len Number of bytes accessed
+ * @param[in] success true if the access was successful
+ */
+void xensiv_pasco2_sync_shadow(xensiv_pasco2_t * dev, uint8_t reg_addr, const uint8_t * data, uint8_t len, bool success);
+
+/**
+ * @brief Invalidates the shadow of the configuration registers.
+ * Must be called if the sensor may have lost its configuration without the driver noticing, e.g. after a power cycle
+ *
+ * @param[in] dev Pointer to the XENSIV™ PAS CO2 sensor device
+ */
+void xensiv_pasco2_invalidate_shadow(xensiv_pasco2_t * dev);
 
 /**
  * @brief Gets the sensor device product and version ID
@@ -282,7 +425,7 @@ int32_t xensiv_pasco2_get_reg(const xensiv_pasco2_t * dev, uint8_t reg_addr, uin
  * @note : Refer to the register map description of the XENSIV™ PAS CO2 device for detailed information on the ID format
  * @return XENSIV_PASCO2_OK if reading the product id was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_id(const xensiv_pasco2_t * dev, xensiv_pasco2_id_t * id);
+int32_t xensiv_pasco2_get_id(xensiv_pasco2_t * dev, xensiv_pasco2_id_t * id);
 
 /**
  * @brief Gets the sensor device status
@@ -291,7 +434,7 @@ int32_t xensiv_pasco2_get_id(const xensiv_pasco2_t * dev, xensiv_pasco2_id_t * i
  * @param[out] status Pointer to populate with the sensor device status
  * @return XENSIV_PASCO2_OK if reading the device status was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_status(const xensiv_pasco2_t * dev, xensiv_pasco2_status_t * status);
+int32_t xensiv_pasco2_get_status(xensiv_pasco2_t * dev, xensiv_pasco2_status_t * status);
 
 /**
  * @brief Clears the sensor device status bits
@@ -303,7 +446,7 @@ int32_t xensiv_pasco2_get_status(const xensiv_pasco2_t * dev, xensiv_pasco2_stat
  *                 @arg @ref XENSIV_PASCO2_REG_SENS_STS_ORTMP_CLR_MSK Clears the ORTMP status sticky bit
  * @return XENSIV_PASCO2_OK if the status bits clearing was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_clear_status(const xensiv_pasco2_t * dev, uint8_t mask);
+int32_t xensiv_pasco2_clear_status(xensiv_pasco2_t * dev, uint8_t mask);
 
 /**
  * @brief Gets the sensor device interrupt configuration
@@ -312,7 +455,7 @@ int32_t xensiv_pasco2_clear_status(const xensiv_pasco2_t * dev, uint8_t mask);
  * @param[out] int_config Pointer to populate with the sensor device interrupt configuration
  * @return XENSIV_PASCO2_OK if getting the interrupt configuration was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_interrupt_config(const xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t * int_config);
+int32_t xensiv_pasco2_get_interrupt_config(xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t * int_config);
 
 /**
  * @brief Sets the sensor device interrupt configuration
@@ -321,7 +464,7 @@ int32_t xensiv_pasco2_get_interrupt_config(const xensiv_pasco2_t * dev, xensiv_p
  * @param[in] int_config New sensor device interrupt configuration to apply
  * @return XENSIV_PASCO2_OK if setting the interrupt configuration was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_interrupt_config(const xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t int_config);
+int32_t xensiv_pasco2_set_interrupt_config(xensiv_pasco2_t * dev, xensiv_pasco2_interrupt_config_t int_config);
 
 /**
  * @brief Gets the sensor device measurement configuration
@@ -330,7 +473,7 @@ int32_t xensiv_pasco2_set_interrupt_config(const xensiv_pasco2_t * dev, xensiv_p
  * @param[out] meas_config Pointer to populate with the sensor device measurement configuration
  * @return XENSIV_PASCO2_OK if getting the measurement configuration was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_measurement_config(const xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t * meas_config);
+int32_t xensiv_pasco2_get_measurement_config(xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t * meas_config);
 
 /**
  * @brief Sets the sensor device measurement configuration
@@ -339,7 +482,7 @@ int32_t xensiv_pasco2_get_measurement_config(const xensiv_pasco2_t * dev, xensiv
  * @param[in] meas_config New sensor device measurement configuration to apply
  * @return XENSIV_PASCO2_OK if setting the measurement configuration was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_measurement_config(const xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t meas_config);
+int32_t xensiv_pasco2_set_measurement_config(xensiv_pasco2_t * dev, xensiv_pasco2_measurement_config_t meas_config);
 
 /**
  * @brief Gets the current CO2 ppm values from the sensor device
@@ -348,7 +491,19 @@ int32_t xensiv_pasco2_set_measurement_config(const xensiv_pasco2_t * dev, xensiv
  * @param[out] val Pointer to populate with the CO2 ppm value
  * @return XENSIV_PASCO2_OK if obtaining the current CO2 value successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_result(const xensiv_pasco2_t * dev, uint16_t * val);
+int32_t xensiv_pasco2_get_result(xensiv_pasco2_t * dev, uint16_t * val);
+
+/**
+ * @brief Gets the current CO2 ppm value together with the sensor and measurement status.
+ * Reads the register window from SENS_STS to MEAS_STS in one bus transaction and decodes it in place,
+ * instead of the separate status and result accesses performed by \ref xensiv_pasco2_get_result
+ *
+ * @param[in] dev Pointer to the XENSIV™ PAS CO2 sensor device
+ * @param[out] result Pointer to populate with the decoded register window
+ * @return XENSIV_PASCO2_OK if a new CO2 value was read; XENSIV_PASCO2_READ_NRDY if no new value is available yet
+ * (the status fields are still valid); an error indicating what went wrong otherwise
+ */
+int32_t xensiv_pasco2_get_result_ex(xensiv_pasco2_t * dev, xensiv_pasco2_result_t * result);
 
 /**
  * @brief Sets the measurement rate for continuos mode
@@ -357,7 +512,7 @@ int32_t xensiv_pasco2_get_result(const xensiv_pasco2_t * dev, uint16_t * val);
  * @param[in] val New measurement rate to apply [5-4095s]
  * @return XENSIV_PASCO2_OK if setting the measurement rate was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_measurement_rate(const xensiv_pasco2_t * dev, uint16_t val);
+int32_t xensiv_pasco2_set_measurement_rate(xensiv_pasco2_t * dev, uint16_t val);
 
 /**
  * @brief Gets the measurement status of the sensor device.
@@ -369,7 +524,7 @@ int32_t xensiv_pasco2_set_measurement_rate(const xensiv_pasco2_t * dev, uint16_t
  * @param[out] status Pointer to populate with the sensor device measurement status
  * @return XENSIV_PASCO2_OK if getting the measurement was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_measurement_status(const xensiv_pasco2_t * dev, xensiv_pasco2_meas_status_t * status);
+int32_t xensiv_pasco2_get_measurement_status(xensiv_pasco2_t * dev, xensiv_pasco2_meas_status_t * status);
 
 /**
  * @brief Clears the measurement status of the sensor device
@@ -380,7 +535,7 @@ int32_t xensiv_pasco2_get_measurement_status(const xensiv_pasco2_t * dev, xensiv
  *                 @arg @ref XENSIV_PASCO2_REG_MEAS_STS_ALARM_CLR_MSK   Clears the sticky bit MEAS_STS.ALARM
  * @return XENSIV_PASCO2_OK if clearing the measurement status selected bits was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_clear_measurement_status(const xensiv_pasco2_t * dev, uint8_t mask);
+int32_t xensiv_pasco2_clear_measurement_status(xensiv_pasco2_t * dev, uint8_t mask);
 
 /**
  * @brief Sets the alarm threshold
@@ -389,7 +544,7 @@ int32_t xensiv_pasco2_clear_measurement_status(const xensiv_pasco2_t * dev, uint
  * @param[in] val New alarm threshold value to apply
  * @return XENSIV_PASCO2_OK if setting the alarm threshold was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_alarm_threshold(const xensiv_pasco2_t * dev, uint16_t val);
+int32_t xensiv_pasco2_set_alarm_threshold(xensiv_pasco2_t * dev, uint16_t val);
 
 /**
  * @brief Sets the pressure compensation value.
@@ -403,7 +558,7 @@ int32_t xensiv_pasco2_set_alarm_threshold(const xensiv_pasco2_t * dev, uint16_t
  * @param[in] val New pressure compensation value to apply
  * @return XENSIV_PASCO2_OK if setting the pressure reference value was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_pressure_compensation(const xensiv_pasco2_t * dev, uint16_t val);
+int32_t xensiv_pasco2_set_pressure_compensation(xensiv_pasco2_t * dev, uint16_t val);
 
 /**
  * @brief Sets the offset compensation value
@@ -413,7 +568,7 @@ int32_t xensiv_pasco2_set_pressure_compensation(const xensiv_pasco2_t * dev, uin
  * @param[in] val New pressure calibration value to apply
  * @return XENSIV_PASCO2_OK if setting the measurement offset was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_offset_compensation(const xensiv_pasco2_t * dev, uint16_t val);
+int32_t xensiv_pasco2_set_offset_compensation(xensiv_pasco2_t * dev, uint16_t val);
 
 /**
  * @brief Writes to the scratchpad register
@@ -422,7 +577,7 @@ int32_t xensiv_pasco2_set_offset_compensation(const xensiv_pasco2_t * dev, uint1
  * @param[in] val New scratchpad register value to apply
  * @return XENSIV_PASCO2_OK if writing to the scratch pad register was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_set_scratch_pad(const xensiv_pasco2_t * dev, uint8_t val);
+int32_t xensiv_pasco2_set_scratch_pad(xensiv_pasco2_t * dev, uint8_t val);
 
 /**
  * @brief Reads from the scratchpad register
@@ -431,7 +586,7 @@ int32_t xensiv_pasco2_set_scratch_pad(const xensiv_pasco2_t * dev, uint8_t val);
  * @param[out] val Pointer to populate with the sensor device scratchpad register value
  * @return XENSIV_PASCO2_OK if reading from the scratch pad register was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_get_scratch_pad(const xensiv_pasco2_t * dev, uint8_t * val);
+int32_t xensiv_pasco2_get_scratch_pad(xensiv_pasco2_t * dev, uint8_t * val);
 
 /**
  * @brief Triggers a sensor device command
@@ -440,7 +595,7 @@ int32_t xensiv_pasco2_get_scratch_pad(const xensiv_pasco2_t * dev, uint8_t * val
  * @param[in] cmd Command to trigger
  * @return XENSIV_PASCO2_OK if triggering the command  was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_cmd(const xensiv_pasco2_t * dev, xensiv_pasco2_cmd_t cmd);
+int32_t xensiv_pasco2_cmd(xensiv_pasco2_t * dev, xensiv_pasco2_cmd_t cmd);
 
 /**
  * @brief Triggers a single mode measurement
@@ -448,7 +603,7 @@ int32_t xensiv_pasco2_cmd(const xensiv_pasco2_t * dev, xensiv_pasco2_cmd_t cmd);
  * @param[in] dev Pointer to the XENSIV™ PAS CO2 sensor device
  * @return XENSIV_PASCO2_OK if starting the measurement was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_start_single_mode(const xensiv_pasco2_t * dev);
+int32_t xensiv_pasco2_start_single_mode(xensiv_pasco2_t * dev);
 
 /**
  * @brief Starts measurements in continuous mode
@@ -457,18 +612,59 @@ int32_t xensiv_pasco2_start_single_mode(const xensiv_pasco2_t * dev);
  * @param[in] val Measurement rate to apply [5-4095s]
  * @return XENSIV_PASCO2_OK if starting the measurements was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_start_continuous_mode(const xensiv_pasco2_t * dev, uint16_t val);
+int32_t xensiv_pasco2_start_continuous_mode(xensiv_pasco2_t * dev, uint16_t val);
 
 /**
  * @brief Performs force compensation.
  * Used to calculate the offset compensation when the sensor is exposed to a CO2 reference value.
  * The device is left in idle mode and the new offset compensation value is stored in non-volatile memory.
+ * Blocks the caller until the sensor completes, polling it every XENSIV_PASCO2_FCS_POLL_MS for at most
+ * XENSIV_PASCO2_FCS_TIMEOUT_MS. See \ref xensiv_pasco2_fcs_start for the non-blocking variant.
  *
  * @param[in] dev Pointer to the XENSIV™ PAS CO2 sensor device
  * @param[in] co2_ref CO2 reference value
  * @return XENSIV_PASCO2_OK if the force compensation was successful; an error indicating what went wrong otherwise
  */
-int32_t xensiv_pasco2_perform_forced_compensation(const xensiv_pasco2_t * dev, uint16_t co2_ref);
+int32_t xensiv_pasco2_perform_forced_compensation(xensiv_pasco2_t * dev, uint16_t co2_ref);
+
+/**
+ * @brief Starts a forced compensation without waiting for its completion.
+ * The sensor is switched to continuous mode with forced compensation at the FCS measurement rate.
+ * The job is then advanced with \ref xensiv_pasco2_fcs_step, which polls the sensor once every
+ * XENSIV_PASCO2_FCS_POLL_MS. Measurement results remain available while the job is running.
+ * On completion the offset is saved into the non volatile memory and the measurement rate and
+ * configuration active before the job are restored. If the job cannot be started once the sensor
+ * configuration was read, that configuration and measurement rate are restored before returning.
+ *
+ * @param[out] job Pointer to the job structure allocated by the user
+ * @param[in] dev Pointer to the XENSIV™ PAS CO2 sensor device
+ * @param[in] co2_ref CO2 reference value
+ * @param[in] callback Function receiving the progress and completion events; can be NULL
+ * @param[in] callback_arg Argument passed to the callback
+ * @return XENSIV_PASCO2_OK if the forced compensation was started; an error indicating what went wrong otherwise
+ */
+int32_t xensiv_pasco2_fcs_start(xensiv_pasco2_fcs_job_t * job, xensiv_pasco2_t * dev, uint16_t co2_ref,
+                                xensiv_pasco2_fcs_cb_t callback, void * callback_arg);
+
+/**
+ * @brief Advances a forced compensation job.
+ * Checks the sensor if the poll interval has elapsed and reports XENSIV_PASCO2_FCS_EVENT_PROGRESS,
+ * or finishes the job and reports its outcome. Must not run concurrently with other accesses to the sensor.
+ *
+ * @param[inout] job Pointer to the job
+ * @return Milliseconds until the job needs to be stepped again, or XENSIV_PASCO2_FCS_IDLE if the job is not running
+ */
+uint32_t xensiv_pasco2_fcs_step(xensiv_pasco2_fcs_job_t * job);
+
+/**
+ * @brief Cancels a running forced compensation job.
+ * Restores the measurement rate and configuration active before the job and reports XENSIV_PASCO2_FCS_EVENT_CANCELLED.
+ * The offset saved in the non volatile memory is left unchanged
+ *
+ * @param[inout] job Pointer to the job
+ * @return XENSIV_PASCO2_OK if the sensor configuration was restored; an error indicating what went wrong otherwise
+ */
+int32_t xensiv_pasco2_fcs_cancel(xensiv_pasco2_fcs_job_t * job);
 
 #ifdef __cplusplus
 }
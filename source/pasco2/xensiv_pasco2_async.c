@@ -0,0 +1,302 @@
+/***********************************************************************************************//**
+ * \file xensiv_pasco2_async.c
+ *
+ * Description: This file contains the asynchronous request engine
+ *              for interacting with the XENSIV™ PAS CO2 sensor.
+ *
+ ***************************************************************************************************
+ * \copyright
+ * Copyright 2023 Infineon Technologies AG
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************************************/
+
+#include "xensiv_pasco2_async.h"
+#include "xensiv_pasco2_platform.h"
+
+#define XENSIV_PASCO2_RESULT_WINDOW_LEN         (XENSIV_PASCO2_REG_MEAS_STS - XENSIV_PASCO2_REG_SENS_STS + 1U)
+
+/* Moves the requests submitted since the last call to the tail of the pending queue, oldest first */
+static void xensiv_pasco2_async_collect(xensiv_pasco2_async_t * engine)
+{
+    xensiv_pasco2_async_req_t * list = __atomic_exchange_n(&engine->incoming, NULL, __ATOMIC_ACQUIRE);
+    xensiv_pasco2_async_req_t * fifo = NULL;
+
+    /* The incoming list is newest first */
+    while (list != NULL)
+    {
+        xensiv_pasco2_async_req_t * next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+
+    while (fifo != NULL)
+    {
+        xensiv_pasco2_async_req_t * next = fifo->next;
+        fifo->next = NULL;
+
+        if (engine->tail == NULL)
+        {
+            engine->head = fifo;
+        }
+        else
+        {
+            engine->tail->next = fifo;
+        }
+        engine->tail = fifo;
+
+        fifo = next;
+    }
+}
+
+/* Builds the bus transfer for a request and starts it */
+static int32_t xensiv_pasco2_async_start(xensiv_pasco2_async_t * engine, xensiv_pasco2_async_req_t * req)
+{
+    uint8_t * rx = NULL;
+    size_t rx_len = 0U;
+    size_t tx_len = 1U;
+
+    switch (req->op)
+    {
+        case XENSIV_PASCO2_ASYNC_GET_RESULT:
+            engine->buf[0] = (uint8_t)XENSIV_PASCO2_REG_SENS_STS;
+            rx = engine->buf;
+            rx_len = XENSIV_PASCO2_RESULT_WINDOW_LEN;
+            break;
+
+        case XENSIV_PASCO2_ASYNC_GET_REG:
+            xensiv_pasco2_plat_assert((req->len > 0U) && (req->len <= XENSIV_PASCO2_ASYNC_MAX_DATA_LEN));
+            engine->buf[0] = req->reg_addr;
+            rx = req->data;
+            rx_len = req->len;
+            break;
+
+        case XENSIV_PASCO2_ASYNC_SET_REG:
+            xensiv_pasco2_plat_assert((req->len > 0U) && (req->len <= XENSIV_PASCO2_ASYNC_MAX_DATA_LEN));
+            engine->buf[0] = req->reg_addr;
+            for (uint8_t i = 0U; i < req->len; ++i)
+            {
+                engine->buf[i + 1U] = req->data[i];
+            }
+            tx_len += req->len;
+            break;
+
+        case XENSIV_PASCO2_ASYNC_SET_MEAS_RATE:
+            xensiv_pasco2_plat_assert((req->value >= XENSIV_PASCO2_MEAS_RATE_MIN) && (req->value <= XENSIV_PASCO2_MEAS_RATE_MAX));
+            /* fall through */
+        case XENSIV_PASCO2_ASYNC_SET_PRESS_REF:
+            engine->buf[0] = (XENSIV_PASCO2_ASYNC_SET_MEAS_RATE == req->op) ?
+                             (uint8_t)XENSIV_PASCO2_REG_MEAS_RATE_H :
+                             (uint8_t)XENSIV_PASCO2_REG_PRESS_REF_H;
+            engine->buf[1] = (uint8_t)(req->value >> 8);
+            engine->buf[2] = (uint8_t)(req->value & 0xFFU);
+            tx_len += 2U;
+            break;
+
+        case XENSIV_PASCO2_ASYNC_CMD:
+            engine->buf[0] = (uint8_t)XENSIV_PASCO2_REG_SENS_RST;
+            engine->buf[1] = (uint8_t)req->value;
+            tx_len += 1U;
+            break;
+
+        default:
+            xensiv_pasco2_plat_assert(false);
+            break;
+    }
+
+    engine->tx_len = (uint8_t)tx_len;
+    engine->done = false;
+    engine->busy = true;
+
+    int32_t res = xensiv_pasco2_plat_i2c_transfer_async(engine->dev->ctx, XENSIV_PASCO2_I2C_ADDR, engine->buf, tx_len, rx, rx_len);
+    if (XENSIV_PASCO2_OK != res)
+    {
+        engine->xfer_res = res;
+        engine->done = true;
+    }
+
+    return res;
+}
+
+/* Passes the registers read or written by the finished transfer to the shadow of the blocking API */
+static void xensiv_pasco2_async_sync_shadow(xensiv_pasco2_async_t * engine, const xensiv_pasco2_async_req_t * req, bool success)
+{
+    switch (req->op)
+    {
+        case XENSIV_PASCO2_ASYNC_GET_RESULT:
+            xensiv_pasco2_sync_shadow(engine->dev, (uint8_t)XENSIV_PASCO2_REG_SENS_STS, engine->buf,
+                                      (uint8_t)XENSIV_PASCO2_RESULT_WINDOW_LEN, success);
+            break;
+
+        case XENSIV_PASCO2_ASYNC_GET_REG:
+            xensiv_pasco2_sync_shadow(engine->dev, req->reg_addr, req->data, req->len, success);
+            break;
+
+        default:
+            /* The register address is followed by the bytes written */
+            xensiv_pasco2_sync_shadow(engine->dev, engine->buf[0], &engine->buf[1], (uint8_t)(engine->tx_len - 1U), success);
+            break;
+    }
+}
+
+/* Decodes the finished transfer, retires the head request and runs its callback */
+static void xensiv_pasco2_async_finish(xensiv_pasco2_async_t * engine)
+{
+    xensiv_pasco2_async_req_t * req = engine->head;
+    int32_t res = engine->xfer_res;
+    uint32_t now = xensiv_pasco2_plat_get_time_ms();
+
+    engine->dev->bus_ready_ms = now + XENSIV_PASCO2_COMM_DELAY_MS;
+    engine->busy = false;
+    engine->done = false;
+
+    if ((XENSIV_PASCO2_OK == res) && (XENSIV_PASCO2_ASYNC_GET_RESULT == req->op))
+    {
+        const uint8_t * buf = engine->buf;
+        req->result.sens_status.u = buf[XENSIV_PASCO2_REG_SENS_STS - XENSIV_PASCO2_REG_SENS_STS];
+        req->result.meas_rate = (uint16_t)(((uint16_t)buf[XENSIV_PASCO2_REG_MEAS_RATE_H - XENSIV_PASCO2_REG_SENS_STS] << 8) |
+                                           buf[XENSIV_PASCO2_REG_MEAS_RATE_L - XENSIV_PASCO2_REG_SENS_STS]);
+        req->result.meas_config.u = buf[XENSIV_PASCO2_REG_MEAS_CFG - XENSIV_PASCO2_REG_SENS_STS];
+        req->result.co2_ppm = (uint16_t)(((uint16_t)buf[XENSIV_PASCO2_REG_CO2PPM_H - XENSIV_PASCO2_REG_SENS_STS] << 8) |
+                                         buf[XENSIV_PASCO2_REG_CO2PPM_L - XENSIV_PASCO2_REG_SENS_STS]);
+        req->result.meas_status.u = buf[XENSIV_PASCO2_REG_MEAS_STS - XENSIV_PASCO2_REG_SENS_STS];
+
+        if (req->result.meas_status.b.drdy == 0U)
+        {
+            res = XENSIV_PASCO2_READ_NRDY;
+        }
+    }
+    else if (XENSIV_PASCO2_OK != res)
+    {
+        engine->errors++;
+    }
+    else
+    {
+        /* Register data was received in place; writes have nothing to decode */
+    }
+
+    xensiv_pasco2_async_sync_shadow(engine, req, XENSIV_PASCO2_OK == engine->xfer_res);
+
+    uint32_t latency = now - req->submit_ms;
+    engine->latency_sum_ms += latency;
+    if (latency > engine->latency_max_ms)
+    {
+        engine->latency_max_ms = latency;
+    }
+    engine->completed++;
+
+    engine->head = req->next;
+    if (engine->head == NULL)
+    {
+        engine->tail = NULL;
+    }
+    req->next = NULL;
+
+    if (req->callback != NULL)
+    {
+        req->callback(req, res);
+    }
+}
+
+void xensiv_pasco2_async_init(xensiv_pasco2_async_t * engine, xensiv_pasco2_t * dev, void (*wake)(void * arg), void * wake_arg)
+{
+    xensiv_pasco2_plat_assert(engine != NULL);
+    xensiv_pasco2_plat_assert(dev != NULL);
+
+    engine->dev = dev;
+    engine->incoming = NULL;
+    engine->head = NULL;
+    engine->tail = NULL;
+    engine->busy = false;
+    engine->done = false;
+    engine->xfer_res = XENSIV_PASCO2_OK;
+    engine->tx_len = 0U;
+    engine->wake = wake;
+    engine->wake_arg = wake_arg;
+    engine->completed = 0U;
+    engine->errors = 0U;
+    engine->latency_sum_ms = 0U;
+    engine->latency_max_ms = 0U;
+}
+
+void xensiv_pasco2_async_submit(xensiv_pasco2_async_t * engine, xensiv_pasco2_async_req_t * req)
+{
+    xensiv_pasco2_plat_assert(engine != NULL);
+    xensiv_pasco2_plat_assert(req != NULL);
+
+    req->submit_ms = xensiv_pasco2_plat_get_time_ms();
+
+    xensiv_pasco2_async_req_t * head = __atomic_load_n(&engine->incoming, __ATOMIC_RELAXED);
+    do
+    {
+        req->next = head;
+    } while (!__atomic_compare_exchange_n(&engine->incoming, &head, req, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    if (engine->wake != NULL)
+    {
+        engine->wake(engine->wake_arg);
+    }
+}
+
+uint32_t xensiv_pasco2_async_process(xensiv_pasco2_async_t * engine)
+{
+    xensiv_pasco2_plat_assert(engine != NULL);
+
+    for (;;)
+    {
+        if (engine->busy)
+        {
+            if (!engine->done)
+            {
+                /* Woken up again by xensiv_pasco2_async_xfer_done */
+                return XENSIV_PASCO2_ASYNC_WAIT_FOREVER;
+            }
+
+            xensiv_pasco2_async_finish(engine);
+        }
+
+        xensiv_pasco2_async_collect(engine);
+
+        if (engine->head == NULL)
+        {
+            return XENSIV_PASCO2_ASYNC_WAIT_FOREVER;
+        }
+
+        int32_t remaining = (int32_t)(engine->dev->bus_ready_ms - xensiv_pasco2_plat_get_time_ms());
+        if (remaining > 0)
+        {
+            /* Inter-command delay still running */
+            return (uint32_t)remaining;
+        }
+
+        (void)xensiv_pasco2_async_start(engine, engine->head);
+    }
+}
+
+void xensiv_pasco2_async_xfer_done(xensiv_pasco2_async_t * engine, int32_t res)
+{
+    xensiv_pasco2_plat_assert(engine != NULL);
+
+    if (engine->busy && !engine->done)
+    {
+        engine->xfer_res = res;
+        engine->done = true;
+
+        if (engine->wake != NULL)
+        {
+            engine->wake(engine->wake_arg);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+/***********************************************************************************************//**
+ * \file xensiv_pasco2_async.h
+ *
+ * Description: This file contains the asynchronous request interface
+ *              for interacting with the XENSIV™ PAS CO2 sensor.
+ *
+ ***************************************************************************************************
+ * \copyright
+ * Copyright 2023 Infineon Technologies AG
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************************************/
+
+#ifndef XENSIV_PASCO2_ASYNC_H_
+#define XENSIV_PASCO2_ASYNC_H_
+
+#include "xensiv_pasco2.h"
+
+/**
+ * \addtogroup group_board_libs_async XENSIV™ PAS CO2 sensor asynchronous interface
+ * \{
+ * Non-blocking variant of the XENSIV™ PAS CO2 driver for the I2C interface.
+ *
+ * Requests are queued with \ref xensiv_pasco2_async_submit from any context and executed one at a time
+ * by a state machine. Each request is a single bus transfer started with
+ * \ref xensiv_pasco2_plat_i2c_transfer_async; the platform reports its end with \ref xensiv_pasco2_async_xfer_done,
+ * typically from the I2C interrupt. All other work, including the completion callbacks, happens in
+ * \ref xensiv_pasco2_async_process, which the owner of the engine calls whenever the wake function fires
+ * or the returned timeout expires. No task is blocked while a transfer or the inter-command delay is pending.
+ *
+ * The engine and the blocking API must not access the bus at the same time. Calling both from the task that
+ * runs \ref xensiv_pasco2_async_process guarantees this.
+ */
+
+/************************************** Macros *******************************************/
+
+/** Maximum number of register bytes transferred by a single request */
+#define XENSIV_PASCO2_ASYNC_MAX_DATA_LEN        (8U)
+
+/** Returned by \ref xensiv_pasco2_async_process when there is nothing to do until the next wake up */
+#define XENSIV_PASCO2_ASYNC_WAIT_FOREVER        (0xFFFFFFFFUL)
+
+/********************************* Type definitions **************************************/
+
+/** Enum defining the asynchronous request types */
+typedef enum
+{
+    XENSIV_PASCO2_ASYNC_GET_RESULT = 0U,                /**< Burst read of the result window, see \ref xensiv_pasco2_get_result_ex */
+    XENSIV_PASCO2_ASYNC_GET_REG = 1U,                   /**< Reads len bytes starting at reg_addr into data */
+    XENSIV_PASCO2_ASYNC_SET_REG = 2U,                   /**< Writes len bytes from data starting at reg_addr */
+    XENSIV_PASCO2_ASYNC_SET_MEAS_RATE = 3U,             /**< Sets the measurement rate given in value, see \ref xensiv_pasco2_set_measurement_rate */
+    XENSIV_PASCO2_ASYNC_SET_PRESS_REF = 4U,             /**< Sets the pressure compensation given in value, see \ref xensiv_pasco2_set_pressure_compensation */
+    XENSIV_PASCO2_ASYNC_CMD = 5U                        /**< Triggers the \ref xensiv_pasco2_cmd_t command given in value */
+} xensiv_pasco2_async_op_t;
+
+struct xensiv_pasco2_async_req_s;                       /* Forward declaration */
+
+/** Completion callback; res is XENSIV_PASCO2_OK or an error code as returned by the blocking API */
+typedef void (*xensiv_pasco2_async_cb_t)(struct xensiv_pasco2_async_req_s * req, int32_t res);
+
+/** Structure of an asynchronous request. The memory is owned by the caller and must stay valid until the callback runs */
+typedef struct xensiv_pasco2_async_req_s
+{
+    xensiv_pasco2_async_op_t op;                        /*!< Request type */
+    uint8_t reg_addr;                                   /*!< Start register for XENSIV_PASCO2_ASYNC_GET_REG/SET_REG */
+    uint8_t len;                                        /*!< Number of bytes for XENSIV_PASCO2_ASYNC_GET_REG/SET_REG */
+    uint16_t value;                                     /*!< Argument for XENSIV_PASCO2_ASYNC_SET_MEAS_RATE/SET_PRESS_REF/CMD */
+    uint8_t data[XENSIV_PASCO2_ASYNC_MAX_DATA_LEN];     /*!< Register data for XENSIV_PASCO2_ASYNC_GET_REG/SET_REG */
+    xensiv_pasco2_result_t result;                      /*!< Decoded result for XENSIV_PASCO2_ASYNC_GET_RESULT */
+    xensiv_pasco2_async_cb_t callback;                  /*!< Completion callback; can be NULL */
+    void * callback_arg;                                /*!< Argument available to the callback */
+    uint32_t submit_ms;                                 /*!< Submission time, used for latency statistics */
+    struct xensiv_pasco2_async_req_s * next;            /*!< Queue link, managed by the engine */
+} xensiv_pasco2_async_req_t;
+
+/** Structure of the asynchronous engine. Initialized using \ref xensiv_pasco2_async_init */
+typedef struct
+{
+    xensiv_pasco2_t * dev;                              /*!< Sensor device the requests are executed on */
+    xensiv_pasco2_async_req_t * incoming;               /*!< Requests submitted since the last processing, newest first */
+    xensiv_pasco2_async_req_t * head;                   /*!< Oldest pending request; in flight while busy is set */
+    xensiv_pasco2_async_req_t * tail;                   /*!< Newest pending request */
+    volatile bool busy;                                 /*!< A bus transfer is in flight */
+    volatile bool done;                                 /*!< The in-flight transfer has finished */
+    volatile int32_t xfer_res;                          /*!< Result of the last transfer */
+    uint8_t buf[XENSIV_PASCO2_ASYNC_MAX_DATA_LEN + 1U]; /*!< Transfer buffer */
+    uint8_t tx_len;                                     /*!< Bytes sent by the last transfer, register address included */
+    void (*wake)(void * arg);                           /*!< Called when \ref xensiv_pasco2_async_process should run; may be called from an interrupt */
+    void * wake_arg;                                    /*!< Argument for the wake function */
+    uint32_t completed;                                 /*!< Number of completed requests */
+    uint32_t errors;                                    /*!< Number of requests completed with an error */
+    uint32_t latency_sum_ms;                            /*!< Sum of submit-to-completion latencies */
+    uint32_t latency_max_ms;                            /*!< Largest submit-to-completion latency */
+} xensiv_pasco2_async_t;
+
+/******************************* Function prototypes *************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the asynchronous engine
+ *
+ * @param[out] engine Pointer to the engine structure allocated by the user
+ * @param[in] dev Pointer to a XENSIV™ PAS CO2 sensor device initialized with \ref xensiv_pasco2_init_i2c
+ * @param[in] wake Function called when \ref xensiv_pasco2_async_process should run; can be NULL if the owner polls
+ * @param[in] wake_arg Argument for the wake function
+ */
+void xensiv_pasco2_async_init(xensiv_pasco2_async_t * engine, xensiv_pasco2_t * dev, void (*wake)(void * arg), void * wake_arg);
+
+/**
+ * @brief Queues a request. Lock-free; can be called from any task or interrupt
+ *
+ * @param[in] engine Pointer to the engine
+ * @param[inout] req Request to execute; must not be queued already
+ */
+void xensiv_pasco2_async_submit(xensiv_pasco2_async_t * engine, xensiv_pasco2_async_req_t * req);
+
+/**
+ * @brief Advances the state machine: completes finished transfers, runs their callbacks and starts the next one.
+ * Must always be called from the same context
+ *
+ * @param[in] engine Pointer to the engine
+ * @return Milliseconds after which the function must be called again at the latest,
+ *         or XENSIV_PASCO2_ASYNC_WAIT_FOREVER if only a wake up can produce new work
+ */
+uint32_t xensiv_pasco2_async_process(xensiv_pasco2_async_t * engine);
+
+/**
+ * @brief Reports the end of the transfer started with \ref xensiv_pasco2_plat_i2c_transfer_async.
+ * To be called by the platform layer, typically from the I2C interrupt
+ *
+ * @param[in] engine Pointer to the engine
+ * @param[in] res XENSIV_PASCO2_OK if the transfer succeeded; XENSIV_PASCO2_ERR_COMM otherwise
+ */
+void xensiv_pasco2_async_xfer_done(xensiv_pasco2_async_t * engine, int32_t res);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** \} group_board_libs_async */
+
+#endif
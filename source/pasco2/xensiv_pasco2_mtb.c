@@ -25,6 +25,9 @@
 #if defined(CY_USING_HAL)
 
 #include "cyhal_system.h"
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+#include "cyabs_rtos.h"
+#endif
 
 #include "xensiv_pasco2_mtb.h"
 
@@ -33,9 +36,69 @@
 
 #define XENSIV_PASCO2_MEAS_RATE_S               (10)
 
+/* Scratch pad value marking a sensor configured by xensiv_pasco2_mtb_init_i2c_warm */
+#define XENSIV_PASCO2_WARM_SIGNATURE            (0x5CU)
+
+/* Polling of a sensor that does not respond yet after power on */
+#define XENSIV_PASCO2_BOOT_POLL_MS              (50U)
+#define XENSIV_PASCO2_BOOT_TIMEOUT_MS           (2000U)
+
 #define XENSIV_PASCO2_ERROR(x)                  (((x) == XENSIV_PASCO2_OK) ? CY_RSLT_SUCCESS :\
                                                  CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_BOARD_HARDWARE_XENSIV_PASCO2, (x)))
 
+#define XENSIV_PASCO2_I2C_ASYNC_EVENTS          ((cyhal_i2c_event_t)(CYHAL_I2C_MASTER_WR_CMPLT_EVENT | \
+                                                                     CYHAL_I2C_MASTER_RD_CMPLT_EVENT | \
+                                                                     CYHAL_I2C_MASTER_ERR_EVENT))
+
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+/* Signalled by the UART interrupt once a whole response has been received */
+static cy_semaphore_t xensiv_pasco2_mtb_uart_rx_sema;
+static bool xensiv_pasco2_mtb_uart_rx_sema_ready = false;
+#endif
+
+/* Application handler of the UART events; the driver owns the callback of the UART object */
+static cyhal_uart_event_callback_t xensiv_pasco2_mtb_uart_app_cb = NULL;
+static void * xensiv_pasco2_mtb_uart_app_cb_arg = NULL;
+
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+static void xensiv_pasco2_mtb_uart_event(void * callback_arg, cyhal_uart_event_t event)
+{
+    (void)callback_arg;
+
+    if (((uint32_t)event & (uint32_t)CYHAL_UART_IRQ_RX_DONE) != 0U)
+    {
+        (void)cy_rtos_set_semaphore(&xensiv_pasco2_mtb_uart_rx_sema, true);
+    }
+
+    if (xensiv_pasco2_mtb_uart_app_cb != NULL)
+    {
+        xensiv_pasco2_mtb_uart_app_cb(xensiv_pasco2_mtb_uart_app_cb_arg, event);
+    }
+}
+#endif
+
+/* The asynchronous transfer in flight includes a read phase */
+static volatile bool xensiv_pasco2_mtb_async_rx_pending = false;
+
+static void xensiv_pasco2_mtb_i2c_event(void * callback_arg, cyhal_i2c_event_t event)
+{
+    xensiv_pasco2_async_t * engine = (xensiv_pasco2_async_t *)callback_arg;
+
+    if (((uint32_t)event & (uint32_t)CYHAL_I2C_MASTER_ERR_EVENT) != 0U)
+    {
+        xensiv_pasco2_async_xfer_done(engine, XENSIV_PASCO2_ERR_COMM);
+    }
+    else if ((((uint32_t)event & (uint32_t)CYHAL_I2C_MASTER_RD_CMPLT_EVENT) != 0U) ||
+             ((((uint32_t)event & (uint32_t)CYHAL_I2C_MASTER_WR_CMPLT_EVENT) != 0U) && !xensiv_pasco2_mtb_async_rx_pending))
+    {
+        xensiv_pasco2_async_xfer_done(engine, XENSIV_PASCO2_OK);
+    }
+    else
+    {
+        /* Write phase of a write/read transfer; wait for the read to complete */
+    }
+}
+
 cy_rslt_t xensiv_pasco2_mtb_init_i2c(xensiv_pasco2_t * dev, cyhal_i2c_t * i2c)
 {
     CY_ASSERT(dev != NULL);
@@ -50,11 +113,50 @@ cy_rslt_t xensiv_pasco2_mtb_init_i2c(xensiv_pasco2_t * dev, cyhal_i2c_t * i2c)
     return XENSIV_PASCO2_ERROR(res);
 }
 
+cy_rslt_t xensiv_pasco2_mtb_init_i2c_warm(xensiv_pasco2_t * dev, cyhal_i2c_t * i2c, bool * warm)
+{
+    CY_ASSERT(dev != NULL);
+    CY_ASSERT(i2c != NULL);
+    CY_ASSERT(warm != NULL);
+
+    int32_t res = XENSIV_PASCO2_ERR_COMM;
+
+    /* Instead of a fixed delay for the sensor to boot after power on, poll until it responds. The polls
+     * are counted rather than timed, as the time base is constant without an RTOS */
+    for (uint32_t poll = 0U; poll <= (XENSIV_PASCO2_BOOT_TIMEOUT_MS / XENSIV_PASCO2_BOOT_POLL_MS); poll++)
+    {
+        if (0U != poll)
+        {
+            xensiv_pasco2_plat_delay(XENSIV_PASCO2_BOOT_POLL_MS);
+        }
+        res = xensiv_pasco2_init_i2c_warm(dev, i2c, XENSIV_PASCO2_WARM_SIGNATURE, XENSIV_PASCO2_MEAS_RATE_S, warm);
+        if (XENSIV_PASCO2_ERR_COMM != res)
+        {
+            break;
+        }
+    }
+
+    return XENSIV_PASCO2_ERROR(res);
+}
+
 cy_rslt_t xensiv_pasco2_mtb_init_uart(xensiv_pasco2_t * dev, cyhal_uart_t * uart)
 {
     CY_ASSERT(dev != NULL);
     CY_ASSERT(uart != NULL);
 
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+    if (!xensiv_pasco2_mtb_uart_rx_sema_ready &&
+        (CY_RSLT_SUCCESS == cy_rtos_init_semaphore(&xensiv_pasco2_mtb_uart_rx_sema, 1U, 0U)))
+    {
+        xensiv_pasco2_mtb_uart_rx_sema_ready = true;
+    }
+
+    if (xensiv_pasco2_mtb_uart_rx_sema_ready)
+    {
+        cyhal_uart_register_callback(uart, xensiv_pasco2_mtb_uart_event, NULL);
+        cyhal_uart_enable_event(uart, CYHAL_UART_IRQ_RX_DONE, CYHAL_ISR_PRIORITY_DEFAULT, true);
+    }
+#endif
 
     int32_t res = xensiv_pasco2_init_uart(dev, uart);
     if (XENSIV_PASCO2_OK == res)
@@ -64,7 +166,25 @@ cy_rslt_t xensiv_pasco2_mtb_init_uart(xensiv_pasco2_t * dev, cyhal_uart_t * uart
     return XENSIV_PASCO2_ERROR(res);
 }
 
-cy_rslt_t xensiv_pasco2_mtb_interrupt_init(const xensiv_pasco2_t * dev, 
+void xensiv_pasco2_mtb_uart_register_callback(cyhal_uart_t * uart, cyhal_uart_event_callback_t callback, void * callback_arg)
+{
+    CY_ASSERT(uart != NULL);
+
+    xensiv_pasco2_mtb_uart_app_cb = callback;
+    xensiv_pasco2_mtb_uart_app_cb_arg = callback_arg;
+
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+    if (xensiv_pasco2_mtb_uart_rx_sema_ready)
+    {
+        /* Events reach the application through xensiv_pasco2_mtb_uart_event */
+        return;
+    }
+#endif
+
+    cyhal_uart_register_callback(uart, callback, callback_arg);
+}
+
+cy_rslt_t xensiv_pasco2_mtb_interrupt_init(xensiv_pasco2_t * dev, 
                                            const xensiv_pasco2_interrupt_config_t int_config, 
                                            uint16_t alarm_threshold,
                                            cyhal_gpio_t pin, 
@@ -143,15 +263,37 @@ cy_rslt_t xensiv_pasco2_mtb_interrupt_init_ex(xensiv_pasco2_t * dev,
     return XENSIV_PASCO2_ERROR(res);
 }
 
-cy_rslt_t xensiv_pasco2_mtb_read(const xensiv_pasco2_t * dev, uint16_t press_ref, uint16_t * co2_ppm_val)
+cy_rslt_t xensiv_pasco2_mtb_async_init(xensiv_pasco2_async_t * engine,
+                                       xensiv_pasco2_t * dev,
+                                       uint8_t intr_priority,
+                                       void (*wake)(void * arg),
+                                       void * wake_arg)
+{
+    CY_ASSERT(engine != NULL);
+    CY_ASSERT(dev != NULL);
+    CY_ASSERT(dev->ctx != NULL);
+
+    cyhal_i2c_t * i2c = (cyhal_i2c_t *)dev->ctx;
+
+    xensiv_pasco2_async_init(engine, dev, wake, wake_arg);
+
+    cyhal_i2c_register_callback(i2c, xensiv_pasco2_mtb_i2c_event, engine);
+    cyhal_i2c_enable_event(i2c, XENSIV_PASCO2_I2C_ASYNC_EVENTS, intr_priority, true);
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t xensiv_pasco2_mtb_read(xensiv_pasco2_t * dev, uint16_t press_ref, uint16_t * co2_ppm_val)
 {
     CY_ASSERT(dev != NULL);
     CY_ASSERT(co2_ppm_val != NULL);
 
 
-    int32_t res = xensiv_pasco2_get_result(dev, co2_ppm_val);
+    xensiv_pasco2_result_t result;
+    int32_t res = xensiv_pasco2_get_result_ex(dev, &result);
     if (XENSIV_PASCO2_OK == res)
     {
+        *co2_ppm_val = result.co2_ppm;
         res = xensiv_pasco2_set_pressure_compensation(dev, press_ref);
     }
 
@@ -179,6 +321,21 @@ int32_t xensiv_pasco2_plat_i2c_transfer(void * ctx, uint16_t dev_addr, const uin
         : XENSIV_PASCO2_ERR_COMM;
 }
 
+int32_t xensiv_pasco2_plat_i2c_transfer_async(void * ctx, uint16_t dev_addr, const uint8_t * tx_buffer, size_t tx_len, uint8_t * rx_buffer, size_t rx_len)
+{
+    CY_ASSERT(ctx != NULL);
+    CY_ASSERT(tx_buffer != NULL);
+
+    cyhal_i2c_t * i2c = (cyhal_i2c_t *)ctx;
+    xensiv_pasco2_mtb_async_rx_pending = (rx_buffer != NULL);
+
+    cy_rslt_t result = cyhal_i2c_master_transfer_async(i2c, dev_addr, tx_buffer, tx_len, rx_buffer, (rx_buffer != NULL) ? rx_len : 0U);
+
+    return (CY_RSLT_SUCCESS == result)
+        ? XENSIV_PASCO2_OK
+        : XENSIV_PASCO2_ERR_COMM;
+}
+
 int32_t xensiv_pasco2_plat_uart_read(void * ctx, uint8_t * data, size_t len)
 {
     CY_ASSERT(ctx != NULL);
@@ -187,6 +344,29 @@ int32_t xensiv_pasco2_plat_uart_read(void * ctx, uint8_t * data, size_t len)
     cy_rslt_t result = XENSIV_PASCO2_ERR_COMM;
 
     cyhal_uart_t * uart = (cyhal_uart_t *)ctx;
+
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+    if (xensiv_pasco2_mtb_uart_rx_sema_ready)
+    {
+        /* Drop a completion left over from a timed out read, then block on
+         * the RX done interrupt instead of polling the FIFO level */
+        (void)cy_rtos_get_semaphore(&xensiv_pasco2_mtb_uart_rx_sema, 0U, false);
+        result = cyhal_uart_read_async(uart, data, len);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            result = cy_rtos_get_semaphore(&xensiv_pasco2_mtb_uart_rx_sema, XENSIV_PASCO2_UART_TIMEOUT_MS, false);
+            if (CY_RSLT_SUCCESS != result)
+            {
+                (void)cyhal_uart_read_abort(uart);
+            }
+        }
+
+        return (CY_RSLT_SUCCESS == result) ?
+                XENSIV_PASCO2_OK :
+                XENSIV_PASCO2_ERR_COMM;
+    }
+#endif
+
     uint32_t timeout = XENSIV_PASCO2_UART_TIMEOUT_MS;
     while ((cyhal_uart_readable(uart) < len) && (timeout > 0U))
     {
@@ -226,7 +406,24 @@ int32_t xensiv_pasco2_plat_uart_write(void * ctx, uint8_t * data, size_t len)
 
 void xensiv_pasco2_plat_delay(uint32_t ms)
 {
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+    /* Yield to other tasks instead of spinning while the sensor is busy */
+    (void)cy_rtos_delay_milliseconds(ms);
+#else
     (void)cyhal_system_delay_ms(ms);
+#endif
+}
+
+uint32_t xensiv_pasco2_plat_get_time_ms(void)
+{
+#if defined(CY_RTOS_AWARE) || defined(COMPONENT_RTOS_AWARE)
+    cy_time_t now = 0U;
+    (void)cy_rtos_get_time(&now);
+    return (uint32_t)now;
+#else
+    /* No time base: every command pays the full inter-command delay */
+    return 0U;
+#endif
 }
 
 uint16_t xensiv_pasco2_plat_htons(uint16_t x)
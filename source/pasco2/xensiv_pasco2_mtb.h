@@ -28,6 +28,7 @@
 #include "cy_result.h"
 
 #include "xensiv_pasco2.h"
+#include "xensiv_pasco2_async.h"
 
 /**
  * \addtogroup group_board_libs_mtb XENSIV™ PAS CO2 sensor ModusToolbox&trade; interface
@@ -120,7 +121,23 @@ extern "C" {
  */
 cy_rslt_t xensiv_pasco2_mtb_init_i2c(xensiv_pasco2_t * dev, cyhal_i2c_t * i2c);
 
+/** Initializes the XENSIV™ PAS CO2 sensor over the specified I2C peripheral, keeping it running if it
+ * was already configured by this function before a reset of the host. See \ref xensiv_pasco2_init_i2c_warm.
+ * While the sensor does not respond after power on, the initialization is retried for up to 2 s.
+ *
+ * @param[inout]  obj       Pointer to the ModusToolbox&trade PAS CO2 object. The caller must allocate the
+ * memory for this object but the init function will initialize its contents
+ * @param[in]   i2c         Pointer to an initialized I2C object
+ * @param[out]  warm        Set to true if the running sensor was kept; false if it was reset
+ * @return CY_RSLT_SUCCESS if the initialization was successful; an error indicating what went wrong otherwise
+ */
+cy_rslt_t xensiv_pasco2_mtb_init_i2c_warm(xensiv_pasco2_t * dev, cyhal_i2c_t * i2c, bool * warm);
+
 /** Initializes the XENSIV™ PAS CO2 sensor, and configures it to use the specified UART peripheral
+ * \note With an RTOS, responses are received through the UART RX done event: this function replaces
+ * the callback registered on the UART object with cyhal_uart_register_callback and enables
+ * CYHAL_UART_IRQ_RX_DONE. A callback registered before is no longer called; register the application
+ * handler with \ref xensiv_pasco2_mtb_uart_register_callback instead.
  *
  * @param[inout]  obj       Pointer to the ModusToolbox&trade PAS CO2 object. The caller must allocate the
  * memory for this object but the init function will initialize its contents
@@ -129,6 +146,17 @@ cy_rslt_t xensiv_pasco2_mtb_init_i2c(xensiv_pasco2_t * dev, cyhal_i2c_t * i2c);
  */
 cy_rslt_t xensiv_pasco2_mtb_init_uart(xensiv_pasco2_t * dev, cyhal_uart_t * uart);
 
+/** Registers the application handler of the events of the UART object used by the sensor.
+ * Once \ref xensiv_pasco2_mtb_init_uart has taken over the callback of the UART object, every event is
+ * passed on to this handler; otherwise the handler is registered on the UART object directly.
+ * The events the handler needs are enabled with cyhal_uart_enable_event as usual.
+ *
+ * @param[in]   uart            Pointer to the UART object used by the sensor
+ * @param[in]   callback        Function called on UART events; NULL to unregister
+ * @param[in]   callback_arg    Argument for the callback; can be NULL
+ */
+void xensiv_pasco2_mtb_uart_register_callback(cyhal_uart_t * uart, cyhal_uart_event_callback_t callback, void * callback_arg);
+
 /** Configures a GPIO pin as an interrupt for the PAS CO2 sensor.
  * This initializes and configures the pin as an interrupt, and calls the PAS CO2 interrupt
  * configuration API with the application-supplied settings structure
@@ -143,7 +171,7 @@ cy_rslt_t xensiv_pasco2_mtb_init_uart(xensiv_pasco2_t * dev, cyhal_uart_t * uart
  * @param[in] callback_arg      Generic argument that will be provided to the callback when called; can be NULL
  * @return CY_RSLT_SUCCESS if interrupt was successfully enabled; an error occurred while initializing the pin otherwise
  */
-cy_rslt_t xensiv_pasco2_mtb_interrupt_init(const xensiv_pasco2_t * dev,
+cy_rslt_t xensiv_pasco2_mtb_interrupt_init(xensiv_pasco2_t * dev,
                                            const xensiv_pasco2_interrupt_config_t int_config,
                                            uint16_t alarm_threshold,
                                            cyhal_gpio_t pin,
@@ -173,6 +201,23 @@ cy_rslt_t xensiv_pasco2_mtb_interrupt_init_ex(xensiv_pasco2_t * dev,
                                               uint8_t intr_priority,
                                               xensiv_pasco2_mtb_interrupt_cb_t * interrupt_cb);
 
+/** Initializes the asynchronous engine for a PAS CO2 sensor connected over I2C.
+ * This registers the I2C event handler that reports the end of each transfer to the engine,
+ * replacing any callback registered on the I2C object.
+ * \note Should be called only after \ref xensiv_pasco2_mtb_init_i2c.
+ * @param[out] engine           Pointer to the engine structure allocated by the user
+ * @param[in] dev               Pointer to the PAS CO2 sensor device
+ * @param[in] intr_priority     Priority for the I2C interrupt events
+ * @param[in] wake              Function called when \ref xensiv_pasco2_async_process should run; may be called from an interrupt
+ * @param[in] wake_arg          Argument for the wake function
+ * @return CY_RSLT_SUCCESS if the engine was initialized
+ */
+cy_rslt_t xensiv_pasco2_mtb_async_init(xensiv_pasco2_async_t * engine,
+                                       xensiv_pasco2_t * dev,
+                                       uint8_t intr_priority,
+                                       void (*wake)(void * arg),
+                                       void * wake_arg);
+
 /** Reads the CO2 value value if available.
  * This checks whether a new CO2 value is available, in which case it returns it and sets the new pressure reference value for the next measurement
  * @param[in] obj           Pointer to the ModusToolbox&trade PAS CO2 object
@@ -181,7 +226,7 @@ cy_rslt_t xensiv_pasco2_mtb_interrupt_init_ex(xensiv_pasco2_t * dev,
  * @return CY_RSLT_SUCCESS if PPM value was successfully read.
  *         XENSIV_PASCO2_RSLT_READ_NRDY if the measurement value is not ready yet; an error indicating what went wrong otherwise
  */
-cy_rslt_t xensiv_pasco2_mtb_read(const xensiv_pasco2_t * dev, uint16_t press_ref, uint16_t * co2_ppm_val);
+cy_rslt_t xensiv_pasco2_mtb_read(xensiv_pasco2_t * dev, uint16_t press_ref, uint16_t * co2_ppm_val);
 
 #ifdef __cplusplus
 }
@@ -55,6 +55,21 @@ extern "C" {
  */
 int32_t xensiv_pasco2_plat_i2c_transfer(void * ctx, uint16_t dev_addr, const uint8_t * tx_buffer, size_t tx_len, uint8_t * rx_buffer, size_t rx_len);
 
+/**
+ * @brief Target platform-specific function to start an I2C write/read transfer without waiting for it.
+ * Same semantics as \ref xensiv_pasco2_plat_i2c_transfer, but returns as soon as the transfer has been started.
+ * The platform must report the end of the transfer with \ref xensiv_pasco2_async_xfer_done.
+ * Only required when the asynchronous interface (xensiv_pasco2_async.h) is used.
+ * @param[in] ctx Target platform object
+ * @param[in] dev_addr device address (7-bit)
+ * @param[in] tx_buffer I2C send data
+ * @param[in] tx_len I2C send data size
+ * @param[in] rx_buffer I2C receive data @note Can be NULL to indicate no read access.
+ * @param[in] rx_len I2C receive data size
+ * @return XENSIV_PASCO2_OK if the I2C transfer was started; an error indicating what went wrong otherwise
+ */
+int32_t xensiv_pasco2_plat_i2c_transfer_async(void * ctx, uint16_t dev_addr, const uint8_t * tx_buffer, size_t tx_len, uint8_t * rx_buffer, size_t rx_len);
+
 /**
  * @brief Target platform-specific function to read over UART
  *
@@ -82,6 +97,16 @@ int32_t xensiv_pasco2_plat_uart_write(void *ctx, uint8_t * data, size_t len);
  */
 void xensiv_pasco2_plat_delay(uint32_t ms);
 
+/**
+ * @brief Target platform-specific function that returns a free-running time base in milliseconds.
+ * Used to space consecutive commands to the sensor only when they would otherwise arrive too early.
+ * The value is allowed to wrap around. A platform without a time base may return a constant, in which
+ * case every command is followed by the full inter-command delay.
+ *
+ * @return Current time in milliseconds
+ */
+uint32_t xensiv_pasco2_plat_get_time_ms(void);
+
 /**
  * @brief Target platform-specific function to reverse the byte order (16-bit)
  * A sample implementation would look like 
@@ -0,0 +1,99 @@
+/***********************************************************************************************//**
+ * \file xensiv_pasco2_rate.c
+ *
+ * Description: This file contains the adaptive measurement rate controller
+ *              for the XENSIV™ PAS CO2 sensor.
+ *
+ ***************************************************************************************************
+ * \copyright
+ * Copyright 2023 Infineon Technologies AG
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************************************/
+
+#include "xensiv_pasco2_rate.h"
+#include "xensiv_pasco2_platform.h"
+
+void xensiv_pasco2_rate_init(xensiv_pasco2_rate_ctrl_t * ctrl, const xensiv_pasco2_rate_config_t * config)
+{
+    xensiv_pasco2_plat_assert(ctrl != NULL);
+    xensiv_pasco2_plat_assert(config != NULL);
+    xensiv_pasco2_plat_assert(config->fast_rate_s >= XENSIV_PASCO2_MEAS_RATE_MIN);
+    xensiv_pasco2_plat_assert((config->slow_rate_s >= config->fast_rate_s) && (config->slow_rate_s <= XENSIV_PASCO2_MEAS_RATE_MAX));
+    xensiv_pasco2_plat_assert(config->stable_samples > 0U);
+
+    ctrl->config = *config;
+    ctrl->rate_s = config->fast_rate_s;
+    ctrl->last_ppm = 0U;
+    ctrl->has_last = false;
+    ctrl->subscribed = false;
+    ctrl->stable = 0U;
+}
+
+uint16_t xensiv_pasco2_rate_update(xensiv_pasco2_rate_ctrl_t * ctrl, uint16_t co2_ppm)
+{
+    xensiv_pasco2_plat_assert(ctrl != NULL);
+
+    const xensiv_pasco2_rate_config_t * config = &(ctrl->config);
+
+    if (ctrl->has_last)
+    {
+        uint32_t delta = (co2_ppm > ctrl->last_ppm) ? (uint32_t)(co2_ppm - ctrl->last_ppm) : (uint32_t)(ctrl->last_ppm - co2_ppm);
+        uint32_t slope = (delta * 60U) / ctrl->rate_s;
+
+        if (slope >= config->fast_slope_ppm_min)
+        {
+            ctrl->rate_s = config->fast_rate_s;
+            ctrl->stable = 0U;
+        }
+        else if (delta > config->stable_ppm)
+        {
+            ctrl->rate_s = (uint16_t)(ctrl->rate_s / 2U);
+            if (ctrl->rate_s < config->fast_rate_s)
+            {
+                ctrl->rate_s = config->fast_rate_s;
+            }
+            ctrl->stable = 0U;
+        }
+        else if (!ctrl->subscribed && (++ctrl->stable >= config->stable_samples))
+        {
+            uint32_t rate = (uint32_t)ctrl->rate_s * 2U;
+            ctrl->rate_s = (rate < config->slow_rate_s) ? (uint16_t)rate : config->slow_rate_s;
+            ctrl->stable = 0U;
+        }
+        else
+        {
+            /* Keep the period */
+        }
+    }
+
+    ctrl->last_ppm = co2_ppm;
+    ctrl->has_last = true;
+
+    return ctrl->rate_s;
+}
+
+uint16_t xensiv_pasco2_rate_set_subscribed(xensiv_pasco2_rate_ctrl_t * ctrl, bool subscribed)
+{
+    xensiv_pasco2_plat_assert(ctrl != NULL);
+
+    if (subscribed && !ctrl->subscribed)
+    {
+        ctrl->rate_s = ctrl->config.fast_rate_s;
+        ctrl->stable = 0U;
+    }
+    ctrl->subscribed = subscribed;
+
+    return ctrl->rate_s;
+}
@@ -0,0 +1,109 @@
+/***********************************************************************************************//**
+ * \file xensiv_pasco2_rate.h
+ *
+ * Description: This file contains the adaptive measurement rate controller
+ *              for the XENSIV™ PAS CO2 sensor.
+ *
+ ***************************************************************************************************
+ * \copyright
+ * Copyright 2023 Infineon Technologies AG
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************************************/
+
+#ifndef XENSIV_PASCO2_RATE_H_
+#define XENSIV_PASCO2_RATE_H_
+
+#include "xensiv_pasco2.h"
+
+/**
+ * \addtogroup group_board_libs_rate XENSIV™ PAS CO2 sensor adaptive measurement rate
+ * \{
+ * Chooses the measurement period of the sensor in continuous mode from the measured values.
+ *
+ * Every measurement costs the sensor an emitter pulse, and every result read costs bus traffic, so the period
+ * is kept as long as the readings allow:
+ * - while a consumer is subscribed, or when the concentration changes by at least fast_slope_ppm_min,
+ *   the controller selects fast_rate_s
+ * - when a reading differs from the previous one by more than stable_ppm, the period is halved
+ * - after stable_samples consecutive readings within stable_ppm, the period is doubled up to slow_rate_s
+ *
+ * The controller does not access the sensor. The owner applies the returned period with
+ * \ref xensiv_pasco2_start_continuous_mode or the equivalent asynchronous requests, as the sensor only
+ * accepts a new period in idle mode.
+ */
+
+/********************************* Type definitions **************************************/
+
+/** Structure of the controller parameters */
+typedef struct
+{
+    uint16_t fast_rate_s;                               /*!< Shortest measurement period [5-4095s] */
+    uint16_t slow_rate_s;                               /*!< Longest measurement period [fast_rate_s-4095s] */
+    uint16_t stable_ppm;                                /*!< Largest difference between consecutive readings considered stable */
+    uint16_t fast_slope_ppm_min;                        /*!< Rate of change selecting fast_rate_s [ppm/min] */
+    uint8_t stable_samples;                             /*!< Stable readings after which the period is doubled */
+} xensiv_pasco2_rate_config_t;
+
+/** Structure of the controller state. Initialized using \ref xensiv_pasco2_rate_init */
+typedef struct
+{
+    xensiv_pasco2_rate_config_t config;                 /*!< Controller parameters */
+    uint16_t rate_s;                                    /*!< Selected measurement period */
+    uint16_t last_ppm;                                  /*!< Previous reading */
+    bool has_last;                                      /*!< last_ppm holds a reading */
+    bool subscribed;                                    /*!< A consumer is subscribed to the readings */
+    uint8_t stable;                                     /*!< Consecutive stable readings at the selected period */
+} xensiv_pasco2_rate_ctrl_t;
+
+/******************************* Function prototypes *************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the controller. The selected period starts at fast_rate_s
+ *
+ * @param[out] ctrl Pointer to the controller state allocated by the user
+ * @param[in] config Controller parameters; copied
+ */
+void xensiv_pasco2_rate_init(xensiv_pasco2_rate_ctrl_t * ctrl, const xensiv_pasco2_rate_config_t * config);
+
+/**
+ * @brief Feeds a new reading, taken at the currently selected period, to the controller
+ *
+ * @param[inout] ctrl Pointer to the controller state
+ * @param[in] co2_ppm CO2 concentration read from the sensor
+ * @return Measurement period to run at
+ */
+uint16_t xensiv_pasco2_rate_update(xensiv_pasco2_rate_ctrl_t * ctrl, uint16_t co2_ppm);
+
+/**
+ * @brief Sets whether a consumer is subscribed to the readings. A subscription selects fast_rate_s at once,
+ * which is kept until the subscription ends
+ *
+ * @param[inout] ctrl Pointer to the controller state
+ * @param[in] subscribed true while a consumer is subscribed
+ * @return Measurement period to run at
+ */
+uint16_t xensiv_pasco2_rate_set_subscribed(xensiv_pasco2_rate_ctrl_t * ctrl, bool subscribed);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** \} group_board_libs_rate */
+
+#endif
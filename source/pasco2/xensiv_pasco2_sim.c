@@ -0,0 +1,786 @@
+/***********************************************************************************************//**
+ * \file xensiv_pasco2_sim.c
+ *
+ * Description: This file contains the register-level simulator of the
+ *              XENSIV™ PAS CO2 sensor for host builds.
+ *
+ ***************************************************************************************************
+ * \copyright
+ * Copyright 2023 Infineon Technologies AG
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************************************/
+
+#if defined(XENSIV_PASCO2_SIM)
+
+#include <assert.h>
+#include <string.h>
+
+#include "xensiv_pasco2_sim.h"
+
+#define XENSIV_PASCO2_SIM_PROD_ID               (0x42U)
+#define XENSIV_PASCO2_SIM_MEAS_RATE_S           (60U)
+#define XENSIV_PASCO2_SIM_PRESS_REF_HPA         (1015U)
+#define XENSIV_PASCO2_SIM_CALIB_REF_PPM         (400U)
+#define XENSIV_PASCO2_SIM_UART_ACK              (0x06U)
+#define XENSIV_PASCO2_SIM_UART_NAK              (0x15U)
+#define XENSIV_PASCO2_SIM_UART_READ_CMD_LEN     (5U)
+#define XENSIV_PASCO2_SIM_UART_WRITE_CMD_LEN    (8U)
+
+/* Sensor used by the platform functions without a context */
+static xensiv_pasco2_sim_t * xensiv_pasco2_sim_active = NULL;
+
+static inline bool xensiv_pasco2_sim_reached(uint32_t now, uint32_t t)
+{
+    return ((int32_t)(now - t) >= 0);
+}
+
+static inline uint16_t xensiv_pasco2_sim_get_u16(const xensiv_pasco2_sim_t * sim, uint8_t reg_addr)
+{
+    return (uint16_t)(((uint16_t)sim->regs[reg_addr] << 8) | sim->regs[reg_addr + 1U]);
+}
+
+static inline void xensiv_pasco2_sim_set_u16(xensiv_pasco2_sim_t * sim, uint8_t reg_addr, uint16_t val)
+{
+    sim->regs[reg_addr] = (uint8_t)(val >> 8);
+    sim->regs[reg_addr + 1U] = (uint8_t)(val & 0xFFU);
+}
+
+static inline uint8_t xensiv_pasco2_sim_op_mode(const xensiv_pasco2_sim_t * sim)
+{
+    return (uint8_t)((sim->regs[XENSIV_PASCO2_REG_MEAS_CFG] & XENSIV_PASCO2_REG_MEAS_CFG_OP_MODE_MSK) >> XENSIV_PASCO2_REG_MEAS_CFG_OP_MODE_POS);
+}
+
+static inline uint8_t xensiv_pasco2_sim_boc_cfg(const xensiv_pasco2_sim_t * sim)
+{
+    return (uint8_t)((sim->regs[XENSIV_PASCO2_REG_MEAS_CFG] & XENSIV_PASCO2_REG_MEAS_CFG_BOC_CFG_MSK) >> XENSIV_PASCO2_REG_MEAS_CFG_BOC_CFG_POS);
+}
+
+static inline uint8_t xensiv_pasco2_sim_int_func(const xensiv_pasco2_sim_t * sim)
+{
+    return (uint8_t)((sim->regs[XENSIV_PASCO2_REG_INT_CFG] & XENSIV_PASCO2_REG_INT_CFG_INT_FUNC_MSK) >> XENSIV_PASCO2_REG_INT_CFG_INT_FUNC_POS);
+}
+
+static uint32_t xensiv_pasco2_sim_period_ms(const xensiv_pasco2_sim_t * sim)
+{
+    uint32_t rate = xensiv_pasco2_sim_get_u16(sim, XENSIV_PASCO2_REG_MEAS_RATE_H);
+    if (rate < XENSIV_PASCO2_MEAS_RATE_MIN)
+    {
+        rate = XENSIV_PASCO2_MEAS_RATE_MIN;
+    }
+    else if (rate > XENSIV_PASCO2_MEAS_RATE_MAX)
+    {
+        rate = XENSIV_PASCO2_MEAS_RATE_MAX;
+    }
+
+    return rate * 1000U;
+}
+
+/* Recomputes the INT pin from the interrupt configuration and the sensor state */
+static void xensiv_pasco2_sim_update_pin(xensiv_pasco2_sim_t * sim)
+{
+    bool active;
+
+    switch (xensiv_pasco2_sim_int_func(sim))
+    {
+        case XENSIV_PASCO2_INTERRUPT_FUNCTION_ALARM:
+        case XENSIV_PASCO2_INTERRUPT_FUNCTION_DRDY:
+            active = ((sim->regs[XENSIV_PASCO2_REG_MEAS_STS] & XENSIV_PASCO2_REG_MEAS_STS_INT_STS_MSK) != 0U);
+            break;
+
+        case XENSIV_PASCO2_INTERRUPT_FUNCTION_BUSY:
+            active = sim->meas_running;
+            break;
+
+        case XENSIV_PASCO2_INTERRUPT_FUNCTION_EARLY:
+            active = (XENSIV_PASCO2_OP_MODE_CONTINUOUS == xensiv_pasco2_sim_op_mode(sim)) && !sim->meas_running &&
+                     xensiv_pasco2_sim_reached(sim->now_ms, sim->next_meas_ms - XENSIV_PASCO2_SIM_EARLY_MS);
+            break;
+
+        default:
+            active = false;
+            break;
+    }
+
+    bool high_active = ((sim->regs[XENSIV_PASCO2_REG_INT_CFG] & XENSIV_PASCO2_REG_INT_CFG_INT_TYP_MSK) != 0U);
+    bool level = (active == high_active);
+
+    if (level != sim->int_level)
+    {
+        sim->int_level = level;
+        if (sim->int_cb != NULL)
+        {
+            sim->int_cb(sim->int_cb_arg, level);
+        }
+    }
+}
+
+/* Latches INT_STS, which keeps the INT pin active until it is cleared */
+static void xensiv_pasco2_sim_latch_int(xensiv_pasco2_sim_t * sim)
+{
+    sim->regs[XENSIV_PASCO2_REG_MEAS_STS] |= XENSIV_PASCO2_REG_MEAS_STS_INT_STS_MSK;
+}
+
+static int32_t xensiv_pasco2_sim_noise(xensiv_pasco2_sim_t * sim)
+{
+    if (0U == sim->wave.noise_ppm)
+    {
+        return 0;
+    }
+
+    /* Numerical Recipes LCG; the upper bits have the longest period */
+    sim->noise_state = (sim->noise_state * 1664525U) + 1013904223U;
+    return (int32_t)((sim->noise_state >> 16) % ((2U * sim->wave.noise_ppm) + 1U)) - (int32_t)sim->wave.noise_ppm;
+}
+
+static void xensiv_pasco2_sim_start_measurement(xensiv_pasco2_sim_t * sim)
+{
+    if (!sim->meas_running)
+    {
+        sim->meas_running = true;
+        sim->meas_done_ms = sim->now_ms + XENSIV_PASCO2_SIM_MEAS_DURATION_MS;
+    }
+}
+
+static void xensiv_pasco2_sim_complete_measurement(xensiv_pasco2_sim_t * sim)
+{
+    sim->meas_running = false;
+    sim->measurements++;
+
+    /* The sensor compensates for the pressure in PRESS_REF; any difference to the real pressure
+     * shows up as a proportional error */
+    int32_t ppm = (int32_t)xensiv_pasco2_sim_get_true_ppm(sim) + xensiv_pasco2_sim_noise(sim);
+    uint16_t press_ref = xensiv_pasco2_sim_get_u16(sim, XENSIV_PASCO2_REG_PRESS_REF_H);
+    if (press_ref != 0U)
+    {
+        ppm = (ppm * (int32_t)sim->ambient_hpa) / (int32_t)press_ref;
+    }
+
+    if (XENSIV_PASCO2_BOC_CFG_FORCED == xensiv_pasco2_sim_boc_cfg(sim))
+    {
+        if (++sim->fcs_meas >= XENSIV_PASCO2_SIM_FCS_MEAS_COUNT)
+        {
+            sim->offset_ppm = (int16_t)((int32_t)xensiv_pasco2_sim_get_u16(sim, XENSIV_PASCO2_REG_CALIB_REF_H) - ppm);
+            sim->regs[XENSIV_PASCO2_REG_MEAS_CFG] &= (uint8_t)~XENSIV_PASCO2_REG_MEAS_CFG_BOC_CFG_MSK;
+            sim->regs[XENSIV_PASCO2_REG_MEAS_CFG] |= (uint8_t)(XENSIV_PASCO2_BOC_CFG_AUTOMATIC << XENSIV_PASCO2_REG_MEAS_CFG_BOC_CFG_POS);
+        }
+    }
+
+    ppm += sim->offset_ppm;
+    if (ppm < 0)
+    {
+        ppm = 0;
+    }
+    else if (ppm > 0x7FFF)
+    {
+        ppm = 0x7FFF;
+    }
+
+    xensiv_pasco2_sim_set_u16(sim, XENSIV_PASCO2_REG_CO2PPM_H, (uint16_t)ppm);
+    sim->regs[XENSIV_PASCO2_REG_MEAS_STS] |= XENSIV_PASCO2_REG_MEAS_STS_DRDY_MSK;
+
+    uint16_t threshold = xensiv_pasco2_sim_get_u16(sim, XENSIV_PASCO2_REG_ALARM_TH_H);
+    bool low_to_high = ((sim->regs[XENSIV_PASCO2_REG_INT_CFG] & XENSIV_PASCO2_REG_INT_CFG_ALARM_TYP_MSK) != 0U);
+    bool alarm = low_to_high ? (ppm > (int32_t)threshold) : (ppm < (int32_t)threshold);
+    if (alarm)
+    {
+        sim->regs[XENSIV_PASCO2_REG_MEAS_STS] |= XENSIV_PASCO2_REG_MEAS_STS_ALARM_MSK;
+    }
+
+    uint8_t int_func = xensiv_pasco2_sim_int_func(sim);
+    if ((XENSIV_PASCO2_INTERRUPT_FUNCTION_DRDY == int_func) ||
+        ((XENSIV_PASCO2_INTERRUPT_FUNCTION_ALARM == int_func) && alarm))
+    {
+        xensiv_pasco2_sim_latch_int(sim);
+    }
+
+    if (XENSIV_PASCO2_OP_MODE_SINGLE == xensiv_pasco2_sim_op_mode(sim))
+    {
+        sim->regs[XENSIV_PASCO2_REG_MEAS_CFG] &= (uint8_t)~XENSIV_PASCO2_REG_MEAS_CFG_OP_MODE_MSK;
+    }
+}
+
+/* Restores the power-on register contents; the sensor restarts and does not respond for a while */
+static void xensiv_pasco2_sim_reset(xensiv_pasco2_sim_t * sim)
+{
+    (void)memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[XENSIV_PASCO2_REG_PROD_ID] = XENSIV_PASCO2_SIM_PROD_ID;
+    sim->regs[XENSIV_PASCO2_REG_SENS_STS] = XENSIV_PASCO2_REG_SENS_STS_SEN_RDY_MSK;
+    xensiv_pasco2_sim_set_u16(sim, XENSIV_PASCO2_REG_MEAS_RATE_H, XENSIV_PASCO2_SIM_MEAS_RATE_S);
+    sim->regs[XENSIV_PASCO2_REG_MEAS_CFG] = (uint8_t)(XENSIV_PASCO2_REG_MEAS_CFG_PWM_OUTEN_MSK |
+                                                      (XENSIV_PASCO2_BOC_CFG_AUTOMATIC << XENSIV_PASCO2_REG_MEAS_CFG_BOC_CFG_POS));
+    sim->regs[XENSIV_PASCO2_REG_INT_CFG] = XENSIV_PASCO2_REG_INT_CFG_INT_TYP_MSK;
+    xensiv_pasco2_sim_set_u16(sim, XENSIV_PASCO2_REG_PRESS_REF_H, XENSIV_PASCO2_SIM_PRESS_REF_HPA);
+    xensiv_pasco2_sim_set_u16(sim, XENSIV_PASCO2_REG_CALIB_REF_H, XENSIV_PASCO2_SIM_CALIB_REF_PPM);
+
+    sim->meas_running = false;
+    sim->fcs_meas = 0U;
+    sim->offset_ppm = sim->saved_offset_ppm;
+    sim->uart_rx_len = 0U;
+    sim->ready_ms = sim->now_ms + XENSIV_PASCO2_SIM_BOOT_MS;
+
+    xensiv_pasco2_sim_update_pin(sim);
+}
+
+static void xensiv_pasco2_sim_cmd(xensiv_pasco2_sim_t * sim, uint8_t cmd)
+{
+    switch (cmd)
+    {
+        case XENSIV_PASCO2_CMD_SOFT_RESET:
+            xensiv_pasco2_sim_reset(sim);
+            break;
+
+        case XENSIV_PASCO2_CMD_SAVE_FCS_CALIB_OFFSET:
+            sim->saved_offset_ppm = sim->offset_ppm;
+            break;
+
+        case XENSIV_PASCO2_CMD_RESET_FCS:
+            sim->offset_ppm = 0;
+            sim->saved_offset_ppm = 0;
+            break;
+
+        default:
+            /* XENSIV_PASCO2_CMD_RESET_ABOC: the automatic compensation is not modeled */
+            break;
+    }
+}
+
+static uint8_t xensiv_pasco2_sim_read_reg(xensiv_pasco2_sim_t * sim, uint8_t reg_addr)
+{
+    if (reg_addr >= XENSIV_PASCO2_SIM_REG_COUNT)
+    {
+        return 0U;
+    }
+
+    uint8_t val = sim->regs[reg_addr];
+
+    if (XENSIV_PASCO2_REG_MEAS_STS == reg_addr)
+    {
+        /* DRDY is cleared by reading the status */
+        if ((val & XENSIV_PASCO2_REG_MEAS_STS_DRDY_MSK) != 0U)
+        {
+            sim->results_read++;
+        }
+        sim->regs[reg_addr] &= (uint8_t)~XENSIV_PASCO2_REG_MEAS_STS_DRDY_MSK;
+    }
+    else if (XENSIV_PASCO2_REG_SENS_RST == reg_addr)
+    {
+        val = 0U;
+    }
+    else
+    {
+        /* Plain register */
+    }
+
+    return val;
+}
+
+static void xensiv_pasco2_sim_write_reg(xensiv_pasco2_sim_t * sim, uint8_t reg_addr, uint8_t val)
+{
+    switch (reg_addr)
+    {
+        case XENSIV_PASCO2_REG_PROD_ID:
+        case XENSIV_PASCO2_REG_CO2PPM_H:
+        case XENSIV_PASCO2_REG_CO2PPM_L:
+            /* Read-only */
+            break;
+
+        case XENSIV_PASCO2_REG_SENS_STS:
+            if ((val & XENSIV_PASCO2_REG_SENS_STS_ICCER_CLR_MSK) != 0U)
+            {
+                sim->regs[reg_addr] &= (uint8_t)~XENSIV_PASCO2_REG_SENS_STS_ICCER_MSK;
+            }
+            if ((val & XENSIV_PASCO2_REG_SENS_STS_ORVS_CLR_MSK) != 0U)
+            {
+                sim->regs[reg_addr] &= (uint8_t)~XENSIV_PASCO2_REG_SENS_STS_ORVS_MSK;
+            }
+            if ((val & XENSIV_PASCO2_REG_SENS_STS_ORTMP_CLR_MSK) != 0U)
+            {
+                sim->regs[reg_addr] &= (uint8_t)~XENSIV_PASCO2_REG_SENS_STS_ORTMP_MSK;
+            }
+            break;
+
+        case XENSIV_PASCO2_REG_MEAS_STS:
+            if ((val & XENSIV_PASCO2_REG_MEAS_STS_ALARM_CLR_MSK) != 0U)
+            {
+                sim->regs[reg_addr] &= (uint8_t)~XENSIV_PASCO2_REG_MEAS_STS_ALARM_MSK;
+            }
+            if ((val & XENSIV_PASCO2_REG_MEAS_STS_INT_STS_CLR_MSK) != 0U)
+            {
+                sim->regs[reg_addr] &= (uint8_t)~XENSIV_PASCO2_REG_MEAS_STS_INT_STS_MSK;
+            }
+            break;
+
+        case XENSIV_PASCO2_REG_MEAS_CFG:
+        {
+            uint8_t prev_mode = xensiv_pasco2_sim_op_mode(sim);
+            sim->regs[reg_addr] = val;
+
+            if (XENSIV_PASCO2_BOC_CFG_FORCED == xensiv_pasco2_sim_boc_cfg(sim))
+            {
+                sim->fcs_meas = 0U;
+            }
+
+            uint8_t mode = xensiv_pasco2_sim_op_mode(sim);
+            if (XENSIV_PASCO2_OP_MODE_SINGLE == mode)
+            {
+                xensiv_pasco2_sim_start_measurement(sim);
+            }
+            else if ((XENSIV_PASCO2_OP_MODE_CONTINUOUS == mode) && (XENSIV_PASCO2_OP_MODE_CONTINUOUS != prev_mode))
+            {
+                xensiv_pasco2_sim_start_measurement(sim);
+                sim->next_meas_ms = sim->now_ms + xensiv_pasco2_sim_period_ms(sim);
+            }
+            else
+            {
+                /* A measurement in progress completes in idle mode */
+            }
+            break;
+        }
+
+        case XENSIV_PASCO2_REG_SENS_RST:
+            xensiv_pasco2_sim_cmd(sim, val);
+            break;
+
+        default:
+            if (reg_addr < XENSIV_PASCO2_SIM_REG_COUNT)
+            {
+                sim->regs[reg_addr] = val;
+            }
+            break;
+    }
+
+    xensiv_pasco2_sim_update_pin(sim);
+}
+
+/* Accounts for the transmission time of a bus access and checks whether the sensor answers. A UART command
+ * sent after the response to the previous one was read is paced by that handshake, not by the spacing */
+static bool xensiv_pasco2_sim_bus_access(xensiv_pasco2_sim_t * sim, size_t bytes, uint32_t byte_us, bool handshake)
+{
+    if ((sim->transfers > 0U) && !handshake && ((sim->now_ms - sim->last_cmd_ms) < XENSIV_PASCO2_COMM_DELAY_MS))
+    {
+        sim->spacing_violations++;
+    }
+
+    sim->transfers++;
+    sim->bus_bytes += (uint32_t)bytes;
+
+    uint32_t us = sim->now_us + ((uint32_t)bytes * byte_us);
+    sim->now_us = us % 1000U;
+    xensiv_pasco2_sim_advance(sim, us / 1000U);
+    sim->last_cmd_ms = sim->now_ms;
+
+    if (!xensiv_pasco2_sim_reached(sim->now_ms, sim->ready_ms))
+    {
+        sim->nacks++;
+        return false;
+    }
+
+    return true;
+}
+
+static int32_t xensiv_pasco2_sim_i2c_transfer(xensiv_pasco2_sim_t * sim, uint16_t dev_addr, const uint8_t * tx_buffer, size_t tx_len, uint8_t * rx_buffer, size_t rx_len)
+{
+    /* Address byte of each phase plus payload */
+    size_t bytes = 1U + tx_len + ((rx_buffer != NULL) ? (1U + rx_len) : 0U);
+
+    if (!xensiv_pasco2_sim_bus_access(sim, bytes, XENSIV_PASCO2_SIM_I2C_BYTE_US, false) ||
+        (XENSIV_PASCO2_I2C_ADDR != dev_addr) || (0U == tx_len))
+    {
+        return XENSIV_PASCO2_ERR_COMM;
+    }
+
+    uint8_t reg_addr = tx_buffer[0];
+
+    if ((rx_buffer == NULL) && (reg_addr == sim->nack_write_reg))
+    {
+        sim->nack_write_reg = XENSIV_PASCO2_SIM_NACK_NONE;
+        sim->nacks++;
+        return XENSIV_PASCO2_ERR_COMM;
+    }
+
+    if (rx_buffer != NULL)
+    {
+        for (size_t i = 0U; i < rx_len; ++i)
+        {
+            rx_buffer[i] = xensiv_pasco2_sim_read_reg(sim, (uint8_t)(reg_addr + i));
+        }
+    }
+    else
+    {
+        for (size_t i = 1U; i < tx_len; ++i)
+        {
+            xensiv_pasco2_sim_write_reg(sim, (uint8_t)(reg_addr + i - 1U), tx_buffer[i]);
+        }
+    }
+
+    return XENSIV_PASCO2_OK;
+}
+
+static bool xensiv_pasco2_sim_hex(uint8_t c, uint8_t * digit)
+{
+    if ((c >= (uint8_t)'0') && (c <= (uint8_t)'9'))
+    {
+        *digit = (uint8_t)(c - (uint8_t)'0');
+    }
+    else if ((c >= (uint8_t)'A') && (c <= (uint8_t)'F'))
+    {
+        *digit = (uint8_t)(c - (uint8_t)'A' + 10U);
+    }
+    else if ((c >= (uint8_t)'a') && (c <= (uint8_t)'f'))
+    {
+        *digit = (uint8_t)(c - (uint8_t)'a' + 10U);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+static bool xensiv_pasco2_sim_hex_byte(const uint8_t * p, uint8_t * val)
+{
+    uint8_t hi;
+    uint8_t lo;
+    bool ok = xensiv_pasco2_sim_hex(p[0], &hi) && xensiv_pasco2_sim_hex(p[1], &lo);
+
+    *val = (uint8_t)((hi << 4) | lo);
+    return ok;
+}
+
+static void xensiv_pasco2_sim_uart_respond(xensiv_pasco2_sim_t * sim, uint8_t b0, uint8_t b1, bool three)
+{
+    size_t len = three ? 3U : 2U;
+
+    if (((size_t)sim->uart_rx_len + len) <= sizeof(sim->uart_rx))
+    {
+        sim->uart_rx[sim->uart_rx_len++] = b0;
+        if (three)
+        {
+            sim->uart_rx[sim->uart_rx_len++] = b1;
+        }
+        sim->uart_rx[sim->uart_rx_len++] = (uint8_t)'\n';
+    }
+}
+
+static inline uint8_t xensiv_pasco2_sim_ascii(uint8_t digit)
+{
+    return (uint8_t)((digit < 10U) ? (digit + 0x30U) : (digit + 0x37U));
+}
+
+/* Executes the ASCII commands "r,AA\n" and "w,AA,DD\n" in order and queues their responses */
+static void xensiv_pasco2_sim_uart_commands(xensiv_pasco2_sim_t * sim, const uint8_t * data, size_t len)
+{
+    size_t pos = 0U;
+
+    while (pos < len)
+    {
+        if (pos > 0U)
+        {
+            /* Sent before the sensor answered the previous command */
+            sim->uart_queued++;
+        }
+
+        const uint8_t * cmd = &data[pos];
+        size_t left = len - pos;
+        uint8_t reg_addr;
+        uint8_t val;
+
+        if ((left >= XENSIV_PASCO2_SIM_UART_READ_CMD_LEN) && ((uint8_t)'r' == cmd[0]) && ((uint8_t)',' == cmd[1]) &&
+            xensiv_pasco2_sim_hex_byte(&cmd[2], &reg_addr) && ((uint8_t)'\n' == cmd[4]))
+        {
+            val = xensiv_pasco2_sim_read_reg(sim, reg_addr);
+            xensiv_pasco2_sim_uart_respond(sim, xensiv_pasco2_sim_ascii(val >> 4), xensiv_pasco2_sim_ascii(val & 0x0FU), true);
+            pos += XENSIV_PASCO2_SIM_UART_READ_CMD_LEN;
+        }
+        else if ((left >= XENSIV_PASCO2_SIM_UART_WRITE_CMD_LEN) && ((uint8_t)'w' == cmd[0]) && ((uint8_t)',' == cmd[1]) &&
+                 xensiv_pasco2_sim_hex_byte(&cmd[2], &reg_addr) && ((uint8_t)',' == cmd[4]) &&
+                 xensiv_pasco2_sim_hex_byte(&cmd[5], &val) && ((uint8_t)'\n' == cmd[7]))
+        {
+            bool soft_reset = (XENSIV_PASCO2_REG_SENS_RST == reg_addr) && ((uint8_t)XENSIV_PASCO2_CMD_SOFT_RESET == val);
+
+            xensiv_pasco2_sim_write_reg(sim, reg_addr, val);
+            if (!soft_reset)
+            {
+                xensiv_pasco2_sim_uart_respond(sim, XENSIV_PASCO2_SIM_UART_ACK, 0U, false);
+            }
+            pos += XENSIV_PASCO2_SIM_UART_WRITE_CMD_LEN;
+        }
+        else
+        {
+            /* Invalid command: flag it, answer NAK and resynchronize on the next line */
+            sim->regs[XENSIV_PASCO2_REG_SENS_STS] |= XENSIV_PASCO2_REG_SENS_STS_ICCER_MSK;
+            xensiv_pasco2_sim_uart_respond(sim, XENSIV_PASCO2_SIM_UART_NAK, 0U, false);
+            while ((pos < len) && ((uint8_t)'\n' != data[pos]))
+            {
+                pos++;
+            }
+            pos++;
+        }
+    }
+}
+
+void xensiv_pasco2_sim_init(xensiv_pasco2_sim_t * sim)
+{
+    assert(sim != NULL);
+
+    (void)memset(sim, 0, sizeof(*sim));
+    sim->ambient_hpa = XENSIV_PASCO2_SIM_PRESS_REF_HPA;
+    sim->wave.type = XENSIV_PASCO2_SIM_WAVE_CONSTANT;
+    sim->wave.base_ppm = XENSIV_PASCO2_SIM_CALIB_REF_PPM;
+    sim->noise_state = 1U;
+    sim->nack_write_reg = XENSIV_PASCO2_SIM_NACK_NONE;
+
+    xensiv_pasco2_sim_reset(sim);
+    sim->int_level = false;
+    xensiv_pasco2_sim_update_pin(sim);
+
+    xensiv_pasco2_sim_active = sim;
+}
+
+void xensiv_pasco2_sim_set_waveform(xensiv_pasco2_sim_t * sim, const xensiv_pasco2_sim_waveform_t * wave)
+{
+    assert(sim != NULL);
+    assert(wave != NULL);
+
+    sim->wave = *wave;
+}
+
+void xensiv_pasco2_sim_set_ambient_pressure(xensiv_pasco2_sim_t * sim, uint16_t hpa)
+{
+    assert(sim != NULL);
+
+    sim->ambient_hpa = hpa;
+}
+
+void xensiv_pasco2_sim_set_int_callback(xensiv_pasco2_sim_t * sim, xensiv_pasco2_sim_int_cb_t callback, void * callback_arg)
+{
+    assert(sim != NULL);
+
+    sim->int_cb = callback;
+    sim->int_cb_arg = callback_arg;
+}
+
+void xensiv_pasco2_sim_set_async_engine(xensiv_pasco2_sim_t * sim, xensiv_pasco2_async_t * engine)
+{
+    assert(sim != NULL);
+
+    sim->engine = engine;
+}
+
+void xensiv_pasco2_sim_nack_write(xensiv_pasco2_sim_t * sim, uint8_t reg_addr)
+{
+    assert(sim != NULL);
+
+    sim->nack_write_reg = reg_addr;
+}
+
+void xensiv_pasco2_sim_advance(xensiv_pasco2_sim_t * sim, uint32_t ms)
+{
+    assert(sim != NULL);
+
+    uint32_t target = sim->now_ms + ms;
+
+    /* Step from event to event so that the INT pin sees every edge */
+    for (;;)
+    {
+        uint32_t next = target;
+        bool continuous = (XENSIV_PASCO2_OP_MODE_CONTINUOUS == xensiv_pasco2_sim_op_mode(sim));
+
+        if (sim->meas_running && !xensiv_pasco2_sim_reached(sim->meas_done_ms, next))
+        {
+            next = sim->meas_done_ms;
+        }
+
+        if (continuous && !sim->meas_running)
+        {
+            uint32_t early = sim->next_meas_ms - XENSIV_PASCO2_SIM_EARLY_MS;
+
+            if (!xensiv_pasco2_sim_reached(sim->now_ms, early) && !xensiv_pasco2_sim_reached(early, next))
+            {
+                next = early;
+            }
+            if (!xensiv_pasco2_sim_reached(sim->next_meas_ms, next))
+            {
+                next = sim->next_meas_ms;
+            }
+        }
+
+        sim->now_ms = next;
+
+        if (sim->meas_running && xensiv_pasco2_sim_reached(sim->now_ms, sim->meas_done_ms))
+        {
+            xensiv_pasco2_sim_complete_measurement(sim);
+        }
+
+        if ((XENSIV_PASCO2_OP_MODE_CONTINUOUS == xensiv_pasco2_sim_op_mode(sim)) && !sim->meas_running &&
+            xensiv_pasco2_sim_reached(sim->now_ms, sim->next_meas_ms))
+        {
+            xensiv_pasco2_sim_start_measurement(sim);
+            sim->next_meas_ms += xensiv_pasco2_sim_period_ms(sim);
+        }
+
+        xensiv_pasco2_sim_update_pin(sim);
+
+        if (sim->now_ms == target)
+        {
+            break;
+        }
+    }
+}
+
+uint16_t xensiv_pasco2_sim_get_true_ppm(const xensiv_pasco2_sim_t * sim)
+{
+    assert(sim != NULL);
+
+    const xensiv_pasco2_sim_waveform_t * wave = &sim->wave;
+    int32_t ppm = (int32_t)wave->base_ppm;
+    uint32_t period = (wave->period_ms != 0U) ? wave->period_ms : 1U;
+    uint32_t phase = sim->now_ms % period;
+
+    switch (wave->type)
+    {
+        case XENSIV_PASCO2_SIM_WAVE_STEP:
+            if (sim->now_ms >= wave->period_ms)
+            {
+                ppm += wave->amplitude_ppm;
+            }
+            break;
+
+        case XENSIV_PASCO2_SIM_WAVE_SQUARE:
+            if (phase >= (period / 2U))
+            {
+                ppm += wave->amplitude_ppm;
+            }
+            break;
+
+        case XENSIV_PASCO2_SIM_WAVE_RAMP:
+            ppm += (int32_t)(((int64_t)wave->amplitude_ppm * phase) / (int64_t)period);
+            break;
+
+        case XENSIV_PASCO2_SIM_WAVE_TRIANGLE:
+        {
+            uint32_t half = (period / 2U) + 1U;
+            uint32_t pos = (phase < half) ? phase : (period - phase);
+            ppm += (int32_t)(((int64_t)wave->amplitude_ppm * pos) / (int64_t)half);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return (ppm < 0) ? 0U : (uint16_t)ppm;
+}
+
+/**************************** driver platform specific implementation  **********************************/
+
+int32_t xensiv_pasco2_plat_i2c_transfer(void * ctx, uint16_t dev_addr, const uint8_t * tx_buffer, size_t tx_len, uint8_t * rx_buffer, size_t rx_len)
+{
+    assert(ctx != NULL);
+    assert(tx_buffer != NULL);
+
+    return xensiv_pasco2_sim_i2c_transfer((xensiv_pasco2_sim_t *)ctx, dev_addr, tx_buffer, tx_len, rx_buffer, rx_len);
+}
+
+int32_t xensiv_pasco2_plat_i2c_transfer_async(void * ctx, uint16_t dev_addr, const uint8_t * tx_buffer, size_t tx_len, uint8_t * rx_buffer, size_t rx_len)
+{
+    assert(ctx != NULL);
+    assert(tx_buffer != NULL);
+
+    xensiv_pasco2_sim_t * sim = (xensiv_pasco2_sim_t *)ctx;
+    assert(sim->engine != NULL);
+
+    /* The transfer time has elapsed on return, so the completion is reported right away */
+    int32_t res = xensiv_pasco2_sim_i2c_transfer(sim, dev_addr, tx_buffer, tx_len, rx_buffer, rx_len);
+    xensiv_pasco2_async_xfer_done(sim->engine, res);
+
+    return XENSIV_PASCO2_OK;
+}
+
+int32_t xensiv_pasco2_plat_uart_read(void * ctx, uint8_t * data, size_t len)
+{
+    assert(ctx != NULL);
+    assert(data != NULL);
+
+    xensiv_pasco2_sim_t * sim = (xensiv_pasco2_sim_t *)ctx;
+
+    if (len > sim->uart_rx_len)
+    {
+        /* Timeout: the sensor did not send enough data */
+        sim->uart_rx_len = 0U;
+        return XENSIV_PASCO2_ERR_COMM;
+    }
+
+    (void)memcpy(data, sim->uart_rx, len);
+    sim->uart_rx_len = (uint8_t)(sim->uart_rx_len - len);
+    (void)memmove(sim->uart_rx, &sim->uart_rx[len], sim->uart_rx_len);
+    sim->uart_answered = (0U == sim->uart_rx_len);
+
+    return XENSIV_PASCO2_OK;
+}
+
+int32_t xensiv_pasco2_plat_uart_write(void * ctx, uint8_t * data, size_t len)
+{
+    assert(ctx != NULL);
+    assert(data != NULL);
+
+    xensiv_pasco2_sim_t * sim = (xensiv_pasco2_sim_t *)ctx;
+
+    bool handshake = sim->uart_answered;
+    sim->uart_answered = false;
+
+    /* Like the target implementation, discard unread responses first */
+    sim->uart_rx_len = 0U;
+
+    if (xensiv_pasco2_sim_bus_access(sim, len, XENSIV_PASCO2_SIM_UART_BYTE_US, handshake))
+    {
+        xensiv_pasco2_sim_uart_commands(sim, data, len);
+
+        /* The responses are transmitted back at the same rate */
+        uint32_t us = sim->now_us + ((uint32_t)sim->uart_rx_len * XENSIV_PASCO2_SIM_UART_BYTE_US);
+        sim->now_us = us % 1000U;
+        xensiv_pasco2_sim_advance(sim, us / 1000U);
+    }
+
+    return XENSIV_PASCO2_OK;
+}
+
+void xensiv_pasco2_plat_delay(uint32_t ms)
+{
+    assert(xensiv_pasco2_sim_active != NULL);
+
+    xensiv_pasco2_sim_advance(xensiv_pasco2_sim_active, ms);
+}
+
+uint32_t xensiv_pasco2_plat_get_time_ms(void)
+{
+    assert(xensiv_pasco2_sim_active != NULL);
+
+    return xensiv_pasco2_sim_active->now_ms;
+}
+
+uint16_t xensiv_pasco2_plat_htons(uint16_t x)
+{
+    return (uint16_t)((x << 8) | (x >> 8));
+}
+
+void xensiv_pasco2_plat_assert(int expr)
+{
+    assert(expr);
+    (void)expr; /* make release build */
+}
+
+#endif // defined(XENSIV_PASCO2_SIM)
@@ -0,0 +1,225 @@
+/***********************************************************************************************//**
+ * \file xensiv_pasco2_sim.h
+ *
+ * Description: This file contains the register-level simulator of the
+ *              XENSIV™ PAS CO2 sensor for host builds.
+ *
+ ***************************************************************************************************
+ * \copyright
+ * Copyright 2023 Infineon Technologies AG
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************************************/
+
+#ifndef XENSIV_PASCO2_SIM_H_
+#define XENSIV_PASCO2_SIM_H_
+
+#if defined(XENSIV_PASCO2_SIM)
+
+#include "xensiv_pasco2.h"
+#include "xensiv_pasco2_async.h"
+
+/**
+ * \addtogroup group_board_libs_sim XENSIV™ PAS CO2 sensor simulator
+ * \{
+ * Host implementation of the xensiv_pasco2_plat_* functions backed by a model of the sensor register map,
+ * built when XENSIV_PASCO2_SIM is defined. Time is virtual: \ref xensiv_pasco2_plat_delay advances the
+ * simulated clock instead of sleeping, and every bus transfer consumes its transmission time, so runs
+ * are deterministic and complete as fast as the host allows.
+ *
+ * The model covers:
+ * - power-on and soft reset register contents, and a sensor that does not respond while it restarts
+ * - idle, single and continuous operating modes with the programmed measurement period
+ * - DRDY, alarm and interrupt status bits, including the INT pin for all interrupt functions
+ * - pressure compensation against a configurable ambient pressure
+ * - forced compensation, the saved calibration offset and the sensor commands
+ * - the I2C and the ASCII UART protocol
+ *
+ * The sensor object is passed as the context to \ref xensiv_pasco2_init_i2c or \ref xensiv_pasco2_init_uart.
+ * Delay and time functions act on the object last passed to \ref xensiv_pasco2_sim_init.
+ */
+
+/************************************** Macros *******************************************/
+
+/** Number of registers of the sensor */
+#define XENSIV_PASCO2_SIM_REG_COUNT             (XENSIV_PASCO2_REG_SENS_RST + 1U)
+
+/** Duration of a measurement sequence in milliseconds */
+#define XENSIV_PASCO2_SIM_MEAS_DURATION_MS      (1000U)
+
+/** Time in milliseconds the sensor does not respond after power on or a soft reset */
+#define XENSIV_PASCO2_SIM_BOOT_MS               (1000U)
+
+/** Lead time in milliseconds of the early measurement start notification */
+#define XENSIV_PASCO2_SIM_EARLY_MS              (1000U)
+
+/** Number of measurements the sensor takes to complete a forced compensation */
+#define XENSIV_PASCO2_SIM_FCS_MEAS_COUNT        (3U)
+
+/** Transmission time of one byte in microseconds on I2C at 100 kHz, including the acknowledge bit */
+#define XENSIV_PASCO2_SIM_I2C_BYTE_US           (90U)
+
+/** Transmission time of one byte in microseconds on UART at 9600 bit/s with 8N1 framing */
+#define XENSIV_PASCO2_SIM_UART_BYTE_US          (1042U)
+
+/** Value of nack_write_reg when no write is to fail */
+#define XENSIV_PASCO2_SIM_NACK_NONE             (0xFFFFU)
+
+/** Size of the buffer holding UART responses not yet read */
+#define XENSIV_PASCO2_SIM_UART_RX_LEN           (64U)
+
+/********************************* Type definitions **************************************/
+
+/** Enum defining the simulated CO2 concentration waveforms */
+typedef enum
+{
+    XENSIV_PASCO2_SIM_WAVE_CONSTANT = 0U,               /**< base_ppm */
+    XENSIV_PASCO2_SIM_WAVE_STEP = 1U,                   /**< base_ppm, then base_ppm + amplitude_ppm from period_ms on */
+    XENSIV_PASCO2_SIM_WAVE_SQUARE = 2U,                 /**< Alternates between base_ppm and base_ppm + amplitude_ppm every half period */
+    XENSIV_PASCO2_SIM_WAVE_RAMP = 3U,                   /**< Rises from base_ppm by amplitude_ppm over each period */
+    XENSIV_PASCO2_SIM_WAVE_TRIANGLE = 4U                /**< Rises by amplitude_ppm over the first half period and falls back over the second */
+} xensiv_pasco2_sim_wave_t;
+
+/** Structure of the simulated CO2 concentration */
+typedef struct
+{
+    xensiv_pasco2_sim_wave_t type;                      /*!< Waveform */
+    uint16_t base_ppm;                                  /*!< Lowest concentration */
+    int16_t amplitude_ppm;                              /*!< Excursion from base_ppm; can be negative */
+    uint32_t period_ms;                                 /*!< Period of the waveform; start time of XENSIV_PASCO2_SIM_WAVE_STEP */
+    uint16_t noise_ppm;                                 /*!< Peak amplitude of the pseudo-random noise added to each measurement */
+} xensiv_pasco2_sim_waveform_t;
+
+/** INT pin callback, called on every level change of the pin */
+typedef void (*xensiv_pasco2_sim_int_cb_t)(void * arg, bool level);
+
+/** Structure of the simulated sensor. Initialized using \ref xensiv_pasco2_sim_init */
+typedef struct
+{
+    uint8_t regs[XENSIV_PASCO2_SIM_REG_COUNT];          /*!< Register map */
+    uint32_t now_ms;                                    /*!< Virtual time */
+    uint32_t now_us;                                    /*!< Sub-millisecond part of the virtual time */
+    uint32_t ready_ms;                                  /*!< The sensor does not respond before this time */
+    bool meas_running;                                  /*!< A measurement sequence is in progress */
+    uint32_t meas_done_ms;                              /*!< End of the measurement sequence in progress */
+    uint32_t next_meas_ms;                              /*!< Start of the next measurement in continuous mode */
+    uint8_t fcs_meas;                                   /*!< Measurements taken since the forced compensation started */
+    int16_t offset_ppm;                                 /*!< Offset applied to every measurement */
+    int16_t saved_offset_ppm;                           /*!< Offset kept in the non volatile memory */
+    uint16_t ambient_hpa;                               /*!< Ambient pressure the sensor is exposed to */
+    xensiv_pasco2_sim_waveform_t wave;                  /*!< Simulated CO2 concentration */
+    uint32_t noise_state;                               /*!< Noise generator state */
+    bool int_level;                                     /*!< Level of the INT pin */
+    xensiv_pasco2_sim_int_cb_t int_cb;                  /*!< INT pin callback; can be NULL */
+    void * int_cb_arg;                                  /*!< Argument for the INT pin callback */
+    xensiv_pasco2_async_t * engine;                     /*!< Engine notified of asynchronous transfer completion */
+    uint8_t uart_rx[XENSIV_PASCO2_SIM_UART_RX_LEN];     /*!< UART responses not yet read */
+    uint8_t uart_rx_len;                                /*!< Number of bytes in uart_rx */
+    bool uart_answered;                                 /*!< All responses to the last UART command were read */
+    uint32_t last_cmd_ms;                               /*!< Time of the last bus access */
+    uint32_t transfers;                                 /*!< Number of bus transfers */
+    uint32_t bus_bytes;                                 /*!< Number of bytes transmitted on the bus */
+    uint32_t nacks;                                     /*!< Accesses while the sensor was not responding, injected ones included */
+    uint16_t nack_write_reg;                            /*!< Register whose next I2C write is not acknowledged;
+                                                             XENSIV_PASCO2_SIM_NACK_NONE if none */
+    uint32_t spacing_violations;                        /*!< Accesses less than XENSIV_PASCO2_COMM_DELAY_MS after the previous one, other than
+                                                             UART commands sent once the previous response was read */
+    uint32_t uart_queued;                               /*!< UART commands received while the response to the previous one was pending */
+    uint32_t measurements;                              /*!< Number of completed measurements */
+    uint32_t results_read;                              /*!< Number of measurement results read with DRDY set */
+} xensiv_pasco2_sim_t;
+
+/******************************* Function prototypes *************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Powers on the simulated sensor and makes it the time base of the platform functions.
+ * The sensor starts in idle mode at 400 ppm, 1015 hPa and virtual time 0, and answers on the bus
+ * after XENSIV_PASCO2_SIM_BOOT_MS like after a power on
+ *
+ * @param[out] sim Pointer to the simulated sensor allocated by the user
+ */
+void xensiv_pasco2_sim_init(xensiv_pasco2_sim_t * sim);
+
+/**
+ * @brief Sets the simulated CO2 concentration
+ *
+ * @param[inout] sim Pointer to the simulated sensor
+ * @param[in] wave Waveform of the concentration
+ */
+void xensiv_pasco2_sim_set_waveform(xensiv_pasco2_sim_t * sim, const xensiv_pasco2_sim_waveform_t * wave);
+
+/**
+ * @brief Sets the ambient pressure. Measurements deviate from the concentration unless the pressure
+ * compensation register matches it
+ *
+ * @param[inout] sim Pointer to the simulated sensor
+ * @param[in] hpa Ambient pressure in hPa
+ */
+void xensiv_pasco2_sim_set_ambient_pressure(xensiv_pasco2_sim_t * sim, uint16_t hpa);
+
+/**
+ * @brief Registers the function called on every level change of the INT pin
+ *
+ * @param[inout] sim Pointer to the simulated sensor
+ * @param[in] callback Pin callback; NULL to unregister
+ * @param[in] callback_arg Argument for the callback
+ */
+void xensiv_pasco2_sim_set_int_callback(xensiv_pasco2_sim_t * sim, xensiv_pasco2_sim_int_cb_t callback, void * callback_arg);
+
+/**
+ * @brief Sets the engine that \ref xensiv_pasco2_plat_i2c_transfer_async reports completion to
+ *
+ * @param[inout] sim Pointer to the simulated sensor
+ * @param[in] engine Asynchronous engine using the simulated sensor
+ */
+void xensiv_pasco2_sim_set_async_engine(xensiv_pasco2_sim_t * sim, xensiv_pasco2_async_t * engine);
+
+/**
+ * @brief Makes the next I2C write starting at a register fail as if the sensor did not acknowledge it.
+ * The register is left unchanged
+ *
+ * @param[inout] sim Pointer to the simulated sensor
+ * @param[in] reg_addr First register of the write to fail
+ */
+void xensiv_pasco2_sim_nack_write(xensiv_pasco2_sim_t * sim, uint8_t reg_addr);
+
+/**
+ * @brief Advances the virtual time, completing measurements and updating the INT pin on the way
+ *
+ * @param[inout] sim Pointer to the simulated sensor
+ * @param[in] ms Milliseconds to advance
+ */
+void xensiv_pasco2_sim_advance(xensiv_pasco2_sim_t * sim, uint32_t ms);
+
+/**
+ * @brief Returns the concentration the sensor is exposed to at the current virtual time, without noise
+ *
+ * @param[in] sim Pointer to the simulated sensor
+ * @return CO2 concentration in ppm
+ */
+uint16_t xensiv_pasco2_sim_get_true_ppm(const xensiv_pasco2_sim_t * sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // defined(XENSIV_PASCO2_SIM)
+
+/** \} group_board_libs_sim */
+
+#endif
@@ -0,0 +1,51 @@
+/*******************************************************************************
+* File Name: FreeRTOS.h
+*
+* Description: Host stand-in for the FreeRTOS kernel header, covering what
+* the modules under test use. The heap counts its blocks, and whether the
+* caller is an interrupt is a per-thread flag set by the test.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef FREERTOS_H_STUB_
+#define FREERTOS_H_STUB_
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+
+#define pdFALSE                         ((BaseType_t)0)
+#define pdTRUE                          ((BaseType_t)1)
+#define pdPASS                          (pdTRUE)
+#define portMAX_DELAY                   ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS              ((TickType_t)1)
+#define pdMS_TO_TICKS(ms)               ((TickType_t)(ms))
+#define configASSERT(x)                 assert(x)
+#define portYIELD_FROM_ISR(x)           ((void)(x))
+
+void *pvPortMalloc(size_t size);
+void vPortFree(void *pv);
+BaseType_t xPortIsInsideInterrupt(void);
+
+void taskENTER_CRITICAL(void);
+void taskEXIT_CRITICAL(void);
+UBaseType_t taskENTER_CRITICAL_FROM_ISR(void);
+void taskEXIT_CRITICAL_FROM_ISR(UBaseType_t state);
+
+/* Test controls */
+extern __thread bool stub_rtos_in_isr;
+size_t stub_rtos_heap_blocks(void);
+void stub_rtos_set_tick(TickType_t tick);
+void stub_rtos_advance_tick(TickType_t ticks);
+
+#endif /* FREERTOS_H_STUB_ */
@@ -0,0 +1,195 @@
+/*******************************************************************************
+* File Name: bt_stub.c
+*
+* Description: Host stand-in for the Bluetooth stack calls, the core
+* registers and the trace used by the Bluetooth LE modules. The stack calls
+* yield, as the caller is likely to be preempted there on the target.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/* sched_yield is POSIX */
+#define _XOPEN_SOURCE 700
+
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "cybsp.h"
+#include "app_trace.h"
+#include "wiced_bt_ble.h"
+#include "wiced_bt_dev.h"
+#include "wiced_bt_gatt.h"
+#include "wiced_bt_l2c.h"
+
+static uint32_t stub_ble_phy = 0u;
+static uint32_t stub_ble_length = 0u;
+static uint32_t stub_l2c_count = 0u;
+static stub_l2c_params_t stub_l2c_params;
+static stub_gatt_notify_cb_t stub_gatt_notify_cb = NULL;
+static const uint16_t *stub_gatt_handles = NULL;
+static const uint16_t *stub_gatt_types = NULL;
+static uint16_t stub_gatt_type_count = 0u;
+
+stub_dwt_t stub_dwt;
+stub_core_debug_t stub_core_debug;
+
+void app_trace_write(uint32_t argc, const char *fmt, ...)
+{
+    (void)argc;
+    (void)fmt;
+}
+
+wiced_bt_dev_status_t wiced_bt_ble_set_phy(wiced_bt_ble_phy_preferences_t *p_phy)
+{
+    (void)p_phy;
+    (void)sched_yield();
+    (void)__atomic_add_fetch(&stub_ble_phy, 1u, __ATOMIC_RELAXED);
+    return WICED_BT_SUCCESS;
+}
+
+wiced_bt_dev_status_t wiced_bt_ble_set_data_packet_length(wiced_bt_device_address_t bd_addr,
+                                                          uint16_t tx_pdu_length)
+{
+    (void)bd_addr;
+    (void)tx_pdu_length;
+    (void)sched_yield();
+    (void)__atomic_add_fetch(&stub_ble_length, 1u, __ATOMIC_RELAXED);
+    return WICED_BT_SUCCESS;
+}
+
+wiced_result_t wiced_bt_dev_add_device_to_address_resolution_db(wiced_bt_device_link_keys_t *p_link_keys)
+{
+    (void)p_link_keys;
+    return WICED_BT_SUCCESS;
+}
+
+wiced_result_t wiced_bt_dev_remove_device_from_address_resolution_db(wiced_bt_device_link_keys_t *p_link_keys)
+{
+    (void)p_link_keys;
+    return WICED_BT_SUCCESS;
+}
+
+uint32_t stub_ble_phy_requests(void)
+{
+    return __atomic_load_n(&stub_ble_phy, __ATOMIC_RELAXED);
+}
+
+uint32_t stub_ble_length_requests(void)
+{
+    return __atomic_load_n(&stub_ble_length, __ATOMIC_RELAXED);
+}
+
+wiced_bool_t wiced_bt_l2cap_update_ble_conn_params(wiced_bt_device_address_t rem_bda, uint16_t min_int,
+                                                   uint16_t max_int, uint16_t latency, uint16_t timeout)
+{
+    (void)rem_bda;
+    (void)sched_yield();
+    stub_l2c_params = (stub_l2c_params_t){ min_int, max_int, latency, timeout };
+    (void)__atomic_add_fetch(&stub_l2c_count, 1u, __ATOMIC_RELAXED);
+    return WICED_TRUE;
+}
+
+uint32_t stub_l2c_requests(void)
+{
+    return __atomic_load_n(&stub_l2c_count, __ATOMIC_RELAXED);
+}
+
+stub_l2c_params_t stub_l2c_last(void)
+{
+    return stub_l2c_params;
+}
+
+wiced_bt_gatt_status_t wiced_bt_gatt_server_send_notification(uint16_t conn_id, uint16_t attr_handle,
+                                                               uint16_t val_len, uint8_t *p_val,
+                                                               void *p_app_ctx)
+{
+    (void)p_app_ctx;
+
+    return (NULL != stub_gatt_notify_cb) ? stub_gatt_notify_cb(conn_id, attr_handle, val_len, p_val)
+                                         : WICED_BT_GATT_SUCCESS;
+}
+
+uint16_t wiced_bt_gatt_get_handle_from_stream(uint8_t *p_stream, uint16_t handle_index)
+{
+    return (uint16_t)(p_stream[2u * handle_index] | (p_stream[(2u * handle_index) + 1u] << 8));
+}
+
+/* Walks the database from the start handle, found by bisection, like the
+ * stack walks its database from the start of the range */
+uint16_t wiced_bt_gatt_find_handle_by_type(uint16_t s_handle, uint16_t e_handle, wiced_bt_uuid_t *p_uuid)
+{
+    uint16_t lo = 0u;
+    uint16_t hi = stub_gatt_type_count;
+
+    while (lo < hi)
+    {
+        uint16_t mid = (uint16_t)((lo + hi) / 2u);
+
+        if (stub_gatt_handles[mid] < s_handle)
+        {
+            lo = (uint16_t)(mid + 1u);
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    for (; (lo < stub_gatt_type_count) && (stub_gatt_handles[lo] <= e_handle); lo++)
+    {
+        if ((2u == p_uuid->len) && (p_uuid->uu.uuid16 == stub_gatt_types[lo]))
+        {
+            return stub_gatt_handles[lo];
+        }
+    }
+    return 0u;
+}
+
+/* The first pair sets the pair length; later values must have the same
+ * length. Returns the bytes written, 0 if the pair does not fit or differs. */
+int wiced_bt_gatt_put_read_by_type_rsp_in_stream(uint8_t *p_stream, int stream_len, uint8_t *p_pair_len,
+                                                 uint16_t attr_handle, int value_len, uint8_t *p_value)
+{
+    int pair_len = value_len + 2;
+
+    if (0u == *p_pair_len)
+    {
+        /* A long first value is cut to what fits */
+        pair_len = (pair_len > stream_len) ? stream_len : pair_len;
+        pair_len = (pair_len > UINT8_MAX) ? UINT8_MAX : pair_len;
+        if (pair_len < 2)
+        {
+            return 0;
+        }
+        *p_pair_len = (uint8_t)pair_len;
+    }
+    else if ((pair_len != (int)*p_pair_len) || (pair_len > stream_len))
+    {
+        return 0;
+    }
+    else
+    {
+        /* Same length as the previous pairs */
+    }
+
+    p_stream[0] = (uint8_t)(attr_handle & 0xFFu);
+    p_stream[1] = (uint8_t)(attr_handle >> 8);
+    memcpy(&p_stream[2], p_value, (size_t)pair_len - 2u);
+    return pair_len;
+}
+
+void stub_gatt_set_notify_cb(stub_gatt_notify_cb_t callback)
+{
+    stub_gatt_notify_cb = callback;
+}
+
+void stub_gatt_set_types(const uint16_t *p_handles, const uint16_t *p_types, uint16_t count)
+{
+    stub_gatt_handles = p_handles;
+    stub_gatt_types = p_types;
+    stub_gatt_type_count = count;
+}
@@ -0,0 +1,41 @@
+/*******************************************************************************
+* File Name: cybsp.h
+*
+* Description: Host stand-in for the board support header and the core
+* registers it brings in.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef CYBSP_H_STUB_
+#define CYBSP_H_STUB_
+
+#include <assert.h>
+#include <stdint.h>
+
+#define CY_ASSERT(x)                    assert(x)
+
+/* Cycle counter; counts nothing on the host */
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} stub_dwt_t;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} stub_core_debug_t;
+
+extern stub_dwt_t stub_dwt;
+extern stub_core_debug_t stub_core_debug;
+
+#define DWT                             (&stub_dwt)
+#define CoreDebug                       (&stub_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+
+#endif /* CYBSP_H_STUB_ */
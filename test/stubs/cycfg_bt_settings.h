@@ -0,0 +1,19 @@
+/*******************************************************************************
+* File Name: cycfg_bt_settings.h
+*
+* Description: Host stand-in for the header generated from design.cybt,
+* holding the settings the modules under test use.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef CYCFG_BT_SETTINGS_H_STUB_
+#define CYCFG_BT_SETTINGS_H_STUB_
+
+/* MtuSize of design.cybt */
+#define CY_BT_MTU_SIZE                  (247u)
+
+#endif /* CYCFG_BT_SETTINGS_H_STUB_ */
@@ -0,0 +1,29 @@
+/*******************************************************************************
+* File Name: cycfg_gatt_db.h
+*
+* Description: Host stand-in for the generated GATT database header. The
+* test defines the attribute table.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef CYCFG_GATT_DB_H_STUB_
+#define CYCFG_GATT_DB_H_STUB_
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint16_t handle;
+    uint16_t max_len;
+    uint16_t cur_len;
+    uint8_t *p_data;
+} gatt_db_lookup_table_t;
+
+extern gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[];
+extern const uint16_t app_gatt_db_ext_attr_tbl_size;
+
+#endif /* CYCFG_GATT_DB_H_STUB_ */
@@ -0,0 +1,96 @@
+/*******************************************************************************
+* File Name: flash_stub.c
+*
+* Description: Host stand-in for the flash storage of configuration items.
+* A write yields, as the writer is held for the erase on the target.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/* sched_yield is POSIX */
+#define _XOPEN_SOURCE 700
+
+#include <sched.h>
+#include <string.h>
+#include "flash_utils.h"
+
+#define STUB_FLASH_ITEMS                (16u)
+#define STUB_FLASH_ITEM_LEN             (256u)
+
+static struct stub_flash_item
+{
+    uint16_t id;
+    uint16_t len;
+    uint8_t data[STUB_FLASH_ITEM_LEN];
+} stub_flash_items[STUB_FLASH_ITEMS];
+static uint8_t stub_flash_count = 0u;
+static uint32_t stub_flash_write_count = 0u;
+static bool stub_flash_fail = false;
+
+static struct stub_flash_item *stub_flash_find(uint16_t id)
+{
+    for (uint8_t i = 0u; i < stub_flash_count; i++)
+    {
+        if (id == stub_flash_items[i].id)
+        {
+            return &stub_flash_items[i];
+        }
+    }
+    return NULL;
+}
+
+uint16_t flash_memory_write(uint16_t config_item_id, uint32_t len, uint8_t* buf, wiced_result_t *rslt)
+{
+    struct stub_flash_item *p_item = stub_flash_find(config_item_id);
+
+    (void)sched_yield();
+    (void)__atomic_add_fetch(&stub_flash_write_count, 1u, __ATOMIC_RELAXED);
+
+    if (stub_flash_fail || (len > STUB_FLASH_ITEM_LEN) ||
+        ((NULL == p_item) && (STUB_FLASH_ITEMS == stub_flash_count)))
+    {
+        *rslt = WICED_BT_ERROR;
+        return 0u;
+    }
+    if (NULL == p_item)
+    {
+        p_item = &stub_flash_items[stub_flash_count++];
+        p_item->id = config_item_id;
+    }
+    memcpy(p_item->data, buf, len);
+    p_item->len = (uint16_t)len;
+    *rslt = WICED_BT_SUCCESS;
+    return (uint16_t)len;
+}
+
+uint16_t flash_memory_read(uint16_t config_item_id, uint32_t len, uint8_t* buf, wiced_result_t *rslt)
+{
+    struct stub_flash_item *p_item = stub_flash_find(config_item_id);
+
+    if ((NULL == p_item) || (len < p_item->len))
+    {
+        *rslt = WICED_BT_ERROR;
+        return 0u;
+    }
+    memcpy(buf, p_item->data, p_item->len);
+    *rslt = WICED_BT_SUCCESS;
+    return p_item->len;
+}
+
+void stub_flash_erase(void)
+{
+    stub_flash_count = 0u;
+}
+
+uint32_t stub_flash_writes(void)
+{
+    return __atomic_load_n(&stub_flash_write_count, __ATOMIC_RELAXED);
+}
+
+void stub_flash_set_fail(bool fail)
+{
+    stub_flash_fail = fail;
+}
@@ -0,0 +1,27 @@
+/*******************************************************************************
+* File Name: flash_utils.h
+*
+* Description: Host stand-in for the flash storage of configuration items.
+* Items are kept in RAM; the test can count the writes and make them fail.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef FLASH_UTILS_H_STUB_
+#define FLASH_UTILS_H_STUB_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "wiced_bt_types.h"
+
+uint16_t flash_memory_write(uint16_t config_item_id, uint32_t len, uint8_t* buf, wiced_result_t *rslt);
+uint16_t flash_memory_read(uint16_t config_item_id, uint32_t len, uint8_t* buf, wiced_result_t *rslt);
+
+void stub_flash_erase(void);
+uint32_t stub_flash_writes(void);
+void stub_flash_set_fail(bool fail);
+
+#endif /* FLASH_UTILS_H_STUB_ */
@@ -0,0 +1,162 @@
+/*******************************************************************************
+* File Name: freertos_stub.c
+*
+* Description: Host stand-in for the FreeRTOS heap, critical sections, ticks
+* and task notifications. A critical section is one process-wide recursive
+* mutex, which is what it amounts to on a single-core target.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/* Recursive mutexes are an XSI extension */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#define STUB_RTOS_TIMERS                (4u)
+
+__thread bool stub_rtos_in_isr = false;
+
+static size_t stub_rtos_blocks = 0u;
+static TickType_t stub_rtos_tick = 0u;
+static uint32_t stub_rtos_notified = 0u;
+static pthread_mutex_t stub_rtos_critical;
+static pthread_once_t stub_rtos_once = PTHREAD_ONCE_INIT;
+static struct stub_rtos_timer
+{
+    TimerCallbackFunction_t callback;
+    TickType_t period;
+} stub_rtos_timers[STUB_RTOS_TIMERS];
+static uint8_t stub_rtos_timer_count = 0u;
+
+static void stub_rtos_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    (void)pthread_mutexattr_init(&attr);
+    (void)pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    (void)pthread_mutex_init(&stub_rtos_critical, &attr);
+}
+
+void *pvPortMalloc(size_t size)
+{
+    assert(!stub_rtos_in_isr);
+
+    void *pv = malloc(size);
+    if (NULL != pv)
+    {
+        (void)__atomic_add_fetch(&stub_rtos_blocks, 1u, __ATOMIC_RELAXED);
+    }
+    return pv;
+}
+
+void vPortFree(void *pv)
+{
+    assert(!stub_rtos_in_isr);
+
+    if (NULL != pv)
+    {
+        (void)__atomic_sub_fetch(&stub_rtos_blocks, 1u, __ATOMIC_RELAXED);
+        free(pv);
+    }
+}
+
+BaseType_t xPortIsInsideInterrupt(void)
+{
+    return stub_rtos_in_isr ? pdTRUE : pdFALSE;
+}
+
+size_t stub_rtos_heap_blocks(void)
+{
+    return __atomic_load_n(&stub_rtos_blocks, __ATOMIC_RELAXED);
+}
+
+void taskENTER_CRITICAL(void)
+{
+    (void)pthread_once(&stub_rtos_once, stub_rtos_init);
+    (void)pthread_mutex_lock(&stub_rtos_critical);
+}
+
+void taskEXIT_CRITICAL(void)
+{
+    (void)pthread_mutex_unlock(&stub_rtos_critical);
+}
+
+UBaseType_t taskENTER_CRITICAL_FROM_ISR(void)
+{
+    taskENTER_CRITICAL();
+    return 0u;
+}
+
+void taskEXIT_CRITICAL_FROM_ISR(UBaseType_t state)
+{
+    (void)state;
+    taskEXIT_CRITICAL();
+}
+
+void stub_rtos_set_tick(TickType_t tick)
+{
+    __atomic_store_n(&stub_rtos_tick, tick, __ATOMIC_RELAXED);
+}
+
+void stub_rtos_advance_tick(TickType_t ticks)
+{
+    (void)__atomic_add_fetch(&stub_rtos_tick, ticks, __ATOMIC_RELAXED);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return __atomic_load_n(&stub_rtos_tick, __ATOMIC_RELAXED);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    (void)task;
+    stub_rtos_notified++;
+}
+
+uint32_t stub_rtos_notifications(void)
+{
+    return stub_rtos_notified;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t reload, void *id,
+                           TimerCallbackFunction_t callback)
+{
+    (void)name;
+    (void)reload;
+    (void)id;
+
+    assert(stub_rtos_timer_count < STUB_RTOS_TIMERS);
+    stub_rtos_timers[stub_rtos_timer_count].callback = callback;
+    stub_rtos_timers[stub_rtos_timer_count].period = period;
+    return &stub_rtos_timers[stub_rtos_timer_count++];
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait)
+{
+    (void)wait;
+
+    __atomic_store_n(&timer->period, period, __ATOMIC_RELAXED);
+    return pdPASS;
+}
+
+void stub_rtos_timers_fire(void)
+{
+    for (uint8_t i = 0u; i < stub_rtos_timer_count; i++)
+    {
+        stub_rtos_timers[i].callback(&stub_rtos_timers[i]);
+    }
+}
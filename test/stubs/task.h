@@ -0,0 +1,24 @@
+/*******************************************************************************
+* File Name: task.h
+*
+* Description: Host stand-in for the FreeRTOS task header.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef TASK_H_STUB_
+#define TASK_H_STUB_
+
+#include "FreeRTOS.h"
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+void xTaskNotifyGive(TaskHandle_t task);
+
+/* Test controls */
+uint32_t stub_rtos_notifications(void);
+
+#endif /* TASK_H_STUB_ */
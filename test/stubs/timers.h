@@ -0,0 +1,28 @@
+/*******************************************************************************
+* File Name: timers.h
+*
+* Description: Host stand-in for the FreeRTOS software timers. Timers do not
+* run by themselves; the test fires them with stub_rtos_timers_fire().
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef TIMERS_H_STUB_
+#define TIMERS_H_STUB_
+
+#include "FreeRTOS.h"
+
+typedef struct stub_rtos_timer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t reload, void *id,
+                           TimerCallbackFunction_t callback);
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait);
+
+/* Test controls */
+void stub_rtos_timers_fire(void);
+
+#endif /* TIMERS_H_STUB_ */
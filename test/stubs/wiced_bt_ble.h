@@ -0,0 +1,67 @@
+/*******************************************************************************
+* File Name: wiced_bt_ble.h
+*
+* Description: Host stand-in for the LE part of the Bluetooth stack. Requests
+* are counted for the test and always accepted.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef WICED_BT_BLE_H_STUB_
+#define WICED_BT_BLE_H_STUB_
+
+#include "wiced_bt_types.h"
+
+#define BTM_BLE_PREFER_1M_PHY           (0x01u)
+#define BTM_BLE_PREFER_2M_PHY           (0x02u)
+#define BTM_BLE_PREFER_LELR_PHY         (0x04u)
+#define BTM_BLE_PREFER_CODED_PHY_NONE   (0x00u)
+
+typedef uint8_t wiced_bt_ble_address_type_t;
+
+typedef struct
+{
+    wiced_bt_device_address_t remote_bd_addr;
+    uint8_t tx_phys;
+    uint8_t rx_phys;
+    uint16_t phy_opts;
+} wiced_bt_ble_phy_preferences_t;
+
+typedef struct
+{
+    uint8_t status;
+    wiced_bt_device_address_t bd_addr;
+    uint16_t conn_interval;
+    uint16_t conn_latency;
+    uint16_t supervision_timeout;
+} wiced_bt_ble_connection_param_update_t;
+
+typedef struct
+{
+    uint8_t status;
+    wiced_bt_device_address_t bd_address;
+    uint8_t tx_phy;
+    uint8_t rx_phy;
+} wiced_bt_ble_phy_update_t;
+
+typedef struct
+{
+    wiced_bt_device_address_t bd_addr;
+    uint16_t max_tx_octets;
+    uint16_t max_tx_time;
+    uint16_t max_rx_octets;
+    uint16_t max_rx_time;
+} wiced_bt_ble_data_length_update_t;
+
+wiced_bt_dev_status_t wiced_bt_ble_set_phy(wiced_bt_ble_phy_preferences_t *p_phy);
+wiced_bt_dev_status_t wiced_bt_ble_set_data_packet_length(wiced_bt_device_address_t bd_addr,
+                                                          uint16_t tx_pdu_length);
+
+/* Test controls */
+uint32_t stub_ble_phy_requests(void);
+uint32_t stub_ble_length_requests(void);
+
+#endif /* WICED_BT_BLE_H_STUB_ */
@@ -0,0 +1,42 @@
+/*******************************************************************************
+* File Name: wiced_bt_dev.h
+*
+* Description: Host stand-in for the Bluetooth device management header.
+* The address resolution list is not modelled.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef WICED_BT_DEV_H_STUB_
+#define WICED_BT_DEV_H_STUB_
+
+#include "wiced_bt_types.h"
+#include "wiced_bt_ble.h"
+
+#define BTM_SECURITY_KEY_DATA_LEN       (132)
+#define BTM_SECURITY_LOCAL_KEY_DATA_LEN (65)
+
+typedef struct
+{
+    wiced_bt_ble_address_type_t ble_addr_type;
+    uint8_t le_keys[BTM_SECURITY_KEY_DATA_LEN];
+} wiced_bt_device_sec_keys_t;
+
+typedef struct
+{
+    wiced_bt_device_address_t bd_addr;
+    wiced_bt_device_sec_keys_t key_data;
+} wiced_bt_device_link_keys_t;
+
+typedef struct
+{
+    uint8_t local_key_data[BTM_SECURITY_LOCAL_KEY_DATA_LEN];
+} wiced_bt_local_identity_keys_t;
+
+wiced_result_t wiced_bt_dev_add_device_to_address_resolution_db(wiced_bt_device_link_keys_t *p_link_keys);
+wiced_result_t wiced_bt_dev_remove_device_from_address_resolution_db(wiced_bt_device_link_keys_t *p_link_keys);
+
+#endif /* WICED_BT_DEV_H_STUB_ */
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* File Name: wiced_bt_gatt.h
+*
+* Description: Host stand-in for the GATT part of the Bluetooth stack.
+* Notifications go to a callback set by the test, and searches by type walk
+* a list of handles and types set by the test in place of the database.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef WICED_BT_GATT_H_STUB_
+#define WICED_BT_GATT_H_STUB_
+
+#include "wiced_bt_types.h"
+
+#define GATT_CLIENT_CONFIG_NONE         (0x0000u)
+#define GATT_CLIENT_CONFIG_NOTIFICATION (0x0001u)
+#define GATT_CLIENT_CONFIG_INDICATION   (0x0002u)
+
+#define GATT_REQ_READ_MULTI             (0x0Eu)
+#define GATT_REQ_READ_MULTI_VAR_LENGTH  (0x20u)
+
+typedef enum
+{
+    WICED_BT_GATT_SUCCESS = 0x00,
+    WICED_BT_GATT_INVALID_HANDLE = 0x01,
+    WICED_BT_GATT_INVALID_PDU = 0x04,
+    WICED_BT_GATT_ERR_UNLIKELY = 0x0E,
+    WICED_BT_GATT_INSUF_RESOURCE = 0x11,
+    WICED_BT_GATT_ERROR = 0x85
+} wiced_bt_gatt_status_t;
+
+typedef uint8_t wiced_bt_gatt_opcode_t;
+
+typedef struct
+{
+    uint16_t len;
+    union
+    {
+        uint16_t uuid16;
+        uint32_t uuid32;
+        uint8_t uuid128[16];
+    } uu;
+} wiced_bt_uuid_t;
+
+typedef struct
+{
+    uint16_t s_handle;
+    uint16_t e_handle;
+    wiced_bt_uuid_t uuid;
+} wiced_bt_gatt_read_by_type_t;
+
+typedef struct
+{
+    uint16_t num_handles;
+    uint8_t *p_handle_stream;   /* Little-endian handles */
+} wiced_bt_gatt_read_multiple_req_t;
+
+/* Receives the notifications handed to the stack */
+typedef wiced_bt_gatt_status_t (*stub_gatt_notify_cb_t)(uint16_t conn_id, uint16_t attr_handle,
+                                                        uint16_t val_len, const uint8_t *p_val);
+
+wiced_bt_gatt_status_t wiced_bt_gatt_server_send_notification(uint16_t conn_id, uint16_t attr_handle,
+                                                               uint16_t val_len, uint8_t *p_val,
+                                                               void *p_app_ctx);
+
+uint16_t wiced_bt_gatt_get_handle_from_stream(uint8_t *p_stream, uint16_t handle_index);
+
+uint16_t wiced_bt_gatt_find_handle_by_type(uint16_t s_handle, uint16_t e_handle, wiced_bt_uuid_t *p_uuid);
+
+int wiced_bt_gatt_put_read_by_type_rsp_in_stream(uint8_t *p_stream, int stream_len, uint8_t *p_pair_len,
+                                                 uint16_t attr_handle, int value_len, uint8_t *p_value);
+
+/* Test controls */
+void stub_gatt_set_notify_cb(stub_gatt_notify_cb_t callback);
+/* Database searched by type: handles in ascending order and their 16-bit
+ * types. The arrays must outlive the searches. */
+void stub_gatt_set_types(const uint16_t *p_handles, const uint16_t *p_types, uint16_t count);
+
+#endif /* WICED_BT_GATT_H_STUB_ */
@@ -0,0 +1,34 @@
+/*******************************************************************************
+* File Name: wiced_bt_l2c.h
+*
+* Description: Host stand-in for the L2CAP part of the Bluetooth stack. The
+* last connection parameters requested are kept for the test.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef WICED_BT_L2C_H_STUB_
+#define WICED_BT_L2C_H_STUB_
+
+#include "wiced_bt_types.h"
+
+/* Connection parameters of a request */
+typedef struct
+{
+    uint16_t min_interval;
+    uint16_t max_interval;
+    uint16_t latency;
+    uint16_t timeout;
+} stub_l2c_params_t;
+
+wiced_bool_t wiced_bt_l2cap_update_ble_conn_params(wiced_bt_device_address_t rem_bda, uint16_t min_int,
+                                                   uint16_t max_int, uint16_t latency, uint16_t timeout);
+
+/* Test controls */
+uint32_t stub_l2c_requests(void);
+stub_l2c_params_t stub_l2c_last(void);
+
+#endif /* WICED_BT_L2C_H_STUB_ */
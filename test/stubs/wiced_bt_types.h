@@ -0,0 +1,29 @@
+/*******************************************************************************
+* File Name: wiced_bt_types.h
+*
+* Description: Host stand-in for the Bluetooth stack base types.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+#ifndef WICED_BT_TYPES_H_STUB_
+#define WICED_BT_TYPES_H_STUB_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BD_ADDR_LEN                     (6)
+#define WICED_TRUE                      (1u)
+#define WICED_FALSE                     (0u)
+#define WICED_BT_SUCCESS                (0)
+#define WICED_BT_ERROR                  (0x8005)
+
+typedef uint8_t wiced_bt_device_address_t[BD_ADDR_LEN];
+typedef uint32_t wiced_bool_t;
+typedef uint16_t wiced_result_t;
+typedef uint16_t wiced_bt_dev_status_t;
+
+#endif /* WICED_BT_TYPES_H_STUB_ */
@@ -0,0 +1,66 @@
+/*******************************************************************************
+* File Name: test.h
+*
+* Description: This file contains the checks shared by the host tests. A
+* failed check is reported with its location and makes the test exit with a
+* non-zero status once it has run to the end.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef TEST_H_
+#define TEST_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Failed checks of the running test; defined once by TEST_MAIN */
+extern unsigned int test_failures;
+
+#define TEST_CHECK(cond)                                                       \
+    do                                                                         \
+    {                                                                          \
+        if (!(cond))                                                           \
+        {                                                                      \
+            test_failures++;                                                   \
+            (void)printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                      \
+    } while (0)
+
+#define TEST_CHECK_EQ(actual, expected)                                        \
+    do                                                                         \
+    {                                                                          \
+        long long test_a = (long long)(actual);                                \
+        long long test_e = (long long)(expected);                              \
+        if (test_a != test_e)                                                  \
+        {                                                                      \
+            test_failures++;                                                   \
+            (void)printf("%s:%d: %s is %lld, expected %lld\n",                 \
+                         __FILE__, __LINE__, #actual, test_a, test_e);         \
+        }                                                                      \
+    } while (0)
+
+/* Runs a test function and reports it */
+#define TEST_RUN(fn)                                                           \
+    do                                                                         \
+    {                                                                          \
+        unsigned int test_before = test_failures;                              \
+        fn();                                                                  \
+        (void)printf("%s %s\n", (test_failures == test_before) ? "PASS" : "FAIL", #fn); \
+    } while (0)
+
+#define TEST_MAIN_DEFINE  unsigned int test_failures = 0u
+#define TEST_RESULT       ((test_failures == 0u) ? 0 : 1)
+
+#endif /* TEST_H_ */
@@ -0,0 +1,225 @@
+/*******************************************************************************
+* File Name: test_bt_attr.c
+*
+* Description: This file contains the host test of the handle index of the
+* GATT attribute table and of the Read Multiple responses built from it.
+* Every handle must resolve to the entry the linear search finds, for
+* handles inside and beyond the index, duplicates and handles without an
+* entry. Both Read Multiple forms are checked whole and truncated.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "bt_attr.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_CONN_ID                    (0x0040u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+static uint8_t test_co2[] = { 0x20u, 0x03u };
+static uint8_t test_name[] = { 'D', 'o', 'o', 'r', 'R' };
+static uint8_t test_cccd[] = { 0x01u, 0x00u };
+static uint16_t test_read_conn_id;
+
+/* Handles like those of the generated database, a duplicate, both ends of
+ * the index and handles beyond it */
+gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[] =
+{
+    { 0x0003u, sizeof(test_co2), sizeof(test_co2), test_co2 },
+    { 0x0005u, 0u, 0u, NULL },
+    { 0x0009u, sizeof(test_name), sizeof(test_name), test_name },
+    { 0x000Bu, sizeof(test_cccd), sizeof(test_cccd), test_cccd },
+    { 0x000Cu, 0u, 0u, NULL },
+    { 0x000Eu, 0u, 0u, NULL },
+    { 0x0005u, 0u, 0u, NULL },
+    { 0x0000u, 0u, 0u, NULL },
+    { BT_ATTR_INDEX_LEN - 1u, 0u, 0u, NULL },
+    { BT_ATTR_INDEX_LEN, 0u, 0u, NULL },
+    { 0x0200u, 0u, 0u, NULL },
+    { 0xFFFFu, 0u, 0u, NULL },
+};
+const uint16_t app_gatt_db_ext_attr_tbl_size =
+    (uint16_t)(sizeof(app_gatt_db_ext_attr_tbl) / sizeof(app_gatt_db_ext_attr_tbl[0]));
+
+/*******************************************************************************
+* Function Name: test_scan
+********************************************************************************
+* Summary:
+*  Reference lookup: the first entry of the handle, or NULL.
+*
+*******************************************************************************/
+static gatt_db_lookup_table_t *test_scan(uint16_t handle)
+{
+    for (uint16_t i = 0u; i < app_gatt_db_ext_attr_tbl_size; i++)
+    {
+        if (handle == app_gatt_db_ext_attr_tbl[i].handle)
+        {
+            return &app_gatt_db_ext_attr_tbl[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: test_attr_all_handles
+********************************************************************************
+* Summary:
+*  Compares the lookup with the reference for every handle, before the index
+*  is built and after.
+*
+*******************************************************************************/
+static void test_attr_all_handles(void)
+{
+    uint32_t mismatches[2] = { 0u, 0u };
+    uint32_t found = 0u;
+
+    for (uint32_t handle = 0u; handle <= UINT16_MAX; handle++)
+    {
+        if (bt_attr_find((uint16_t)handle) != test_scan((uint16_t)handle))
+        {
+            mismatches[0]++;
+        }
+    }
+
+    bt_attr_init();
+    for (uint32_t handle = 0u; handle <= UINT16_MAX; handle++)
+    {
+        gatt_db_lookup_table_t *p_attr = bt_attr_find((uint16_t)handle);
+
+        if (p_attr != test_scan((uint16_t)handle))
+        {
+            mismatches[1]++;
+        }
+        found += (NULL != p_attr) ? 1u : 0u;
+    }
+
+    TEST_CHECK_EQ(mismatches[0], 0u);
+    TEST_CHECK_EQ(mismatches[1], 0u);
+    TEST_CHECK_EQ(found, app_gatt_db_ext_attr_tbl_size - 1u);
+    TEST_CHECK(bt_attr_find(0x0005u) == &app_gatt_db_ext_attr_tbl[1]);
+    TEST_CHECK(bt_attr_find(0x0004u) == NULL);
+}
+
+/*******************************************************************************
+* Function Name: test_read / test_multi
+********************************************************************************
+* Summary:
+*  Value reader as bt_app_read_value for plain attributes, and a Read
+*  Multiple request of a list of handles.
+*
+*******************************************************************************/
+static uint16_t test_read(uint16_t conn_id, gatt_db_lookup_table_t *p_attr,
+                          uint16_t offset, uint8_t *p_out, uint16_t out_len)
+{
+    uint16_t len;
+
+    test_read_conn_id = conn_id;
+    if (offset >= p_attr->cur_len)
+    {
+        return 0u;
+    }
+    len = (uint16_t)(p_attr->cur_len - offset);
+    len = (out_len < len) ? out_len : len;
+    memcpy(p_out, p_attr->p_data + offset, len);
+    return len;
+}
+
+static uint16_t test_multi(wiced_bt_gatt_opcode_t opcode, const uint16_t *p_handles, uint16_t count,
+                           uint8_t *p_rsp, uint16_t len_req)
+{
+    uint8_t stream[16];
+    wiced_bt_gatt_read_multiple_req_t req = { count, stream };
+
+    for (uint16_t n = 0u; n < count; n++)
+    {
+        stream[2u * n] = (uint8_t)(p_handles[n] & 0xFFu);
+        stream[(2u * n) + 1u] = (uint8_t)(p_handles[n] >> 8u);
+    }
+    return bt_attr_read_multi(TEST_CONN_ID, opcode, &req, test_read, p_rsp, len_req);
+}
+
+/*******************************************************************************
+* Function Name: test_attr_read_multi
+********************************************************************************
+* Summary:
+*  Builds both Read Multiple responses, whole and cut at len_req, and checks
+*  requests with a handle without an entry.
+*
+*******************************************************************************/
+static void test_attr_read_multi(void)
+{
+    static const uint16_t handles[] = { 0x0003u, 0x0009u, 0x000Bu };
+    static const uint8_t plain[] = { 0x20u, 0x03u, 'D', 'o', 'o', 'r', 'R', 0x01u, 0x00u };
+    static const uint8_t var[] = { 0x02u, 0x00u, 0x20u, 0x03u,
+                                   0x05u, 0x00u, 'D', 'o', 'o', 'r', 'R',
+                                   0x02u, 0x00u, 0x01u, 0x00u };
+    uint8_t stream[6];
+    wiced_bt_gatt_read_multiple_req_t req = { 3u, stream };
+    uint8_t rsp[32];
+    uint16_t bad_handle = 0u;
+    uint16_t len;
+
+    bt_attr_init();
+
+    len = test_multi(GATT_REQ_READ_MULTI, handles, 3u, rsp, sizeof(rsp));
+    TEST_CHECK_EQ(len, sizeof(plain));
+    TEST_CHECK_EQ(memcmp(rsp, plain, sizeof(plain)), 0);
+    TEST_CHECK_EQ(test_read_conn_id, TEST_CONN_ID);
+
+    len = test_multi(GATT_REQ_READ_MULTI_VAR_LENGTH, handles, 3u, rsp, sizeof(rsp));
+    TEST_CHECK_EQ(len, sizeof(var));
+    TEST_CHECK_EQ(memcmp(rsp, var, sizeof(var)), 0);
+
+    /* Truncated at len_req; nothing is written beyond it */
+    memset(rsp, 0xEE, sizeof(rsp));
+    len = test_multi(GATT_REQ_READ_MULTI, handles, 3u, rsp, 4u);
+    TEST_CHECK_EQ(len, 4u);
+    TEST_CHECK_EQ(memcmp(rsp, plain, 4u), 0);
+    TEST_CHECK_EQ(rsp[4], 0xEEu);
+
+    /* A cut value keeps the length of the whole value */
+    len = test_multi(GATT_REQ_READ_MULTI_VAR_LENGTH, handles, 3u, rsp, 8u);
+    TEST_CHECK_EQ(len, 8u);
+    TEST_CHECK_EQ(memcmp(rsp, var, 8u), 0);
+
+    /* No room for the next length: the response ends before it */
+    memset(rsp, 0xEE, sizeof(rsp));
+    len = test_multi(GATT_REQ_READ_MULTI_VAR_LENGTH, handles, 3u, rsp, 5u);
+    TEST_CHECK_EQ(len, 4u);
+    TEST_CHECK_EQ(rsp[4], 0xEEu);
+
+    /* Unknown handles are found even where the response would be cut */
+    stream[0] = 0x03u; stream[1] = 0x00u;
+    stream[2] = 0x09u; stream[3] = 0x00u;
+    stream[4] = 0x01u; stream[5] = 0x02u;
+    TEST_CHECK(!bt_attr_find_all(&req, &bad_handle));
+    TEST_CHECK_EQ(bad_handle, 0x0201u);
+    stream[2] = 0x04u;
+    TEST_CHECK(!bt_attr_find_all(&req, &bad_handle));
+    TEST_CHECK_EQ(bad_handle, 0x0004u);
+    stream[2] = 0x09u;
+    stream[4] = 0xFFu; stream[5] = 0xFFu;
+    TEST_CHECK(bt_attr_find_all(&req, &bad_handle));
+}
+
+int main(void)
+{
+    TEST_RUN(test_attr_all_handles);
+    TEST_RUN(test_attr_read_multi);
+
+    return TEST_RESULT;
+}
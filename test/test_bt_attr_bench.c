@@ -0,0 +1,367 @@
+/*******************************************************************************
+* File Name: test_bt_attr_bench.c
+*
+* Description: This file contains the host benchmark of the GATT request
+* handling that depends on the size of the attribute table. A synthetic
+* database holds two blocks of characteristics: handles below
+* BT_ATTR_INDEX_LEN, found through the index, and the same characteristics
+* beyond it, found by the linear search of the table as every handle was
+* before the index. Reads, writes and Read By Type requests run as the
+* handlers of bt_app.c run them, against the database search of the stack
+* stand-in, for databases of a growing number of characteristics. The
+* responses are checked; the timings are printed.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+/* clock_gettime is POSIX */
+#define _XOPEN_SOURCE 700
+
+#include <string.h>
+#include <time.h>
+#include "bt_attr.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_CHARS                      (40u)       /* Characteristics per block */
+#define TEST_HANDLES_PER_CHAR           (3u)        /* Declaration, value, CCCD */
+#define TEST_LOW_BASE                   (0x0001u)   /* Found through the index */
+#define TEST_HIGH_BASE                  (0x0100u)   /* Found by the linear search */
+#define TEST_TYPE_CHAR                  (0x2803u)
+#define TEST_TYPE_VALUE                 (0xFF01u)
+#define TEST_TYPE_CCCD                  (0x2902u)
+#define TEST_VALUE_LEN                  (2u)
+#define TEST_MTU_LEN_REQ                (512u)      /* Room for every pair */
+#define TEST_SHORT_LEN_REQ              (22u)       /* Default MTU of 23 */
+#define TEST_CONN_ID                    (0x0040u)
+#define TEST_REPEATS                    (20000u)
+#define TEST_RBT_REPEATS                (2000u)
+
+/* Both blocks, and a value at the last handle */
+#define TEST_ENTRIES                    ((4u * TEST_CHARS) + 1u)
+#define TEST_TYPES                      ((2u * TEST_CHARS * TEST_HANDLES_PER_CHAR) + 1u)
+#define TEST_LAST_HANDLE                (0xFFFFu)
+
+/* Handle of the declaration of characteristic n of a block */
+#define TEST_CHAR_HANDLE(base, n)       ((uint16_t)((base) + ((n) * TEST_HANDLES_PER_CHAR)))
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+/* Value and CCCD of each characteristic of both blocks */
+static uint8_t test_values[TEST_ENTRIES][TEST_VALUE_LEN];
+
+gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[TEST_ENTRIES];
+const uint16_t app_gatt_db_ext_attr_tbl_size = (uint16_t)TEST_ENTRIES;
+
+/* Database searched by type by the stack stand-in */
+static uint16_t test_handles[TEST_TYPES];
+static uint16_t test_types[TEST_TYPES];
+
+/* Keeps the timed work from being optimized away */
+static volatile uint32_t test_sink;
+
+/*******************************************************************************
+* Function Name: test_build
+********************************************************************************
+* Summary:
+*  Fills the attribute table and the database of both blocks.
+*
+*******************************************************************************/
+static void test_build(void)
+{
+    const uint16_t bases[2] = { TEST_LOW_BASE, TEST_HIGH_BASE };
+    uint16_t type = 0u;
+
+    for (uint16_t b = 0u; b < 2u; b++)
+    {
+        /* The searched block comes first in the table, so that a search
+         * only walks a database of the characteristics before it */
+        uint16_t entry = (0u == b) ? (uint16_t)(2u * TEST_CHARS) : 0u;
+
+        for (uint16_t n = 0u; n < TEST_CHARS; n++)
+        {
+            uint16_t handle = TEST_CHAR_HANDLE(bases[b], n);
+
+            for (uint16_t h = 0u; h < TEST_HANDLES_PER_CHAR; h++)
+            {
+                test_handles[type] = (uint16_t)(handle + h);
+                test_types[type] = (0u == h) ? TEST_TYPE_CHAR : ((1u == h) ? TEST_TYPE_VALUE : TEST_TYPE_CCCD);
+                type++;
+            }
+
+            /* Value and CCCD; the declaration is served by the stack */
+            for (uint16_t h = 1u; h < TEST_HANDLES_PER_CHAR; h++)
+            {
+                gatt_db_lookup_table_t *p_attr = &app_gatt_db_ext_attr_tbl[entry];
+
+                test_values[entry][0] = (uint8_t)((handle + h) & 0xFFu);
+                test_values[entry][1] = (uint8_t)((handle + h) >> 8);
+                p_attr->handle = (uint16_t)(handle + h);
+                p_attr->max_len = TEST_VALUE_LEN;
+                p_attr->cur_len = TEST_VALUE_LEN;
+                p_attr->p_data = test_values[entry];
+                entry++;
+            }
+        }
+    }
+
+    test_handles[type] = TEST_LAST_HANDLE;
+    test_types[type] = TEST_TYPE_VALUE;
+    app_gatt_db_ext_attr_tbl[TEST_ENTRIES - 1u].handle = TEST_LAST_HANDLE;
+    app_gatt_db_ext_attr_tbl[TEST_ENTRIES - 1u].max_len = TEST_VALUE_LEN;
+    app_gatt_db_ext_attr_tbl[TEST_ENTRIES - 1u].cur_len = TEST_VALUE_LEN;
+    app_gatt_db_ext_attr_tbl[TEST_ENTRIES - 1u].p_data = test_values[TEST_ENTRIES - 1u];
+
+    stub_gatt_set_types(test_handles, test_types, (uint16_t)TEST_TYPES);
+    bt_attr_init();
+}
+
+/*******************************************************************************
+* Function Name: test_read / test_read_inverted / test_now_ns / test_rbt
+********************************************************************************
+* Summary:
+*  Value reader as bt_app_read_value for plain attributes, one returning
+*  other values than the table, the time in
+*  nanoseconds, and a Read By Type request of the values of the first chars
+*  characteristics of a block.
+*
+*******************************************************************************/
+static uint16_t test_read(uint16_t conn_id, gatt_db_lookup_table_t *p_attr,
+                          uint16_t offset, uint8_t *p_out, uint16_t out_len)
+{
+    uint16_t len;
+
+    (void)conn_id;
+    if (offset >= p_attr->cur_len)
+    {
+        return 0u;
+    }
+    len = (uint16_t)(p_attr->cur_len - offset);
+    len = (out_len < len) ? out_len : len;
+    memcpy(p_out, p_attr->p_data + offset, len);
+    return len;
+}
+
+/* Reader whose values differ from those of the table, like CCCDs of a connection */
+static uint16_t test_read_inverted(uint16_t conn_id, gatt_db_lookup_table_t *p_attr,
+                                   uint16_t offset, uint8_t *p_out, uint16_t out_len)
+{
+    uint16_t len = test_read(conn_id, p_attr, offset, p_out, out_len);
+
+    for (uint16_t i = 0u; i < len; i++)
+    {
+        p_out[i] = (uint8_t)~p_out[i];
+    }
+    return len;
+}
+
+static uint64_t test_now_ns(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+static wiced_bt_gatt_status_t test_rbt(uint16_t base, uint16_t chars, uint16_t type, uint8_t *p_rsp,
+                                       uint16_t len_req, uint8_t *p_pair_len, uint16_t *p_used_len)
+{
+    static uint8_t val[TEST_MTU_LEN_REQ];
+    wiced_bt_gatt_read_by_type_t req;
+
+    req.s_handle = base;
+    req.e_handle = (uint16_t)(TEST_CHAR_HANDLE(base, chars) - 1u);
+    req.uuid.len = 2u;
+    req.uuid.uu.uuid16 = type;
+    return bt_attr_read_by_type(TEST_CONN_ID, &req, test_read, val, p_rsp, len_req,
+                                p_pair_len, p_used_len);
+}
+
+/*******************************************************************************
+* Function Name: test_bench_read_by_type
+********************************************************************************
+* Summary:
+*  Checks the Read By Type responses of both blocks: every value pair in
+*  handle order, the response cut at the first pair that does not fit, a
+*  range without the type, a type found without an attribute, a range up to
+*  the last handle, and values taken from the reader.
+*
+*******************************************************************************/
+static void test_bench_read_by_type(void)
+{
+    const uint16_t bases[2] = { TEST_LOW_BASE, TEST_HIGH_BASE };
+    uint8_t rsp[TEST_MTU_LEN_REQ];
+    uint8_t pair_len;
+    uint16_t used_len;
+    wiced_bt_gatt_read_by_type_t req;
+    uint8_t val[TEST_MTU_LEN_REQ];
+
+    test_build();
+
+    for (uint16_t b = 0u; b < 2u; b++)
+    {
+        uint32_t wrong = 0u;
+
+        TEST_CHECK_EQ(test_rbt(bases[b], TEST_CHARS, TEST_TYPE_VALUE, rsp, TEST_MTU_LEN_REQ,
+                               &pair_len, &used_len), WICED_BT_GATT_SUCCESS);
+        TEST_CHECK_EQ(pair_len, 2u + TEST_VALUE_LEN);
+        TEST_CHECK_EQ(used_len, TEST_CHARS * (2u + TEST_VALUE_LEN));
+        for (uint16_t n = 0u; n < TEST_CHARS; n++)
+        {
+            const uint8_t *p_pair = &rsp[n * (2u + TEST_VALUE_LEN)];
+            uint16_t handle = (uint16_t)(TEST_CHAR_HANDLE(bases[b], n) + 1u);
+
+            /* Handle, then the value, which is the handle too */
+            wrong += ((p_pair[0] | (p_pair[1] << 8)) != handle) ? 1u : 0u;
+            wrong += ((p_pair[2] | (p_pair[3] << 8)) != handle) ? 1u : 0u;
+        }
+        TEST_CHECK_EQ(wrong, 0u);
+
+        TEST_CHECK_EQ(test_rbt(bases[b], TEST_CHARS, TEST_TYPE_CCCD, rsp, TEST_SHORT_LEN_REQ,
+                               &pair_len, &used_len), WICED_BT_GATT_SUCCESS);
+        TEST_CHECK_EQ(used_len, (TEST_SHORT_LEN_REQ / (2u + TEST_VALUE_LEN)) * (2u + TEST_VALUE_LEN));
+        TEST_CHECK_EQ(rsp[0] | (rsp[1] << 8), TEST_CHAR_HANDLE(bases[b], 0u) + 2u);
+    }
+
+    TEST_CHECK_EQ(test_rbt(TEST_LOW_BASE, TEST_CHARS, 0x2A00u, rsp, TEST_MTU_LEN_REQ,
+                           &pair_len, &used_len), WICED_BT_GATT_INVALID_HANDLE);
+    TEST_CHECK_EQ(used_len, 0u);
+
+    /* Declarations are typed in the database but have no table entry */
+    TEST_CHECK_EQ(test_rbt(TEST_LOW_BASE, TEST_CHARS, TEST_TYPE_CHAR, rsp, TEST_MTU_LEN_REQ,
+                           &pair_len, &used_len), WICED_BT_GATT_ERR_UNLIKELY);
+
+    /* A search past a value at the last handle does not wrap around */
+    req.s_handle = TEST_HIGH_BASE;
+    req.e_handle = TEST_LAST_HANDLE;
+    req.uuid.len = 2u;
+    req.uuid.uu.uuid16 = TEST_TYPE_VALUE;
+    TEST_CHECK_EQ(bt_attr_read_by_type(TEST_CONN_ID, &req, test_read, val, rsp, TEST_MTU_LEN_REQ,
+                                       &pair_len, &used_len), WICED_BT_GATT_SUCCESS);
+    TEST_CHECK_EQ(used_len, (TEST_CHARS + 1u) * (2u + TEST_VALUE_LEN));
+
+    /* Values are the reader's, not those of the table */
+    TEST_CHECK_EQ(bt_attr_read_by_type(TEST_CONN_ID, &req, test_read_inverted, val, rsp, TEST_MTU_LEN_REQ,
+                                       &pair_len, &used_len), WICED_BT_GATT_SUCCESS);
+    TEST_CHECK_EQ(rsp[2], (uint8_t)~((TEST_HIGH_BASE + 1u) & 0xFFu));
+}
+
+/*******************************************************************************
+* Function Name: test_bench_write
+********************************************************************************
+* Summary:
+*  A value that fits replaces the old one; a longer one is refused and
+*  leaves it.
+*
+*******************************************************************************/
+static void test_bench_write(void)
+{
+    const uint8_t value[TEST_VALUE_LEN + 1u] = { 0x12u, 0x34u, 0x56u };
+    gatt_db_lookup_table_t *p_attr;
+
+    test_build();
+    p_attr = bt_attr_find((uint16_t)(TEST_CHAR_HANDLE(TEST_HIGH_BASE, TEST_CHARS - 1u) + 1u));
+    TEST_CHECK(NULL != p_attr);
+
+    TEST_CHECK_EQ(bt_attr_write(p_attr, value, 1u), WICED_BT_GATT_SUCCESS);
+    TEST_CHECK_EQ(p_attr->cur_len, 1u);
+    TEST_CHECK_EQ(p_attr->p_data[0], 0x12u);
+
+    TEST_CHECK_EQ(bt_attr_write(p_attr, value, sizeof(value)), WICED_BT_GATT_INVALID_HANDLE);
+    TEST_CHECK_EQ(p_attr->cur_len, 1u);
+}
+
+/*******************************************************************************
+* Function Name: test_bench_scaling
+********************************************************************************
+* Summary:
+*  Times, for databases of a growing number of characteristics, a read and
+*  a write of the value of the last characteristic and a Read By Type of
+*  all values, through the index and through the linear search. Through the
+*  index, reads and writes take the same time at every size and Read By
+*  Type the same time per pair; through the search, both grow with the
+*  size, so Read By Type grows with its square.
+*
+*******************************************************************************/
+static void test_bench_scaling(void)
+{
+    const uint16_t sizes[] = { 5u, 10u, 20u, TEST_CHARS };
+    const uint16_t bases[2] = { TEST_LOW_BASE, TEST_HIGH_BASE };
+    const char *names[2] = { "index", "search" };
+    uint8_t rsp[TEST_MTU_LEN_REQ];
+    uint8_t out[TEST_VALUE_LEN];
+    uint8_t pair_len;
+    uint16_t used_len;
+    uint32_t failures = 0u;
+
+    test_build();
+    (void)printf("  %u characteristics max, ns per request:\n", (unsigned int)TEST_CHARS);
+    (void)printf("  %-7s %5s %7s %7s %13s %9s\n", "lookup", "chars", "read", "write", "read by type", "per pair");
+
+    for (uint16_t b = 0u; b < 2u; b++)
+    {
+        for (uint16_t s = 0u; s < (uint16_t)(sizeof(sizes) / sizeof(sizes[0])); s++)
+        {
+            uint16_t chars = sizes[s];
+            uint16_t handle = (uint16_t)(TEST_CHAR_HANDLE(bases[b], chars - 1u) + 1u);
+            uint64_t start;
+            uint64_t read_ns;
+            uint64_t write_ns;
+            uint64_t rbt_ns;
+
+            /* As bt_app_gatt_req_read_handler: look up, then copy the value */
+            start = test_now_ns();
+            for (uint32_t i = 0u; i < TEST_REPEATS; i++)
+            {
+                gatt_db_lookup_table_t *p_attr = bt_attr_find(handle);
+
+                test_sink += test_read(TEST_CONN_ID, p_attr, 0u, out, sizeof(out));
+            }
+            read_ns = test_now_ns() - start;
+
+            /* As bt_app_gatt_req_write_value for a plain attribute */
+            start = test_now_ns();
+            for (uint32_t i = 0u; i < TEST_REPEATS; i++)
+            {
+                failures += (WICED_BT_GATT_SUCCESS != bt_attr_write(bt_attr_find(handle), out, sizeof(out))) ? 1u : 0u;
+            }
+            write_ns = test_now_ns() - start;
+
+            start = test_now_ns();
+            for (uint32_t i = 0u; i < TEST_RBT_REPEATS; i++)
+            {
+                failures += (WICED_BT_GATT_SUCCESS != test_rbt(bases[b], chars, TEST_TYPE_VALUE, rsp,
+                                                               TEST_MTU_LEN_REQ, &pair_len, &used_len)) ? 1u : 0u;
+                failures += (used_len != (chars * (2u + TEST_VALUE_LEN))) ? 1u : 0u;
+            }
+            rbt_ns = test_now_ns() - start;
+
+            (void)printf("  %-7s %5u %7u %7u %13u %9u\n", names[b], (unsigned int)chars,
+                         (unsigned int)(read_ns / TEST_REPEATS), (unsigned int)(write_ns / TEST_REPEATS),
+                         (unsigned int)(rbt_ns / TEST_RBT_REPEATS),
+                         (unsigned int)(rbt_ns / ((uint64_t)TEST_RBT_REPEATS * chars)));
+        }
+    }
+
+    TEST_CHECK_EQ(failures, 0u);
+}
+
+int main(void)
+{
+    TEST_RUN(test_bench_read_by_type);
+    TEST_RUN(test_bench_write);
+    TEST_RUN(test_bench_scaling);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,325 @@
+/*******************************************************************************
+* File Name: test_bt_bond.c
+*
+* Description: This file contains the host test of the bonding information.
+* It checks that the stack context only changes the RAM copy, that
+* bt_bond_flush writes each changed item once, and that the flash holds
+* what a reset restores, also after a failed write. A stress run takes the stack context and bt_task
+* in two threads to catch changes lost while an item is being written.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+/* sched_yield is POSIX */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "flash_utils.h"
+#include "bt_bond.h"
+#include "bt_conn.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_STRESS_CYCLES              (200000u)   /* Stack events */
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+TaskHandle_t bt_task_handle;
+
+static volatile bool test_stop = false;
+
+/*******************************************************************************
+* Function Name: test_keys / test_open
+********************************************************************************
+* Summary:
+*  Link keys of a central derived from its ID, and a connection from it.
+*
+*******************************************************************************/
+static void test_keys(uint8_t id, wiced_bt_device_link_keys_t *p_keys)
+{
+    memset(p_keys, 0, sizeof(*p_keys));
+    p_keys->bd_addr[0] = id;
+    p_keys->key_data.ble_addr_type = (uint8_t)(id & 1u);
+    memset(p_keys->key_data.le_keys, id, sizeof(p_keys->key_data.le_keys));
+}
+
+static bt_conn_t *test_open(uint8_t id)
+{
+    wiced_bt_device_link_keys_t keys;
+
+    test_keys(id, &keys);
+    return bt_conn_add(id, keys.bd_addr);
+}
+
+static void test_set_cccd(bt_conn_t *p_conn, uint8_t value)
+{
+    taskENTER_CRITICAL();
+    p_conn->cccd[BT_CONN_CCCD_CO2][0] = value;
+    p_conn->cccd[BT_CONN_CCCD_TEMPERATURE][0] = (uint8_t)~value;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: test_bond_deferred
+********************************************************************************
+* Summary:
+*  Saves keys and configurations as the stack context does and checks that
+*  flash is only written by bt_bond_flush, and that a reset finds them.
+*
+*******************************************************************************/
+static void test_bond_deferred(void)
+{
+    wiced_bt_device_link_keys_t keys_a;
+    wiced_bt_device_link_keys_t keys_b;
+    wiced_bt_device_link_keys_t loaded;
+    wiced_bt_local_identity_keys_t local;
+    wiced_bt_local_identity_keys_t local_loaded;
+    wiced_bt_device_address_t last;
+    wiced_bt_ble_address_type_t last_type;
+    bt_conn_t *p_conn;
+    uint32_t writes;
+    uint32_t notified;
+
+    stub_flash_erase();
+    bt_conn_init(BT_CONN_MAX);
+    bt_bond_init();
+    test_keys(1u, &keys_a);
+    test_keys(2u, &keys_b);
+    memset(&local, 0x5A, sizeof(local));
+    writes = stub_flash_writes();
+    notified = stub_rtos_notifications();
+
+    /* Stack context: RAM only, bt_task woken */
+    bt_bond_save_local_keys(&local);
+    TEST_CHECK(bt_bond_load_local_keys(&local_loaded));
+    TEST_CHECK_EQ(memcmp(&local_loaded, &local, sizeof(local)), 0);
+
+    p_conn = test_open(1u);
+    test_set_cccd(p_conn, 0x01u);
+    bt_bond_save_keys(&keys_a);
+    TEST_CHECK(bt_bond_is_bonded(keys_a.bd_addr));
+    loaded = keys_a;
+    memset(&loaded.key_data, 0, sizeof(loaded.key_data));
+    TEST_CHECK(bt_bond_load_keys(&loaded));
+    TEST_CHECK_EQ(memcmp(&loaded, &keys_a, sizeof(keys_a)), 0);
+    TEST_CHECK(bt_bond_last_peer(last, &last_type));
+    TEST_CHECK_EQ(memcmp(last, keys_a.bd_addr, sizeof(last)), 0);
+
+    test_set_cccd(p_conn, 0x02u);
+    bt_bond_save_cccd(p_conn);
+    TEST_CHECK_EQ(stub_flash_writes(), writes);
+    TEST_CHECK(stub_rtos_notifications() > notified);
+
+    /* bt_task: peer, index and local keys, once each */
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 3u);
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 3u);
+
+    /* Unchanged configurations are not marked */
+    bt_bond_save_cccd(p_conn);
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 3u);
+
+    /* A second central becomes the last one */
+    bt_conn_remove(1u);
+    (void)test_open(2u);
+    bt_bond_save_keys(&keys_b);
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 5u);
+    bt_conn_remove(2u);
+
+    /* Reset: the first central gets its configurations back and becomes
+     * the last one again, which is written on the next flush */
+    bt_conn_init(BT_CONN_MAX);
+    bt_bond_init();
+    TEST_CHECK(bt_bond_is_bonded(keys_a.bd_addr));
+    TEST_CHECK(bt_bond_is_bonded(keys_b.bd_addr));
+    TEST_CHECK(bt_bond_last_peer(last, &last_type));
+    TEST_CHECK_EQ(memcmp(last, keys_b.bd_addr, sizeof(last)), 0);
+
+    p_conn = test_open(1u);
+    TEST_CHECK(bt_bond_restore_cccd(p_conn));
+    TEST_CHECK_EQ(p_conn->cccd[BT_CONN_CCCD_CO2][0], 0x02u);
+    TEST_CHECK_EQ(p_conn->cccd[BT_CONN_CCCD_TEMPERATURE][0], 0xFDu);
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 5u);
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 6u);
+
+    bt_conn_init(BT_CONN_MAX);
+    bt_bond_init();
+    TEST_CHECK(bt_bond_last_peer(last, &last_type));
+    TEST_CHECK_EQ(memcmp(last, keys_a.bd_addr, sizeof(last)), 0);
+    TEST_CHECK_EQ(last_type, keys_a.key_data.ble_addr_type);
+}
+
+/*******************************************************************************
+* Function Name: test_bond_retry
+********************************************************************************
+* Summary:
+*  A bond whose flash writes fail is written on a later flush without
+*  being changed again.
+*
+*******************************************************************************/
+static void test_bond_retry(void)
+{
+    wiced_bt_device_link_keys_t keys;
+    wiced_bt_device_address_t last;
+    wiced_bt_ble_address_type_t last_type;
+    bt_conn_t *p_conn;
+    uint32_t writes;
+    uint32_t notified;
+
+    stub_flash_erase();
+    bt_conn_init(BT_CONN_MAX);
+    bt_bond_init();
+    test_keys(3u, &keys);
+    p_conn = test_open(3u);
+    test_set_cccd(p_conn, 0x01u);
+    bt_bond_save_keys(&keys);
+
+    /* Peer and index fail; bt_task is not woken for the retry */
+    stub_flash_set_fail(true);
+    writes = stub_flash_writes();
+    notified = stub_rtos_notifications();
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 2u);
+    TEST_CHECK_EQ(stub_rtos_notifications(), notified);
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 4u);
+
+    stub_flash_set_fail(false);
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 6u);
+    bt_bond_flush();
+    TEST_CHECK_EQ(stub_flash_writes(), writes + 6u);
+
+    bt_conn_init(BT_CONN_MAX);
+    bt_bond_init();
+    TEST_CHECK(bt_bond_is_bonded(keys.bd_addr));
+    TEST_CHECK(bt_bond_last_peer(last, &last_type));
+    TEST_CHECK_EQ(memcmp(last, keys.bd_addr, sizeof(last)), 0);
+    p_conn = test_open(3u);
+    TEST_CHECK(bt_bond_restore_cccd(p_conn));
+    TEST_CHECK_EQ(p_conn->cccd[BT_CONN_CCCD_CO2][0], 0x01u);
+}
+
+/*******************************************************************************
+* Function Name: test_task
+********************************************************************************
+* Summary:
+*  bt_task of the stress run: flushes until stopped.
+*
+*******************************************************************************/
+static void *test_task(void *arg)
+{
+    (void)arg;
+
+    while (!test_stop)
+    {
+        bt_bond_flush();
+        (void)sched_yield();
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: test_bond_stress
+********************************************************************************
+* Summary:
+*  The stack context keeps changing the configurations of one central and
+*  the last central while bt_task writes them. After a final flush, a reset
+*  must find the last values written in RAM.
+*
+*******************************************************************************/
+static void test_bond_stress(void)
+{
+    wiced_bt_device_link_keys_t keys_a;
+    wiced_bt_device_link_keys_t keys_b;
+    wiced_bt_device_address_t last;
+    wiced_bt_ble_address_type_t last_type;
+    bt_conn_t *p_conn_a;
+    bt_conn_t *p_conn_b;
+    uint32_t writes;
+    uint8_t value = 0u;
+    bool last_a = false;
+    pthread_t task;
+
+    stub_flash_erase();
+    bt_conn_init(BT_CONN_MAX);
+    bt_bond_init();
+    test_keys(1u, &keys_a);
+    test_keys(2u, &keys_b);
+    p_conn_a = test_open(1u);
+    p_conn_b = test_open(2u);
+    bt_bond_save_keys(&keys_a);
+    bt_bond_save_keys(&keys_b);
+    writes = stub_flash_writes();
+
+    test_stop = false;
+    TEST_CHECK_EQ(pthread_create(&task, NULL, test_task, NULL), 0);
+
+    for (uint32_t cycle = 0u; cycle < TEST_STRESS_CYCLES; cycle++)
+    {
+        value = (uint8_t)(cycle * 7u);
+        test_set_cccd(p_conn_a, value);
+        bt_bond_save_cccd(p_conn_a);
+
+        /* Reconnections of either central move the last slot */
+        if (0u == (cycle % 3u))
+        {
+            last_a = (0u != (cycle & 8u));
+            (void)bt_bond_restore_cccd(last_a ? p_conn_a : p_conn_b);
+            if (last_a)
+            {
+                /* The restored values are the ones just saved */
+                TEST_CHECK_EQ(p_conn_a->cccd[BT_CONN_CCCD_CO2][0], value);
+            }
+        }
+        if (0u == (cycle % 4u))
+        {
+            (void)sched_yield();
+        }
+    }
+
+    test_stop = true;
+    TEST_CHECK_EQ(pthread_join(task, NULL), 0);
+    bt_bond_flush();
+    writes = stub_flash_writes() - writes;
+
+    (void)printf("  %u flash writes for %u changes\n", (unsigned int)writes,
+                 (unsigned int)TEST_STRESS_CYCLES);
+
+    bt_conn_init(BT_CONN_MAX);
+    bt_bond_init();
+    TEST_CHECK(bt_bond_last_peer(last, &last_type));
+    TEST_CHECK_EQ(memcmp(last, (last_a ? keys_a : keys_b).bd_addr, sizeof(last)), 0);
+    p_conn_a = test_open(1u);
+    TEST_CHECK(bt_bond_restore_cccd(p_conn_a));
+    TEST_CHECK_EQ(p_conn_a->cccd[BT_CONN_CCCD_CO2][0], value);
+    TEST_CHECK_EQ(p_conn_a->cccd[BT_CONN_CCCD_TEMPERATURE][0], (uint8_t)~value);
+}
+
+int main(void)
+{
+    TEST_RUN(test_bond_deferred);
+    TEST_RUN(test_bond_retry);
+    TEST_RUN(test_bond_stress);
+
+    return TEST_RESULT;
+}
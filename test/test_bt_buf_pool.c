@@ -0,0 +1,253 @@
+/*******************************************************************************
+* File Name: test_bt_buf_pool.c
+*
+* Description: This file contains the host test of the GATT buffer pool. The
+* size classes, the heap fallback and its refusal in interrupt context are
+* checked first; then threads, some of them posing as interrupts, allocate,
+* fill, verify and free buffers concurrently to catch blocks handed out
+* twice and blocks lost from the free lists.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <pthread.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "bt_buf_pool.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_THREADS                    (6u)
+#define TEST_ISR_THREADS                (2u)        /* Of TEST_THREADS */
+#define TEST_CYCLES                     (200000u)   /* Per thread */
+#define TEST_HELD_MAX                   (3u)        /* Buffers a thread holds at once */
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+typedef struct
+{
+    pthread_t thread;
+    uint8_t id;
+    bool isr;
+    uint32_t seed;
+    uint32_t corrupted;
+    uint32_t refused;
+} test_worker_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+/*******************************************************************************
+* Function Name: test_pool_classes
+********************************************************************************
+* Summary:
+*  A request goes to the smallest class it fits. An exhausted class or an
+*  oversized request is served by the heap in a task and refused in an
+*  interrupt. Freed blocks return to their class.
+*
+*******************************************************************************/
+static void test_pool_classes(void)
+{
+    void *p_small[BT_BUF_POOL_SMALL_COUNT];
+    bt_buf_pool_stats_t stats;
+    void *p_buf;
+
+    bt_buf_pool_init();
+
+    for (uint32_t i = 0u; i < BT_BUF_POOL_SMALL_COUNT; ++i)
+    {
+        p_small[i] = bt_buf_pool_alloc(BT_BUF_POOL_SMALL_SIZE);
+        TEST_CHECK(NULL != p_small[i]);
+    }
+    TEST_CHECK_EQ(stub_rtos_heap_blocks(), 0u);
+
+    /* Small class exhausted: the heap serves a task... */
+    p_buf = bt_buf_pool_alloc(1u);
+    TEST_CHECK(NULL != p_buf);
+    TEST_CHECK_EQ(stub_rtos_heap_blocks(), 1u);
+    bt_buf_pool_free(p_buf);
+    TEST_CHECK_EQ(stub_rtos_heap_blocks(), 0u);
+
+    /* ...but not an interrupt */
+    stub_rtos_in_isr = true;
+    TEST_CHECK(NULL == bt_buf_pool_alloc(1u));
+    TEST_CHECK(NULL == bt_buf_pool_alloc(BT_BUF_POOL_LARGE_SIZE + 1u));
+
+    /* The large class still serves an interrupt, and a block is released there */
+    p_buf = bt_buf_pool_alloc(BT_BUF_POOL_SMALL_SIZE + 1u);
+    TEST_CHECK(NULL != p_buf);
+    bt_buf_pool_free(p_buf);
+    bt_buf_pool_free(p_small[0]);
+    stub_rtos_in_isr = false;
+
+    p_buf = bt_buf_pool_alloc(BT_BUF_POOL_SMALL_SIZE);
+    TEST_CHECK(p_buf == p_small[0]);
+    p_small[0] = p_buf;
+
+    bt_buf_pool_get_stats(BT_BUF_POOL_CLASS_SMALL, &stats);
+    TEST_CHECK_EQ(stats.in_use, BT_BUF_POOL_SMALL_COUNT);
+    TEST_CHECK_EQ(stats.high_water, BT_BUF_POOL_SMALL_COUNT);
+    TEST_CHECK_EQ(stats.allocs, BT_BUF_POOL_SMALL_COUNT + 1u);
+    TEST_CHECK_EQ(stats.exhausted, 2u);
+    TEST_CHECK_EQ(stats.failures, 1u);
+
+    for (uint32_t i = 0u; i < BT_BUF_POOL_SMALL_COUNT; ++i)
+    {
+        bt_buf_pool_free(p_small[i]);
+    }
+
+    bt_buf_pool_get_stats(BT_BUF_POOL_CLASS_SMALL, &stats);
+    TEST_CHECK_EQ(stats.in_use, 0u);
+    bt_buf_pool_get_stats(BT_BUF_POOL_CLASS_LARGE, &stats);
+    TEST_CHECK_EQ(stats.in_use, 0u);
+    TEST_CHECK_EQ(stats.allocs, 1u);
+    TEST_CHECK_EQ(stats.failures, 0u);
+}
+
+static uint32_t test_rand(uint32_t *p_seed)
+{
+    *p_seed = (*p_seed * 1664525u) + 1013904223u;
+    return *p_seed >> 8;
+}
+
+static void *test_worker(void *arg)
+{
+    test_worker_t *p_worker = (test_worker_t *)arg;
+    uint8_t *p_held[TEST_HELD_MAX] = { NULL };
+    uint16_t len_held[TEST_HELD_MAX] = { 0u };
+
+    stub_rtos_in_isr = p_worker->isr;
+
+    for (uint32_t cycle = 0u; cycle < TEST_CYCLES; ++cycle)
+    {
+        uint32_t slot = test_rand(&p_worker->seed) % TEST_HELD_MAX;
+
+        if (NULL != p_held[slot])
+        {
+            /* Every byte must still carry the owner's mark */
+            for (uint16_t i = 0u; i < len_held[slot]; ++i)
+            {
+                if (p_held[slot][i] != (uint8_t)(p_worker->id + i))
+                {
+                    p_worker->corrupted++;
+                    break;
+                }
+            }
+            bt_buf_pool_free(p_held[slot]);
+            p_held[slot] = NULL;
+            continue;
+        }
+
+        /* Mostly pool sizes, sometimes beyond the large class */
+        uint16_t len = (uint16_t)(1u + (test_rand(&p_worker->seed) % (BT_BUF_POOL_LARGE_SIZE + 16u)));
+        uint8_t *p_buf = (uint8_t *)bt_buf_pool_alloc(len);
+
+        if (NULL == p_buf)
+        {
+            p_worker->refused++;
+            continue;
+        }
+        for (uint16_t i = 0u; i < len; ++i)
+        {
+            p_buf[i] = (uint8_t)(p_worker->id + i);
+        }
+        p_held[slot] = p_buf;
+        len_held[slot] = len;
+    }
+
+    for (uint32_t slot = 0u; slot < TEST_HELD_MAX; ++slot)
+    {
+        bt_buf_pool_free(p_held[slot]);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: test_pool_stress
+********************************************************************************
+* Summary:
+*  Runs the workers concurrently. No buffer may be overwritten by another
+*  worker, only the interrupt workers may be refused, and at the end every
+*  block must be back on its free list and every heap buffer freed.
+*
+*******************************************************************************/
+static void test_pool_stress(void)
+{
+    test_worker_t workers[TEST_THREADS];
+    uint32_t refused_isr = 0u;
+
+    bt_buf_pool_init();
+
+    for (uint8_t i = 0u; i < TEST_THREADS; ++i)
+    {
+        workers[i] = (test_worker_t){ .id = (uint8_t)(i * 41u), .isr = (i < TEST_ISR_THREADS), .seed = 1u + i };
+        TEST_CHECK_EQ(pthread_create(&workers[i].thread, NULL, test_worker, &workers[i]), 0);
+    }
+    for (uint8_t i = 0u; i < TEST_THREADS; ++i)
+    {
+        TEST_CHECK_EQ(pthread_join(workers[i].thread, NULL), 0);
+        TEST_CHECK_EQ(workers[i].corrupted, 0u);
+        if (workers[i].isr)
+        {
+            refused_isr += workers[i].refused;
+        }
+        else
+        {
+            TEST_CHECK_EQ(workers[i].refused, 0u);
+        }
+    }
+
+    for (uint8_t c = 0u; c < BT_BUF_POOL_CLASS_COUNT; ++c)
+    {
+        bt_buf_pool_stats_t stats;
+        void *p_blocks[BT_BUF_POOL_SMALL_COUNT + BT_BUF_POOL_LARGE_COUNT];
+        uint16_t size = (BT_BUF_POOL_CLASS_SMALL == c) ? BT_BUF_POOL_SMALL_SIZE : BT_BUF_POOL_LARGE_SIZE;
+        uint16_t count = (BT_BUF_POOL_CLASS_SMALL == c) ? BT_BUF_POOL_SMALL_COUNT : BT_BUF_POOL_LARGE_COUNT;
+
+        bt_buf_pool_get_stats(c, &stats);
+        TEST_CHECK_EQ(stats.in_use, 0u);
+        TEST_CHECK(stats.high_water <= count);
+        (void)printf("  class %u: %u allocs, high water %u, %u exhausted, %u failed\n", (unsigned int)c,
+                     (unsigned int)stats.allocs, (unsigned int)stats.high_water,
+                     (unsigned int)stats.exhausted, (unsigned int)stats.failures);
+
+        /* All blocks are free again and distinct */
+        for (uint16_t i = 0u; i < count; ++i)
+        {
+            p_blocks[i] = bt_buf_pool_alloc(size);
+            for (uint16_t j = 0u; j < i; ++j)
+            {
+                TEST_CHECK(p_blocks[i] != p_blocks[j]);
+            }
+        }
+        TEST_CHECK_EQ(stub_rtos_heap_blocks(), 0u);
+        for (uint16_t i = 0u; i < count; ++i)
+        {
+            bt_buf_pool_free(p_blocks[i]);
+        }
+    }
+
+    TEST_CHECK_EQ(stub_rtos_heap_blocks(), 0u);
+    (void)printf("  %u cycles, %u refused in interrupt context\n",
+                 TEST_THREADS * TEST_CYCLES, (unsigned int)refused_isr);
+}
+
+int main(void)
+{
+    TEST_RUN(test_pool_classes);
+    TEST_RUN(test_pool_stress);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,480 @@
+/*******************************************************************************
+* File Name: test_bt_conn.c
+*
+* Description: This file contains the host test of the connection table and
+* the link policy. Besides the unit checks, three threads take the roles of
+* the stack context, which opens, configures and closes connections, of the
+* BT task, which notifies the subscribers, and of the timer task returning
+* links to idle mode, to catch notifications sent from half-updated slots
+* and link state updates lost between contexts.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+/* sched_yield is POSIX */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "wiced_bt_l2c.h"
+#include "bt_conn.h"
+#include "bt_link.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_HANDLE_CO2                 (0x0010u)
+#define TEST_HANDLE_BATCH               (0x0020u)
+#define TEST_VALUE_LEN                  (244u)      /* Longer than any MTU allows */
+
+#define TEST_STRESS_CYCLES              (400000u)   /* Stack events */
+#define TEST_STRESS_TICKS               (8u)        /* Per stack event */
+#define TEST_STRESS_CLOSE               (256u)      /* 1 in n stack events closes a connection */
+#define TEST_STRESS_ACTIVITY            (200u)      /* 1 in n stack events is bulk traffic */
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+static uint8_t test_value[TEST_VALUE_LEN];
+static uint32_t test_notified[2];               /* Single values, batches */
+static uint32_t test_bad_len = 0u;
+static uint32_t test_bad_batch = 0u;
+static bool test_got[0x10000];                  /* Connection IDs notified */
+static volatile bool test_stop = false;
+static bool test_yield = false;                 /* Sending yields to the other contexts */
+
+/*******************************************************************************
+* Function Name: test_mtu / test_batch
+********************************************************************************
+* Summary:
+*  Configuration of a connection derived from its ID, so that a notification
+*  can be checked against the connection it went to.
+*
+*******************************************************************************/
+static uint16_t test_mtu(uint16_t conn_id)
+{
+    return (uint16_t)(BT_CONN_DEFAULT_MTU + ((conn_id % 8u) * 28u));
+}
+
+static uint8_t test_batch(uint16_t conn_id)
+{
+    return (0u == (conn_id % 3u)) ? (uint8_t)(2u + (conn_id % 5u)) : 0u;
+}
+
+static void test_addr(uint16_t conn_id, wiced_bt_device_address_t bd_addr)
+{
+    memset(bd_addr, 0, sizeof(wiced_bt_device_address_t));
+    bd_addr[0] = (uint8_t)conn_id;
+    bd_addr[1] = (uint8_t)(conn_id >> 8);
+}
+
+/* Opens a connection as the stack context does on connection and MTU exchange */
+static bt_conn_t *test_open(uint16_t conn_id, bool configure)
+{
+    wiced_bt_device_address_t bd_addr;
+    bt_conn_t *p_conn;
+
+    test_addr(conn_id, bd_addr);
+    p_conn = bt_conn_add(conn_id, bd_addr);
+    if (NULL == p_conn)
+    {
+        return NULL;
+    }
+    bt_link_open(conn_id);
+
+    if (configure)
+    {
+        p_conn->mtu = test_mtu(conn_id);
+        p_conn->batch = test_batch(conn_id);
+        taskENTER_CRITICAL();
+        p_conn->cccd[BT_CONN_CCCD_CO2][0] = GATT_CLIENT_CONFIG_NOTIFICATION;
+        p_conn->cccd[BT_CONN_CCCD_CO2][1] = 0u;
+        taskEXIT_CRITICAL();
+    }
+    return p_conn;
+}
+
+/* Checks every notification against the configuration of its connection */
+static wiced_bt_gatt_status_t test_notify_cb(uint16_t conn_id, uint16_t attr_handle, uint16_t val_len,
+                                             const uint8_t *p_val)
+{
+    (void)p_val;
+
+    test_got[conn_id] = true;
+    if (TEST_HANDLE_BATCH == attr_handle)
+    {
+        if (0u == test_batch(conn_id))
+        {
+            test_bad_batch++;
+        }
+        test_notified[1]++;
+    }
+    else
+    {
+        /* Cut to the default MTU until the exchange, then to the exchanged one */
+        if ((val_len != (BT_CONN_DEFAULT_MTU - 3u)) && (val_len != (test_mtu(conn_id) - 3u)))
+        {
+            test_bad_len++;
+        }
+        test_notified[0]++;
+    }
+    if (test_yield)
+    {
+        (void)sched_yield();
+    }
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: test_conn_table
+********************************************************************************
+* Summary:
+*  Slots are taken up to the limit, found by ID and address, and released.
+*
+*******************************************************************************/
+static void test_conn_table(void)
+{
+    wiced_bt_device_address_t bd_addr;
+    bt_conn_t *p_conn;
+
+    bt_conn_init(2u);
+    TEST_CHECK(NULL != test_open(1u, false));
+    p_conn = test_open(2u, false);
+    TEST_CHECK(NULL != p_conn);
+    TEST_CHECK(test_open(2u, false) == p_conn);
+    TEST_CHECK(bt_conn_is_full());
+    TEST_CHECK(NULL == test_open(3u, false));
+    TEST_CHECK_EQ(bt_conn_count(), 2u);
+
+    test_addr(2u, bd_addr);
+    TEST_CHECK(bt_conn_find_by_addr(bd_addr) == p_conn);
+    TEST_CHECK(bt_conn_find(2u) == p_conn);
+    TEST_CHECK_EQ(p_conn->mtu, BT_CONN_DEFAULT_MTU);
+
+    bt_conn_remove(1u);
+    TEST_CHECK(NULL == bt_conn_find(1u));
+    TEST_CHECK(!bt_conn_is_full());
+    TEST_CHECK(NULL != test_open(3u, false));
+    TEST_CHECK_EQ(bt_conn_count(), 2u);
+}
+
+/*******************************************************************************
+* Function Name: test_conn_notify
+********************************************************************************
+* Summary:
+*  Single values go to the subscribers not in batch mode, cut to their MTU;
+*  batches go to the subscribers in batch mode, sized for the smallest.
+*
+*******************************************************************************/
+static void test_conn_notify(void)
+{
+    bt_conn_t *p_conn;
+
+    stub_rtos_set_tick(1000u);
+    bt_conn_init(BT_CONN_MAX);
+    stub_gatt_set_notify_cb(test_notify_cb);
+    memset(test_notified, 0, sizeof(test_notified));
+
+    (void)test_open(1u, true);                  /* MTU 51 */
+    (void)test_open(3u, true);                  /* MTU 107, batch 5 */
+    (void)test_open(6u, true);                  /* MTU 191, batch 3 */
+    p_conn = test_open(4u, false);              /* Not subscribed */
+
+    TEST_CHECK_EQ(bt_conn_subscribers(BT_CONN_CCCD_CO2), 3u);
+    TEST_CHECK_EQ(bt_conn_subscribers(BT_CONN_CCCD_TEMPERATURE), 0u);
+
+    stub_rtos_set_tick(1250u);
+    TEST_CHECK_EQ(bt_conn_notify(BT_CONN_CCCD_CO2, TEST_HANDLE_CO2, test_value, TEST_VALUE_LEN), 1u);
+    TEST_CHECK_EQ(bt_conn_find(1u)->first_notify_ms, 250u);
+    TEST_CHECK_EQ(bt_conn_find(3u)->first_notify_ms, 0u);
+
+    /* 4-byte header and 8-byte records */
+    TEST_CHECK_EQ(bt_conn_batch_capacity(4u, 8u), 3u);
+    TEST_CHECK_EQ(bt_conn_find(3u)->batch, 5u);
+    bt_conn_find(6u)->batch = 0u;
+    TEST_CHECK_EQ(bt_conn_batch_capacity(4u, 8u), 5u);
+    bt_conn_find(3u)->mtu = BT_CONN_DEFAULT_MTU;
+    TEST_CHECK_EQ(bt_conn_batch_capacity(4u, 8u), 2u);
+    bt_conn_find(3u)->mtu = test_mtu(3u);
+    bt_conn_find(6u)->batch = test_batch(6u);
+
+    TEST_CHECK_EQ(bt_conn_notify_batch(TEST_HANDLE_BATCH, test_value, 28u), 2u);
+    TEST_CHECK_EQ(test_notified[0], 1u);
+    TEST_CHECK_EQ(test_notified[1], 2u);
+    TEST_CHECK_EQ(test_bad_len, 0u);
+    TEST_CHECK_EQ(test_bad_batch, 0u);
+    TEST_CHECK_EQ(p_conn->first_notify_ms, 0u);
+}
+
+/*******************************************************************************
+* Function Name: test_conn_link
+********************************************************************************
+* Summary:
+*  A new connection enters bulk mode and returns to idle mode once its
+*  traffic has stopped for BT_LINK_BULK_HOLD_MS.
+*
+*******************************************************************************/
+static void test_conn_link(void)
+{
+    uint32_t requests = stub_l2c_requests();
+    bt_link_t link;
+
+    stub_rtos_set_tick(0u);
+    bt_conn_init(BT_CONN_MAX);
+    bt_link_init();
+
+    (void)test_open(1u, false);
+    TEST_CHECK_EQ(stub_l2c_requests(), requests + 1u);
+    TEST_CHECK(bt_link_get(1u, &link));
+    TEST_CHECK_EQ(link.mode, BT_LINK_MODE_BULK);
+
+    /* Ongoing traffic and a repeated request keep a single bulk request */
+    stub_rtos_set_tick(4000u);
+    bt_link_activity(1u);
+    TEST_CHECK(bt_link_set_mode(1u, BT_LINK_MODE_BULK));
+    stub_rtos_set_tick(8000u);
+    stub_rtos_timers_fire();
+    TEST_CHECK(bt_link_get(1u, &link));
+    TEST_CHECK_EQ(link.mode, BT_LINK_MODE_BULK);
+    TEST_CHECK_EQ(stub_l2c_requests(), requests + 1u);
+
+    stub_rtos_set_tick(4000u + BT_LINK_BULK_HOLD_MS);
+    stub_rtos_timers_fire();
+    TEST_CHECK(bt_link_get(1u, &link));
+    TEST_CHECK_EQ(link.mode, BT_LINK_MODE_IDLE);
+    TEST_CHECK_EQ(link.switches, 2u);
+    TEST_CHECK_EQ(link.bulk_ms, 4000u + BT_LINK_BULK_HOLD_MS);
+    TEST_CHECK_EQ(stub_l2c_requests(), requests + 2u);
+
+    TEST_CHECK(!bt_link_set_mode(2u, BT_LINK_MODE_BULK));
+    TEST_CHECK(!bt_link_set_mode(1u, BT_LINK_MODE_COUNT));
+}
+
+/* Checks connection parameters against the limits iOS and macOS accept */
+static void test_link_params_check(const char *mode)
+{
+    stub_l2c_params_t params = stub_l2c_last();
+    uint32_t min_us = params.min_interval * 1250u;
+    uint32_t max_us = params.max_interval * 1250u;
+    uint32_t timeout_us = params.timeout * 10000u;
+    uint32_t product_us = max_us * (params.latency + 1u);
+
+    TEST_CHECK(min_us >= 15000u);
+    TEST_CHECK(max_us >= (min_us + 15000u));
+    TEST_CHECK(params.latency <= 30u);
+    TEST_CHECK(product_us <= 2000000u);
+    TEST_CHECK((3u * product_us) < timeout_us);
+    TEST_CHECK(timeout_us <= 6000000u);
+    (void)printf("  %s: %u..%u us, latency %u, timeout %u ms, max interval x (latency + 1) %u us\n",
+                 mode, (unsigned int)min_us, (unsigned int)max_us, (unsigned int)params.latency,
+                 (unsigned int)(timeout_us / 1000u), (unsigned int)product_us);
+}
+
+/*******************************************************************************
+* Function Name: test_link_params
+********************************************************************************
+* Summary:
+*  The parameters requested in both modes are accepted by Apple centrals.
+*
+*******************************************************************************/
+static void test_link_params(void)
+{
+    stub_rtos_set_tick(0u);
+    bt_conn_init(BT_CONN_MAX);
+    bt_link_init();
+
+    (void)test_open(1u, false);
+    test_link_params_check("bulk");
+
+    stub_rtos_set_tick(BT_LINK_BULK_HOLD_MS);
+    stub_rtos_timers_fire();
+    test_link_params_check("idle");
+}
+
+static void *test_task(void *arg)
+{
+    (void)arg;
+
+    while (!__atomic_load_n(&test_stop, __ATOMIC_RELAXED))
+    {
+        (void)bt_conn_notify(BT_CONN_CCCD_CO2, TEST_HANDLE_CO2, test_value, TEST_VALUE_LEN);
+        if (0u != bt_conn_batch_capacity(4u, 8u))
+        {
+            (void)bt_conn_notify_batch(TEST_HANDLE_BATCH, test_value, 12u);
+        }
+        (void)sched_yield();
+    }
+    return NULL;
+}
+
+static void *test_timer(void *arg)
+{
+    (void)arg;
+
+    while (!__atomic_load_n(&test_stop, __ATOMIC_RELAXED))
+    {
+        stub_rtos_timers_fire();
+        (void)sched_yield();
+    }
+    return NULL;
+}
+
+/* Closes a connection, adding its link state to the totals */
+static void test_close(uint16_t conn_id, uint32_t *p_switches, uint32_t *p_bad)
+{
+    uint32_t lifetime_ms;
+    uint32_t first_notify_ms;
+    bt_link_t link;
+
+    /* Read and removed at once, so no request of another context is lost */
+    taskENTER_CRITICAL();
+    lifetime_ms = xTaskGetTickCount() - bt_conn_find(conn_id)->connected_ms;
+    first_notify_ms = bt_conn_find(conn_id)->first_notify_ms;
+    (void)bt_link_get(conn_id, &link);
+    bt_conn_remove(conn_id);
+    taskEXIT_CRITICAL();
+
+    *p_switches += link.switches;
+    if ((link.bulk_ms > lifetime_ms) || ((0u != first_notify_ms) && !test_got[conn_id]))
+    {
+        (*p_bad)++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: test_conn_stress
+********************************************************************************
+* Summary:
+*  Runs the stack context against the BT task and the timer task. Every
+*  notification must fit the connection it went to, and only a notified
+*  connection may record one. Every mode switch recorded must match a
+*  request made to the stack, a link must stay in bulk mode for
+*  BT_LINK_BULK_HOLD_MS after traffic, and no connection may have spent
+*  longer in bulk mode than it was open.
+*
+*******************************************************************************/
+static void test_conn_stress(void)
+{
+    uint16_t open[BT_CONN_MAX] = { 0u };
+    uint32_t activity[BT_CONN_MAX];
+    uint16_t next_id = 1u;
+    uint32_t seed = 1u;
+    uint32_t switches = 0u;
+    uint32_t bad = 0u;
+    uint32_t bad_mode = 0u;
+    uint32_t requests;
+    pthread_t task;
+    pthread_t timer;
+
+    stub_rtos_set_tick(0u);
+    bt_conn_init(BT_CONN_MAX);
+    bt_link_init();
+    stub_gatt_set_notify_cb(test_notify_cb);
+    memset(test_notified, 0, sizeof(test_notified));
+    test_bad_len = 0u;
+    test_bad_batch = 0u;
+    test_yield = true;
+    requests = stub_l2c_requests();
+
+    TEST_CHECK_EQ(pthread_create(&task, NULL, test_task, NULL), 0);
+    TEST_CHECK_EQ(pthread_create(&timer, NULL, test_timer, NULL), 0);
+
+    for (uint32_t cycle = 0u; cycle < TEST_STRESS_CYCLES; cycle++)
+    {
+        uint8_t slot;
+
+        seed = (seed * 1664525u) + 1013904223u;
+        slot = (uint8_t)((seed >> 8) % BT_CONN_MAX);
+        stub_rtos_advance_tick(TEST_STRESS_TICKS);
+        if (0u == (cycle % 4u))
+        {
+            /* Let the other contexts run on a single core */
+            (void)sched_yield();
+        }
+
+        if ((0u != open[slot]) && ((xTaskGetTickCount() - activity[slot]) < BT_LINK_BULK_HOLD_MS))
+        {
+            bt_link_t link;
+
+            if (bt_link_get(open[slot], &link) && (BT_LINK_MODE_BULK != link.mode))
+            {
+                bad_mode++;
+            }
+        }
+
+        if (0u == open[slot])
+        {
+            open[slot] = next_id;
+            activity[slot] = xTaskGetTickCount();
+            (void)test_open(next_id, true);
+            next_id = (uint16_t)((next_id % 0xFFF0u) + 1u);
+        }
+        else if (0u == ((seed >> 12) % TEST_STRESS_CLOSE))
+        {
+            test_close(open[slot], &switches, &bad);
+            open[slot] = 0u;
+        }
+        else if (0u == ((seed >> 4) % TEST_STRESS_ACTIVITY))
+        {
+            activity[slot] = xTaskGetTickCount();
+            bt_link_activity(open[slot]);
+        }
+        else if (0u == ((seed >> 4) % 7u))
+        {
+            wiced_bt_ble_connection_param_update_t update =
+            {
+                .status = WICED_BT_SUCCESS, .conn_interval = 24u, .conn_latency = 0u, .supervision_timeout = 200u
+            };
+
+            test_addr(open[slot], update.bd_addr);
+            bt_link_param_update(&update);
+        }
+    }
+
+    __atomic_store_n(&test_stop, true, __ATOMIC_RELAXED);
+    TEST_CHECK_EQ(pthread_join(task, NULL), 0);
+    TEST_CHECK_EQ(pthread_join(timer, NULL), 0);
+    test_yield = false;
+
+    for (uint8_t slot = 0u; slot < BT_CONN_MAX; slot++)
+    {
+        if (0u != open[slot])
+        {
+            test_close(open[slot], &switches, &bad);
+        }
+    }
+
+    TEST_CHECK_EQ(bt_conn_count(), 0u);
+    TEST_CHECK_EQ(test_bad_len, 0u);
+    TEST_CHECK_EQ(test_bad_batch, 0u);
+    TEST_CHECK_EQ(bad, 0u);
+    TEST_CHECK_EQ(bad_mode, 0u);
+    TEST_CHECK_EQ(stub_l2c_requests() - requests, switches);
+    (void)printf("  %u connections, %u notifications, %u batches, %u mode switches\n",
+                 (unsigned int)(next_id - 1u), (unsigned int)test_notified[0],
+                 (unsigned int)test_notified[1], (unsigned int)switches);
+}
+
+int main(void)
+{
+    TEST_RUN(test_conn_table);
+    TEST_RUN(test_conn_notify);
+    TEST_RUN(test_conn_link);
+    TEST_RUN(test_link_params);
+    TEST_RUN(test_conn_stress);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,223 @@
+/*******************************************************************************
+* File Name: test_bt_notify.c
+*
+* Description: This file contains the host test of the notification
+* dispatcher: the deadband and interval trigger of a characteristic, and a
+* replay of a synthetic day of CO2 samples counting the notifications sent
+* with and without the trigger, and with the periodic marks of the tick
+* handler in between.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "FreeRTOS.h"
+#include "bt_conn.h"
+#include "bt_notify.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_HANDLE_CO2                 (0x0010u)
+#define TEST_CO2                        (0u)        /* Entry of the characteristic table */
+
+#define TEST_SAMPLE_MS                  (10000u)
+#define TEST_DAY_SAMPLES                (24u * 3600u * 1000u / TEST_SAMPLE_MS)
+#define TEST_NOISE_PPM                  (10)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+static uint8_t test_co2_value[2];
+gatt_db_lookup_table_t app_gatt_db_ext_attr_tbl[] =
+{
+    { TEST_HANDLE_CO2, sizeof(test_co2_value), sizeof(test_co2_value), test_co2_value },
+};
+const uint16_t app_gatt_db_ext_attr_tbl_size = 1u;
+
+static uint16_t test_co2_ppm;
+static uint32_t test_sent;
+
+/*******************************************************************************
+ * Function Prototype
+ ******************************************************************************/
+static void test_encode_co2(gatt_db_lookup_table_t *p_attr);
+
+static const bt_notify_desc_t test_table[] =
+{
+    [TEST_CO2] = { TEST_HANDLE_CO2, BT_CONN_CCCD_CO2, test_encode_co2 },
+};
+
+static void test_encode_co2(gatt_db_lookup_table_t *p_attr)
+{
+    p_attr->p_data[0] = (uint8_t)test_co2_ppm;
+    p_attr->p_data[1] = (uint8_t)(test_co2_ppm >> 8);
+}
+
+static wiced_bt_gatt_status_t test_notify_cb(uint16_t conn_id, uint16_t attr_handle, uint16_t val_len,
+                                             const uint8_t *p_val)
+{
+    (void)conn_id;
+    (void)attr_handle;
+    (void)val_len;
+    (void)p_val;
+
+    test_sent++;
+    return WICED_BT_GATT_SUCCESS;
+}
+
+/* One subscribed central and a dispatcher with the given trigger */
+static void test_setup(uint16_t deadband, uint16_t min_interval_s, uint16_t max_interval_s)
+{
+    static const wiced_bt_device_address_t bd_addr = { 1u, 2u, 3u, 4u, 5u, 6u };
+    bt_notify_trigger_t trigger = { deadband, min_interval_s, max_interval_s };
+    bt_conn_t *p_conn;
+
+    stub_rtos_set_tick(0u);
+    stub_gatt_set_notify_cb(test_notify_cb);
+    bt_conn_init(BT_CONN_MAX);
+    p_conn = bt_conn_add(1u, bd_addr);
+    p_conn->cccd[BT_CONN_CCCD_CO2][0] = GATT_CLIENT_CONFIG_NOTIFICATION;
+
+    bt_notify_init(test_table, 1u);
+    bt_notify_set_trigger(TEST_CO2, &trigger);
+    test_sent = 0u;
+}
+
+/* Publishes a sample as bt_task does and flushes it */
+static uint32_t test_sample(uint16_t ppm)
+{
+    test_co2_ppm = ppm;
+    bt_notify_mark_value(TEST_CO2, (int32_t)ppm);
+    return bt_notify_flush();
+}
+
+/*******************************************************************************
+* Function Name: test_notify_trigger
+********************************************************************************
+* Summary:
+*  Changes within the deadband are held back, the minimum interval delays a
+*  change, the maximum interval repeats the value, and a mark without a value
+*  only encodes the characteristic again.
+*
+*******************************************************************************/
+static void test_notify_trigger(void)
+{
+    bt_notify_stats_t stats;
+
+    test_setup(20u, 30u, 60u);
+
+    TEST_CHECK_EQ(test_sample(400u), 1u);          /* First value */
+    stub_rtos_set_tick(10000u);
+    TEST_CHECK_EQ(test_sample(415u), 0u);          /* Within the deadband */
+    stub_rtos_set_tick(20000u);
+    TEST_CHECK_EQ(test_sample(430u), 0u);          /* Held by the minimum interval */
+    stub_rtos_set_tick(30000u);
+    TEST_CHECK_EQ(bt_notify_flush(), 1u);          /* Released */
+    TEST_CHECK_EQ(test_co2_value[0] | (test_co2_value[1] << 8), 430);
+
+    /* The tick handler marks without a value */
+    stub_rtos_set_tick(40000u);
+    bt_notify_mark(TEST_CO2);
+    TEST_CHECK_EQ(bt_notify_flush(), 0u);
+
+    stub_rtos_set_tick(89999u);
+    TEST_CHECK_EQ(bt_notify_flush(), 0u);
+    stub_rtos_set_tick(90000u);
+    TEST_CHECK_EQ(bt_notify_flush(), 1u);          /* Heartbeat */
+
+    bt_notify_force(TEST_CO2);
+    TEST_CHECK_EQ(bt_notify_flush(), 1u);
+
+    bt_notify_get_stats(TEST_CO2, &stats);
+    TEST_CHECK_EQ(stats.sent, 4u);
+    TEST_CHECK_EQ(stats.heartbeats, 1u);
+    TEST_CHECK_EQ(stats.suppressed, 3u);
+    TEST_CHECK_EQ(test_sent, 4u);
+}
+
+/* CO2 of an occupied room at a time of the day, without noise */
+static uint16_t test_day_ppm(uint32_t s)
+{
+    static const struct { uint32_t s; uint16_t ppm; } points[] =
+    {
+        { 0u, 420u }, { 8u * 3600u, 420u }, { 9u * 3600u, 1100u }, { 12u * 3600u, 1150u },
+        { 13u * 3600u, 700u }, { 17u * 3600u, 1200u }, { 19u * 3600u, 450u }, { 24u * 3600u, 420u },
+    };
+    uint8_t i = 1u;
+
+    while (s > points[i].s)
+    {
+        i++;
+    }
+    return (uint16_t)(points[i - 1u].ppm + ((int32_t)(points[i].ppm - points[i - 1u].ppm) *
+                                            (int32_t)(s - points[i - 1u].s)) /
+                                           (int32_t)(points[i].s - points[i - 1u].s));
+}
+
+/* Replays the day and returns the notifications sent */
+static uint32_t test_day_run(uint16_t deadband, uint16_t min_interval_s, uint16_t max_interval_s, bool ticks)
+{
+    uint32_t seed = 1u;
+
+    test_setup(deadband, min_interval_s, max_interval_s);
+
+    for (uint32_t n = 0u; n < TEST_DAY_SAMPLES; n++)
+    {
+        int32_t noise;
+
+        seed = (seed * 1664525u) + 1013904223u;
+        noise = (int32_t)((seed >> 8) % (2u * TEST_NOISE_PPM + 1u)) - TEST_NOISE_PPM;
+        stub_rtos_set_tick(n * TEST_SAMPLE_MS);
+        test_co2_ppm = (uint16_t)(test_day_ppm(n * TEST_SAMPLE_MS / 1000u) + noise);
+        bt_notify_mark_value(TEST_CO2, test_co2_ppm);
+        if (ticks)
+        {
+            /* The tick handler may mark between the sample and its flush */
+            bt_notify_mark(TEST_CO2);
+        }
+        (void)bt_notify_flush();
+    }
+    return test_sent;
+}
+
+/*******************************************************************************
+* Function Name: test_notify_day
+********************************************************************************
+* Summary:
+*  Counts the notifications of a day of samples every 10 s with 10 ppm noise.
+*  The tick handler marks must not add any.
+*
+*******************************************************************************/
+static void test_notify_day(void)
+{
+    uint32_t every = test_day_run(0u, 0u, 0u, false);
+    uint32_t deflt = test_day_run(20u, 0u, 60u, false);
+    uint32_t ticks = test_day_run(20u, 0u, 60u, true);
+    uint32_t slow = test_day_run(50u, 30u, 300u, false);
+
+    TEST_CHECK(every > (TEST_DAY_SAMPLES * 9u / 10u));
+    TEST_CHECK(deflt < (every / 2u));
+    TEST_CHECK_EQ(ticks, deflt);
+    TEST_CHECK(slow < deflt);
+    (void)printf("  %u samples: %u notified without trigger, %u with 20 ppm / 60 s (%u with ticks), "
+                 "%u with 50 ppm / 30..300 s\n", (unsigned int)TEST_DAY_SAMPLES, (unsigned int)every,
+                 (unsigned int)deflt, (unsigned int)ticks, (unsigned int)slow);
+}
+
+int main(void)
+{
+    TEST_RUN(test_notify_trigger);
+    TEST_RUN(test_notify_day);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,171 @@
+/*******************************************************************************
+* File Name: test_bt_sensor_state.c
+*
+* Description: This file contains the host stress test of the shared sensor
+* state. One thread publishes states as fast as it can, like bt_task, while
+* reader threads take snapshots concurrently. Every field of a published state
+* is derived from its sequence number, so a snapshot mixing two states is
+* detected, and each reader must see the sequence numbers increase.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <pthread.h>
+#include <stdbool.h>
+#include "bt_sensor_state.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_PUBLISH_COUNT              (2000000u)
+#define TEST_READERS                    (3u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+typedef struct
+{
+    pthread_t thread;
+    uint32_t reads;             /* Snapshots taken while the writer ran */
+    uint32_t torn;              /* Snapshots whose fields belong to different states */
+    uint32_t backwards;         /* Snapshots older than the previous one */
+    uint32_t last_seq;
+} test_reader_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+static bool test_writer_done = false;
+
+/*******************************************************************************
+* Function Name: test_state_for
+********************************************************************************
+* Summary:
+*  Builds the state published with a sequence number; every field changes
+*  with it, in a different way.
+*
+* Parameters:
+*  uint32_t seq : Sequence number
+*
+* Return:
+*  bt_sensor_state_t : State with all fields derived from seq
+*
+*******************************************************************************/
+static bt_sensor_state_t test_state_for(uint32_t seq)
+{
+    bt_sensor_state_t state;
+
+    state.seq = seq;
+    state.time_ms = seq * 2654435761u;
+    state.co2_ppm = (uint16_t)(seq ^ 0xA5A5u);
+    state.temperature = (int16_t)(uint16_t)(seq >> 3);
+    state.status = (uint8_t)(seq & (BT_SENSOR_STATUS_ALARM | BT_SENSOR_STATUS_FCS));
+
+    return state;
+}
+
+static void *test_writer(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t seq = 1u; seq <= TEST_PUBLISH_COUNT; ++seq)
+    {
+        bt_sensor_state_t state = test_state_for(seq);
+
+        TEST_CHECK_EQ(bt_sensor_state_publish(&state), seq);
+    }
+
+    __atomic_store_n(&test_writer_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *test_reader(void *arg)
+{
+    test_reader_t *p_reader = (test_reader_t *)arg;
+
+    while (!__atomic_load_n(&test_writer_done, __ATOMIC_ACQUIRE))
+    {
+        bt_sensor_state_t state;
+        uint32_t seq = bt_sensor_state_read(&state);
+
+        if (0u == seq)
+        {
+            continue;
+        }
+
+        bt_sensor_state_t expected = test_state_for(seq);
+
+        if ((state.time_ms != expected.time_ms) || (state.co2_ppm != expected.co2_ppm) ||
+            (state.temperature != expected.temperature) || (state.status != expected.status))
+        {
+            p_reader->torn++;
+        }
+        if (seq < p_reader->last_seq)
+        {
+            p_reader->backwards++;
+        }
+        p_reader->last_seq = seq;
+        p_reader->reads++;
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: test_sensor_state_no_tearing
+********************************************************************************
+* Summary:
+*  Runs the writer against TEST_READERS concurrent readers. No snapshot may
+*  be torn or go back in time, and the last state must be readable at the end.
+*
+*******************************************************************************/
+static void test_sensor_state_no_tearing(void)
+{
+    test_reader_t readers[TEST_READERS] = { 0 };
+    pthread_t writer;
+    uint32_t reads = 0u;
+
+    for (uint32_t i = 0u; i < TEST_READERS; ++i)
+    {
+        TEST_CHECK_EQ(pthread_create(&readers[i].thread, NULL, test_reader, &readers[i]), 0);
+    }
+    TEST_CHECK_EQ(pthread_create(&writer, NULL, test_writer, NULL), 0);
+
+    TEST_CHECK_EQ(pthread_join(writer, NULL), 0);
+    for (uint32_t i = 0u; i < TEST_READERS; ++i)
+    {
+        TEST_CHECK_EQ(pthread_join(readers[i].thread, NULL), 0);
+        TEST_CHECK_EQ(readers[i].torn, 0u);
+        TEST_CHECK_EQ(readers[i].backwards, 0u);
+        reads += readers[i].reads;
+    }
+
+    /* The readers must actually have overlapped with the writer */
+    TEST_CHECK(reads > 0u);
+    (void)printf("  %u states published, %u snapshots taken\n", TEST_PUBLISH_COUNT, (unsigned int)reads);
+
+    bt_sensor_state_t last;
+    TEST_CHECK_EQ(bt_sensor_state_read(&last), TEST_PUBLISH_COUNT);
+    TEST_CHECK_EQ(last.co2_ppm, test_state_for(TEST_PUBLISH_COUNT).co2_ppm);
+}
+
+int main(void)
+{
+    bt_sensor_state_t none;
+
+    /* Nothing published yet */
+    TEST_CHECK_EQ(bt_sensor_state_read(&none), 0u);
+
+    TEST_RUN(test_sensor_state_no_tearing);
+
+    return TEST_RESULT;
+}
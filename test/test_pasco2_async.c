@@ -0,0 +1,512 @@
+/*******************************************************************************
+* File Name: test_pasco2_async.c
+*
+* Description: This file contains the host test of the asynchronous PAS CO2
+* request engine. A fake platform holds every started transfer until the test
+* completes it, like the I2C interrupt would, so that each state of the
+* engine can be observed: one transfer in flight, the inter-command delay,
+* completion order, errors and callbacks that submit new requests.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "xensiv_pasco2_async.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_MAX_REQS                   (8u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Fake platform: the transfer in flight and the virtual time */
+typedef struct
+{
+    uint32_t now_ms;
+    uint32_t started;               /* Transfers started */
+    uint32_t in_flight;             /* Transfers started and not completed */
+    int32_t start_res;              /* Returned by the next transfer start */
+    uint8_t tx[XENSIV_PASCO2_ASYNC_MAX_DATA_LEN + 1u];
+    size_t tx_len;
+    uint8_t *p_rx;
+    size_t rx_len;
+    uint32_t wakes;
+} test_plat_t;
+
+/* Completion record of one request */
+typedef struct
+{
+    uint32_t count;
+    int32_t res[TEST_MAX_REQS];
+    xensiv_pasco2_async_req_t *p_req[TEST_MAX_REQS];
+} test_log_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+static test_plat_t test_plat;
+static test_log_t test_log;
+static xensiv_pasco2_async_t test_engine;
+static xensiv_pasco2_t test_dev;
+
+/* Request submitted by test_async_resubmit_cb */
+static xensiv_pasco2_async_req_t test_followup;
+
+/**************************** Fake platform **********************************/
+
+int32_t xensiv_pasco2_plat_i2c_transfer(void *ctx, uint16_t dev_addr, const uint8_t *tx_buffer, size_t tx_len, uint8_t *rx_buffer, size_t rx_len)
+{
+    (void)ctx;
+    (void)dev_addr;
+    (void)tx_buffer;
+    (void)tx_len;
+    (void)rx_buffer;
+    (void)rx_len;
+
+    /* The engine must never block on the bus */
+    TEST_CHECK(false);
+    return XENSIV_PASCO2_ERR_COMM;
+}
+
+int32_t xensiv_pasco2_plat_i2c_transfer_async(void *ctx, uint16_t dev_addr, const uint8_t *tx_buffer, size_t tx_len, uint8_t *rx_buffer, size_t rx_len)
+{
+    TEST_CHECK(ctx == &test_plat);
+    TEST_CHECK_EQ(dev_addr, XENSIV_PASCO2_I2C_ADDR);
+    TEST_CHECK(tx_len <= sizeof(test_plat.tx));
+
+    if (XENSIV_PASCO2_OK != test_plat.start_res)
+    {
+        int32_t res = test_plat.start_res;
+        test_plat.start_res = XENSIV_PASCO2_OK;
+        return res;
+    }
+
+    test_plat.started++;
+    test_plat.in_flight++;
+    (void)memcpy(test_plat.tx, tx_buffer, tx_len);
+    test_plat.tx_len = tx_len;
+    test_plat.p_rx = rx_buffer;
+    test_plat.rx_len = rx_len;
+
+    return XENSIV_PASCO2_OK;
+}
+
+int32_t xensiv_pasco2_plat_uart_read(void *ctx, uint8_t *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    (void)len;
+    return XENSIV_PASCO2_ERR_COMM;
+}
+
+int32_t xensiv_pasco2_plat_uart_write(void *ctx, uint8_t *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    (void)len;
+    return XENSIV_PASCO2_ERR_COMM;
+}
+
+void xensiv_pasco2_plat_delay(uint32_t ms)
+{
+    test_plat.now_ms += ms;
+}
+
+uint32_t xensiv_pasco2_plat_get_time_ms(void)
+{
+    return test_plat.now_ms;
+}
+
+uint16_t xensiv_pasco2_plat_htons(uint16_t x)
+{
+    return (uint16_t)((x << 8) | (x >> 8));
+}
+
+void xensiv_pasco2_plat_assert(int expr)
+{
+    TEST_CHECK(expr);
+}
+
+/**************************** Helpers ****************************************/
+
+static void test_async_wake(void *arg)
+{
+    TEST_CHECK(arg == &test_plat);
+    test_plat.wakes++;
+}
+
+static void test_async_cb(xensiv_pasco2_async_req_t *p_req, int32_t res)
+{
+    if (test_log.count < TEST_MAX_REQS)
+    {
+        test_log.res[test_log.count] = res;
+        test_log.p_req[test_log.count] = p_req;
+    }
+    test_log.count++;
+}
+
+static void test_async_resubmit_cb(xensiv_pasco2_async_req_t *p_req, int32_t res)
+{
+    test_async_cb(p_req, res);
+    xensiv_pasco2_async_submit(&test_engine, &test_followup);
+}
+
+/* Completes the transfer in flight, filling the receive buffer with rx */
+static void test_async_complete(int32_t res, const uint8_t *p_rx)
+{
+    TEST_CHECK_EQ(test_plat.in_flight, 1u);
+    test_plat.in_flight--;
+
+    if ((p_rx != NULL) && (test_plat.p_rx != NULL))
+    {
+        (void)memcpy(test_plat.p_rx, p_rx, test_plat.rx_len);
+    }
+    xensiv_pasco2_async_xfer_done(&test_engine, res);
+}
+
+static void test_async_setup(void)
+{
+    (void)memset(&test_plat, 0, sizeof(test_plat));
+    (void)memset(&test_log, 0, sizeof(test_log));
+    (void)memset(&test_dev, 0, sizeof(test_dev));
+    (void)memset(&test_followup, 0, sizeof(test_followup));
+
+    test_plat.now_ms = 1000u;
+    test_dev.ctx = &test_plat;
+    test_dev.bus_ready_ms = test_plat.now_ms;
+    xensiv_pasco2_async_init(&test_engine, &test_dev, test_async_wake, &test_plat);
+}
+
+static void test_async_req(xensiv_pasco2_async_req_t *p_req, xensiv_pasco2_async_op_t op, uint16_t value)
+{
+    (void)memset(p_req, 0, sizeof(*p_req));
+    p_req->op = op;
+    p_req->value = value;
+    p_req->callback = test_async_cb;
+}
+
+/* Runs one request to completion after the inter-command delay */
+static void test_async_run(xensiv_pasco2_async_req_t *p_req, int32_t res, const uint8_t *p_rx)
+{
+    test_plat.now_ms += XENSIV_PASCO2_COMM_DELAY_MS;
+    xensiv_pasco2_async_submit(&test_engine, p_req);
+    (void)xensiv_pasco2_async_process(&test_engine);
+    test_async_complete(res, p_rx);
+    (void)xensiv_pasco2_async_process(&test_engine);
+}
+
+/**************************** Tests ******************************************/
+
+/*******************************************************************************
+* Function Name: test_async_order_and_spacing
+********************************************************************************
+* Summary:
+*  Queued requests run one at a time in submission order, each waits for the
+*  inter-command delay after the previous one, and the engine asks to be
+*  called again exactly when that delay ends.
+*
+*******************************************************************************/
+static void test_async_order_and_spacing(void)
+{
+    xensiv_pasco2_async_req_t rate;
+    xensiv_pasco2_async_req_t press;
+    xensiv_pasco2_async_req_t cmd;
+
+    test_async_setup();
+    test_async_req(&rate, XENSIV_PASCO2_ASYNC_SET_MEAS_RATE, 0x0123u);
+    test_async_req(&press, XENSIV_PASCO2_ASYNC_SET_PRESS_REF, 0x03F7u);
+    test_async_req(&cmd, XENSIV_PASCO2_ASYNC_CMD, XENSIV_PASCO2_CMD_SAVE_FCS_CALIB_OFFSET);
+
+    xensiv_pasco2_async_submit(&test_engine, &rate);
+    xensiv_pasco2_async_submit(&test_engine, &press);
+    xensiv_pasco2_async_submit(&test_engine, &cmd);
+    TEST_CHECK_EQ(test_plat.wakes, 3u);
+    TEST_CHECK_EQ(test_plat.started, 0u);
+
+    /* First request in flight; nothing else starts until it completes */
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_ASYNC_WAIT_FOREVER);
+    TEST_CHECK_EQ(test_plat.started, 1u);
+    TEST_CHECK_EQ(test_plat.tx_len, 3u);
+    TEST_CHECK_EQ(test_plat.tx[0], XENSIV_PASCO2_REG_MEAS_RATE_H);
+    TEST_CHECK_EQ(test_plat.tx[1], 0x01u);
+    TEST_CHECK_EQ(test_plat.tx[2], 0x23u);
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_ASYNC_WAIT_FOREVER);
+    TEST_CHECK_EQ(test_plat.started, 1u);
+
+    test_plat.now_ms += 2u;
+    test_async_complete(XENSIV_PASCO2_OK, NULL);
+    TEST_CHECK_EQ(test_plat.wakes, 4u);
+
+    /* Completed and retired; the next one waits for the spacing */
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_COMM_DELAY_MS);
+    TEST_CHECK_EQ(test_log.count, 1u);
+    TEST_CHECK(test_log.p_req[0] == &rate);
+    TEST_CHECK_EQ(test_log.res[0], XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(test_plat.started, 1u);
+
+    test_plat.now_ms += XENSIV_PASCO2_COMM_DELAY_MS - 1u;
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), 1u);
+    TEST_CHECK_EQ(test_plat.started, 1u);
+
+    test_plat.now_ms += 1u;
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_ASYNC_WAIT_FOREVER);
+    TEST_CHECK_EQ(test_plat.started, 2u);
+    TEST_CHECK_EQ(test_plat.tx[0], XENSIV_PASCO2_REG_PRESS_REF_H);
+    TEST_CHECK_EQ(test_plat.tx[1], 0x03u);
+    TEST_CHECK_EQ(test_plat.tx[2], 0xF7u);
+
+    test_async_complete(XENSIV_PASCO2_OK, NULL);
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_COMM_DELAY_MS);
+    test_plat.now_ms += XENSIV_PASCO2_COMM_DELAY_MS;
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_ASYNC_WAIT_FOREVER);
+    TEST_CHECK_EQ(test_plat.tx_len, 2u);
+    TEST_CHECK_EQ(test_plat.tx[0], XENSIV_PASCO2_REG_SENS_RST);
+    TEST_CHECK_EQ(test_plat.tx[1], XENSIV_PASCO2_CMD_SAVE_FCS_CALIB_OFFSET);
+
+    test_async_complete(XENSIV_PASCO2_OK, NULL);
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_ASYNC_WAIT_FOREVER);
+    TEST_CHECK_EQ(test_log.count, 3u);
+    TEST_CHECK(test_log.p_req[1] == &press);
+    TEST_CHECK(test_log.p_req[2] == &cmd);
+    TEST_CHECK_EQ(test_engine.completed, 3u);
+    TEST_CHECK_EQ(test_engine.errors, 0u);
+    TEST_CHECK(test_engine.head == NULL);
+    TEST_CHECK(test_engine.tail == NULL);
+    TEST_CHECK_EQ(test_engine.latency_max_ms, 2u + XENSIV_PASCO2_COMM_DELAY_MS + XENSIV_PASCO2_COMM_DELAY_MS);
+    TEST_CHECK_EQ(test_plat.started, 3u);
+}
+
+/*******************************************************************************
+* Function Name: test_async_get_result
+********************************************************************************
+* Summary:
+*  The result window is read in one transfer and decoded; a window without
+*  DRDY completes with XENSIV_PASCO2_READ_NRDY.
+*
+*******************************************************************************/
+static void test_async_get_result(void)
+{
+    /* SENS_STS, MEAS_RATE_H/L, MEAS_CFG, CO2PPM_H/L, MEAS_STS */
+    const uint8_t ready[] = { 0x80u, 0x00u, 0x3Cu, 0x02u, 0x01u, 0xF4u, 0x10u };
+    const uint8_t not_ready[] = { 0x80u, 0x00u, 0x3Cu, 0x02u, 0x01u, 0xF4u, 0x00u };
+    xensiv_pasco2_async_req_t req;
+
+    test_async_setup();
+    test_async_req(&req, XENSIV_PASCO2_ASYNC_GET_RESULT, 0u);
+
+    xensiv_pasco2_async_submit(&test_engine, &req);
+    (void)xensiv_pasco2_async_process(&test_engine);
+    TEST_CHECK_EQ(test_plat.tx_len, 1u);
+    TEST_CHECK_EQ(test_plat.tx[0], XENSIV_PASCO2_REG_SENS_STS);
+    TEST_CHECK_EQ(test_plat.rx_len, sizeof(ready));
+    test_async_complete(XENSIV_PASCO2_OK, ready);
+    (void)xensiv_pasco2_async_process(&test_engine);
+
+    TEST_CHECK_EQ(test_log.count, 1u);
+    TEST_CHECK_EQ(test_log.res[0], XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(req.result.co2_ppm, 500u);
+    TEST_CHECK_EQ(req.result.meas_rate, 60u);
+    TEST_CHECK_EQ(req.result.meas_config.b.op_mode, XENSIV_PASCO2_OP_MODE_CONTINUOUS);
+    TEST_CHECK_EQ(req.result.meas_status.b.drdy, 1u);
+
+    test_plat.now_ms += XENSIV_PASCO2_COMM_DELAY_MS;
+    xensiv_pasco2_async_submit(&test_engine, &req);
+    (void)xensiv_pasco2_async_process(&test_engine);
+    test_async_complete(XENSIV_PASCO2_OK, not_ready);
+    (void)xensiv_pasco2_async_process(&test_engine);
+
+    TEST_CHECK_EQ(test_log.count, 2u);
+    TEST_CHECK_EQ(test_log.res[1], XENSIV_PASCO2_READ_NRDY);
+}
+
+/*******************************************************************************
+* Function Name: test_async_errors
+********************************************************************************
+* Summary:
+*  A failed transfer and a transfer that cannot be started both complete
+*  their request with the error and let the queue move on. A completion
+*  reported while no transfer is in flight is ignored.
+*
+*******************************************************************************/
+static void test_async_errors(void)
+{
+    xensiv_pasco2_async_req_t first;
+    xensiv_pasco2_async_req_t second;
+    xensiv_pasco2_async_req_t third;
+
+    test_async_setup();
+    test_async_req(&first, XENSIV_PASCO2_ASYNC_CMD, XENSIV_PASCO2_CMD_RESET_ABOC);
+    test_async_req(&second, XENSIV_PASCO2_ASYNC_CMD, XENSIV_PASCO2_CMD_RESET_ABOC);
+    test_async_req(&third, XENSIV_PASCO2_ASYNC_CMD, XENSIV_PASCO2_CMD_RESET_ABOC);
+
+    xensiv_pasco2_async_xfer_done(&test_engine, XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(test_plat.wakes, 0u);
+
+    xensiv_pasco2_async_submit(&test_engine, &first);
+    xensiv_pasco2_async_submit(&test_engine, &second);
+    xensiv_pasco2_async_submit(&test_engine, &third);
+
+    (void)xensiv_pasco2_async_process(&test_engine);
+    test_async_complete(XENSIV_PASCO2_ERR_COMM, NULL);
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_COMM_DELAY_MS);
+    TEST_CHECK_EQ(test_log.count, 1u);
+
+    /* The second transfer is refused by the platform and completes at once */
+    test_plat.start_res = XENSIV_PASCO2_ERR_COMM;
+    test_plat.now_ms += XENSIV_PASCO2_COMM_DELAY_MS;
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_COMM_DELAY_MS);
+    TEST_CHECK_EQ(test_log.count, 2u);
+    TEST_CHECK_EQ(test_plat.started, 1u);
+
+    test_plat.now_ms += XENSIV_PASCO2_COMM_DELAY_MS;
+    TEST_CHECK_EQ(xensiv_pasco2_async_process(&test_engine), XENSIV_PASCO2_ASYNC_WAIT_FOREVER);
+    TEST_CHECK_EQ(test_plat.started, 2u);
+    test_async_complete(XENSIV_PASCO2_OK, NULL);
+    (void)xensiv_pasco2_async_process(&test_engine);
+
+    TEST_CHECK_EQ(test_log.count, 3u);
+    TEST_CHECK_EQ(test_log.res[0], XENSIV_PASCO2_ERR_COMM);
+    TEST_CHECK_EQ(test_log.res[1], XENSIV_PASCO2_ERR_COMM);
+    TEST_CHECK_EQ(test_log.res[2], XENSIV_PASCO2_OK);
+    TEST_CHECK(test_log.p_req[2] == &third);
+    TEST_CHECK_EQ(test_engine.errors, 2u);
+    TEST_CHECK_EQ(test_engine.completed, 3u);
+}
+
+/*******************************************************************************
+* Function Name: test_async_submit_from_callback
+********************************************************************************
+* Summary:
+*  A request submitted by a completion callback joins the queue behind the
+*  requests already pending and runs in the same processing loop once the
+*  spacing allows it.
+*
+*******************************************************************************/
+static void test_async_submit_from_callback(void)
+{
+    xensiv_pasco2_async_req_t first;
+    xensiv_pasco2_async_req_t second;
+
+    test_async_setup();
+    test_async_req(&first, XENSIV_PASCO2_ASYNC_GET_REG, 0u);
+    first.reg_addr = XENSIV_PASCO2_REG_SCRATCH_PAD;
+    first.len = 1u;
+    first.callback = test_async_resubmit_cb;
+    test_async_req(&second, XENSIV_PASCO2_ASYNC_CMD, XENSIV_PASCO2_CMD_RESET_ABOC);
+    test_async_req(&test_followup, XENSIV_PASCO2_ASYNC_CMD, XENSIV_PASCO2_CMD_RESET_FCS);
+
+    xensiv_pasco2_async_submit(&test_engine, &first);
+    xensiv_pasco2_async_submit(&test_engine, &second);
+    (void)xensiv_pasco2_async_process(&test_engine);
+
+    const uint8_t scratch = 0x5Au;
+    test_async_complete(XENSIV_PASCO2_OK, &scratch);
+    (void)xensiv_pasco2_async_process(&test_engine);
+    TEST_CHECK_EQ(first.data[0], 0x5Au);
+
+    for (uint32_t i = 0u; i < 2u; ++i)
+    {
+        test_plat.now_ms += XENSIV_PASCO2_COMM_DELAY_MS;
+        (void)xensiv_pasco2_async_process(&test_engine);
+        test_async_complete(XENSIV_PASCO2_OK, NULL);
+        (void)xensiv_pasco2_async_process(&test_engine);
+    }
+
+    TEST_CHECK_EQ(test_log.count, 3u);
+    TEST_CHECK(test_log.p_req[0] == &first);
+    TEST_CHECK(test_log.p_req[1] == &second);
+    TEST_CHECK(test_log.p_req[2] == &test_followup);
+    TEST_CHECK_EQ(test_plat.tx[1], XENSIV_PASCO2_CMD_RESET_FCS);
+}
+
+/*******************************************************************************
+* Function Name: test_async_shadow
+********************************************************************************
+* Summary:
+*  The engine keeps the shadow of the blocking API in step: a write or a read
+*  refreshes only the shadowed registers it covers, the MEAS_STS write that
+*  clears each sample leaves the configuration valid, a failed write
+*  invalidates its registers and a soft reset invalidates everything.
+*
+*******************************************************************************/
+static void test_async_shadow(void)
+{
+    /* SENS_STS, MEAS_RATE_H/L, MEAS_CFG, CO2PPM_H/L, MEAS_STS */
+    const uint8_t window[] = { 0x80u, 0x00u, 0x3Cu, 0x02u, 0x01u, 0xF4u, 0x10u };
+    const uint8_t cfg_rate = (uint8_t)((1u << XENSIV_PASCO2_SHADOW_MEAS_CFG) | (1u << XENSIV_PASCO2_SHADOW_MEAS_RATE));
+    const uint8_t press_ref = (uint8_t)(1u << XENSIV_PASCO2_SHADOW_PRESS_REF);
+    const uint8_t int_cfg = 0x12u;
+    xensiv_pasco2_async_req_t req;
+    uint8_t rate[2];
+
+    test_async_setup();
+    xensiv_pasco2_enable_shadow(&test_dev, true);
+
+    /* The result burst fills MEAS_RATE and MEAS_CFG */
+    test_async_req(&req, XENSIV_PASCO2_ASYNC_GET_RESULT, 0u);
+    test_async_run(&req, XENSIV_PASCO2_OK, window);
+    TEST_CHECK_EQ(test_dev.shadow.valid, cfg_rate);
+    TEST_CHECK_EQ(test_dev.shadow.val[XENSIV_PASCO2_SHADOW_MEAS_RATE][1], 0x3Cu);
+    TEST_CHECK_EQ(test_dev.shadow.val[XENSIV_PASCO2_SHADOW_MEAS_CFG][0], 0x02u);
+
+    /* Clearing the sample does not touch the configuration */
+    test_async_req(&req, XENSIV_PASCO2_ASYNC_SET_REG, 0u);
+    req.reg_addr = XENSIV_PASCO2_REG_MEAS_STS;
+    req.data[0] = XENSIV_PASCO2_REG_MEAS_STS_INT_STS_CLR_MSK;
+    req.len = 1u;
+    test_async_run(&req, XENSIV_PASCO2_OK, NULL);
+    TEST_CHECK_EQ(test_dev.shadow.valid, cfg_rate);
+
+    /* Writes and reads fill their own entry */
+    test_async_req(&req, XENSIV_PASCO2_ASYNC_SET_PRESS_REF, 1000u);
+    test_async_run(&req, XENSIV_PASCO2_OK, NULL);
+    TEST_CHECK_EQ(test_dev.shadow.valid, cfg_rate | press_ref);
+    TEST_CHECK_EQ(test_dev.shadow.val[XENSIV_PASCO2_SHADOW_PRESS_REF][0], 0x03u);
+    TEST_CHECK_EQ(test_dev.shadow.val[XENSIV_PASCO2_SHADOW_PRESS_REF][1], 0xE8u);
+
+    test_async_req(&req, XENSIV_PASCO2_ASYNC_GET_REG, 0u);
+    req.reg_addr = XENSIV_PASCO2_REG_INT_CFG;
+    req.len = 1u;
+    test_async_run(&req, XENSIV_PASCO2_OK, &int_cfg);
+    TEST_CHECK(0u != (test_dev.shadow.valid & (1u << XENSIV_PASCO2_SHADOW_INT_CFG)));
+    TEST_CHECK_EQ(test_dev.shadow.val[XENSIV_PASCO2_SHADOW_INT_CFG][0], int_cfg);
+
+    /* The blocking API is served from the shadow; the test device has no bus */
+    if (0u != (test_dev.shadow.valid & (1u << XENSIV_PASCO2_SHADOW_MEAS_RATE)))
+    {
+        TEST_CHECK_EQ(xensiv_pasco2_get_reg(&test_dev, XENSIV_PASCO2_REG_MEAS_RATE_H, rate, 2u), XENSIV_PASCO2_OK);
+        TEST_CHECK_EQ(rate[1], 0x3Cu);
+    }
+
+    /* A failed write leaves its registers unknown */
+    test_async_req(&req, XENSIV_PASCO2_ASYNC_SET_PRESS_REF, 1010u);
+    test_async_run(&req, XENSIV_PASCO2_ERR_COMM, NULL);
+    TEST_CHECK_EQ(test_dev.shadow.valid & press_ref, 0u);
+    TEST_CHECK_EQ(test_dev.shadow.valid & cfg_rate, cfg_rate);
+
+    test_async_req(&req, XENSIV_PASCO2_ASYNC_CMD, XENSIV_PASCO2_CMD_SOFT_RESET);
+    test_async_run(&req, XENSIV_PASCO2_OK, NULL);
+    TEST_CHECK_EQ(test_dev.shadow.valid, 0u);
+}
+
+int main(void)
+{
+    TEST_RUN(test_async_order_and_spacing);
+    TEST_RUN(test_async_get_result);
+    TEST_RUN(test_async_errors);
+    TEST_RUN(test_async_submit_from_callback);
+    TEST_RUN(test_async_shadow);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,250 @@
+/*******************************************************************************
+* File Name: test_pasco2_rate.c
+*
+* Description: This file contains the host test of the adaptive measurement
+* rate controller. The controller rules are checked on hand-picked readings,
+* and a day of room occupancy is replayed against the sensor simulator to
+* compare the adaptive period with a fixed one.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "xensiv_pasco2.h"
+#include "xensiv_pasco2_rate.h"
+#include "xensiv_pasco2_sim.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Parameters of bt_app.c */
+#define TEST_RATE_FAST_S                (10u)
+#define TEST_RATE_SLOW_S                (600u)
+#define TEST_RATE_STABLE_PPM            (30u)
+#define TEST_RATE_FAST_SLOPE_PPM_MIN    (100u)
+#define TEST_RATE_STABLE_SAMPLES        (3u)
+
+/* Replay: an 8 h occupancy triangle between 420 and 1220 ppm over 24 h */
+#define TEST_REPLAY_MS                  (24u * 3600u * 1000u)
+#define TEST_OCCUPANCY_MS               (8u * 3600u * 1000u)
+#define TEST_SUBSCRIBED_FROM_MS         (12u * 3600u * 1000u)
+#define TEST_SUBSCRIBED_MS              (3600u * 1000u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t measurements;
+    uint32_t transfers;
+    uint32_t results;
+} test_replay_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+static const xensiv_pasco2_rate_config_t test_rate_config =
+{
+    .fast_rate_s = TEST_RATE_FAST_S,
+    .slow_rate_s = TEST_RATE_SLOW_S,
+    .stable_ppm = TEST_RATE_STABLE_PPM,
+    .fast_slope_ppm_min = TEST_RATE_FAST_SLOPE_PPM_MIN,
+    .stable_samples = TEST_RATE_STABLE_SAMPLES
+};
+
+/*******************************************************************************
+* Function Name: test_rate_rules
+********************************************************************************
+* Summary:
+*  Stable readings double the period up to the slow period, a reading beyond
+*  the noise halves it, a steep change returns to the fast period, and a
+*  subscription selects the fast period and holds it.
+*
+*******************************************************************************/
+static void test_rate_rules(void)
+{
+    xensiv_pasco2_rate_ctrl_t ctrl;
+    uint16_t rate;
+
+    xensiv_pasco2_rate_init(&ctrl, &test_rate_config);
+    TEST_CHECK_EQ(ctrl.rate_s, TEST_RATE_FAST_S);
+
+    /* First reading only sets the reference */
+    TEST_CHECK_EQ(xensiv_pasco2_rate_update(&ctrl, 500u), TEST_RATE_FAST_S);
+    TEST_CHECK_EQ(xensiv_pasco2_rate_update(&ctrl, 510u), TEST_RATE_FAST_S);
+    TEST_CHECK_EQ(xensiv_pasco2_rate_update(&ctrl, 500u), TEST_RATE_FAST_S);
+    TEST_CHECK_EQ(xensiv_pasco2_rate_update(&ctrl, 505u), 2u * TEST_RATE_FAST_S);
+
+    /* Keeps doubling up to the slow period */
+    rate = ctrl.rate_s;
+    for (uint32_t i = 0u; i < (8u * TEST_RATE_STABLE_SAMPLES); ++i)
+    {
+        rate = xensiv_pasco2_rate_update(&ctrl, 505u);
+    }
+    TEST_CHECK_EQ(rate, TEST_RATE_SLOW_S);
+
+    /* 40 ppm over 600 s is slow, but beyond the noise */
+    TEST_CHECK_EQ(xensiv_pasco2_rate_update(&ctrl, 545u), TEST_RATE_SLOW_S / 2u);
+
+    /* 100 ppm over 300 s is 20 ppm/min, below the fast slope: halves again */
+    TEST_CHECK_EQ(xensiv_pasco2_rate_update(&ctrl, 645u), TEST_RATE_SLOW_S / 4u);
+
+    /* 300 ppm over 150 s is 120 ppm/min: straight to the fast period */
+    TEST_CHECK_EQ(xensiv_pasco2_rate_update(&ctrl, 945u), TEST_RATE_FAST_S);
+
+    /* Backs off again, but a subscription selects the fast period at once */
+    for (uint32_t i = 0u; i < (3u * TEST_RATE_STABLE_SAMPLES); ++i)
+    {
+        rate = xensiv_pasco2_rate_update(&ctrl, 945u);
+    }
+    TEST_CHECK(rate > TEST_RATE_FAST_S);
+    TEST_CHECK_EQ(xensiv_pasco2_rate_set_subscribed(&ctrl, true), TEST_RATE_FAST_S);
+
+    /* ...and holds it while subscribed */
+    for (uint32_t i = 0u; i < (3u * TEST_RATE_STABLE_SAMPLES); ++i)
+    {
+        rate = xensiv_pasco2_rate_update(&ctrl, 945u);
+    }
+    TEST_CHECK_EQ(rate, TEST_RATE_FAST_S);
+
+    /* Released when the subscription ends */
+    TEST_CHECK_EQ(xensiv_pasco2_rate_set_subscribed(&ctrl, false), TEST_RATE_FAST_S);
+    for (uint32_t i = 0u; i < TEST_RATE_STABLE_SAMPLES; ++i)
+    {
+        rate = xensiv_pasco2_rate_update(&ctrl, 945u);
+    }
+    TEST_CHECK_EQ(rate, 2u * TEST_RATE_FAST_S);
+}
+
+/*******************************************************************************
+* Function Name: test_rate_replay
+********************************************************************************
+* Summary:
+*  Replays the occupancy day against the simulator. The result of each
+*  measurement is read once; with adaptive set, the readings go through the
+*  controller and a new period is applied with
+*  xensiv_pasco2_start_continuous_mode, as bt_task does.
+*
+* Parameters:
+*  bool adaptive         : Use the controller instead of the fast period
+*  bool subscribe        : Subscribe for TEST_SUBSCRIBED_MS during the day
+*  test_replay_t *p_out  : Receives the counts
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void test_rate_replay(bool adaptive, bool subscribe, test_replay_t *p_out)
+{
+    const xensiv_pasco2_sim_waveform_t wave =
+    {
+        .type = XENSIV_PASCO2_SIM_WAVE_TRIANGLE,
+        .base_ppm = 420u,
+        .amplitude_ppm = 800,
+        .period_ms = TEST_OCCUPANCY_MS,
+        .noise_ppm = 10u,
+    };
+    xensiv_pasco2_sim_t sim;
+    xensiv_pasco2_t dev;
+    xensiv_pasco2_rate_ctrl_t ctrl;
+    bool subscribed = false;
+    uint16_t applied = TEST_RATE_FAST_S;
+
+    xensiv_pasco2_sim_init(&sim);
+    xensiv_pasco2_sim_set_waveform(&sim, &wave);
+    xensiv_pasco2_plat_delay(XENSIV_PASCO2_SIM_BOOT_MS);
+    TEST_CHECK_EQ(xensiv_pasco2_init_i2c(&dev, &sim), XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(xensiv_pasco2_start_continuous_mode(&dev, applied), XENSIV_PASCO2_OK);
+    xensiv_pasco2_rate_init(&ctrl, &test_rate_config);
+
+    uint32_t start_ms = sim.now_ms;
+    uint32_t start_transfers = sim.transfers;
+    uint32_t start_measurements = sim.measurements;
+
+    p_out->results = 0u;
+
+    while ((sim.now_ms - start_ms) < TEST_REPLAY_MS)
+    {
+        uint32_t t = sim.now_ms - start_ms;
+        bool subscribe_now = subscribe && (t >= TEST_SUBSCRIBED_FROM_MS) && (t < (TEST_SUBSCRIBED_FROM_MS + TEST_SUBSCRIBED_MS));
+        uint16_t rate = applied;
+        uint16_t ppm = 0u;
+
+        if (subscribe_now != subscribed)
+        {
+            subscribed = subscribe_now;
+            rate = xensiv_pasco2_rate_set_subscribed(&ctrl, subscribed);
+        }
+        else
+        {
+            xensiv_pasco2_plat_delay((uint32_t)applied * 1000u);
+
+            if (XENSIV_PASCO2_OK == xensiv_pasco2_get_result(&dev, &ppm))
+            {
+                p_out->results++;
+                if (adaptive)
+                {
+                    rate = xensiv_pasco2_rate_update(&ctrl, ppm);
+                }
+            }
+        }
+
+        if (adaptive && (rate != applied))
+        {
+            TEST_CHECK_EQ(xensiv_pasco2_start_continuous_mode(&dev, rate), XENSIV_PASCO2_OK);
+            applied = rate;
+        }
+    }
+
+    p_out->measurements = sim.measurements - start_measurements;
+    p_out->transfers = sim.transfers - start_transfers;
+
+    TEST_CHECK_EQ(sim.nacks, 0u);
+    TEST_CHECK_EQ(sim.spacing_violations, 0u);
+    (void)printf("  %s%s: %u measurements, %u results, %u transfers\n",
+                 adaptive ? "adaptive" : "fixed 10 s", subscribe ? ", subscribed 1 h" : "",
+                 (unsigned int)p_out->measurements, (unsigned int)p_out->results, (unsigned int)p_out->transfers);
+}
+
+/*******************************************************************************
+* Function Name: test_rate_day
+********************************************************************************
+* Summary:
+*  The adaptive period must take far fewer measurements and transfers over
+*  the day than the fixed fast period, and a subscription must cost extra
+*  measurements only while it lasts.
+*
+*******************************************************************************/
+static void test_rate_day(void)
+{
+    test_replay_t fixed;
+    test_replay_t adaptive;
+    test_replay_t subscribed;
+
+    test_rate_replay(false, false, &fixed);
+    test_rate_replay(true, false, &adaptive);
+    test_rate_replay(true, true, &subscribed);
+
+    TEST_CHECK(fixed.measurements >= (TEST_REPLAY_MS / (TEST_RATE_FAST_S * 1000u)) - 1u);
+    TEST_CHECK((adaptive.measurements * 4u) < fixed.measurements);
+    TEST_CHECK(adaptive.transfers < fixed.transfers);
+    TEST_CHECK(subscribed.measurements > adaptive.measurements);
+    TEST_CHECK(subscribed.measurements <
+               (adaptive.measurements + (TEST_SUBSCRIBED_MS / (TEST_RATE_FAST_S * 1000u)) + (TEST_REPLAY_MS / (TEST_RATE_SLOW_S * 1000u))));
+}
+
+int main(void)
+{
+    TEST_RUN(test_rate_rules);
+    TEST_RUN(test_rate_day);
+
+    return TEST_RESULT;
+}
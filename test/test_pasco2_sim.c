@@ -0,0 +1,536 @@
+/*******************************************************************************
+* File Name: test_pasco2_sim.c
+*
+* Description: This file contains the host test of the PAS CO2 driver against
+* the register-level sensor simulator. The driver is initialized over I2C and
+* over UART, measures a concentration step in continuous mode and must follow
+* it without violating the command spacing of the sensor. A forced
+* compensation whose start fails must leave the sensor measuring. The test
+* is also built with pipelined UART commands (test_pasco2_sim_burst).
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* $ Copyright 2023-YEAR Cypress Semiconductor $
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "xensiv_pasco2.h"
+#include "xensiv_pasco2_async.h"
+#include "xensiv_pasco2_sim.h"
+#include "test.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_MEAS_RATE_S                (5u)
+#define TEST_BASE_PPM                   (600u)
+#define TEST_STEP_PPM                   (800)
+#define TEST_STEP_MS                    (30000u)
+#define TEST_RUN_MS                     (60000u)
+#define TEST_POLL_MS                    (1000u)
+#define TEST_TICK_MS                    (100u)
+#define TEST_ALARM_PPM                  (1000u)
+#define TEST_UART_BLOCK_READS           (50u)
+
+/* Per-byte UART commands the driver sends back to back */
+#ifdef XENSIV_PASCO2_UART_CMDS_IN_FLIGHT
+#define TEST_UART_CMDS_IN_FLIGHT        (XENSIV_PASCO2_UART_CMDS_IN_FLIGHT)
+#else
+#define TEST_UART_CMDS_IN_FLIGHT        (1u)
+#endif
+
+/* Like PASCO2_DRDY_TIMEOUT_PERIODS of bt_app.c */
+#define TEST_DRDY_TIMEOUT_MS            (2u * TEST_MEAS_RATE_S * 1000u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Stand-in for the DRDY acquisition of bt_pasco2_acquire in bt_app.c */
+typedef struct
+{
+    xensiv_pasco2_async_t engine;
+    xensiv_pasco2_async_req_t result_req;
+    xensiv_pasco2_async_req_t clear_req;
+    uint32_t reqs_pending;
+    bool drdy_pending;          /* Set by the INT pin edge, like the GPIO interrupt */
+    uint32_t measurements;      /* Taken by the sensor during the run */
+    uint16_t edge_ppm;          /* Concentration at the last edge, the end of its measurement */
+    uint32_t edges;
+    uint32_t timeouts;
+    uint32_t results;
+    uint32_t wrong;             /* Results not matching the concentration at the last edge */
+} test_drdy_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+TEST_MAIN_DEFINE;
+
+static xensiv_pasco2_sim_t *p_test_drdy_sim;
+
+/*******************************************************************************
+* Function Name: test_pasco2_follow_step
+********************************************************************************
+* Summary:
+*  Starts the continuous mode on an initialized sensor and polls for results
+*  while the concentration steps up. Every result must match the
+*  concentration of its measurement, and every measurement must be read.
+*
+* Parameters:
+*  xensiv_pasco2_t *p_dev       : Initialized driver
+*  xensiv_pasco2_sim_t *p_sim   : Simulated sensor behind the driver
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void test_pasco2_follow_step(xensiv_pasco2_t *p_dev, xensiv_pasco2_sim_t *p_sim)
+{
+    const xensiv_pasco2_sim_waveform_t wave =
+    {
+        .type = XENSIV_PASCO2_SIM_WAVE_STEP,
+        .base_ppm = TEST_BASE_PPM,
+        .amplitude_ppm = TEST_STEP_PPM,
+        .period_ms = TEST_STEP_MS,
+        .noise_ppm = 0u,
+    };
+    uint32_t results = 0u;
+    uint32_t stepped = 0u;
+
+    xensiv_pasco2_sim_set_waveform(p_sim, &wave);
+    TEST_CHECK_EQ(xensiv_pasco2_start_continuous_mode(p_dev, TEST_MEAS_RATE_S), XENSIV_PASCO2_OK);
+
+    while (p_sim->now_ms < TEST_RUN_MS)
+    {
+        uint16_t ppm = 0u;
+        int32_t res;
+
+        xensiv_pasco2_plat_delay(TEST_POLL_MS);
+        res = xensiv_pasco2_get_result(p_dev, &ppm);
+
+        if (XENSIV_PASCO2_OK == res)
+        {
+            /* Polled within a second of the end of the measurement, which
+             * does not straddle the step */
+            TEST_CHECK_EQ(ppm, xensiv_pasco2_sim_get_true_ppm(p_sim));
+            results++;
+            stepped += (ppm == (TEST_BASE_PPM + TEST_STEP_PPM)) ? 1u : 0u;
+        }
+        else
+        {
+            TEST_CHECK_EQ(res, XENSIV_PASCO2_READ_NRDY);
+        }
+    }
+
+    TEST_CHECK(results >= ((TEST_RUN_MS - p_sim->ready_ms) / (TEST_MEAS_RATE_S * 1000u)) - 1u);
+    TEST_CHECK(stepped > 0u);
+    TEST_CHECK_EQ(p_sim->results_read, results);
+    TEST_CHECK_EQ(p_sim->measurements, results);
+    TEST_CHECK_EQ(p_sim->nacks, 0u);
+    TEST_CHECK_EQ(p_sim->spacing_violations, 0u);
+}
+
+/*******************************************************************************
+* Function Name: test_pasco2_i2c
+********************************************************************************
+* Summary:
+*  Measures over I2C.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void test_pasco2_i2c(void)
+{
+    xensiv_pasco2_sim_t sim;
+    xensiv_pasco2_t dev;
+
+    xensiv_pasco2_sim_init(&sim);
+    xensiv_pasco2_plat_delay(XENSIV_PASCO2_SIM_BOOT_MS);
+    TEST_CHECK_EQ(xensiv_pasco2_init_i2c(&dev, &sim), XENSIV_PASCO2_OK);
+    test_pasco2_follow_step(&dev, &sim);
+    (void)printf("  i2c: %u transfers, %u bytes\n", (unsigned int)sim.transfers, (unsigned int)sim.bus_bytes);
+}
+
+/*******************************************************************************
+* Function Name: test_pasco2_uart
+********************************************************************************
+* Summary:
+*  Measures over UART, then writes and reads back register blocks, which must
+*  match the registers of the simulator, and prints their rate. Unless
+*  bursts are enabled, the sensor must never
+*  receive a command while it still answers the previous one.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void test_pasco2_uart(void)
+{
+    const uint8_t alarm_th[2] = { 0x03u, 0xE8u };
+    uint8_t block[XENSIV_PASCO2_REG_SCRATCH_PAD - XENSIV_PASCO2_REG_INT_CFG + 1u];
+    xensiv_pasco2_sim_t sim;
+    xensiv_pasco2_t dev;
+    uint32_t start_ms;
+    uint32_t elapsed_ms;
+    uint32_t transfers;
+
+    xensiv_pasco2_sim_init(&sim);
+    xensiv_pasco2_plat_delay(XENSIV_PASCO2_SIM_BOOT_MS);
+    TEST_CHECK_EQ(xensiv_pasco2_init_uart(&dev, &sim), XENSIV_PASCO2_OK);
+    test_pasco2_follow_step(&dev, &sim);
+    (void)printf("  uart: %u transfers, %u bytes\n", (unsigned int)sim.transfers, (unsigned int)sim.bus_bytes);
+
+    /* The configuration registers after INT_CFG do not change on their own */
+    TEST_CHECK_EQ(xensiv_pasco2_set_reg(&dev, XENSIV_PASCO2_REG_ALARM_TH_H, alarm_th, sizeof(alarm_th)), XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(sim.regs[XENSIV_PASCO2_REG_ALARM_TH_H], alarm_th[0]);
+    TEST_CHECK_EQ(sim.regs[XENSIV_PASCO2_REG_ALARM_TH_L], alarm_th[1]);
+
+    start_ms = xensiv_pasco2_plat_get_time_ms();
+    transfers = sim.transfers;
+    for (uint32_t i = 0u; i < TEST_UART_BLOCK_READS; i++)
+    {
+        (void)memset(block, 0, sizeof(block));
+        sim.regs[XENSIV_PASCO2_REG_SCRATCH_PAD] = (uint8_t)(i + 1u);
+        TEST_CHECK_EQ(xensiv_pasco2_get_reg(&dev, XENSIV_PASCO2_REG_INT_CFG, block, sizeof(block)), XENSIV_PASCO2_OK);
+        TEST_CHECK_EQ(memcmp(block, &sim.regs[XENSIV_PASCO2_REG_INT_CFG], sizeof(block)), 0);
+    }
+    elapsed_ms = xensiv_pasco2_plat_get_time_ms() - start_ms;
+    transfers = sim.transfers - transfers;
+
+    TEST_CHECK_EQ(sim.nacks, 0u);
+    TEST_CHECK_EQ(sim.spacing_violations, 0u);
+    if (TEST_UART_CMDS_IN_FLIGHT > 1u)
+    {
+        TEST_CHECK(sim.uart_queued > 0u);
+    }
+    else
+    {
+        TEST_CHECK_EQ(sim.uart_queued, 0u);
+    }
+    /* The simulator charges the bytes on the wire, not the turnaround of
+     * each transfer, so bursts show up in the transfers per read */
+    (void)printf("  uart, %u commands in flight: %u %u-byte block reads/s, %u transfers each\n",
+                 (unsigned int)TEST_UART_CMDS_IN_FLIGHT,
+                 (unsigned int)((TEST_UART_BLOCK_READS * 1000u) / elapsed_ms), (unsigned int)sizeof(block),
+                 (unsigned int)(transfers / TEST_UART_BLOCK_READS));
+}
+
+/* INT pin callback; the GPIO interrupt fires on the rising edge only */
+static void test_drdy_pin(void *arg, bool level)
+{
+    test_drdy_t *p_drdy = (test_drdy_t *)arg;
+
+    if (level)
+    {
+        p_drdy->drdy_pending = true;
+        p_drdy->edge_ppm = xensiv_pasco2_sim_get_true_ppm(p_test_drdy_sim);
+        p_drdy->edges++;
+    }
+}
+
+static void test_drdy_req_done(xensiv_pasco2_async_req_t *p_req, int32_t res)
+{
+    test_drdy_t *p_drdy = (test_drdy_t *)p_req->callback_arg;
+
+    p_drdy->reqs_pending--;
+    if ((p_req == &p_drdy->result_req) && (XENSIV_PASCO2_OK == res))
+    {
+        p_drdy->results++;
+        p_drdy->wrong += (p_req->result.co2_ppm != p_drdy->edge_ppm) ? 1u : 0u;
+    }
+}
+
+/*******************************************************************************
+* Function Name: test_drdy_run
+********************************************************************************
+* Summary:
+*  Runs the DRDY acquisition loop of bt_app.c for TEST_RUN_MS of virtual
+*  time: the INT pin edge marks a result pending, which submits a burst read
+*  of the result window and, if clear_int is set, the write that releases
+*  the latched pin. A result is also read after TEST_DRDY_TIMEOUT_MS without
+*  an edge.
+*
+* Parameters:
+*  test_drdy_t *p_drdy : Acquisition state
+*  bool clear_int      : Release the INT pin after each read
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void test_drdy_run(test_drdy_t *p_drdy, bool clear_int)
+{
+    xensiv_pasco2_sim_t sim;
+    xensiv_pasco2_t dev;
+    const xensiv_pasco2_interrupt_config_t int_config =
+    {
+        .b.int_func = XENSIV_PASCO2_INTERRUPT_FUNCTION_DRDY,
+        .b.int_typ = (uint32_t)XENSIV_PASCO2_INTERRUPT_TYPE_HIGH_ACTIVE
+    };
+    const xensiv_pasco2_sim_waveform_t wave =
+    {
+        .type = XENSIV_PASCO2_SIM_WAVE_TRIANGLE,
+        .base_ppm = TEST_BASE_PPM,
+        .amplitude_ppm = TEST_STEP_PPM,
+        .period_ms = TEST_RUN_MS / 2u,
+        .noise_ppm = 0u,
+    };
+
+    (void)memset(p_drdy, 0, sizeof(*p_drdy));
+    p_test_drdy_sim = &sim;
+    xensiv_pasco2_sim_init(&sim);
+    xensiv_pasco2_sim_set_waveform(&sim, &wave);
+    xensiv_pasco2_plat_delay(XENSIV_PASCO2_SIM_BOOT_MS);
+    TEST_CHECK_EQ(xensiv_pasco2_init_i2c(&dev, &sim), XENSIV_PASCO2_OK);
+
+    xensiv_pasco2_async_init(&p_drdy->engine, &dev, NULL, NULL);
+    xensiv_pasco2_sim_set_async_engine(&sim, &p_drdy->engine);
+    xensiv_pasco2_sim_set_int_callback(&sim, test_drdy_pin, p_drdy);
+
+    /* Sequence of bt_pasco2_task: interrupt configuration, then release of
+     * a result latched meanwhile */
+    TEST_CHECK_EQ(xensiv_pasco2_set_interrupt_config(&dev, int_config), XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(xensiv_pasco2_set_alarm_threshold(&dev, TEST_ALARM_PPM), XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(xensiv_pasco2_start_continuous_mode(&dev, TEST_MEAS_RATE_S), XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(xensiv_pasco2_clear_measurement_status(&dev, XENSIV_PASCO2_REG_MEAS_STS_INT_STS_CLR_MSK), XENSIV_PASCO2_OK);
+
+    uint32_t transfers = sim.transfers;
+    uint32_t measurements = sim.measurements;
+    uint32_t deadline = sim.now_ms + TEST_DRDY_TIMEOUT_MS;
+
+    while (sim.now_ms < TEST_RUN_MS)
+    {
+        uint32_t wait_ms = xensiv_pasco2_async_process(&p_drdy->engine);
+        bool due = p_drdy->drdy_pending;
+
+        p_drdy->drdy_pending = false;
+        if ((int32_t)(deadline - sim.now_ms) <= 0)
+        {
+            p_drdy->timeouts++;
+            due = true;
+        }
+
+        if (due && (0u == p_drdy->reqs_pending))
+        {
+            deadline = sim.now_ms + TEST_DRDY_TIMEOUT_MS;
+
+            p_drdy->result_req.op = XENSIV_PASCO2_ASYNC_GET_RESULT;
+            p_drdy->result_req.callback = test_drdy_req_done;
+            p_drdy->result_req.callback_arg = p_drdy;
+            p_drdy->reqs_pending++;
+            xensiv_pasco2_async_submit(&p_drdy->engine, &p_drdy->result_req);
+
+            if (clear_int)
+            {
+                p_drdy->clear_req.op = XENSIV_PASCO2_ASYNC_SET_REG;
+                p_drdy->clear_req.reg_addr = XENSIV_PASCO2_REG_MEAS_STS;
+                p_drdy->clear_req.len = 1u;
+                p_drdy->clear_req.data[0] = XENSIV_PASCO2_REG_MEAS_STS_INT_STS_CLR_MSK;
+                p_drdy->clear_req.callback = test_drdy_req_done;
+                p_drdy->clear_req.callback_arg = p_drdy;
+                p_drdy->reqs_pending++;
+                xensiv_pasco2_async_submit(&p_drdy->engine, &p_drdy->clear_req);
+            }
+            continue;
+        }
+
+        xensiv_pasco2_plat_delay((wait_ms < TEST_TICK_MS) ? wait_ms : TEST_TICK_MS);
+    }
+
+    (void)printf("  %s: %u measurements, %u edges, %u timeouts, %u results, %u transfers\n",
+                 clear_int ? "clear" : "no clear", (unsigned int)(sim.measurements - measurements),
+                 (unsigned int)p_drdy->edges, (unsigned int)p_drdy->timeouts, (unsigned int)p_drdy->results,
+                 (unsigned int)(sim.transfers - transfers));
+
+    TEST_CHECK_EQ(sim.nacks, 0u);
+    TEST_CHECK_EQ(sim.spacing_violations, 0u);
+
+    p_drdy->measurements = sim.measurements - measurements;
+    p_test_drdy_sim = NULL;
+}
+
+/*******************************************************************************
+* Function Name: test_pasco2_drdy
+********************************************************************************
+* Summary:
+*  Acquires on the INT pin configured for DRDY, as bt_app.c does with
+*  APP_PASCO2_DRDY. Each measurement must raise exactly one edge and be read
+*  exactly once with two transfers and no timeout. Without the release of
+*  the latched pin there is a single edge, and only the timeout keeps the
+*  acquisition going.
+*
+*******************************************************************************/
+static void test_pasco2_drdy(void)
+{
+    test_drdy_t drdy;
+
+    test_drdy_run(&drdy, true);
+    TEST_CHECK(drdy.measurements >= (TEST_RUN_MS / (TEST_MEAS_RATE_S * 1000u)) - 2u);
+    TEST_CHECK_EQ(drdy.edges, drdy.measurements);
+    TEST_CHECK_EQ(drdy.results, drdy.measurements);
+    TEST_CHECK_EQ(drdy.wrong, 0u);
+    TEST_CHECK_EQ(drdy.timeouts, 0u);
+
+    test_drdy_run(&drdy, false);
+    TEST_CHECK_EQ(drdy.edges, 1u);
+    TEST_CHECK(drdy.timeouts > 0u);
+}
+
+/*******************************************************************************
+* Function Name: test_pasco2_result_burst
+********************************************************************************
+* Summary:
+*  Reads each result of a concentration step once through
+*  xensiv_pasco2_get_result and once through the burst read of
+*  xensiv_pasco2_get_result_ex. Both must decode the same concentrations; the
+*  burst takes one transfer per result instead of two and spends less virtual
+*  time waiting for the bus.
+*
+*******************************************************************************/
+static void test_pasco2_result_burst(void)
+{
+    const xensiv_pasco2_sim_waveform_t wave =
+    {
+        .type = XENSIV_PASCO2_SIM_WAVE_SQUARE,
+        .base_ppm = TEST_BASE_PPM,
+        .amplitude_ppm = TEST_STEP_PPM,
+        .period_ms = 4u * TEST_MEAS_RATE_S * 1000u,
+        .noise_ppm = 0u,
+    };
+    uint32_t transfers[2] = { 0u, 0u };
+    uint32_t busy_ms[2] = { 0u, 0u };
+    uint16_t ppms[2][TEST_RUN_MS / (TEST_MEAS_RATE_S * 1000u)];
+    uint32_t results[2] = { 0u, 0u };
+
+    for (uint32_t burst = 0u; burst < 2u; ++burst)
+    {
+        xensiv_pasco2_sim_t sim;
+        xensiv_pasco2_t dev;
+
+        xensiv_pasco2_sim_init(&sim);
+        xensiv_pasco2_sim_set_waveform(&sim, &wave);
+        xensiv_pasco2_plat_delay(XENSIV_PASCO2_SIM_BOOT_MS);
+        TEST_CHECK_EQ(xensiv_pasco2_init_i2c(&dev, &sim), XENSIV_PASCO2_OK);
+        TEST_CHECK_EQ(xensiv_pasco2_start_continuous_mode(&dev, TEST_MEAS_RATE_S), XENSIV_PASCO2_OK);
+
+        while (sim.now_ms < TEST_RUN_MS)
+        {
+            uint16_t ppm = 0u;
+            int32_t res;
+
+            /* Read right after the end of each measurement */
+            xensiv_pasco2_plat_delay(TEST_MEAS_RATE_S * 1000u);
+
+            uint32_t start_transfers = sim.transfers;
+            uint32_t start_ms = sim.now_ms;
+
+            if (0u != burst)
+            {
+                xensiv_pasco2_result_t result;
+
+                res = xensiv_pasco2_get_result_ex(&dev, &result);
+                ppm = result.co2_ppm;
+                if ((XENSIV_PASCO2_OK == res) && (0u == result.meas_status.b.drdy))
+                {
+                    res = XENSIV_PASCO2_READ_NRDY;
+                }
+            }
+            else
+            {
+                res = xensiv_pasco2_get_result(&dev, &ppm);
+            }
+
+            if ((XENSIV_PASCO2_OK == res) && (results[burst] < (sizeof(ppms[0]) / sizeof(ppms[0][0]))))
+            {
+                TEST_CHECK((TEST_BASE_PPM == ppm) || ((TEST_BASE_PPM + TEST_STEP_PPM) == ppm));
+                ppms[burst][results[burst]++] = ppm;
+                transfers[burst] += sim.transfers - start_transfers;
+                busy_ms[burst] += sim.now_ms - start_ms;
+            }
+        }
+
+        TEST_CHECK_EQ(results[burst], sim.results_read);
+        TEST_CHECK(results[burst] > 0u);
+        TEST_CHECK_EQ(transfers[burst], (0u != burst) ? results[burst] : (2u * results[burst]));
+        TEST_CHECK_EQ(sim.spacing_violations, 0u);
+    }
+
+    /* Same readings, read both ways */
+    TEST_CHECK_EQ(results[1], results[0]);
+    for (uint32_t i = 0u; (i < results[0]) && (i < results[1]); ++i)
+    {
+        TEST_CHECK_EQ(ppms[1][i], ppms[0][i]);
+    }
+
+    /* The separate reads wait for the inter-command delay in between */
+    TEST_CHECK(busy_ms[1] < busy_ms[0]);
+    (void)printf("  separate reads: %u transfers, %u ms; burst: %u transfers, %u ms\n",
+                 (unsigned int)transfers[0], (unsigned int)busy_ms[0],
+                 (unsigned int)transfers[1], (unsigned int)busy_ms[1]);
+}
+
+/*******************************************************************************
+* Function Name: test_pasco2_fcs_start_nack
+********************************************************************************
+* Summary:
+*  Fails the FCS measurement rate write of xensiv_pasco2_fcs_start after the
+*  sensor was set to idle mode. The start must fail and leave the sensor
+*  measuring in continuous mode at its previous rate.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void test_pasco2_fcs_start_nack(void)
+{
+    xensiv_pasco2_sim_t sim;
+    xensiv_pasco2_t dev;
+    xensiv_pasco2_fcs_job_t job;
+    uint32_t measurements;
+
+    xensiv_pasco2_sim_init(&sim);
+    xensiv_pasco2_plat_delay(XENSIV_PASCO2_SIM_BOOT_MS);
+    TEST_CHECK_EQ(xensiv_pasco2_init_i2c(&dev, &sim), XENSIV_PASCO2_OK);
+    TEST_CHECK_EQ(xensiv_pasco2_start_continuous_mode(&dev, TEST_MEAS_RATE_S), XENSIV_PASCO2_OK);
+
+    xensiv_pasco2_sim_nack_write(&sim, (uint8_t)XENSIV_PASCO2_REG_MEAS_RATE_H);
+    TEST_CHECK_EQ(xensiv_pasco2_fcs_start(&job, &dev, TEST_BASE_PPM, NULL, NULL), XENSIV_PASCO2_ERR_COMM);
+    TEST_CHECK(!job.active);
+    TEST_CHECK_EQ(xensiv_pasco2_fcs_step(&job), XENSIV_PASCO2_FCS_IDLE);
+    TEST_CHECK_EQ(sim.nacks, 1u);
+
+    TEST_CHECK_EQ(sim.regs[XENSIV_PASCO2_REG_MEAS_CFG] & XENSIV_PASCO2_REG_MEAS_CFG_OP_MODE_MSK,
+                  (uint8_t)XENSIV_PASCO2_OP_MODE_CONTINUOUS);
+    TEST_CHECK_EQ(((uint32_t)sim.regs[XENSIV_PASCO2_REG_MEAS_RATE_H] << 8) | sim.regs[XENSIV_PASCO2_REG_MEAS_RATE_L],
+                  TEST_MEAS_RATE_S);
+
+    measurements = sim.measurements;
+    xensiv_pasco2_plat_delay(3u * TEST_MEAS_RATE_S * 1000u);
+    TEST_CHECK(sim.measurements >= (measurements + 2u));
+}
+
+int main(void)
+{
+    TEST_RUN(test_pasco2_i2c);
+    TEST_RUN(test_pasco2_uart);
+    TEST_RUN(test_pasco2_result_burst);
+    TEST_RUN(test_pasco2_drdy);
+    TEST_RUN(test_pasco2_fcs_start_nack);
+
+    return TEST_RESULT;
+}